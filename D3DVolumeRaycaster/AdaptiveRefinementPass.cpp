@@ -0,0 +1,363 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: AdaptiveRefinementPass.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of AdaptiveRefinementPass functionality.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#include "stdafx.h"
+#include "AdaptiveRefinementPass.h"
+
+using namespace DirectX;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    AdaptiveRefinementPass::AdaptiveRefinementPass()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    AdaptiveRefinementPass::~AdaptiveRefinementPass()
+    {
+        Release();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create compute shaders and the resolve pixel shader (all part of the ray-casting shader file)
+    //------------------------------------------------------------------------------------------------------
+    bool AdaptiveRefinementPass::createShaderObjects(ID3D11Device* pD3DDevice)
+    {
+        HRESULT hr = S_OK;
+
+        const char* computeEntryPoints[2] = { "CS_REFINE_COARSE", "CS_REFINE_LEVEL" };
+        ID3D11ComputeShader** ppComputeShaders[2] = { &pCoarseCS_, &pLevelCS_ };
+        for (int idx = 0; idx < 2; idx++)
+        {
+            ID3DBlob* pCSBlob = nullptr;
+            hr = CompileShaderFromFile(L"RayCastingShader.fx", computeEntryPoints[idx], "cs_5_0", &pCSBlob);
+            if (FAILED(hr))
+            {
+                MessageBox(
+                    nullptr,
+                    L"The FX file RayCastingShader.fx cannot be compiled.  Please run this executable from the directory that contains the FX file.",
+                    L"Error",
+                    MB_OK);
+                return false;
+            }
+
+            hr = pD3DDevice->CreateComputeShader(pCSBlob->GetBufferPointer(), pCSBlob->GetBufferSize(), nullptr, ppComputeShaders[idx]);
+            SAFE_RELEASE(pCSBlob);
+            if (FAILED(hr))
+            {
+                return false;
+            }
+        }
+
+        ID3DBlob* pPSBlob = nullptr;
+        hr = CompileShaderFromFile(L"RayCastingShader.fx", "PS_REFINE_RESOLVE", "ps_5_0", &pPSBlob);
+        if (FAILED(hr))
+        {
+            MessageBox(
+                nullptr,
+                L"The FX file RayCastingShader.fx cannot be compiled.  Please run this executable from the directory that contains the FX file.",
+                L"Error",
+                MB_OK);
+            return false;
+        }
+
+        hr = pD3DDevice->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, &pResolvePS_);
+        SAFE_RELEASE(pPSBlob);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create constant buffers used to pass uniform data to the shader stages
+    //------------------------------------------------------------------------------------------------------
+    bool AdaptiveRefinementPass::createConstantBuffers(ID3D11Device* pD3DDevice)
+    {
+        D3D11_BUFFER_DESC bufferDsc = { 0 };
+        bufferDsc.Usage = D3D11_USAGE_DEFAULT;
+        bufferDsc.ByteWidth = sizeof(ConstantBufferRefine);
+        bufferDsc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        bufferDsc.CPUAccessFlags = 0;
+        HRESULT hr = pD3DDevice->CreateBuffer(&bufferDsc, nullptr, &pConstantBuffer_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create the refinement image of canvas size
+    //------------------------------------------------------------------------------------------------------
+    bool AdaptiveRefinementPass::createTextureResources(ID3D11Device* pD3DDevice, UINT canvasWidth, UINT canvasHeight)
+    {
+        HRESULT hr = S_OK;
+
+        D3D11_TEXTURE2D_DESC texDsc = { 0 };
+        texDsc.ArraySize = 1;
+        texDsc.BindFlags = D3D11_BIND_UNORDERED_ACCESS | D3D11_BIND_SHADER_RESOURCE;
+        texDsc.Usage = D3D11_USAGE_DEFAULT;
+        texDsc.Format = DXGI_FORMAT_R32_FLOAT;      // typed UAV loads are supported for R32 formats only
+        texDsc.Width = canvasWidth;
+        texDsc.Height = canvasHeight;
+        texDsc.MipLevels = 1;
+        texDsc.SampleDesc.Count = 1;
+        texDsc.CPUAccessFlags = 0;
+
+        hr = pD3DDevice->CreateTexture2D(&texDsc, nullptr, &pImageTexture_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        hr = pD3DDevice->CreateShaderResourceView(pImageTexture_, nullptr, &pImageResView_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        hr = pD3DDevice->CreateUnorderedAccessView(pImageTexture_, nullptr, &pImageUAV_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        imageSize_[0] = canvasWidth;
+        imageSize_[1] = canvasHeight;
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create the statistics counter buffer (raw UAV) and its staging buffers
+    //------------------------------------------------------------------------------------------------------
+    bool AdaptiveRefinementPass::createStatisticsBuffers(ID3D11Device* pD3DDevice)
+    {
+        HRESULT hr = S_OK;
+
+        D3D11_BUFFER_DESC bufferDesc = { 0 };
+        bufferDesc.ByteWidth = 4 * sizeof(UINT);
+        bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+        bufferDesc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+        bufferDesc.CPUAccessFlags = 0;
+        bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+
+        hr = pD3DDevice->CreateBuffer(&bufferDesc, nullptr, &pStatisticsBuffer_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc;
+        ZeroMemory(&uavDesc, sizeof(uavDesc));
+        uavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+        uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+        uavDesc.Buffer.FirstElement = 0;
+        uavDesc.Buffer.NumElements = 4;
+        uavDesc.Buffer.Flags = D3D11_BUFFER_UAV_FLAG_RAW;
+
+        hr = pD3DDevice->CreateUnorderedAccessView(pStatisticsBuffer_, &uavDesc, &pStatisticsUAV_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        bufferDesc.Usage = D3D11_USAGE_STAGING;
+        bufferDesc.BindFlags = 0;
+        bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        bufferDesc.MiscFlags = 0;
+        for (UINT idx = 0; idx < STATISTICS_LATENCY; idx++)
+        {
+            hr = pD3DDevice->CreateBuffer(&bufferDesc, nullptr, &pStatisticsStaging_[idx]);
+            if (FAILED(hr))
+            {
+                return false;
+            }
+            statisticsPending_[idx] = false;
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Initialize the refinement pass - create Direct3D resources
+    //------------------------------------------------------------------------------------------------------
+    bool AdaptiveRefinementPass::Initialize(ID3D11Device* pD3DDevice, UINT canvasWidth, UINT canvasHeight)
+    {
+        assert(pD3DDevice);
+        assert(canvasWidth > 0);
+        assert(canvasHeight > 0);
+
+        if (!createShaderObjects(pD3DDevice)) return false;
+        if (!createConstantBuffers(pD3DDevice)) return false;
+        if (!createTextureResources(pD3DDevice, canvasWidth, canvasHeight)) return false;
+        if (!createStatisticsBuffers(pD3DDevice)) return false;
+
+        frameCounter_ = 0;
+        stats_ = AdaptiveRefinementStats();
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Release all allocated resources 
+    //------------------------------------------------------------------------------------------------------
+    void AdaptiveRefinementPass::Release()
+    {
+        SAFE_RELEASE(pStatisticsUAV_);
+        SAFE_RELEASE(pStatisticsBuffer_);
+        for (UINT idx = 0; idx < STATISTICS_LATENCY; idx++)
+        {
+            SAFE_RELEASE(pStatisticsStaging_[idx]);
+            statisticsPending_[idx] = false;
+        }
+        SAFE_RELEASE(pImageUAV_);
+        SAFE_RELEASE(pImageResView_);
+        SAFE_RELEASE(pImageTexture_);
+        SAFE_RELEASE(pConstantBuffer_);
+        SAFE_RELEASE(pResolvePS_);
+        SAFE_RELEASE(pLevelCS_);
+        SAFE_RELEASE(pCoarseCS_);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Resize handler - recreates the refinement image
+    //------------------------------------------------------------------------------------------------------
+    bool AdaptiveRefinementPass::OnResize(ID3D11Device* pD3DDevice, UINT canvasWidth, UINT canvasHeight)
+    {
+        SAFE_RELEASE(pImageUAV_);
+        SAFE_RELEASE(pImageResView_);
+        SAFE_RELEASE(pImageTexture_);
+        return createTextureResources(pD3DDevice, canvasWidth, canvasHeight);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Ray-cast the coarse lattice and refine it level by level (one dispatch per level - every level reads
+    // the pixels written by the previous levels)
+    //------------------------------------------------------------------------------------------------------
+    void AdaptiveRefinementPass::Render(
+        ID3D11DeviceContext* pDeviceContext, 
+        ID3D11Buffer* pConstantBufferPS, 
+        ID3D11ShaderResourceView* pVolumeResView, 
+        ID3D11ShaderResourceView* texCubeFacesRV[2], 
+        ID3D11SamplerState* pSamplerState, 
+        float refineThreshold)
+    {
+        const UINT zero[4] = { 0, 0, 0, 0 };
+        pDeviceContext->ClearUnorderedAccessViewUint(pStatisticsUAV_, zero);
+
+        ID3D11ShaderResourceView* resViews[3] = { pVolumeResView, texCubeFacesRV[0], texCubeFacesRV[1] };
+        ID3D11Buffer* constantBuffers[3] = { pConstantBufferPS, nullptr, pConstantBuffer_ };
+        ID3D11UnorderedAccessView* unorderedViews[3] = { pImageUAV_, nullptr, pStatisticsUAV_ };
+        pDeviceContext->CSSetShaderResources(0, 3, resViews);
+        pDeviceContext->CSSetConstantBuffers(0, 3, constantBuffers);
+        pDeviceContext->CSSetUnorderedAccessViews(0, 3, unorderedViews, nullptr);
+        pDeviceContext->CSSetSamplers(0, 1, &pSamplerState);
+
+        ConstantBufferRefine cbRefine;
+        cbRefine.refineThreshold = refineThreshold;
+        cbRefine.refineImageSize[0] = imageSize_[0];
+        cbRefine.refineImageSize[1] = imageSize_[1];
+
+        for (UINT refineStep = COARSE_STEP; refineStep > 0; refineStep /= 2)
+        {
+            cbRefine.refineStep = refineStep;
+            pDeviceContext->UpdateSubresource(pConstantBuffer_, 0, nullptr, &cbRefine, 0, 0);
+
+            // one thread per lattice point of the level
+            const UINT latticeWidth = (imageSize_[0] + refineStep - 1) / refineStep;
+            const UINT latticeHeight = (imageSize_[1] + refineStep - 1) / refineStep;
+            pDeviceContext->CSSetShader(COARSE_STEP == refineStep ? pCoarseCS_ : pLevelCS_, nullptr, 0);
+            pDeviceContext->Dispatch((latticeWidth + GROUP_SIZE - 1) / GROUP_SIZE, (latticeHeight + GROUP_SIZE - 1) / GROUP_SIZE, 1);
+        }
+
+        // unbind - the refinement image is read by the resolve pixel shader next
+        ID3D11ShaderResourceView* nullResViews[3] = { nullptr, nullptr, nullptr };
+        ID3D11UnorderedAccessView* nullUnorderedViews[3] = { nullptr, nullptr, nullptr };
+        pDeviceContext->CSSetShaderResources(0, 3, nullResViews);
+        pDeviceContext->CSSetUnorderedAccessViews(0, 3, nullUnorderedViews, nullptr);
+        pDeviceContext->CSSetShader(nullptr, nullptr, 0);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Queue the statistics of the frame for read back; copies are mapped STATISTICS_LATENCY - 1 frames
+    // later, when the GPU is done with them
+    //------------------------------------------------------------------------------------------------------
+    void AdaptiveRefinementPass::EndFrame(ID3D11DeviceContext* pImmediateContext, bool readImmediately)
+    {
+        const UINT slot = static_cast<UINT>(frameCounter_ % STATISTICS_LATENCY);
+        pImmediateContext->CopyResource(pStatisticsStaging_[slot], pStatisticsBuffer_);
+        statisticsFrame_[slot] = frameCounter_;
+        statisticsPixels_[slot] = static_cast<UINT64>(imageSize_[0]) * imageSize_[1];
+        statisticsPending_[slot] = true;
+        frameCounter_++;
+
+        if (readImmediately)
+        {
+            readStatistics(pImmediateContext, slot);
+            return;
+        }
+
+        const UINT oldest = static_cast<UINT>(frameCounter_ % STATISTICS_LATENCY);
+        if (statisticsPending_[oldest] && frameCounter_ - statisticsFrame_[oldest] >= STATISTICS_LATENCY - 1)
+        {
+            readStatistics(pImmediateContext, oldest);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Map the given staging buffer and take over its statistics
+    //------------------------------------------------------------------------------------------------------
+    void AdaptiveRefinementPass::readStatistics(ID3D11DeviceContext* pImmediateContext, UINT slot)
+    {
+        D3D11_MAPPED_SUBRESOURCE mappedResource;
+        HRESULT hr = pImmediateContext->Map(pStatisticsStaging_[slot], 0, D3D11_MAP_READ, 0, &mappedResource);
+        if (SUCCEEDED(hr))
+        {
+            stats_.raysCast = reinterpret_cast<const UINT*>(mappedResource.pData)[0];
+            stats_.pixelCount = statisticsPixels_[slot];
+            pImmediateContext->Unmap(pStatisticsStaging_[slot], 0);
+        }
+        statisticsPending_[slot] = false;
+    }
+
+    ID3D11ShaderResourceView* AdaptiveRefinementPass::GetImageResourceView() const
+    {
+        return pImageResView_;
+    }
+
+    ID3D11PixelShader* AdaptiveRefinementPass::GetResolvePixelShader() const
+    {
+        return pResolvePS_;
+    }
+
+    const AdaptiveRefinementStats& AdaptiveRefinementPass::GetStats() const
+    {
+        return stats_;
+    }
+}
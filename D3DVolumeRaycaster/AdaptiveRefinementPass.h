@@ -0,0 +1,122 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: AdaptiveRefinementPass.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: adaptive image-space refinement - ray-casts a coarse pixel lattice and refines it only
+//          where neighbouring samples disagree (compute shaders).
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    // constant buffer for passing the refinement level to the HLSL compute shaders
+    struct ConstantBufferRefine
+    {
+        UINT  refineStep;           // lattice spacing of the current level
+        float refineThreshold;      // maximum difference of parent pixels that is interpolated
+        UINT  refineImageSize[2];   // image size in pixels
+    };
+
+    // statistics of a refined frame
+    struct AdaptiveRefinementStats
+    {
+        UINT64 raysCast = 0;        // rays cast over all levels
+        UINT64 pixelCount = 0;      // pixels of the frame
+    };
+
+    class AdaptiveRefinementPass
+    {
+    public:
+        // constructor / desctructor
+        AdaptiveRefinementPass();
+        virtual ~AdaptiveRefinementPass();
+
+        // avoid usage of copy constructor and =operator ...
+        AdaptiveRefinementPass(AdaptiveRefinementPass const&) = delete;
+        AdaptiveRefinementPass& operator= (AdaptiveRefinementPass const&) = delete;
+
+        // initialize the refinement pass - create compute shaders, refinement image and statistics buffers
+        bool Initialize(ID3D11Device* pD3DDevice, UINT canvasWidth, UINT canvasHeight);
+        // release all allocated resources 
+        void Release();
+        // resize handler - recreates the refinement image
+        bool OnResize(ID3D11Device* pD3DDevice, UINT canvasWidth, UINT canvasHeight);
+        // ray-cast the coarse lattice and refine it level by level; the volume, the ray setup textures and the
+        // sampler are those of the ray-casting pixel shader, pConstantBufferPS is its constant buffer
+        void Render(
+            ID3D11DeviceContext* pDeviceContext, 
+            ID3D11Buffer* pConstantBufferPS, 
+            ID3D11ShaderResourceView* pVolumeResView, 
+            ID3D11ShaderResourceView* texCubeFacesRV[2], 
+            ID3D11SamplerState* pSamplerState, 
+            float refineThreshold);
+        // queue the statistics of the frame for read back (immediate context only); readImmediately maps them
+        // right away (waits for the GPU - for offscreen rendering, which waits for the frame anyway)
+        void EndFrame(ID3D11DeviceContext* pImmediateContext, bool readImmediately);
+        // get resource view to the refined image (input of the resolve pixel shader)
+        ID3D11ShaderResourceView* GetImageResourceView() const;
+        // get the pixel shader copying the refined image to the render target
+        ID3D11PixelShader* GetResolvePixelShader() const;
+        // get the statistics of the latest frame read back (up to STATISTICS_LATENCY frames behind)
+        const AdaptiveRefinementStats& GetStats() const;
+
+        // lattice spacing of the coarse level (every 4th pixel in each dimension)
+        static const UINT COARSE_STEP = 4;
+
+    private:
+
+        // create compute shaders and the resolve pixel shader
+        bool createShaderObjects(ID3D11Device* pD3DDevice);
+        // create constant buffers used to pass uniform data to the shader stages
+        bool createConstantBuffers(ID3D11Device* pD3DDevice);
+        // create the refinement image of canvas size
+        bool createTextureResources(ID3D11Device* pD3DDevice, UINT canvasWidth, UINT canvasHeight);
+        // create the statistics counter buffer and its staging buffers
+        bool createStatisticsBuffers(ID3D11Device* pD3DDevice);
+        // map the given staging buffer and take over its statistics
+        void readStatistics(ID3D11DeviceContext* pImmediateContext, UINT slot);
+
+        // ------------------------------------------------------------------------------------------------------------
+
+        static const UINT GROUP_SIZE = 8;           // thread group size in x and y (REFINE_GROUP_SIZE)
+        static const UINT STATISTICS_LATENCY = 3;   // number of staging buffers for statistics read back
+
+        ID3D11ComputeShader*        pCoarseCS_ = nullptr;
+        ID3D11ComputeShader*        pLevelCS_ = nullptr;
+        ID3D11PixelShader*          pResolvePS_ = nullptr;
+        ID3D11Buffer*               pConstantBuffer_ = nullptr;
+        // refinement image (R32 float - read and written by the compute shaders)
+        ID3D11Texture2D*            pImageTexture_ = nullptr;
+        ID3D11ShaderResourceView*   pImageResView_ = nullptr;
+        ID3D11UnorderedAccessView*  pImageUAV_ = nullptr;
+        UINT                        imageSize_[2] = { 0, 0 };
+        // statistics counter (raw buffer) and read back ring
+        ID3D11Buffer*               pStatisticsBuffer_ = nullptr;
+        ID3D11UnorderedAccessView*  pStatisticsUAV_ = nullptr;
+        ID3D11Buffer*               pStatisticsStaging_[STATISTICS_LATENCY] = { nullptr, nullptr, nullptr };
+        UINT64                      statisticsFrame_[STATISTICS_LATENCY] = { 0, 0, 0 };
+        UINT64                      statisticsPixels_[STATISTICS_LATENCY] = { 0, 0, 0 };
+        bool                        statisticsPending_[STATISTICS_LATENCY] = { false, false, false };
+        UINT64                      frameCounter_ = 0;
+        AdaptiveRefinementStats     stats_;
+    };
+}
@@ -0,0 +1,684 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: BrickPagingPass.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of the BrickPagingPass functionality.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#include "stdafx.h"
+#include "BrickPagingPass.h"
+
+using namespace std;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    BrickPageTable::BrickPageTable()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    BrickPageTable::~BrickPageTable()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Set the entries of all bricks and a pool of free slots
+    //------------------------------------------------------------------------------------------------------
+    void BrickPageTable::Reset(std::vector<UINT>&& entries, const UINT poolSlotCounts[3])
+    {
+        entries_ = move(entries);
+        for (int axis = 0; axis < 3; axis++)
+        {
+            poolSlotCounts_[axis] = poolSlotCounts[axis];
+        }
+        const UINT slotCount = poolSlotCounts_[0] * poolSlotCounts_[1] * poolSlotCounts_[2];
+        slotBricks_.assign(slotCount, static_cast<UINT64>(NO_BRICK));
+        slotLastUsed_.assign(slotCount, 0);
+        brickRequested_.assign(entries_.size(), 0);
+        residentCount_ = 0;
+        usageFrame_ = 0;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Remove all entries and slots
+    //------------------------------------------------------------------------------------------------------
+    void BrickPageTable::Clear()
+    {
+        entries_.clear();
+        slotBricks_.clear();
+        slotLastUsed_.clear();
+        brickRequested_.clear();
+        residentCount_ = 0;
+        usageFrame_ = 0;
+    }
+
+    const std::vector<UINT>& BrickPageTable::GetEntries() const
+    {
+        return entries_;
+    }
+
+    UINT BrickPageTable::GetSlotCount() const
+    {
+        return static_cast<UINT>(slotBricks_.size());
+    }
+
+    UINT BrickPageTable::GetResidentCount() const
+    {
+        return residentCount_;
+    }
+
+    void BrickPageTable::GetSlotCoords(UINT slot, UINT slotCoords[3]) const
+    {
+        slotCoords[0] = slot % poolSlotCounts_[0];
+        slotCoords[1] = (slot / poolSlotCounts_[0]) % poolSlotCounts_[1];
+        slotCoords[2] = slot / (poolSlotCounts_[0] * poolSlotCounts_[1]);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Begin the usage of a read back frame
+    //------------------------------------------------------------------------------------------------------
+    void BrickPageTable::BeginUsage(UINT64 usageFrame)
+    {
+        usageFrame_ = usageFrame;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // A brick touched by the rays of the usage frame : resident bricks are marked as used, missing bricks
+    // are requested once (empty bricks are never paged)
+    //------------------------------------------------------------------------------------------------------
+    bool BrickPageTable::TouchBrick(UINT64 brickIndex, std::vector<UINT64>& missingBricks)
+    {
+        const UINT entry = entries_[static_cast<size_t>(brickIndex)];
+        if (entry & PAGE_RESIDENT)
+        {
+            const UINT slot = ((entry >> 20) & 0x3FF) * poolSlotCounts_[0] * poolSlotCounts_[1] + ((entry >> 10) & 0x3FF) * poolSlotCounts_[0] + (entry & 0x3FF);
+            slotLastUsed_[slot] = usageFrame_;
+            return true;
+        }
+        if (0 == (entry & PAGE_EMPTY) && 0 == brickRequested_[static_cast<size_t>(brickIndex)])
+        {
+            brickRequested_[static_cast<size_t>(brickIndex)] = 1;
+            missingBricks.push_back(brickIndex);
+        }
+        return false;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Forget the request of a brick
+    //------------------------------------------------------------------------------------------------------
+    void BrickPageTable::CancelRequest(UINT64 brickIndex)
+    {
+        brickRequested_[static_cast<size_t>(brickIndex)] = 0;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get up to count slots for new bricks : free slots first, then by the usage frame of the last use;
+    // if the working set exceeds the pool, fewer slots than requested are returned
+    //------------------------------------------------------------------------------------------------------
+    void BrickPageTable::GetReplacementSlots(size_t count, std::vector<UINT>& slots) const
+    {
+        slots.clear();
+        for (UINT slot = 0; slot < slotBricks_.size(); slot++)
+        {
+            if (NO_BRICK == slotBricks_[slot] || slotLastUsed_[slot] < usageFrame_)
+            {
+                slots.push_back(slot);
+            }
+        }
+        const size_t slotCount = min(count, slots.size());
+        partial_sort(slots.begin(), slots.begin() + slotCount, slots.end(), [this](UINT slot0, UINT slot1)
+        {
+            const UINT64 lastUsed0 = (NO_BRICK == slotBricks_[slot0]) ? 0 : slotLastUsed_[slot0] + 1;
+            const UINT64 lastUsed1 = (NO_BRICK == slotBricks_[slot1]) ? 0 : slotLastUsed_[slot1] + 1;
+            return lastUsed0 < lastUsed1;
+        });
+        slots.resize(slotCount);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Make the brick resident in the slot - the replaced brick is missing again
+    //------------------------------------------------------------------------------------------------------
+    UINT64 BrickPageTable::PlaceBrick(UINT64 brickIndex, UINT slot)
+    {
+        const UINT64 replacedBrick = slotBricks_[slot];
+        if (NO_BRICK != replacedBrick)
+        {
+            entries_[static_cast<size_t>(replacedBrick)] = 0;
+        }
+        else
+        {
+            residentCount_++;
+        }
+
+        UINT slotCoords[3];
+        GetSlotCoords(slot, slotCoords);
+        entries_[static_cast<size_t>(brickIndex)] = PAGE_RESIDENT | (slotCoords[2] << 20) | (slotCoords[1] << 10) | slotCoords[0];
+        slotBricks_[slot] = brickIndex;
+        slotLastUsed_[slot] = usageFrame_;
+        brickRequested_[static_cast<size_t>(brickIndex)] = 0;
+
+        return replacedBrick;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    BrickPagingPass::BrickPagingPass()
+        : bytesRead_(0), bricksLoaded_(0)
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    BrickPagingPass::~BrickPagingPass()
+    {
+        Release();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create the brick pool (as many slots as the budget allows, at most one per brick), the page table
+    // (empty bricks are marked, so rays neither sample nor request them) and the constant buffer
+    //------------------------------------------------------------------------------------------------------
+    bool BrickPagingPass::createTextureResources(ID3D11Device* pD3DDevice, UINT64 poolBudget)
+    {
+        HRESULT hr = S_OK;
+
+        const BrickedVolumeHeader& header = brickedVolume_.GetHeader();
+        const UINT64 brickCount = brickedVolume_.GetBrickCount();
+        const UINT paddedSize = header.brickSize + 2;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            if (header.brickCounts[axis] > D3D11_REQ_TEXTURE3D_U_V_OR_W_DIMENSION)
+            {
+                // the page table is a 3D texture
+                return false;
+            }
+        }
+
+        // pool slots : a (nearly) cubic arrangement within the 3D texture limit
+        const UINT maxSlotsPerAxis = D3D11_REQ_TEXTURE3D_U_V_OR_W_DIMENSION / paddedSize;
+        const UINT64 slotCount = max(min(poolBudget / brickedVolume_.GetBrickDataSize(), brickCount), 1ull);
+        UINT slotsXY = 1;
+        while (slotsXY < maxSlotsPerAxis && static_cast<UINT64>(slotsXY + 1) * (slotsXY + 1) * (slotsXY + 1) <= slotCount)
+        {
+            slotsXY++;
+        }
+        poolSlotCounts_[0] = slotsXY;
+        poolSlotCounts_[1] = slotsXY;
+        poolSlotCounts_[2] = static_cast<UINT>(max(min(slotCount / (slotsXY * slotsXY), static_cast<UINT64>(maxSlotsPerAxis)), 1ull));
+
+        D3D11_TEXTURE3D_DESC texDesc { 0 };
+        texDesc.Width = poolSlotCounts_[0] * paddedSize;
+        texDesc.Height = poolSlotCounts_[1] * paddedSize;
+        texDesc.Depth = poolSlotCounts_[2] * paddedSize;
+        texDesc.MipLevels = 1;
+        texDesc.Format = (2 == header.bytesPerVoxel) ? DXGI_FORMAT_R16_UNORM : DXGI_FORMAT_R8_UNORM;
+        texDesc.Usage = D3D11_USAGE_DEFAULT;
+        texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        texDesc.CPUAccessFlags = 0;
+        texDesc.MiscFlags = 0;
+
+        hr = pD3DDevice->CreateTexture3D(&texDesc, nullptr, &pBrickPoolTexture_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        hr = pD3DDevice->CreateShaderResourceView(pBrickPoolTexture_, nullptr, &pBrickPoolResView_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        // page table : all bricks missing except the empty ones, all pool slots free
+        vector<UINT> pageEntries(static_cast<size_t>(brickCount));
+        for (UINT64 brickIndex = 0; brickIndex < brickCount; brickIndex++)
+        {
+            pageEntries[static_cast<size_t>(brickIndex)] = (0 == brickedVolume_.GetBrickMax(brickIndex)) ? PAGE_EMPTY : 0;
+        }
+        pageTable_.Reset(move(pageEntries), poolSlotCounts_);
+        stats_.poolSlots = pageTable_.GetSlotCount();
+
+        texDesc.Width = header.brickCounts[0];
+        texDesc.Height = header.brickCounts[1];
+        texDesc.Depth = header.brickCounts[2];
+        texDesc.Format = DXGI_FORMAT_R32_UINT;
+
+        D3D11_SUBRESOURCE_DATA initData { 0 };
+        initData.pSysMem = pageTable_.GetEntries().data();
+        initData.SysMemPitch = header.brickCounts[0] * sizeof(UINT);
+        initData.SysMemSlicePitch = header.brickCounts[0] * header.brickCounts[1] * sizeof(UINT);
+
+        hr = pD3DDevice->CreateTexture3D(&texDesc, &initData, &pPageTableTexture_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        hr = pD3DDevice->CreateShaderResourceView(pPageTableTexture_, nullptr, &pPageTableResView_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        // the paging setup never changes while the volume is paged
+        ConstantBufferPagingPS cbPaging;
+        ZeroMemory(&cbPaging, sizeof(cbPaging));
+        for (int axis = 0; axis < 3; axis++)
+        {
+            cbPaging.pagedVolumeDimensions[axis] = static_cast<float>(header.volDimensions[axis]);
+            cbPaging.pageGridDimensions[axis] = header.brickCounts[axis];
+            cbPaging.brickPoolResolution[axis] = 1.0f / (poolSlotCounts_[axis] * paddedSize);
+        }
+        cbPaging.pageBrickSize = static_cast<float>(header.brickSize);
+
+        D3D11_BUFFER_DESC bufferDesc { 0 };
+        bufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+        bufferDesc.ByteWidth = sizeof(ConstantBufferPagingPS);
+        bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        bufferDesc.CPUAccessFlags = 0;
+
+        D3D11_SUBRESOURCE_DATA cbData { 0 };
+        cbData.pSysMem = &cbPaging;
+        hr = pD3DDevice->CreateBuffer(&bufferDesc, &cbData, &pConstantBuffer_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create the usage bit buffer (raw UAV, one bit per brick) and its staging buffers
+    //------------------------------------------------------------------------------------------------------
+    bool BrickPagingPass::createUsageBuffers(ID3D11Device* pD3DDevice)
+    {
+        HRESULT hr = S_OK;
+
+        const UINT usageWords = static_cast<UINT>((brickedVolume_.GetBrickCount() + 31) / 32);
+
+        D3D11_BUFFER_DESC bufferDesc = { 0 };
+        bufferDesc.ByteWidth = usageWords * sizeof(UINT);
+        bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+        bufferDesc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+        bufferDesc.CPUAccessFlags = 0;
+        bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+
+        hr = pD3DDevice->CreateBuffer(&bufferDesc, nullptr, &pUsageBuffer_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc;
+        ZeroMemory(&uavDesc, sizeof(uavDesc));
+        uavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+        uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+        uavDesc.Buffer.FirstElement = 0;
+        uavDesc.Buffer.NumElements = usageWords;
+        uavDesc.Buffer.Flags = D3D11_BUFFER_UAV_FLAG_RAW;
+
+        hr = pD3DDevice->CreateUnorderedAccessView(pUsageBuffer_, &uavDesc, &pUsageUAV_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        bufferDesc.Usage = D3D11_USAGE_STAGING;
+        bufferDesc.BindFlags = 0;
+        bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        bufferDesc.MiscFlags = 0;
+        for (UINT idx = 0; idx < USAGE_LATENCY; idx++)
+        {
+            hr = pD3DDevice->CreateBuffer(&bufferDesc, nullptr, &pUsageStaging_[idx]);
+            if (FAILED(hr))
+            {
+                return false;
+            }
+            usagePending_[idx] = false;
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Initialize paging of the given bricked volume
+    //------------------------------------------------------------------------------------------------------
+    bool BrickPagingPass::Initialize(ID3D11Device* pD3DDevice, const char* brickedFileName, UINT64 poolBudget)
+    {
+        assert(pD3DDevice);
+
+        Release();
+
+        if (!brickedVolume_.Open(brickedFileName)) return false;
+        if (!createTextureResources(pD3DDevice, poolBudget)) return false;
+        if (!createUsageBuffers(pD3DDevice)) return false;
+
+        frameCounter_ = 0;
+        bytesRead_ = 0;
+        bricksLoaded_ = 0;
+        throughputBytes_ = 0;
+        throughputTime_ = chrono::steady_clock::now();
+        stats_.poolSlots = pageTable_.GetSlotCount();
+
+        stopIO_ = false;
+        for (UINT threadIdx = 0; threadIdx < IO_THREAD_COUNT; threadIdx++)
+        {
+            ioThreads_.emplace_back(&BrickPagingPass::ioThreadProc, this);
+        }
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Stop the I/O threads and release all allocated resources
+    //------------------------------------------------------------------------------------------------------
+    void BrickPagingPass::Release()
+    {
+        {
+            lock_guard<mutex> lock(ioMutex_);
+            stopIO_ = true;
+        }
+        ioCondition_.notify_all();
+        for (auto& ioThread : ioThreads_) ioThread.join();
+        ioThreads_.clear();
+        requests_.clear();
+        loadedBricks_.clear();
+
+        SAFE_RELEASE(pBrickPoolResView_);
+        SAFE_RELEASE(pBrickPoolTexture_);
+        SAFE_RELEASE(pPageTableResView_);
+        SAFE_RELEASE(pPageTableTexture_);
+        SAFE_RELEASE(pConstantBuffer_);
+        SAFE_RELEASE(pUsageUAV_);
+        SAFE_RELEASE(pUsageBuffer_);
+        for (UINT idx = 0; idx < USAGE_LATENCY; idx++)
+        {
+            SAFE_RELEASE(pUsageStaging_[idx]);
+            usagePending_[idx] = false;
+        }
+
+        pageTable_.Clear();
+        brickedVolume_.Close();
+        stats_ = BrickPagingStats();
+    }
+
+    bool BrickPagingPass::IsActive() const
+    {
+        return nullptr != pBrickPoolTexture_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Begin a paged frame - upload the loaded bricks into free slots or the slots of the least recently
+    // used bricks. Bricks touched by the latest read back frame are never evicted : if the working set
+    // exceeds the pool, the remaining bricks keep the coarse level.
+    //------------------------------------------------------------------------------------------------------
+    void BrickPagingPass::BeginFrame(ID3D11DeviceContext* pImmediateContext)
+    {
+        vector<LoadedBrick> uploads;
+        {
+            lock_guard<mutex> lock(ioMutex_);
+            while (!loadedBricks_.empty() && uploads.size() < MAX_UPLOADS_PER_FRAME)
+            {
+                uploads.push_back(move(loadedBricks_.front()));
+                loadedBricks_.pop_front();
+            }
+        }
+
+        if (!uploads.empty())
+        {
+            // free slots first, then by the frame of the last use
+            vector<UINT> slots;
+            pageTable_.GetReplacementSlots(uploads.size(), slots);
+
+            const BrickedVolumeHeader& header = brickedVolume_.GetHeader();
+            const UINT paddedSize = header.brickSize + 2;
+            size_t slotIdx = 0;
+            for (const LoadedBrick& loaded : uploads)
+            {
+                if (loaded.data.empty())
+                {
+                    // unreadable brick : keeps the coarse level (and is not requested again)
+                    continue;
+                }
+                if (slotIdx >= slots.size())
+                {
+                    // no slot available - the brick is requested again when the working set moves
+                    pageTable_.CancelRequest(loaded.brickIndex);
+                    continue;
+                }
+                const UINT slot = slots[slotIdx++];
+
+                UINT slotCoords[3];
+                pageTable_.GetSlotCoords(slot, slotCoords);
+                D3D11_BOX box;
+                box.left = slotCoords[0] * paddedSize;
+                box.top = slotCoords[1] * paddedSize;
+                box.front = slotCoords[2] * paddedSize;
+                box.right = box.left + paddedSize;
+                box.bottom = box.top + paddedSize;
+                box.back = box.front + paddedSize;
+                const UINT rowPitch = paddedSize * header.bytesPerVoxel;
+                pImmediateContext->UpdateSubresource(pBrickPoolTexture_, 0, &box, loaded.data.data(), rowPitch, rowPitch * paddedSize);
+
+                // the least recently used brick of the slot is evicted
+                const UINT64 replacedBrick = pageTable_.PlaceBrick(loaded.brickIndex, slot);
+                if (BrickPageTable::NO_BRICK != replacedBrick)
+                {
+                    updatePageEntry(pImmediateContext, replacedBrick);
+                }
+                updatePageEntry(pImmediateContext, loaded.brickIndex);
+            }
+            stats_.residentBricks = pageTable_.GetResidentCount();
+        }
+
+        const UINT zero[4] = { 0, 0, 0, 0 };
+        pImmediateContext->ClearUnorderedAccessViewUint(pUsageUAV_, zero);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // End a paged frame - queue the usage bits for read back and update the I/O throughput
+    //------------------------------------------------------------------------------------------------------
+    void BrickPagingPass::EndFrame(ID3D11DeviceContext* pImmediateContext)
+    {
+        const UINT slot = static_cast<UINT>(frameCounter_ % USAGE_LATENCY);
+        if (usagePending_[slot])
+        {
+            // the ring is full - the oldest copy has to be read before it is overwritten
+            readUsage(pImmediateContext);
+        }
+        pImmediateContext->CopyResource(pUsageStaging_[slot], pUsageBuffer_);
+        usageFrame_[slot] = frameCounter_;
+        usagePending_[slot] = true;
+        frameCounter_++;
+
+        // read back copies that are USAGE_LATENCY - 1 frames old (GPU is done with them by now)
+        const UINT oldest = static_cast<UINT>(frameCounter_ % USAGE_LATENCY);
+        if (usagePending_[oldest] && frameCounter_ - usageFrame_[oldest] >= USAGE_LATENCY - 1)
+        {
+            readUsage(pImmediateContext);
+        }
+
+        // I/O throughput over intervals of (at least) one second
+        stats_.bytesRead = bytesRead_;
+        stats_.bricksLoaded = bricksLoaded_;
+        const auto now = chrono::steady_clock::now();
+        const double intervalSec = chrono::duration<double>(now - throughputTime_).count();
+        if (intervalSec >= 1.0)
+        {
+            stats_.ioThroughputMBs = (stats_.bytesRead - throughputBytes_) / (1024.0 * 1024.0) / intervalSec;
+            throughputBytes_ = stats_.bytesRead;
+            throughputTime_ = now;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Read back the oldest queued usage bits : touched resident bricks are marked as used, touched missing
+    // bricks are requested from the I/O threads (newest requests first)
+    //------------------------------------------------------------------------------------------------------
+    void BrickPagingPass::readUsage(ID3D11DeviceContext* pImmediateContext)
+    {
+        const UINT oldest = static_cast<UINT>(frameCounter_ % USAGE_LATENCY);
+        if (!usagePending_[oldest])
+        {
+            return;
+        }
+        usagePending_[oldest] = false;
+
+        D3D11_MAPPED_SUBRESOURCE mappedResource;
+        HRESULT hr = pImmediateContext->Map(pUsageStaging_[oldest], 0, D3D11_MAP_READ, 0, &mappedResource);
+        if (FAILED(hr))
+        {
+            return;
+        }
+
+        pageTable_.BeginUsage(usageFrame_[oldest]);
+        const UINT* pUsageWords = reinterpret_cast<const UINT*>(mappedResource.pData);
+        const UINT64 brickCount = brickedVolume_.GetBrickCount();
+        const size_t usageWords = static_cast<size_t>((brickCount + 31) / 32);
+        vector<UINT64> missingBricks;
+        for (size_t wordIdx = 0; wordIdx < usageWords; wordIdx++)
+        {
+            const UINT usageBits = pUsageWords[wordIdx];
+            for (UINT bit = 0; 0 != usageBits && bit < 32; bit++)
+            {
+                if (0 == (usageBits & (1u << bit)))
+                {
+                    continue;
+                }
+                const UINT64 brickIndex = wordIdx * 32 + bit;
+                if (brickIndex >= brickCount)
+                {
+                    break;
+                }
+                stats_.bricksTouched++;
+                if (pageTable_.TouchBrick(brickIndex, missingBricks))
+                {
+                    stats_.cacheHits++;
+                }
+            }
+        }
+        pImmediateContext->Unmap(pUsageStaging_[oldest], 0);
+
+        if (!missingBricks.empty())
+        {
+            {
+                lock_guard<mutex> lock(ioMutex_);
+                for (UINT64 brickIndex : missingBricks)
+                {
+                    requests_.push_front(brickIndex);
+                }
+                // drop the oldest requests (the view has moved on - they are requested again if still needed)
+                while (requests_.size() > MAX_QUEUED_REQUESTS)
+                {
+                    pageTable_.CancelRequest(requests_.back());
+                    requests_.pop_back();
+                }
+            }
+            ioCondition_.notify_all();
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Copy the page table entry of a brick to the page table texture
+    //------------------------------------------------------------------------------------------------------
+    void BrickPagingPass::updatePageEntry(ID3D11DeviceContext* pImmediateContext, UINT64 brickIndex)
+    {
+        const BrickedVolumeHeader& header = brickedVolume_.GetHeader();
+        const UINT entry = pageTable_.GetEntries()[static_cast<size_t>(brickIndex)];
+
+        D3D11_BOX box;
+        box.left = static_cast<UINT>(brickIndex % header.brickCounts[0]);
+        box.top = static_cast<UINT>((brickIndex / header.brickCounts[0]) % header.brickCounts[1]);
+        box.front = static_cast<UINT>(brickIndex / (static_cast<UINT64>(header.brickCounts[0]) * header.brickCounts[1]));
+        box.right = box.left + 1;
+        box.bottom = box.top + 1;
+        box.back = box.front + 1;
+        pImmediateContext->UpdateSubresource(pPageTableTexture_, 0, &box, &entry, sizeof(UINT), sizeof(UINT));
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // I/O thread : read requested bricks (newest first) until the pass is released
+    //------------------------------------------------------------------------------------------------------
+    void BrickPagingPass::ioThreadProc()
+    {
+        ifstream brickFile;
+        if (!brickedVolume_.OpenStream(brickFile))
+        {
+            return;
+        }
+
+        const size_t brickDataSize = brickedVolume_.GetBrickDataSize();
+        for (;;)
+        {
+            LoadedBrick loaded;
+            {
+                unique_lock<mutex> lock(ioMutex_);
+                ioCondition_.wait(lock, [this] { return stopIO_ || !requests_.empty(); });
+                if (stopIO_)
+                {
+                    return;
+                }
+                loaded.brickIndex = requests_.front();
+                requests_.pop_front();
+            }
+
+            loaded.data.resize(brickDataSize);
+            if (brickedVolume_.ReadBrick(brickFile, loaded.brickIndex, loaded.data.data()))
+            {
+                bytesRead_ += brickDataSize;
+                bricksLoaded_++;
+            }
+            else
+            {
+                loaded.data.clear();
+            }
+
+            lock_guard<mutex> lock(ioMutex_);
+            loadedBricks_.push_back(move(loaded));
+        }
+    }
+
+    void BrickPagingPass::Bind(ID3D11DeviceContext* pDeviceContext) const
+    {
+        ID3D11ShaderResourceView* pagingResViews[2] = { pBrickPoolResView_, pPageTableResView_ };
+        ID3D11Buffer* pConstantBuffer = pConstantBuffer_;
+        pDeviceContext->PSSetShaderResources(8, 2, pagingResViews);
+        pDeviceContext->PSSetConstantBuffers(4, 1, &pConstantBuffer);
+    }
+
+    ID3D11UnorderedAccessView* BrickPagingPass::GetUsageView() const
+    {
+        return pUsageUAV_;
+    }
+
+    const BrickedVolume& BrickPagingPass::GetBrickedVolume() const
+    {
+        return brickedVolume_;
+    }
+
+    const BrickPagingStats& BrickPagingPass::GetStats() const
+    {
+        return stats_;
+    }
+}
@@ -0,0 +1,209 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: BrickPagingPass.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: include file for implementation of the BrickPagingPass functionality. Out-of-core paging
+//          of the bricks of a bricked volume into a fixed-budget GPU brick pool.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+#include "BrickedVolume.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    // constant buffer for passing the paging setup to the HLSL paged ray casting pixel-shader
+    struct ConstantBufferPagingPS
+    {
+        float pagedVolumeDimensions[3];     // full resolution dimensions in voxels
+        float pageBrickSize;                // edge length in voxels of a paged brick (without apron)
+        UINT  pageGridDimensions[3];        // number of bricks per axis
+        UINT  padding1;
+        float brickPoolResolution[3];       // 1 / dimensions of the brick pool texture in voxels
+        float padding2;
+    };
+
+    // paging statistics (cache hit rate of the bricks touched by the rays and I/O throughput)
+    struct BrickPagingStats
+    {
+        UINT64  bricksTouched = 0;          // bricks touched by the rays (non-empty, all read back frames)
+        UINT64  cacheHits = 0;              // touched bricks that were resident
+        UINT64  bricksLoaded = 0;           // bricks read by the I/O threads
+        UINT64  bytesRead = 0;              // bytes read by the I/O threads
+        double  ioThroughputMBs = 0.0;      // read throughput of the I/O threads (MB/s, latest interval)
+        UINT    residentBricks = 0;         // bricks resident in the brick pool
+        UINT    poolSlots = 0;              // capacity of the brick pool in bricks
+    };
+
+    // CPU side of the paging : page table entries, pool slots of the resident bricks (the least recently used
+    // bricks are replaced) and the requested bricks
+    class BrickPageTable
+    {
+    public:
+        // page table entries : 0 = missing (sample the coarse level and request the brick), PAGE_EMPTY = all voxels
+        // zero (never paged), otherwise PAGE_RESIDENT | pool slot (10 bits per axis)
+        static const UINT PAGE_EMPTY = 0x80000000;
+        static const UINT PAGE_RESIDENT = 0x40000000;
+        // brick of a free slot
+        static const UINT64 NO_BRICK = UINT64_MAX;
+
+        // constructor / desctructor
+        BrickPageTable();
+        virtual ~BrickPageTable();
+
+        // avoid usage of copy constructor and =operator ...
+        BrickPageTable(BrickPageTable const&) = delete;
+        BrickPageTable& operator= (BrickPageTable const&) = delete;
+
+        // set the entries of all bricks (0 or PAGE_EMPTY) and a pool of free slots (slots per axis)
+        void Reset(std::vector<UINT>&& entries, const UINT poolSlotCounts[3]);
+        // remove all entries and slots
+        void Clear();
+        // get the entries of all bricks (x fastest)
+        const std::vector<UINT>& GetEntries() const;
+        // get the number of pool slots and of the slots holding a brick
+        UINT GetSlotCount() const;
+        UINT GetResidentCount() const;
+        // get the pool coordinates of a slot (x fastest)
+        void GetSlotCoords(UINT slot, UINT slotCoords[3]) const;
+
+        // begin the usage of a read back frame - bricks used in the latest usage frame are never replaced
+        void BeginUsage(UINT64 usageFrame);
+        // a brick touched by the rays of the usage frame : a resident brick is marked as used (true); a missing brick
+        // not requested yet is marked as requested and appended to missingBricks
+        bool TouchBrick(UINT64 brickIndex, std::vector<UINT64>& missingBricks);
+        // forget the request of a brick (request dropped, no slot) - the brick is requested again when it is touched
+        void CancelRequest(UINT64 brickIndex);
+
+        // get up to count slots for new bricks in replacement order : free slots first, then the least recently used
+        // ones (slots of bricks used in the latest usage frame are left out)
+        void GetReplacementSlots(size_t count, std::vector<UINT>& slots) const;
+        // make the brick resident in the slot - returns the replaced brick (NO_BRICK for a free slot), whose entry is
+        // missing again
+        UINT64 PlaceBrick(UINT64 brickIndex, UINT slot);
+
+    private:
+
+        std::vector<UINT>       entries_;
+        std::vector<UINT64>     slotBricks_;            // brick of every pool slot (NO_BRICK = free)
+        std::vector<UINT64>     slotLastUsed_;          // latest usage frame that touched the brick of a slot
+        std::vector<BYTE>       brickRequested_;        // != 0 : brick queued, loading or waiting for upload
+        UINT                    poolSlotCounts_[3] = { 0, 0, 0 };
+        UINT                    residentCount_ = 0;
+        UINT64                  usageFrame_ = 0;
+    };
+
+    class BrickPagingPass
+    {
+    public:
+        // page table entries (see BrickPageTable)
+        static const UINT PAGE_EMPTY = BrickPageTable::PAGE_EMPTY;
+        static const UINT PAGE_RESIDENT = BrickPageTable::PAGE_RESIDENT;
+        // number of I/O threads reading requested bricks
+        static const UINT IO_THREAD_COUNT = 4;
+        // maximum number of bricks uploaded to the brick pool per frame (bounds the upload cost of a frame)
+        static const UINT MAX_UPLOADS_PER_FRAME = 64;
+        // maximum number of queued brick requests (older requests are dropped - the rays request them again)
+        static const UINT MAX_QUEUED_REQUESTS = 1024;
+
+        // constructor / desctructor
+        BrickPagingPass();
+        virtual ~BrickPagingPass();
+
+        // avoid usage of copy constructor and =operator ...
+        BrickPagingPass(BrickPagingPass const&) = delete;
+        BrickPagingPass& operator= (BrickPagingPass const&) = delete;
+
+        // initialize paging of the given bricked volume - create brick pool (at most poolBudget bytes), page table and
+        // usage buffers and start the I/O threads
+        bool Initialize(ID3D11Device* pD3DDevice, const char* brickedFileName, UINT64 poolBudget);
+        // stop the I/O threads and release all allocated resources
+        void Release();
+        // is a bricked volume paged
+        bool IsActive() const;
+        // begin a paged frame - upload loaded bricks (evicting the least recently used ones) and reset the usage bits
+        void BeginFrame(ID3D11DeviceContext* pImmediateContext);
+        // end a paged frame - queue the usage bits for read back; the oldest read back marks resident bricks as used and
+        // requests the missing ones
+        void EndFrame(ID3D11DeviceContext* pImmediateContext);
+        // bind brick pool (t8), page table (t9) and the paging constant buffer (b4) to the pixel shader stage
+        void Bind(ID3D11DeviceContext* pDeviceContext) const;
+        // get unordered access view to the brick usage bits (one bit per brick)
+        ID3D11UnorderedAccessView* GetUsageView() const;
+
+        // get the bricked volume
+        const BrickedVolume& GetBrickedVolume() const;
+        // get the paging statistics
+        const BrickPagingStats& GetStats() const;
+
+    private:
+
+        // a brick read by an I/O thread, waiting for upload
+        struct LoadedBrick
+        {
+            UINT64              brickIndex;
+            std::vector<char>   data;
+        };
+
+        // create brick pool texture, page table texture and constant buffer
+        bool createTextureResources(ID3D11Device* pD3DDevice, UINT64 poolBudget);
+        // create the usage bit buffer and its staging buffers
+        bool createUsageBuffers(ID3D11Device* pD3DDevice);
+        // read back the oldest queued usage bits (without stalling on the GPU)
+        void readUsage(ID3D11DeviceContext* pImmediateContext);
+        // copy the page table entry of a brick to the page table texture
+        void updatePageEntry(ID3D11DeviceContext* pImmediateContext, UINT64 brickIndex);
+        // I/O thread : read requested bricks until the pass is released
+        void ioThreadProc();
+
+        // ------------------------------------------------------------------------------------------------------------
+
+        static const UINT USAGE_LATENCY = 3;    // number of staging buffers for usage read back
+
+        BrickedVolume               brickedVolume_;
+        // brick pool (slots of (PAGE_BRICK_SIZE + 2)^3 voxels) and page table (one entry per brick)
+        ID3D11Texture3D*            pBrickPoolTexture_ = nullptr;
+        ID3D11ShaderResourceView*   pBrickPoolResView_ = nullptr;
+        ID3D11Texture3D*            pPageTableTexture_ = nullptr;
+        ID3D11ShaderResourceView*   pPageTableResView_ = nullptr;
+        ID3D11Buffer*               pConstantBuffer_ = nullptr;
+        UINT                        poolSlotCounts_[3] = { 0, 0, 0 };
+        BrickPageTable              pageTable_;         // CPU copy of the page table, pool slots and requests
+        // usage bits (raw buffer) and read back ring
+        ID3D11Buffer*               pUsageBuffer_ = nullptr;
+        ID3D11UnorderedAccessView*  pUsageUAV_ = nullptr;
+        ID3D11Buffer*               pUsageStaging_[USAGE_LATENCY] = { nullptr, nullptr, nullptr };
+        UINT64                      usageFrame_[USAGE_LATENCY] = { 0, 0, 0 };
+        bool                        usagePending_[USAGE_LATENCY] = { false, false, false };
+        UINT64                      frameCounter_ = 0;
+        // I/O threads : requests (newest first) and loaded bricks
+        std::vector<std::thread>    ioThreads_;
+        std::mutex                  ioMutex_;
+        std::condition_variable     ioCondition_;
+        std::deque<UINT64>          requests_;
+        std::deque<LoadedBrick>     loadedBricks_;
+        bool                        stopIO_ = false;
+        std::atomic<UINT64>         bytesRead_;
+        std::atomic<UINT64>         bricksLoaded_;
+        UINT64                      throughputBytes_ = 0;
+        std::chrono::steady_clock::time_point throughputTime_;
+        BrickPagingStats            stats_;
+    };
+}
@@ -0,0 +1,436 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: BrickedVolume.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of the BrickedVolume functionality.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#include "stdafx.h"
+#include "BrickedVolume.h"
+
+using namespace std;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    namespace
+    {
+        const char BRICKED_VOLUME_MAGIC[4] = { 'B', 'R', 'K', 'V' };
+        const UINT BRICKED_VOLUME_VERSION = 2;
+
+        //------------------------------------------------------------------------------------------------------
+        // Maximum of count voxels (BYTE or UINT16)
+        //------------------------------------------------------------------------------------------------------
+        template <typename T>
+        UINT16 calcMaxValue(const char* pData, size_t count)
+        {
+            const T* pVoxels = reinterpret_cast<const T*>(pData);
+            T value = 0;
+            for (size_t idx = 0; idx < count; idx++)
+            {
+                value = max(value, pVoxels[idx]);
+            }
+            return static_cast<UINT16>(value);
+        }
+
+        //------------------------------------------------------------------------------------------------------
+        // Keep the per-block maximum of a row in the coarse level (BYTE or UINT16)
+        //------------------------------------------------------------------------------------------------------
+        template <typename T>
+        void reduceMaxRow(const char* pSourceRow, UINT columns, UINT coarseFactor, char* pCoarseRow)
+        {
+            const T* pSource = reinterpret_cast<const T*>(pSourceRow);
+            T* pCoarse = reinterpret_cast<T*>(pCoarseRow);
+            for (UINT x = 0; x < columns; x++)
+            {
+                pCoarse[x / coarseFactor] = max(pCoarse[x / coarseFactor], pSource[x]);
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    BrickedVolume::BrickedVolume()
+    {
+        ZeroMemory(&header_, sizeof(header_));
+        ZeroMemory(&coarseDatasetInfo_, sizeof(coarseDatasetInfo_));
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    BrickedVolume::~BrickedVolume()
+    {
+        Close();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Convert a raw volume file into a bricked volume file. The raw file is read one brick layer (plus the
+    // apron slices) at a time, so the memory needed is independent of the number of slices. Every brick
+    // is stored with a one voxel apron (zero outside the volume), which lets the ray-caster interpolate
+    // trilinearly inside a brick without its neighbours. The coarse fallback level is the per-block maximum
+    // of the full resolution voxels (MIP preserving, like the resolution levels of VolumeResource).
+    //------------------------------------------------------------------------------------------------------
+    bool BrickedVolume::Convert(const VolumeDatasetInfo& datasetInfo, const char* brickedFileName)
+    {
+        if (datasetInfo.bitsStored < 8 || datasetInfo.bitsStored > 16 || 0 == datasetInfo.volColumns || 0 == datasetInfo.volRows || 0 == datasetInfo.volSlices)
+        {
+            return false;
+        }
+
+        BrickedVolumeHeader header;
+        ZeroMemory(&header, sizeof(header));
+        memcpy(header.magic, BRICKED_VOLUME_MAGIC, sizeof(header.magic));
+        header.version = BRICKED_VOLUME_VERSION;
+        header.volDimensions[0] = datasetInfo.volColumns;
+        header.volDimensions[1] = datasetInfo.volRows;
+        header.volDimensions[2] = datasetInfo.volSlices;
+        header.bitsStored = datasetInfo.bitsStored;
+        header.bytesPerVoxel = (datasetInfo.bitsStored > 8) ? 2 : 1;
+        header.brickSize = PAGE_BRICK_SIZE;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            header.voxelSpacing[axis] = (datasetInfo.voxelSpacing[axis] > 0.0f) ? datasetInfo.voxelSpacing[axis] : 1.0f;
+        }
+
+        // coarse level : the smallest power of two reduction fitting MAX_COARSE_EXTENT
+        UINT coarseFactor = 1;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            header.brickCounts[axis] = (header.volDimensions[axis] + PAGE_BRICK_SIZE - 1) / PAGE_BRICK_SIZE;
+            while ((header.volDimensions[axis] + coarseFactor - 1) / coarseFactor > MAX_COARSE_EXTENT)
+            {
+                coarseFactor *= 2;
+            }
+        }
+        for (int axis = 0; axis < 3; axis++)
+        {
+            header.coarseDimensions[axis] = (header.volDimensions[axis] + coarseFactor - 1) / coarseFactor;
+        }
+
+        const UINT columns = header.volDimensions[0];
+        const UINT rows = header.volDimensions[1];
+        const UINT slices = header.volDimensions[2];
+        const UINT bytesPerVoxel = header.bytesPerVoxel;
+        const size_t rowSize = static_cast<size_t>(columns) * bytesPerVoxel;
+        const size_t sliceSize = rowSize * rows;
+
+        ifstream rawFile(datasetInfo.fileName, ifstream::in | ifstream::binary);
+        if (!rawFile)
+        {
+            return false;
+        }
+        rawFile.seekg(0, rawFile.end);
+        if (static_cast<UINT64>(rawFile.tellg()) != static_cast<UINT64>(sliceSize) * slices)
+        {
+            return false;
+        }
+
+        ofstream brickFile(brickedFileName, ofstream::out | ofstream::binary | ofstream::trunc);
+        if (!brickFile)
+        {
+            return false;
+        }
+
+        // header and brick max table (the table is written again when all bricks are known)
+        const UINT64 brickCount = static_cast<UINT64>(header.brickCounts[0]) * header.brickCounts[1] * header.brickCounts[2];
+        vector<UINT16> brickMax(static_cast<size_t>(brickCount), 0);
+        brickFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        brickFile.write(reinterpret_cast<const char*>(brickMax.data()), static_cast<streamsize>(brickMax.size() * sizeof(UINT16)));
+
+        const UINT paddedSize = PAGE_BRICK_SIZE + 2;
+        const size_t paddedRowSize = static_cast<size_t>(paddedSize) * bytesPerVoxel;
+        const size_t brickDataSize = paddedRowSize * paddedSize * paddedSize;
+        const size_t coarseRowSize = static_cast<size_t>(header.coarseDimensions[0]) * bytesPerVoxel;
+        const size_t coarseSliceSize = coarseRowSize * header.coarseDimensions[1];
+        const UINT shift = 16 - datasetInfo.bitsStored;
+
+        vector<char> layer(sliceSize * paddedSize);
+        vector<char> brickData(brickDataSize);
+        vector<char> coarseData(coarseSliceSize * header.coarseDimensions[2], 0);
+
+        for (UINT bz = 0; bz < header.brickCounts[2]; bz++)
+        {
+            // slices of the brick layer including the apron (zero outside the volume), converted to the storage format
+            for (UINT layerSlice = 0; layerSlice < paddedSize; layerSlice++)
+            {
+                char* pSlice = layer.data() + sliceSize * layerSlice;
+                const INT64 z = static_cast<INT64>(bz) * PAGE_BRICK_SIZE - 1 + layerSlice;
+                if (z < 0 || z >= slices)
+                {
+                    memset(pSlice, 0, sliceSize);
+                    continue;
+                }
+
+                rawFile.seekg(static_cast<streamoff>(sliceSize * z), rawFile.beg);
+                rawFile.read(pSlice, static_cast<streamsize>(sliceSize));
+                if (!rawFile)
+                {
+                    return false;
+                }
+                if (2 == bytesPerVoxel)
+                {
+                    // 9 .. 16 bit data : shift the bits stored to the top of the word (as VolumeResource does)
+                    UINT16* pVoxels = reinterpret_cast<UINT16*>(pSlice);
+                    for (size_t idx = 0; idx < sliceSize / 2; idx++)
+                    {
+                        pVoxels[idx] = static_cast<UINT16>(pVoxels[idx] << shift);
+                    }
+                }
+
+                // the inner slices of the layer feed the coarse level (apron slices belong to the neighbour layers)
+                if (layerSlice >= 1 && layerSlice <= PAGE_BRICK_SIZE)
+                {
+                    char* pCoarseSlice = coarseData.data() + coarseSliceSize * (static_cast<size_t>(z) / coarseFactor);
+                    for (UINT y = 0; y < rows; y++)
+                    {
+                        char* pCoarseRow = pCoarseSlice + coarseRowSize * (y / coarseFactor);
+                        if (2 == bytesPerVoxel)
+                        {
+                            reduceMaxRow<UINT16>(pSlice + rowSize * y, columns, coarseFactor, pCoarseRow);
+                        }
+                        else
+                        {
+                            reduceMaxRow<BYTE>(pSlice + rowSize * y, columns, coarseFactor, pCoarseRow);
+                        }
+                    }
+                }
+            }
+
+            // cut the bricks of the layer
+            for (UINT by = 0; by < header.brickCounts[1]; by++)
+            {
+                for (UINT bx = 0; bx < header.brickCounts[0]; bx++)
+                {
+                    // columns [xBegin, xEnd) of the volume fall into the brick (the apron may be outside)
+                    const INT64 xOrigin = static_cast<INT64>(bx) * PAGE_BRICK_SIZE - 1;
+                    const INT64 xBegin = max(xOrigin, 0ll);
+                    const INT64 xEnd = min(xOrigin + paddedSize, static_cast<INT64>(columns));
+                    const size_t copySize = static_cast<size_t>(xEnd - xBegin) * bytesPerVoxel;
+
+                    fill(brickData.begin(), brickData.end(), static_cast<char>(0));
+                    for (UINT lz = 0; lz < paddedSize; lz++)
+                    {
+                        for (UINT ly = 0; ly < paddedSize; ly++)
+                        {
+                            const INT64 y = static_cast<INT64>(by) * PAGE_BRICK_SIZE - 1 + ly;
+                            if (y < 0 || y >= rows)
+                            {
+                                continue;
+                            }
+                            const char* pSource = layer.data() + sliceSize * lz + rowSize * static_cast<size_t>(y) + static_cast<size_t>(xBegin) * bytesPerVoxel;
+                            char* pTarget = brickData.data() + (static_cast<size_t>(lz) * paddedSize + ly) * paddedRowSize + static_cast<size_t>(xBegin - xOrigin) * bytesPerVoxel;
+                            memcpy(pTarget, pSource, copySize);
+                        }
+                    }
+
+                    const UINT64 brickIndex = (static_cast<UINT64>(bz) * header.brickCounts[1] + by) * header.brickCounts[0] + bx;
+                    brickMax[static_cast<size_t>(brickIndex)] = (2 == bytesPerVoxel) ?
+                        calcMaxValue<UINT16>(brickData.data(), brickDataSize / 2) :
+                        calcMaxValue<BYTE>(brickData.data(), brickDataSize);
+                    brickFile.write(brickData.data(), static_cast<streamsize>(brickDataSize));
+                }
+            }
+            if (!brickFile)
+            {
+                return false;
+            }
+        }
+
+        // final brick max table
+        brickFile.seekp(sizeof(header), brickFile.beg);
+        brickFile.write(reinterpret_cast<const char*>(brickMax.data()), static_cast<streamsize>(brickMax.size() * sizeof(UINT16)));
+        if (!brickFile)
+        {
+            return false;
+        }
+
+        ofstream coarseFile(getCoarseFileName(brickedFileName), ofstream::out | ofstream::binary | ofstream::trunc);
+        coarseFile.write(coarseData.data(), static_cast<streamsize>(coarseData.size()));
+        return static_cast<bool>(coarseFile);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Open a bricked volume file - reads the header and the brick max table
+    //------------------------------------------------------------------------------------------------------
+    bool BrickedVolume::Open(const char* brickedFileName)
+    {
+        Close();
+
+        ifstream brickFile(brickedFileName, ifstream::in | ifstream::binary);
+        if (!brickFile)
+        {
+            return false;
+        }
+
+        brickFile.seekg(0, brickFile.end);
+        const UINT64 fileSize = static_cast<UINT64>(brickFile.tellg());
+        brickFile.seekg(0, brickFile.beg);
+        brickFile.read(reinterpret_cast<char*>(&header_), sizeof(header_));
+        if (!brickFile || !validateHeader(header_, fileSize))
+        {
+            ZeroMemory(&header_, sizeof(header_));
+            return false;
+        }
+
+        brickMax_.resize(static_cast<size_t>(GetBrickCount()));
+        brickFile.read(reinterpret_cast<char*>(brickMax_.data()), static_cast<streamsize>(brickMax_.size() * sizeof(UINT16)));
+        if (!brickFile)
+        {
+            brickMax_.clear();
+            return false;
+        }
+        bricksOffset_ = sizeof(header_) + brickMax_.size() * sizeof(UINT16);
+
+        fileName_ = brickedFileName;
+        coarseFileName_ = getCoarseFileName(brickedFileName);
+        coarseDatasetInfo_.fileName = coarseFileName_.c_str();
+        coarseDatasetInfo_.volColumns = header_.coarseDimensions[0];
+        coarseDatasetInfo_.volRows = header_.coarseDimensions[1];
+        coarseDatasetInfo_.volSlices = header_.coarseDimensions[2];
+        // the coarse level is stored in the storage format (bits already shifted to the top of the word)
+        coarseDatasetInfo_.bitsStored = 8 * header_.bytesPerVoxel;
+        // the renderer scales the world box to the full resolution dimensions
+        coarseDatasetInfo_.voxelSpacing[0] = 1.0f;
+        coarseDatasetInfo_.voxelSpacing[1] = 1.0f;
+        coarseDatasetInfo_.voxelSpacing[2] = 1.0f;
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Close the file
+    //------------------------------------------------------------------------------------------------------
+    void BrickedVolume::Close()
+    {
+        fileName_.clear();
+        brickMax_.clear();
+        brickMax_.shrink_to_fit();
+        bricksOffset_ = 0;
+    }
+
+    bool BrickedVolume::IsOpen() const
+    {
+        return !brickMax_.empty();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Open an additional stream to the bricked volume file
+    //------------------------------------------------------------------------------------------------------
+    bool BrickedVolume::OpenStream(ifstream& brickFile) const
+    {
+        brickFile.open(fileName_, ifstream::in | ifstream::binary);
+        return brickFile.is_open();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Read one brick including apron (64 bit file offsets - the file may be far larger than 4 GiB)
+    //------------------------------------------------------------------------------------------------------
+    bool BrickedVolume::ReadBrick(ifstream& brickFile, UINT64 brickIndex, char* pBrickData) const
+    {
+        assert(brickIndex < GetBrickCount());
+
+        const size_t brickDataSize = GetBrickDataSize();
+        brickFile.clear();
+        brickFile.seekg(static_cast<streamoff>(bricksOffset_ + brickIndex * brickDataSize), brickFile.beg);
+        brickFile.read(pBrickData, static_cast<streamsize>(brickDataSize));
+        return static_cast<bool>(brickFile);
+    }
+
+    const BrickedVolumeHeader& BrickedVolume::GetHeader() const
+    {
+        return header_;
+    }
+
+    UINT64 BrickedVolume::GetBrickCount() const
+    {
+        return static_cast<UINT64>(header_.brickCounts[0]) * header_.brickCounts[1] * header_.brickCounts[2];
+    }
+
+    size_t BrickedVolume::GetBrickDataSize() const
+    {
+        const size_t paddedSize = header_.brickSize + 2;
+        return paddedSize * paddedSize * paddedSize * header_.bytesPerVoxel;
+    }
+
+    UINT16 BrickedVolume::GetBrickMax(UINT64 brickIndex) const
+    {
+        return brickMax_[static_cast<size_t>(brickIndex)];
+    }
+
+    const VolumeDatasetInfo& BrickedVolume::GetCoarseDatasetInfo() const
+    {
+        return coarseDatasetInfo_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Check the header read from a file of the given size before anything is allocated from it : the brick
+    // layout has to follow from the dimensions (as Convert() writes it) and the brick max table plus the
+    // bricks have to fill the file exactly
+    //------------------------------------------------------------------------------------------------------
+    bool BrickedVolume::validateHeader(const BrickedVolumeHeader& header, UINT64 fileSize)
+    {
+        if (0 != memcmp(header.magic, BRICKED_VOLUME_MAGIC, sizeof(header.magic)) || BRICKED_VOLUME_VERSION != header.version)
+        {
+            return false;
+        }
+        if (header.bitsStored < 8 || header.bitsStored > 16 || header.bytesPerVoxel != ((header.bitsStored > 8) ? 2u : 1u) || PAGE_BRICK_SIZE != header.brickSize)
+        {
+            return false;
+        }
+        for (int axis = 0; axis < 3; axis++)
+        {
+            if (0 == header.volDimensions[axis] ||
+                header.brickCounts[axis] != (header.volDimensions[axis] + PAGE_BRICK_SIZE - 1) / PAGE_BRICK_SIZE ||
+                0 == header.coarseDimensions[axis] || 
+                header.coarseDimensions[axis] > min(header.volDimensions[axis], MAX_COARSE_EXTENT) ||
+                !(header.voxelSpacing[axis] > 0.0f))
+            {
+                return false;
+            }
+        }
+
+        // the number of bricks in the file (brick max entry plus brick data each) has to be the product of the brick
+        // counts - divided out axis by axis, as the product of three 26 bit counts may exceed 64 bit
+        const UINT64 paddedSize = PAGE_BRICK_SIZE + 2;
+        const UINT64 brickFileSize = sizeof(UINT16) + paddedSize * paddedSize * paddedSize * header.bytesPerVoxel;
+        if (fileSize < sizeof(header) || 0 != (fileSize - sizeof(header)) % brickFileSize)
+        {
+            return false;
+        }
+        UINT64 fileBrickCount = (fileSize - sizeof(header)) / brickFileSize;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            if (0 != fileBrickCount % header.brickCounts[axis])
+            {
+                return false;
+            }
+            fileBrickCount /= header.brickCounts[axis];
+        }
+        return 1 == fileBrickCount;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the file name of the coarse fallback level
+    //------------------------------------------------------------------------------------------------------
+    string BrickedVolume::getCoarseFileName(const char* brickedFileName)
+    {
+        return string(brickedFileName) + ".coarse.raw";
+    }
+}
@@ -0,0 +1,106 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: BrickedVolume.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: include file for implementation of the BrickedVolume functionality. Bricked on-disk
+//          representation of volumes exceeding the system memory (out-of-core paging).
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+#include "VolumeResource.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    // header of a bricked volume file; followed by the brick max table (one UINT16 per brick) and the bricks
+    // (PAGE_BRICK_SIZE^3 voxels plus a one voxel apron, storage format of the GPU brick pool, bricks in x-y-z order)
+    struct BrickedVolumeHeader
+    {
+        char    magic[4];               // "BRKV"
+        UINT    version;
+        UINT    volDimensions[3];       // full resolution dimensions in voxels (columns, rows, slices)
+        UINT    bitsStored;             // bits stored of the source raw file
+        UINT    bytesPerVoxel;          // 1 (R8) or 2 (R16, bits stored shifted to the top of the word)
+        UINT    brickSize;              // edge length in voxels of a brick (without apron)
+        UINT    brickCounts[3];         // number of bricks per axis
+        UINT    coarseDimensions[3];    // dimensions of the coarse fallback level (max down-sampled)
+        float   voxelSpacing[3];        // voxel size along columns, rows and slices (mm) - scales the world box
+    };
+
+    class BrickedVolume
+    {
+    public:
+        // edge length in voxels of a paged brick (the bricks are stored with a one voxel apron)
+        static const UINT PAGE_BRICK_SIZE = 64;
+        // maximum edge length in voxels of the coarse fallback level (resident on the GPU as a whole)
+        static const UINT MAX_COARSE_EXTENT = 256;
+
+        // constructor / desctructor
+        BrickedVolume();
+        virtual ~BrickedVolume();
+
+        // avoid usage of copy constructor and =operator ...
+        BrickedVolume(BrickedVolume const&) = delete;
+        BrickedVolume& operator= (BrickedVolume const&) = delete;
+
+        // convert a raw volume file into a bricked volume file and the raw file of its coarse fallback level
+        // (<brickedFileName>.coarse.raw); the raw file is streamed one brick layer at a time
+        static bool Convert(const VolumeDatasetInfo& datasetInfo, const char* brickedFileName);
+
+        // open a bricked volume file - reads the header and the brick max table; fails for headers not matching the file
+        bool Open(const char* brickedFileName);
+        // close the file (release the brick max table)
+        void Close();
+        // is a bricked volume open
+        bool IsOpen() const;
+
+        // read one brick (including apron) - thread safe, every reader passes its own file stream
+        bool ReadBrick(std::ifstream& brickFile, UINT64 brickIndex, char* pBrickData) const;
+        // open an additional stream to the bricked volume file (one per I/O thread)
+        bool OpenStream(std::ifstream& brickFile) const;
+
+        // get the header of the bricked volume
+        const BrickedVolumeHeader& GetHeader() const;
+        // get the number of bricks
+        UINT64 GetBrickCount() const;
+        // get the size in bytes of one brick including apron
+        size_t GetBrickDataSize() const;
+        // get the maximum voxel value of the given brick (0 -> the brick is empty and never paged)
+        UINT16 GetBrickMax(UINT64 brickIndex) const;
+        // get the raw file description of the coarse fallback level (loadable as VolumeResource)
+        const VolumeDatasetInfo& GetCoarseDatasetInfo() const;
+
+    private:
+
+        // get the file name of the coarse fallback level
+        static std::string getCoarseFileName(const char* brickedFileName);
+        // check the header read from a file of the given size (dimensions, brick layout and the resulting file size)
+        static bool validateHeader(const BrickedVolumeHeader& header, UINT64 fileSize);
+
+        // ------------------------------------------------------------------------------------------------------------
+
+        std::string         fileName_;
+        std::string         coarseFileName_;
+        BrickedVolumeHeader header_;
+        std::vector<UINT16> brickMax_;
+        UINT64              bricksOffset_ = 0;      // file offset of the first brick
+        VolumeDatasetInfo   coarseDatasetInfo_;
+    };
+}
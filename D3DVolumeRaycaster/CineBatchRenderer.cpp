@@ -0,0 +1,238 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: CineBatchRenderer.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of the CineBatchRenderer functionality.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#include "stdafx.h"
+#include "CineBatchRenderer.h"
+
+using namespace DirectX;
+using namespace std;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    CineBatchRenderer::CineBatchRenderer()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    CineBatchRenderer::~CineBatchRenderer()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Render and write all frames of the cine loop. Every frame in flight has its own render session; the
+    // sessions of a batch record concurrently (frame-level parallelism on the CPU, the rasterizer spreads
+    // the pixels of every frame across the GPU) and the image files of a batch are written in parallel
+    // while the next batch is recorded.
+    //------------------------------------------------------------------------------------------------------
+    bool CineBatchRenderer::Render(const CineBatchSettings& settings)
+    {
+        stats_ = { 0 };
+        if (0 == settings.frameCount || 0 == settings.width || 0 == settings.height)
+        {
+            return false;
+        }
+
+        RayCastRenderer renderer;
+        if (!renderer.InitializeOffscreen(64, 64))
+        {
+            renderer.Release();
+            return false;
+        }
+        VolumeHandle volume;
+        if (!renderer.AcquireVolume(settings.volumeDataset, volume))
+        {
+            renderer.Release();
+            return false;
+        }
+
+        UINT concurrentFrames = settings.concurrentFrames;
+        if (0 == concurrentFrames)
+        {
+            concurrentFrames = thread::hardware_concurrency();
+        }
+        concurrentFrames = min(max(concurrentFrames, 1u), min(settings.frameCount, MAX_CONCURRENT_FRAMES));
+
+        vector<unique_ptr<RenderSession>> sessions;
+        for (UINT idx = 0; idx < concurrentFrames; idx++)
+        {
+            sessions.push_back(make_unique<RenderSession>());
+            if (!sessions.back()->Initialize(&renderer, settings.width, settings.height))
+            {
+                sessions.clear();
+                volume.Reset();
+                renderer.Release();
+                return false;
+            }
+            sessions.back()->SetVolume(volume.Share());
+        }
+
+        const char* fileExtension = (CINE_IMAGE_FORMAT::PGM == settings.imageFormat) ? "pgm" : "raw";
+
+        vector<vector<BYTE>> images(concurrentFrames);
+        vector<future<bool>> pendingWrites;
+        vector<RenderSession*> batchSessions;
+        bool succeeded = true;
+
+        chrono::steady_clock::time_point batchStart = chrono::steady_clock::now();
+        for (UINT firstFrame = 0; firstFrame < settings.frameCount && succeeded; firstFrame += concurrentFrames)
+        {
+            const UINT batchFrames = min(concurrentFrames, settings.frameCount - firstFrame);
+
+            batchSessions.clear();
+            for (UINT idx = 0; idx < batchFrames; idx++)
+            {
+                float quaternion[4];
+                GetFrameRotation(settings.rotationAxis, firstFrame + idx, settings.frameCount, quaternion);
+                sessions[idx]->SetCamera(quaternion, settings.cameraDistance);
+                batchSessions.push_back(sessions[idx].get());
+            }
+            succeeded = RenderSession::RecordFrames(batchSessions);
+
+            // the image buffers are reused - wait for the files of the previous batch
+            for (auto& pendingWrite : pendingWrites)
+            {
+                succeeded = pendingWrite.get() && succeeded;
+            }
+            pendingWrites.clear();
+
+            for (UINT idx = 0; idx < batchFrames && succeeded; idx++)
+            {
+                if (!batchSessions[idx]->ReadFrame(images[idx]))
+                {
+                    succeeded = false;
+                    break;
+                }
+                char fileName[MAX_PATH] = { 0 };
+                sprintf_s(fileName, sizeof(fileName), "%s_%04u.%s", settings.outputPrefix.c_str(), firstFrame + idx, fileExtension);
+                pendingWrites.push_back(async(
+                    launch::async, 
+                    &CineBatchRenderer::WriteImage, 
+                    string(fileName), 
+                    settings.imageFormat, 
+                    cref(images[idx]), 
+                    settings.width, 
+                    settings.height));
+                stats_.renderedFrames++;
+            }
+        }
+        for (auto& pendingWrite : pendingWrites)
+        {
+            succeeded = pendingWrite.get() && succeeded;
+        }
+
+        stats_.concurrentFrames = concurrentFrames;
+        stats_.totalTimeMSec = chrono::duration<float, milli>(chrono::steady_clock::now() - batchStart).count();
+        stats_.framesPerSecond = stats_.totalTimeMSec > 0.0f ? 1000.0f * stats_.renderedFrames / stats_.totalTimeMSec : 0.0f;
+
+        // sessions use the device of the renderer - release them first
+        sessions.clear();
+        volume.Reset();
+        renderer.Release();
+
+        return succeeded;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the throughput of the last batch
+    //------------------------------------------------------------------------------------------------------
+    const CineBatchStats& CineBatchRenderer::GetStats() const
+    {
+        return stats_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the rotation quaternion of the given frame of a cine loop - equally spaced rotation angles over
+    // the full turn
+    //------------------------------------------------------------------------------------------------------
+    void CineBatchRenderer::GetFrameRotation(CINE_AXIS rotationAxis, UINT frameIdx, UINT frameCount, float quaternion[4])
+    {
+        const XMVECTOR rotationAxes[] =
+        {
+            XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f),
+            XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f),
+            XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f)
+        };
+        const float angle = XM_2PI * frameIdx / max(frameCount, 1u);
+        XMFLOAT4 quatRotation;
+        XMStoreFloat4(&quatRotation, XMQuaternionRotationAxis(rotationAxes[static_cast<UINT>(rotationAxis) % ARRAYSIZE(rotationAxes)], angle));
+        quaternion[0] = quatRotation.x;
+        quaternion[1] = quatRotation.y;
+        quaternion[2] = quatRotation.z;
+        quaternion[3] = quatRotation.w;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Write one frame to an image file
+    //------------------------------------------------------------------------------------------------------
+    bool CineBatchRenderer::WriteImage(const std::string& fileName, CINE_IMAGE_FORMAT imageFormat, const std::vector<BYTE>& image, UINT width, UINT height)
+    {
+        if (image.size() < static_cast<size_t>(width) * height)
+        {
+            return false;
+        }
+        ofstream imageFile(fileName, ofstream::out | ofstream::binary | ofstream::trunc);
+        if (!imageFile)
+        {
+            return false;
+        }
+        if (CINE_IMAGE_FORMAT::PGM == imageFormat)
+        {
+            imageFile << "P5\n" << width << " " << height << "\n255\n";
+        }
+        imageFile.write(reinterpret_cast<const char*>(image.data()), static_cast<streamsize>(width) * height);
+
+        return static_cast<bool>(imageFile);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Headless batch mode : render the cine loop and report the throughput
+    //------------------------------------------------------------------------------------------------------
+    int CineBatchRenderer::RunBatch(const CineBatchSettings& settings)
+    {
+        CineBatchRenderer cineRenderer;
+        bool succeeded = cineRenderer.Render(settings);
+
+        const CineBatchStats& stats = cineRenderer.GetStats();
+        char charBuffer[256] = { 0 };
+        sprintf_s(
+            charBuffer,
+            sizeof(charBuffer),
+            "cine batch : %s - %u frames (%u x %u, %u in flight) in %4.2f s, throughput : %4.1f frames/s%s\n",
+            GetVolumeDatasetInfo(settings.volumeDataset).fileName,
+            stats.renderedFrames,
+            settings.width,
+            settings.height,
+            stats.concurrentFrames,
+            stats.totalTimeMSec / 1000.0f,
+            stats.framesPerSecond,
+            succeeded ? "" : " - FAILED");
+        OutputDebugStringA(charBuffer);
+
+        return succeeded ? 0 : 1;
+    }
+}
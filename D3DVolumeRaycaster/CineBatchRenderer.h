@@ -0,0 +1,102 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: CineBatchRenderer.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: include file for implementation of the CineBatchRenderer functionality. Renders 360 degree
+//          rotating MIP loops offscreen (several frames in flight) and writes them as raw or PGM image sequence.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+#include "RenderSession.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    // rotation axis of a cine loop (see auto-rotation options of the RayCastRenderer)
+    enum class CINE_AXIS
+    {
+        X = 0,
+        Y,
+        Z
+    };
+
+    // image file format of the cine frames
+    enum class CINE_IMAGE_FORMAT
+    {
+        RAW = 0,    // 8 bit gray, row-major, no header
+        PGM         // binary portable graymap (P5)
+    };
+
+    // settings of a cine batch
+    struct CineBatchSettings
+    {
+        VOLUME_DATASET      volumeDataset = VOLUME_DATASET::MR_HEAD_TOF;
+        CINE_AXIS           rotationAxis = CINE_AXIS::Y;
+        UINT                frameCount = 36;            // frames per 360 degree rotation
+        UINT                width = 512;
+        UINT                height = 512;
+        std::string         outputPrefix = "cine";      // frame file name : <prefix>_<frame index>.<pgm|raw>
+        CINE_IMAGE_FORMAT   imageFormat = CINE_IMAGE_FORMAT::PGM;
+        float               cameraDistance = -3.0f;
+        UINT                concurrentFrames = 0;       // frames in flight (0 = one per CPU core)
+    };
+
+    // throughput of a cine batch
+    struct CineBatchStats
+    {
+        UINT    renderedFrames;
+        UINT    concurrentFrames;
+        float   totalTimeMSec;              // render, read back and file output of all frames
+        float   framesPerSecond;
+    };
+
+    class CineBatchRenderer
+    {
+    public:
+        // constructor / desctructor
+        CineBatchRenderer();
+        virtual ~CineBatchRenderer();
+
+        // avoid usage of copy constructor and =operator ...
+        CineBatchRenderer(CineBatchRenderer const&) = delete;
+        CineBatchRenderer& operator= (CineBatchRenderer const&) = delete;
+
+        // render and write all frames of the cine loop
+        bool Render(const CineBatchSettings& settings);
+        // get the throughput of the last batch
+        const CineBatchStats& GetStats() const;
+
+        // headless batch mode : render the cine loop and report the throughput
+        static int RunBatch(const CineBatchSettings& settings);
+
+        // get the rotation quaternion (x, y, z, w) of the given frame of a cine loop - equally spaced angles over the full turn
+        static void GetFrameRotation(CINE_AXIS rotationAxis, UINT frameIdx, UINT frameCount, float quaternion[4]);
+        // write one frame (width x height gray values) to an image file - false if the image is smaller
+        static bool WriteImage(const std::string& fileName, CINE_IMAGE_FORMAT imageFormat, const std::vector<BYTE>& image, UINT width, UINT height);
+
+    private:
+
+        // ------------------------------------------------------------------------------------------------------------
+
+        static const UINT MAX_CONCURRENT_FRAMES = 32;
+
+        CineBatchStats  stats_ = { 0 };
+    };
+}
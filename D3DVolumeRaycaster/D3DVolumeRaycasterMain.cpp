@@ -25,6 +25,14 @@
 
 #include "stdafx.h"
 #include "RayCastRenderer.h"
+#include "DistributedMipRenderer.h"
+#include "RenderService.h"
+#include "FrameCodec.h"
+#include "SharedFrameRingBuffer.h"
+#include "CineBatchRenderer.h"
+#include "BrickedVolume.h"
+#include "DicomSeries.h"
+#include "SelfTest.h"
 
 using namespace D3D11_VOLUME_RAYCASTER;
 
@@ -34,6 +42,7 @@ using namespace D3D11_VOLUME_RAYCASTER;
 namespace
 {
     std::unique_ptr<RayCastRenderer> g_RayCaster;
+    std::unique_ptr<RenderService>   g_RenderService;
 
     HINSTANCE                        g_hInst = nullptr;
     HWND                             g_hWnd = nullptr;
@@ -115,12 +124,8 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
     switch (message)
     {
     case WM_PAINT:
+        // frames are presented by the render thread - only validate the client area
         hdc = BeginPaint(hWnd, &ps);
-        if (g_RayCaster.get() != nullptr)
-        {
-            g_RayCaster->Update();
-            g_RayCaster->Render();
-        }
         EndPaint(hWnd, &ps);
         break;
     case WM_SIZE:
@@ -130,6 +135,11 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
         }
         break;
     case WM_DESTROY:
+        if (g_RayCaster.get() != nullptr)
+        {
+            // stop rendering while the swap chain's window still exists
+            g_RayCaster->StopRenderThread();
+        }
         PostQuitMessage(0);
         break;
     default:
@@ -138,6 +148,455 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
     return 0;
 }
 
+//--------------------------------------------------------------------------------------
+// Frame codec benchmark : renders a slow rotation of every demo dataset offscreen and
+// reports compression ratio and encode time of the frame codec
+//--------------------------------------------------------------------------------------
+int RunCodecBenchmark(UINT frameCount)
+{
+    RayCastRenderer renderer;
+    if (!renderer.InitializeOffscreen(512, 512))
+    {
+        renderer.Release();
+        return 1;
+    }
+
+    const VOLUME_DATASET datasets[] = { VOLUME_DATASET::CT_HEAD, VOLUME_DATASET::CT_HEAD_ANGIO, VOLUME_DATASET::MR_ABDOMEN, VOLUME_DATASET::MR_HEAD_TOF };
+    std::vector<BYTE> image;
+    std::vector<BYTE> encodedFrame;
+
+    for (VOLUME_DATASET dataset : datasets)
+    {
+        if (!renderer.LoadDataset(dataset))
+        {
+            continue;
+        }
+
+        FrameEncoder encoder;
+        size_t rawBytes = 0, encodedBytes = 0;
+        float encodeTimeMSec = 0.0f;
+        for (UINT frameIdx = 0; frameIdx < frameCount; frameIdx++)
+        {
+            // half a degree per frame around the y-axis
+            float angle = DirectX::XMConvertToRadians(0.5f * frameIdx);
+            float quatRotation[4] = { 0.0f, sinf(0.5f * angle), 0.0f, cosf(0.5f * angle) };
+            renderer.SetRotation(quatRotation);
+            if (!renderer.RenderToImage(image))
+            {
+                break;
+            }
+            encoder.Encode(image.data(), 512, 512, encodedFrame);
+
+            const FrameCodecStats& codecStats = encoder.GetLastStats();
+            rawBytes += codecStats.rawSize;
+            encodedBytes += codecStats.encodedSize;
+            encodeTimeMSec += codecStats.encodeTimeMSec;
+        }
+
+        char charBuffer[256] = { 0 };
+        sprintf_s(
+            charBuffer,
+            sizeof(charBuffer),
+            "codec benchmark : %s - %u frames, compression %4.1f : 1, average encode time : %4.3f ms\n",
+            GetVolumeDatasetInfo(dataset).fileName,
+            frameCount,
+            encodedBytes > 0 ? static_cast<float>(rawBytes) / encodedBytes : 0.0f,
+            frameCount > 0 ? encodeTimeMSec / frameCount : 0.0f);
+        OutputDebugStringA(charBuffer);
+    }
+
+    renderer.Release();
+    return 0;
+}
+
+//--------------------------------------------------------------------------------------
+// Adaptive refinement benchmark : renders a rotation of every demo dataset with all rays
+// cast (reference) and with adaptive refinement at several thresholds; reports the share
+// of rays cast, the speedup and the image error against the reference (frame times include
+// the read back of the image)
+//--------------------------------------------------------------------------------------
+int RunRefinementBenchmark(UINT frameCount)
+{
+    RayCastRenderer renderer;
+    if (!renderer.InitializeOffscreen(512, 512))
+    {
+        renderer.Release();
+        return 1;
+    }
+
+    const VOLUME_DATASET datasets[] = { VOLUME_DATASET::CT_HEAD, VOLUME_DATASET::CT_HEAD_ANGIO, VOLUME_DATASET::MR_ABDOMEN, VOLUME_DATASET::MR_HEAD_TOF };
+    const float thresholds[] = { 0.01f, 0.02f, 0.05f, 0.1f };
+    std::vector<std::vector<BYTE>> referenceImages(frameCount);
+    std::vector<BYTE> image;
+
+    LARGE_INTEGER perfCounterFreq, startCounter, endCounter;
+    QueryPerformanceFrequency(&perfCounterFreq);
+
+    // one degree per frame around the y-axis
+    auto setFrameRotation = [&renderer](UINT frameIdx)
+    {
+        float angle = DirectX::XMConvertToRadians(static_cast<float>(frameIdx));
+        float quatRotation[4] = { 0.0f, sinf(0.5f * angle), 0.0f, cosf(0.5f * angle) };
+        renderer.SetRotation(quatRotation);
+    };
+
+    for (VOLUME_DATASET dataset : datasets)
+    {
+        if (!renderer.LoadDataset(dataset))
+        {
+            continue;
+        }
+
+        // reference : every ray cast
+        renderer.SetAdaptiveRefinement(false, 0.0f);
+        QueryPerformanceCounter(&startCounter);
+        for (UINT frameIdx = 0; frameIdx < frameCount; frameIdx++)
+        {
+            setFrameRotation(frameIdx);
+            renderer.RenderToImage(referenceImages[frameIdx]);
+        }
+        QueryPerformanceCounter(&endCounter);
+        const double referenceTime = static_cast<double>(endCounter.QuadPart - startCounter.QuadPart) / perfCounterFreq.QuadPart;
+
+        for (float threshold : thresholds)
+        {
+            renderer.SetAdaptiveRefinement(true, threshold);
+            UINT64 raysCast = 0, pixelCount = 0;
+            double squaredErrorSum = 0.0;
+            UINT maxError = 0;
+            double refinedTime = 0.0;
+            for (UINT frameIdx = 0; frameIdx < frameCount; frameIdx++)
+            {
+                setFrameRotation(frameIdx);
+                QueryPerformanceCounter(&startCounter);
+                if (!renderer.RenderToImage(image))
+                {
+                    break;
+                }
+                QueryPerformanceCounter(&endCounter);
+                refinedTime += static_cast<double>(endCounter.QuadPart - startCounter.QuadPart) / perfCounterFreq.QuadPart;
+
+                const AdaptiveRefinementStats& refineStats = renderer.GetAdaptiveRefinementStats();
+                raysCast += refineStats.raysCast;
+                pixelCount += refineStats.pixelCount;
+
+                const std::vector<BYTE>& reference = referenceImages[frameIdx];
+                for (size_t pixelIdx = 0; pixelIdx < image.size() && pixelIdx < reference.size(); pixelIdx++)
+                {
+                    UINT error = static_cast<UINT>(abs(static_cast<int>(image[pixelIdx]) - static_cast<int>(reference[pixelIdx])));
+                    squaredErrorSum += static_cast<double>(error) * error;
+                    maxError = max(maxError, error);
+                }
+            }
+
+            char charBuffer[256] = { 0 };
+            sprintf_s(
+                charBuffer,
+                sizeof(charBuffer),
+                "refinement benchmark : %s - threshold %4.3f : rays %4.1f %%, speedup %4.2f, RMSE %4.2f, max error %u (gray levels)\n",
+                GetVolumeDatasetInfo(dataset).fileName,
+                threshold,
+                pixelCount > 0 ? 100.0 * raysCast / pixelCount : 0.0,
+                refinedTime > 0.0 ? referenceTime / refinedTime : 0.0,
+                frameCount > 0 ? sqrt(squaredErrorSum / (static_cast<double>(frameCount) * image.size())) : 0.0,
+                maxError);
+            OutputDebugStringA(charBuffer);
+        }
+    }
+
+    renderer.Release();
+    return 0;
+}
+
+//--------------------------------------------------------------------------------------
+// Voxel format benchmark : renders a rotation of every demo dataset stored with 8 and with
+// 16 bit voxels and reports the frame time and volume memory of both formats (8 bit
+// datasets are promoted to 16 bit storage; frame times include the read back of the image)
+//--------------------------------------------------------------------------------------
+int RunVoxelFormatBenchmark(UINT frameCount)
+{
+    RayCastRenderer renderer;
+    if (!renderer.InitializeOffscreen(512, 512))
+    {
+        renderer.Release();
+        return 1;
+    }
+
+    const VOLUME_DATASET datasets[] = { VOLUME_DATASET::CT_HEAD, VOLUME_DATASET::CT_HEAD_ANGIO, VOLUME_DATASET::MR_ABDOMEN, VOLUME_DATASET::MR_HEAD_TOF };
+    const VOXEL_FORMAT voxelFormats[] = { VOXEL_FORMAT::UINT8, VOXEL_FORMAT::UINT16 };
+    std::vector<BYTE> image;
+
+    LARGE_INTEGER perfCounterFreq, startCounter, endCounter;
+    QueryPerformanceFrequency(&perfCounterFreq);
+
+    for (VOLUME_DATASET dataset : datasets)
+    {
+        for (VOXEL_FORMAT voxelFormat : voxelFormats)
+        {
+            if (!renderer.LoadDatasetAs(dataset, voxelFormat, VOLUME_STORAGE::TEXTURE))
+            {
+                continue;
+            }
+
+            // one degree per frame around the y-axis
+            QueryPerformanceCounter(&startCounter);
+            for (UINT frameIdx = 0; frameIdx < frameCount; frameIdx++)
+            {
+                float angle = DirectX::XMConvertToRadians(static_cast<float>(frameIdx));
+                float quatRotation[4] = { 0.0f, sinf(0.5f * angle), 0.0f, cosf(0.5f * angle) };
+                renderer.SetRotation(quatRotation);
+                renderer.RenderToImage(image);
+            }
+            QueryPerformanceCounter(&endCounter);
+            const double renderTime = static_cast<double>(endCounter.QuadPart - startCounter.QuadPart) / perfCounterFreq.QuadPart;
+
+            char charBuffer[256] = { 0 };
+            sprintf_s(
+                charBuffer,
+                sizeof(charBuffer),
+                "voxel format benchmark : %s - %s : %4.3f ms / frame, volume memory %4.1f MB\n",
+                GetVolumeDatasetInfo(dataset).fileName,
+                VOXEL_FORMAT::UINT8 == voxelFormat ? "8 bit" : "16 bit",
+                frameCount > 0 ? 1000.0 * renderTime / frameCount : 0.0,
+                renderer.GetVolumeMemorySize() / (1024.0 * 1024.0));
+            OutputDebugStringA(charBuffer);
+        }
+    }
+
+    renderer.Release();
+    return 0;
+}
+
+//--------------------------------------------------------------------------------------
+// Packed bricks benchmark : renders a rotation of every demo dataset (native voxel format)
+// from the volume texture and from packed bricks and reports frame time and volume memory
+// of both storages (frame times include the read back of the image)
+//--------------------------------------------------------------------------------------
+int RunPackedBrickBenchmark(UINT frameCount)
+{
+    RayCastRenderer renderer;
+    if (!renderer.InitializeOffscreen(512, 512))
+    {
+        renderer.Release();
+        return 1;
+    }
+
+    const VOLUME_DATASET datasets[] = { VOLUME_DATASET::CT_HEAD, VOLUME_DATASET::CT_HEAD_ANGIO, VOLUME_DATASET::MR_ABDOMEN, VOLUME_DATASET::MR_HEAD_TOF };
+    const VOLUME_STORAGE storages[] = { VOLUME_STORAGE::TEXTURE, VOLUME_STORAGE::PACKED_BRICKS };
+    std::vector<BYTE> image;
+
+    LARGE_INTEGER perfCounterFreq, startCounter, endCounter;
+    QueryPerformanceFrequency(&perfCounterFreq);
+
+    for (VOLUME_DATASET dataset : datasets)
+    {
+        double textureRenderTime = 0.0;
+        size_t textureMemorySize = 0;
+        for (VOLUME_STORAGE storage : storages)
+        {
+            if (!renderer.LoadDatasetAs(dataset, GetNativeVoxelFormat(GetVolumeDatasetInfo(dataset)), storage))
+            {
+                continue;
+            }
+
+            // one degree per frame around the y-axis
+            QueryPerformanceCounter(&startCounter);
+            for (UINT frameIdx = 0; frameIdx < frameCount; frameIdx++)
+            {
+                float angle = DirectX::XMConvertToRadians(static_cast<float>(frameIdx));
+                float quatRotation[4] = { 0.0f, sinf(0.5f * angle), 0.0f, cosf(0.5f * angle) };
+                renderer.SetRotation(quatRotation);
+                renderer.RenderToImage(image);
+            }
+            QueryPerformanceCounter(&endCounter);
+            const double renderTime = static_cast<double>(endCounter.QuadPart - startCounter.QuadPart) / perfCounterFreq.QuadPart;
+            const size_t memorySize = renderer.GetVolumeMemorySize();
+            if (VOLUME_STORAGE::TEXTURE == storage)
+            {
+                textureRenderTime = renderTime;
+                textureMemorySize = memorySize;
+            }
+
+            char charBuffer[256] = { 0 };
+            sprintf_s(
+                charBuffer,
+                sizeof(charBuffer),
+                "packed bricks benchmark : %s - %s : %4.3f ms / frame (throughput %4.2f x texture), volume memory %4.1f MB (%4.2f : 1)\n",
+                GetVolumeDatasetInfo(dataset).fileName,
+                VOLUME_STORAGE::TEXTURE == storage ? "texture" : "packed",
+                frameCount > 0 ? 1000.0 * renderTime / frameCount : 0.0,
+                renderTime > 0.0 ? textureRenderTime / renderTime : 0.0,
+                memorySize / (1024.0 * 1024.0),
+                memorySize > 0 ? static_cast<double>(textureMemorySize) / memorySize : 0.0);
+            OutputDebugStringA(charBuffer);
+        }
+    }
+
+    renderer.Release();
+    return 0;
+}
+
+//--------------------------------------------------------------------------------------
+// Live volume benchmark : loads a synthetic 12 bit live volume (vessel-like tubes) and
+// replaces it slab by slab, sweeping along z like an ongoing acquisition. For every slab
+// thickness the time per update (queue, convert, upload, resolution levels and brick max
+// grid of the region) is the frame time with one update minus the frame time without.
+//--------------------------------------------------------------------------------------
+int RunLiveVolumeBenchmark(UINT updateCount)
+{
+    const UINT volumeSize = 256;
+    VolumeDatasetInfo datasetInfo = { nullptr, volumeSize, volumeSize, volumeSize, 12, { 1.0f, 1.0f, 1.0f } };
+
+    // tubes along z whose radius changes with the slice and the acquisition phase
+    auto synthesizeSlab = [&datasetInfo](UINT sliceBegin, UINT sliceEnd, UINT phase, std::vector<char>& slabData)
+    {
+        const size_t slicePitch = static_cast<size_t>(datasetInfo.volColumns) * datasetInfo.volRows;
+        slabData.resize(slicePitch * (sliceEnd - sliceBegin) * sizeof(UINT16));
+        UINT16* pVoxels = reinterpret_cast<UINT16*>(slabData.data());
+        for (UINT slice = sliceBegin; slice < sliceEnd; slice++)
+        {
+            const float radius = 6.0f + 4.0f * sinf(0.05f * slice + 0.3f * phase);
+            for (UINT row = 0; row < datasetInfo.volRows; row++)
+            {
+                for (UINT column = 0; column < datasetInfo.volColumns; column++)
+                {
+                    const float dx = static_cast<float>(column % 64) - 32.0f;
+                    const float dy = static_cast<float>(row % 64) - 32.0f;
+                    const float distance = sqrtf(dx * dx + dy * dy);
+                    const UINT value = (distance < radius) ? 4095 - static_cast<UINT>(100.0f * distance) : (column * 7 + row * 3 + slice) % 200;
+                    *pVoxels++ = static_cast<UINT16>(value);
+                }
+            }
+        }
+    };
+
+    RayCastRenderer renderer;
+    std::vector<char> volumeData;
+    synthesizeSlab(0, datasetInfo.volSlices, 0, volumeData);
+    if (!renderer.InitializeOffscreen(512, 512) || !renderer.LoadLiveVolume(datasetInfo, &volumeData))
+    {
+        renderer.Release();
+        return 1;
+    }
+    volumeData.clear();
+    volumeData.shrink_to_fit();
+
+    const UINT slabThicknesses[] = { 1, 4, 16, 64 };
+    std::vector<BYTE> image;
+    std::vector<char> slabData;
+    LARGE_INTEGER perfCounterFreq, startCounter, endCounter;
+    QueryPerformanceFrequency(&perfCounterFreq);
+
+    // frame time without updates
+    QueryPerformanceCounter(&startCounter);
+    for (UINT frameIdx = 0; frameIdx < updateCount; frameIdx++)
+    {
+        renderer.RenderToImage(image);
+    }
+    QueryPerformanceCounter(&endCounter);
+    const double frameTime = updateCount > 0 ? static_cast<double>(endCounter.QuadPart - startCounter.QuadPart) / perfCounterFreq.QuadPart / updateCount : 0.0;
+
+    bool updatesApplied = true;
+    for (UINT slabThickness : slabThicknesses)
+    {
+        double updateTime = 0.0;
+        for (UINT updateIdx = 0; updateIdx < updateCount; updateIdx++)
+        {
+            // sequential slabs, wrapping around at the last slice
+            const UINT regionBegin[3] = { 0, 0, (updateIdx * slabThickness) % datasetInfo.volSlices };
+            const UINT regionEnd[3] = { datasetInfo.volColumns, datasetInfo.volRows, min(regionBegin[2] + slabThickness, datasetInfo.volSlices) };
+            synthesizeSlab(regionBegin[2], regionEnd[2], updateIdx + 1, slabData);
+
+            QueryPerformanceCounter(&startCounter);
+            updatesApplied = renderer.UpdateVolumeRegion(regionBegin, regionEnd, slabData.data()) && updatesApplied;
+            renderer.RenderToImage(image);
+            QueryPerformanceCounter(&endCounter);
+            updateTime += static_cast<double>(endCounter.QuadPart - startCounter.QuadPart) / perfCounterFreq.QuadPart;
+        }
+
+        char charBuffer[256] = { 0 };
+        sprintf_s(
+            charBuffer,
+            sizeof(charBuffer),
+            "live volume benchmark : slab of %u slices (%4.2f MB) : %4.3f ms / update (%4.3f ms / frame without update)\n",
+            slabThickness,
+            static_cast<double>(datasetInfo.volColumns) * datasetInfo.volRows * slabThickness * sizeof(UINT16) / (1024.0 * 1024.0),
+            updateCount > 0 ? 1000.0 * (updateTime / updateCount - frameTime) : 0.0,
+            1000.0 * frameTime);
+        OutputDebugStringA(charBuffer);
+    }
+
+    renderer.Release();
+    return updatesApplied ? 0 : 1;
+}
+
+//--------------------------------------------------------------------------------------
+// Frame output consumer stand-in : reads frames from the shared memory ring buffer
+// (zero-copy) with the given processing delay per frame and reports dropped frames.
+// Gives up if the producer does not show up within 10 seconds or stops publishing
+// frames for 5 seconds (e.g. it has exited).
+//--------------------------------------------------------------------------------------
+int RunFrameConsumer(const wchar_t* sharedMemoryName, UINT frameCount, UINT processingDelayMSec)
+{
+    const UINT PRODUCER_TIMEOUT_MSEC = 10000;
+    const UINT FRAME_TIMEOUT_MSEC = 5000;
+
+    SharedFrameRingBuffer frameOutput;
+    bool isOpen = frameOutput.Open(sharedMemoryName);
+    for (UINT waitedMSec = 0; !isOpen && waitedMSec < PRODUCER_TIMEOUT_MSEC; waitedMSec += 100)
+    {
+        Sleep(100);
+        isOpen = frameOutput.Open(sharedMemoryName);
+    }
+    if (!isOpen)
+    {
+        OutputDebugStringA("frame consumer : no frame output found\n");
+        return 1;
+    }
+
+    UINT consumedFrames = 0;
+    UINT64 graySum = 0;
+    SharedFrameView frameView;
+    std::chrono::steady_clock::time_point lastFrameTime = std::chrono::steady_clock::now();
+    while (consumedFrames < frameCount)
+    {
+        if (!frameOutput.AcquireFrame(frameView))
+        {
+            if (std::chrono::steady_clock::now() - lastFrameTime > std::chrono::milliseconds(FRAME_TIMEOUT_MSEC))
+            {
+                // producer has stopped
+                break;
+            }
+            Sleep(1);
+            continue;
+        }
+        lastFrameTime = std::chrono::steady_clock::now();
+        // "process" the frame in place
+        for (UINT row = 0; row < frameView.height; row += 16)
+        {
+            graySum += frameView.pPixels[static_cast<size_t>(row) * frameView.width + frameView.width / 2];
+        }
+        Sleep(processingDelayMSec);
+        if (frameOutput.ReleaseFrame(frameView))
+        {
+            consumedFrames++;
+        }
+    }
+
+    char charBuffer[256] = { 0 };
+    sprintf_s(
+        charBuffer,
+        sizeof(charBuffer),
+        "frame consumer : %u frames consumed, %llu skipped / torn, %llu dropped by producer (checksum %llu)\n",
+        consumedFrames,
+        frameOutput.GetSkippedFrames(),
+        frameOutput.GetDroppedFrames(),
+        graySum);
+    OutputDebugStringA(charBuffer);
+
+    return (consumedFrames == frameCount) ? 0 : 1;
+}
+
 //--------------------------------------------------------------------------------------
 // Entry point to the application. Initializes everything and goes into a message 
 // processing loop. Idle time is used to render via Ray-Caster.
@@ -146,6 +605,191 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
 {
     UNREFERENCED_PARAMETER(hPrevInstance);
     UNREFERENCED_PARAMETER(lpCmdLine);
+
+    // parse command line options ...
+    // --distributed <N>                      : render with N worker processes (one volume slab per worker)
+    // --mip-worker <port> <index> <count>    : run as worker process of the distributed renderer (no window)
+    // --render-service <port>                : additionally serve MIP frames to remote clients on the given port
+    // --render-client <port> <frames>        : run the loopback client stand-in of the render service (no window)
+    // --codec-benchmark <frames>             : measure the frame codec on all demo datasets (no window)
+    // --refine-benchmark <frames>            : measure adaptive refinement speedup and error on all demo datasets (no window)
+    // --voxel-benchmark <frames>             : measure frame time and memory of 8 and 16 bit voxels on all demo datasets (no window)
+    // --packed-benchmark <frames>            : measure frame time and memory of packed bricks on all demo datasets (no window)
+    // --live-benchmark <updates>             : measure the time per region update of a synthetic live volume by slab size (no window)
+    // --self-test                            : run the self-test of the codecs, caches and validations (no window), exit code 0 = passed
+    // --frame-output <name> <slots>          : write every rendered frame to the named shared memory ring buffer
+    // --frame-consumer <name> <frames> <ms>  : run the frame output consumer stand-in (no window)
+    // --cine <dataset> <x|y|z> <frames> <width> <height> <prefix> <pgm|raw>
+    //                                        : render a 360 degree rotation of dataset 0..3 as image sequence (no window)
+    // --brick <dataset> <file>               : convert dataset 0..3 into a bricked volume file for out-of-core paging (no window)
+    // --brick-raw <raw file> <columns> <rows> <slices> <bits stored> <spacing x> <spacing y> <spacing z> <file>
+    //                                        : convert a raw volume file into a bricked volume file (no window)
+    // --paged <file> <budget MB>             : render a bricked volume file with a brick pool of the given size
+    // --raw <file> <columns> <rows> <slices> <bits stored> <spacing x> <spacing y> <spacing z>
+    //                                        : render a raw volume file (partitioned if it exceeds the 3D texture limits)
+    // --dicom-export <dataset> <directory>   : write dataset 0..3 as synthetic DICOM series, one file per slice (no window)
+    // --dicom <directory>                    : render the uncompressed DICOM series in the given directory
+    UINT distributedWorkers = 0;
+    int renderServicePort = -1;
+    std::wstring frameOutputName;
+    UINT frameOutputSlots = 0;
+    char pagedFileName[MAX_PATH] = { 0 };
+    UINT pagedBudgetMB = 0;
+    char dicomDirectory[MAX_PATH] = { 0 };
+    char rawFileName[MAX_PATH] = { 0 };
+    VolumeDatasetInfo rawDatasetInfo = { rawFileName, 0, 0, 0, 8, { 1.0f, 1.0f, 1.0f } };
+    int argCount = 0;
+    LPWSTR* argList = CommandLineToArgvW(GetCommandLineW(), &argCount);
+    for (int argIdx = 1; argList && argIdx < argCount; argIdx++)
+    {
+        if (0 == wcscmp(argList[argIdx], L"--mip-worker") && argIdx + 3 < argCount)
+        {
+            UINT16 compositorPort = static_cast<UINT16>(_wtoi(argList[argIdx + 1]));
+            UINT workerIndex = static_cast<UINT>(_wtoi(argList[argIdx + 2]));
+            UINT workerCount = static_cast<UINT>(_wtoi(argList[argIdx + 3]));
+            LocalFree(argList);
+            return DistributedMipRenderer::RunWorker(compositorPort, workerIndex, workerCount);
+        }
+        if (0 == wcscmp(argList[argIdx], L"--render-client") && argIdx + 2 < argCount)
+        {
+            UINT16 servicePort = static_cast<UINT16>(_wtoi(argList[argIdx + 1]));
+            UINT frameCount = static_cast<UINT>(_wtoi(argList[argIdx + 2]));
+            LocalFree(argList);
+            return RenderService::RunLoopbackClient(servicePort, frameCount);
+        }
+        if (0 == wcscmp(argList[argIdx], L"--codec-benchmark") && argIdx + 1 < argCount)
+        {
+            UINT frameCount = static_cast<UINT>(_wtoi(argList[argIdx + 1]));
+            LocalFree(argList);
+            return RunCodecBenchmark(frameCount);
+        }
+        if (0 == wcscmp(argList[argIdx], L"--refine-benchmark") && argIdx + 1 < argCount)
+        {
+            UINT frameCount = static_cast<UINT>(_wtoi(argList[argIdx + 1]));
+            LocalFree(argList);
+            return RunRefinementBenchmark(frameCount);
+        }
+        if (0 == wcscmp(argList[argIdx], L"--voxel-benchmark") && argIdx + 1 < argCount)
+        {
+            UINT frameCount = static_cast<UINT>(_wtoi(argList[argIdx + 1]));
+            LocalFree(argList);
+            return RunVoxelFormatBenchmark(frameCount);
+        }
+        if (0 == wcscmp(argList[argIdx], L"--packed-benchmark") && argIdx + 1 < argCount)
+        {
+            UINT frameCount = static_cast<UINT>(_wtoi(argList[argIdx + 1]));
+            LocalFree(argList);
+            return RunPackedBrickBenchmark(frameCount);
+        }
+        if (0 == wcscmp(argList[argIdx], L"--live-benchmark") && argIdx + 1 < argCount)
+        {
+            UINT updateCount = static_cast<UINT>(_wtoi(argList[argIdx + 1]));
+            LocalFree(argList);
+            return RunLiveVolumeBenchmark(updateCount);
+        }
+        if (0 == wcscmp(argList[argIdx], L"--self-test"))
+        {
+            LocalFree(argList);
+            return SelfTest::RunSelfTest();
+        }
+        if (0 == wcscmp(argList[argIdx], L"--frame-consumer") && argIdx + 3 < argCount)
+        {
+            std::wstring sharedMemoryName = argList[argIdx + 1];
+            UINT frameCount = static_cast<UINT>(_wtoi(argList[argIdx + 2]));
+            UINT processingDelayMSec = static_cast<UINT>(_wtoi(argList[argIdx + 3]));
+            LocalFree(argList);
+            return RunFrameConsumer(sharedMemoryName.c_str(), frameCount, processingDelayMSec);
+        }
+        if (0 == wcscmp(argList[argIdx], L"--cine") && argIdx + 7 < argCount)
+        {
+            CineBatchSettings cineSettings;
+            cineSettings.volumeDataset = static_cast<VOLUME_DATASET>(_wtoi(argList[argIdx + 1]));
+            switch (argList[argIdx + 2][0])
+            {
+            case L'x': case L'X': cineSettings.rotationAxis = CINE_AXIS::X; break;
+            case L'z': case L'Z': cineSettings.rotationAxis = CINE_AXIS::Z; break;
+            default: cineSettings.rotationAxis = CINE_AXIS::Y; break;
+            }
+            cineSettings.frameCount = static_cast<UINT>(_wtoi(argList[argIdx + 3]));
+            cineSettings.width = static_cast<UINT>(_wtoi(argList[argIdx + 4]));
+            cineSettings.height = static_cast<UINT>(_wtoi(argList[argIdx + 5]));
+            char outputPrefix[MAX_PATH] = { 0 };
+            WideCharToMultiByte(CP_ACP, 0, argList[argIdx + 6], -1, outputPrefix, MAX_PATH, nullptr, nullptr);
+            cineSettings.outputPrefix = outputPrefix;
+            cineSettings.imageFormat = (0 == wcscmp(argList[argIdx + 7], L"raw")) ? CINE_IMAGE_FORMAT::RAW : CINE_IMAGE_FORMAT::PGM;
+            LocalFree(argList);
+            return CineBatchRenderer::RunBatch(cineSettings);
+        }
+        if (0 == wcscmp(argList[argIdx], L"--brick") && argIdx + 2 < argCount)
+        {
+            VOLUME_DATASET volumeDataset = static_cast<VOLUME_DATASET>(_wtoi(argList[argIdx + 1]));
+            char brickedFileName[MAX_PATH] = { 0 };
+            WideCharToMultiByte(CP_ACP, 0, argList[argIdx + 2], -1, brickedFileName, MAX_PATH, nullptr, nullptr);
+            LocalFree(argList);
+            return BrickedVolume::Convert(GetVolumeDatasetInfo(volumeDataset), brickedFileName) ? 0 : 1;
+        }
+        if (0 == wcscmp(argList[argIdx], L"--brick-raw") && argIdx + 9 < argCount)
+        {
+            char sourceFileName[MAX_PATH] = { 0 };
+            char brickedFileName[MAX_PATH] = { 0 };
+            WideCharToMultiByte(CP_ACP, 0, argList[argIdx + 1], -1, sourceFileName, MAX_PATH, nullptr, nullptr);
+            VolumeDatasetInfo sourceInfo = { sourceFileName, 0, 0, 0, 8, { 1.0f, 1.0f, 1.0f } };
+            sourceInfo.volColumns = static_cast<UINT>(_wtoi(argList[argIdx + 2]));
+            sourceInfo.volRows = static_cast<UINT>(_wtoi(argList[argIdx + 3]));
+            sourceInfo.volSlices = static_cast<UINT>(_wtoi(argList[argIdx + 4]));
+            sourceInfo.bitsStored = static_cast<UINT>(_wtoi(argList[argIdx + 5]));
+            for (int axis = 0; axis < 3; axis++)
+            {
+                sourceInfo.voxelSpacing[axis] = static_cast<float>(_wtof(argList[argIdx + 6 + axis]));
+            }
+            WideCharToMultiByte(CP_ACP, 0, argList[argIdx + 9], -1, brickedFileName, MAX_PATH, nullptr, nullptr);
+            LocalFree(argList);
+            return BrickedVolume::Convert(sourceInfo, brickedFileName) ? 0 : 1;
+        }
+        if (0 == wcscmp(argList[argIdx], L"--dicom-export") && argIdx + 2 < argCount)
+        {
+            VOLUME_DATASET volumeDataset = static_cast<VOLUME_DATASET>(_wtoi(argList[argIdx + 1]));
+            char exportDirectory[MAX_PATH] = { 0 };
+            WideCharToMultiByte(CP_ACP, 0, argList[argIdx + 2], -1, exportDirectory, MAX_PATH, nullptr, nullptr);
+            LocalFree(argList);
+            return DicomSeries::Export(GetVolumeDatasetInfo(volumeDataset), exportDirectory) ? 0 : 1;
+        }
+        if (0 == wcscmp(argList[argIdx], L"--dicom") && argIdx + 1 < argCount)
+        {
+            WideCharToMultiByte(CP_ACP, 0, argList[++argIdx], -1, dicomDirectory, MAX_PATH, nullptr, nullptr);
+        }
+        if (0 == wcscmp(argList[argIdx], L"--raw") && argIdx + 8 < argCount)
+        {
+            WideCharToMultiByte(CP_ACP, 0, argList[++argIdx], -1, rawFileName, MAX_PATH, nullptr, nullptr);
+            rawDatasetInfo.volColumns = static_cast<UINT>(_wtoi(argList[++argIdx]));
+            rawDatasetInfo.volRows = static_cast<UINT>(_wtoi(argList[++argIdx]));
+            rawDatasetInfo.volSlices = static_cast<UINT>(_wtoi(argList[++argIdx]));
+            rawDatasetInfo.bitsStored = static_cast<UINT>(_wtoi(argList[++argIdx]));
+            for (int axis = 0; axis < 3; axis++)
+            {
+                rawDatasetInfo.voxelSpacing[axis] = static_cast<float>(_wtof(argList[++argIdx]));
+            }
+        }
+        if (0 == wcscmp(argList[argIdx], L"--paged") && argIdx + 2 < argCount)
+        {
+            WideCharToMultiByte(CP_ACP, 0, argList[++argIdx], -1, pagedFileName, MAX_PATH, nullptr, nullptr);
+            pagedBudgetMB = static_cast<UINT>(_wtoi(argList[++argIdx]));
+        }
+        if (0 == wcscmp(argList[argIdx], L"--frame-output") && argIdx + 2 < argCount)
+        {
+            frameOutputName = argList[++argIdx];
+            frameOutputSlots = static_cast<UINT>(_wtoi(argList[++argIdx]));
+        }
+        if (0 == wcscmp(argList[argIdx], L"--distributed") && argIdx + 1 < argCount)
+        {
+            distributedWorkers = static_cast<UINT>(_wtoi(argList[++argIdx]));
+        }
+        if (0 == wcscmp(argList[argIdx], L"--render-service") && argIdx + 1 < argCount)
+        {
+            renderServicePort = _wtoi(argList[++argIdx]);
+        }
+    }
+    LocalFree(argList);
     
     g_RayCaster = std::make_unique<RayCastRenderer>();
 
@@ -159,23 +803,58 @@ int WINAPI wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance,
         MessageBox(nullptr, L"Initialization of Ray-Caster Renderer failed!", L"ERROR", MB_OK);
         g_RayCaster->Release();
     }
+    else if (distributedWorkers > 0 && !g_RayCaster->EnableDistributedRendering(distributedWorkers))
+    {
+        MessageBox(nullptr, L"Unable to start worker processes - distributed rendering disabled!", L"ERROR", MB_OK);
+    }
 
-    // main message loop
-    MSG msg = { 0 };
-    while (WM_QUIT != msg.message)
+    if (!frameOutputName.empty() && !g_RayCaster->EnableFrameOutput(frameOutputName.c_str(), frameOutputSlots))
     {
-        if (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE))
-        {
-            TranslateMessage(&msg);
-            DispatchMessage(&msg);
-        }
-        else
+        MessageBox(nullptr, L"Unable to create shared memory frame output (name already in use?)!", L"ERROR", MB_OK);
+    }
+
+    if (0 != pagedFileName[0] && !g_RayCaster->LoadPagedDataset(pagedFileName, static_cast<UINT64>(pagedBudgetMB) << 20))
+    {
+        MessageBox(nullptr, L"Unable to open bricked volume file - paging disabled!", L"ERROR", MB_OK);
+    }
+
+    if (0 != rawFileName[0] && !g_RayCaster->LoadRawVolume(rawDatasetInfo))
+    {
+        MessageBox(nullptr, L"Unable to load raw volume file (check dimensions and bits stored)!", L"ERROR", MB_OK);
+    }
+
+    if (0 != dicomDirectory[0] && !g_RayCaster->LoadDicomSeries(dicomDirectory))
+    {
+        MessageBox(nullptr, L"Unable to load DICOM series (uncompressed, one consistent series per directory)!", L"ERROR", MB_OK);
+    }
+
+    if (renderServicePort >= 0)
+    {
+        // the render service uses its own device on its own render thread
+        g_RenderService = std::make_unique<RenderService>();
+        if (!g_RenderService->Start(static_cast<UINT16>(renderServicePort)))
         {
-            g_RayCaster->Update();
-            g_RayCaster->Render();
+            MessageBox(nullptr, L"Unable to start render service!", L"ERROR", MB_OK);
+            g_RenderService.reset();
         }
     }
 
+    // rendering runs on its own thread - the main thread only handles window messages, so input stays responsive
+    // while a frame is in flight
+    g_RayCaster->StartRenderThread();
+
+    // main message loop
+    MSG msg = { 0 };
+    while (GetMessage(&msg, nullptr, 0, 0) > 0)
+    {
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
+    }
+
+    if (g_RenderService)
+    {
+        g_RenderService->Stop();
+    }
     g_RayCaster->Release();
 
     return (int)msg.wParam;
@@ -0,0 +1,784 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: DicomSeries.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of the DicomSeries functionality.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#include "stdafx.h"
+#include "DicomSeries.h"
+
+using namespace std;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    const double DicomSeries::SLICE_DISTANCE_TOLERANCE = 0.01;
+    const double DicomSeries::GEOMETRY_TOLERANCE = 1e-4;
+
+    namespace
+    {
+        // data elements (group << 16 | element) read from the headers
+        const UINT TAG_TRANSFER_SYNTAX = 0x00020010;
+        const UINT TAG_SLICE_THICKNESS = 0x00180050;
+        const UINT TAG_SERIES_INSTANCE_UID = 0x0020000E;
+        const UINT TAG_IMAGE_POSITION = 0x00200032;
+        const UINT TAG_IMAGE_ORIENTATION = 0x00200037;
+        const UINT TAG_SAMPLES_PER_PIXEL = 0x00280002;
+        const UINT TAG_ROWS = 0x00280010;
+        const UINT TAG_COLUMNS = 0x00280011;
+        const UINT TAG_PIXEL_SPACING = 0x00280030;
+        const UINT TAG_BITS_ALLOCATED = 0x00280100;
+        const UINT TAG_BITS_STORED = 0x00280101;
+        const UINT TAG_HIGH_BIT = 0x00280102;
+        const UINT TAG_PIXEL_REPRESENTATION = 0x00280103;
+        const UINT TAG_RESCALE_INTERCEPT = 0x00281052;
+        const UINT TAG_RESCALE_SLOPE = 0x00281053;
+        const UINT TAG_PIXEL_DATA = 0x7FE00010;
+        // sequence items and delimiters
+        const UINT TAG_ITEM = 0xFFFEE000;
+        const UINT TAG_ITEM_DELIMITER = 0xFFFEE00D;
+        const UINT TAG_SEQUENCE_DELIMITER = 0xFFFEE0DD;
+        const UINT UNDEFINED_LENGTH = 0xFFFFFFFF;
+
+        // the supported (uncompressed, little endian) transfer syntaxes
+        const char* const IMPLICIT_VR_LITTLE_ENDIAN = "1.2.840.10008.1.2";
+        const char* const EXPLICIT_VR_LITTLE_ENDIAN = "1.2.840.10008.1.2.1";
+
+        //------------------------------------------------------------------------------------------------------
+        // Explicit VR : value representations with a 32 bit length (preceded by two reserved bytes)
+        //------------------------------------------------------------------------------------------------------
+        bool hasLongLength(const char vr[2])
+        {
+            static const char* const longVRs[] = { "OB", "OD", "OF", "OL", "OV", "OW", "SQ", "SV", "UC", "UN", "UR", "UT", "UV" };
+            for (auto longVR : longVRs)
+            {
+                if (vr[0] == longVR[0] && vr[1] == longVR[1]) return true;
+            }
+            return false;
+        }
+
+        //------------------------------------------------------------------------------------------------------
+        // Read the tag, VR and value length of the next data element. The file meta information (group 0002)
+        // is explicit VR in every transfer syntax; items and delimiters (group FFFE) have no VR. A defined length
+        // beyond the end of the file fails - the length is untrusted input and sizes the value buffer.
+        //------------------------------------------------------------------------------------------------------
+        bool readElementHeader(ifstream& file, UINT64 fileSize, bool explicitVR, UINT& tag, UINT& length)
+        {
+            UINT16 groupElement[2] = { 0, 0 };
+            file.read(reinterpret_cast<char*>(groupElement), sizeof(groupElement));
+            if (!file)
+            {
+                return false;
+            }
+            tag = (static_cast<UINT>(groupElement[0]) << 16) | groupElement[1];
+
+            if ((explicitVR || 0x0002 == groupElement[0]) && 0xFFFE != groupElement[0])
+            {
+                char vr[2] = { 0, 0 };
+                file.read(vr, sizeof(vr));
+                if (hasLongLength(vr))
+                {
+                    char reserved[2];
+                    file.read(reserved, sizeof(reserved));
+                    file.read(reinterpret_cast<char*>(&length), sizeof(length));
+                }
+                else
+                {
+                    UINT16 shortLength = 0;
+                    file.read(reinterpret_cast<char*>(&shortLength), sizeof(shortLength));
+                    length = shortLength;
+                }
+            }
+            else
+            {
+                file.read(reinterpret_cast<char*>(&length), sizeof(length));
+            }
+            if (!file)
+            {
+                return false;
+            }
+            return UNDEFINED_LENGTH == length || length <= fileSize - static_cast<UINT64>(file.tellg());
+        }
+
+        //------------------------------------------------------------------------------------------------------
+        // Skip the content of a sequence or item of undefined length up to the given delimiter (nested
+        // sequences and items of undefined length are skipped recursively)
+        //------------------------------------------------------------------------------------------------------
+        bool skipUndefinedLength(ifstream& file, UINT64 fileSize, bool explicitVR, UINT delimiterTag)
+        {
+            UINT tag = 0, length = 0;
+            while (readElementHeader(file, fileSize, explicitVR, tag, length))
+            {
+                if (delimiterTag == tag)
+                {
+                    return true;
+                }
+                if (UNDEFINED_LENGTH == length)
+                {
+                    if (!skipUndefinedLength(file, fileSize, explicitVR, (TAG_ITEM == tag) ? TAG_ITEM_DELIMITER : TAG_SEQUENCE_DELIMITER))
+                    {
+                        return false;
+                    }
+                }
+                else
+                {
+                    file.seekg(length, file.cur);
+                }
+            }
+            return false;
+        }
+
+        //------------------------------------------------------------------------------------------------------
+        // Value helpers : strings without padding, unsigned short (US) and multi-valued decimal strings (DS)
+        //------------------------------------------------------------------------------------------------------
+        void trimValue(string& value)
+        {
+            while (!value.empty() && (' ' == value.back() || '\0' == value.back()))
+            {
+                value.pop_back();
+            }
+        }
+
+        UINT toUnsignedShort(const string& value)
+        {
+            return (value.size() >= 2) ? (static_cast<BYTE>(value[0]) | (static_cast<UINT>(static_cast<BYTE>(value[1])) << 8)) : 0;
+        }
+
+        UINT toDecimals(const string& value, double* pValues, UINT maxCount)
+        {
+            UINT count = 0;
+            const char* pText = value.c_str();
+            while (count < maxCount)
+            {
+                char* pEnd = nullptr;
+                pValues[count] = strtod(pText, &pEnd);
+                if (pEnd == pText) break;
+                count++;
+                pText = strchr(pEnd, '\\');
+                if (nullptr == pText) break;
+                pText++;
+            }
+            return count;
+        }
+
+        //------------------------------------------------------------------------------------------------------
+        // Export : append an explicit VR little endian data element (values are padded to even length)
+        //------------------------------------------------------------------------------------------------------
+        void appendElement(vector<char>& buffer, UINT tag, const char* vr, const void* pValue, UINT length)
+        {
+            const UINT16 groupElement[2] = { static_cast<UINT16>(tag >> 16), static_cast<UINT16>(tag & 0xFFFF) };
+            const UINT paddedLength = (length + 1) & ~1u;
+            buffer.insert(buffer.end(), reinterpret_cast<const char*>(groupElement), reinterpret_cast<const char*>(groupElement) + sizeof(groupElement));
+            buffer.insert(buffer.end(), vr, vr + 2);
+            if (hasLongLength(vr))
+            {
+                buffer.insert(buffer.end(), 2, '\0');
+                buffer.insert(buffer.end(), reinterpret_cast<const char*>(&paddedLength), reinterpret_cast<const char*>(&paddedLength) + sizeof(paddedLength));
+            }
+            else
+            {
+                const UINT16 shortLength = static_cast<UINT16>(paddedLength);
+                buffer.insert(buffer.end(), reinterpret_cast<const char*>(&shortLength), reinterpret_cast<const char*>(&shortLength) + sizeof(shortLength));
+            }
+            buffer.insert(buffer.end(), static_cast<const char*>(pValue), static_cast<const char*>(pValue) + length);
+            if (paddedLength > length)
+            {
+                // UIDs are padded with NUL, text with a space
+                buffer.push_back(('U' == vr[0] && 'I' == vr[1]) ? '\0' : ' ');
+            }
+        }
+
+        void appendString(vector<char>& buffer, UINT tag, const char* vr, const string& value)
+        {
+            appendElement(buffer, tag, vr, value.data(), static_cast<UINT>(value.size()));
+        }
+
+        void appendUnsignedShort(vector<char>& buffer, UINT tag, UINT value)
+        {
+            const UINT16 shortValue = static_cast<UINT16>(value);
+            appendElement(buffer, tag, "US", &shortValue, sizeof(shortValue));
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Construction
+    //------------------------------------------------------------------------------------------------------
+    DicomSeries::DicomSeries()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destruction
+    //------------------------------------------------------------------------------------------------------
+    DicomSeries::~DicomSeries()
+    {
+        Release();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Load the DICOM series in the given directory. Files that are not DICOM images (DICOMDIR, reports,
+    // compressed or big endian transfer syntaxes) are skipped - a missing slice fails the slice distance
+    // check. Parsing reads only the headers; the pixel data is read once, straight into the volume buffer.
+    //------------------------------------------------------------------------------------------------------
+    bool DicomSeries::Load(const char* directory)
+    {
+        Release();
+        const auto startTime = chrono::steady_clock::now();
+
+        // list the files of the directory
+        directory_ = directory;
+        vector<string> fileNames;
+        WIN32_FIND_DATAA findData;
+        HANDLE hFind = FindFirstFileA((directory_ + "\\*").c_str(), &findData);
+        if (INVALID_HANDLE_VALUE == hFind)
+        {
+            return false;
+        }
+        do
+        {
+            if (0 == (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+            {
+                fileNames.push_back(directory_ + "\\" + findData.cFileName);
+            }
+        } while (FindNextFileA(hFind, &findData));
+        FindClose(hFind);
+
+        // parse the headers in parallel
+        vector<DicomSliceHeader> headers(fileNames.size());
+        vector<BYTE> isSlice(fileNames.size(), 0);
+        parallelFor(fileNames.size(), [&](size_t fileIdx)
+        {
+            isSlice[fileIdx] = ParseHeader(fileNames[fileIdx], headers[fileIdx]) ? 1 : 0;
+            return true;
+        });
+        for (size_t fileIdx = 0; fileIdx < headers.size(); fileIdx++)
+        {
+            if (isSlice[fileIdx]) slices_.push_back(move(headers[fileIdx]));
+        }
+        const auto parseTime = chrono::steady_clock::now();
+
+        if (!SortAndCheckSlices(slices_, datasetInfo_) || !decodeSlices())
+        {
+            Release();
+            return false;
+        }
+        datasetInfo_.fileName = directory_.c_str();
+        const auto decodeTime = chrono::steady_clock::now();
+
+        const size_t bufferSize = 512;
+        char charBuffer[bufferSize];
+        sprintf_s(
+            charBuffer,
+            bufferSize,
+            "DICOM series %s : %u x %u x %u voxels (%.3f x %.3f x %.3f mm), headers : %.1f ms, pixel data : %.1f ms\n",
+            directory_.c_str(),
+            datasetInfo_.volColumns,
+            datasetInfo_.volRows,
+            datasetInfo_.volSlices,
+            datasetInfo_.voxelSpacing[0],
+            datasetInfo_.voxelSpacing[1],
+            datasetInfo_.voxelSpacing[2],
+            chrono::duration<double, milli>(parseTime - startTime).count(),
+            chrono::duration<double, milli>(decodeTime - parseTime).count());
+        OutputDebugStringA(charBuffer);
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Release the volume data
+    //------------------------------------------------------------------------------------------------------
+    void DicomSeries::Release()
+    {
+        slices_.clear();
+        volumeData_.clear();
+        volumeData_.shrink_to_fit();
+        datasetInfo_.fileName = nullptr;
+        datasetInfo_.volColumns = 0;
+        datasetInfo_.volRows = 0;
+        datasetInfo_.volSlices = 0;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Parse the header of a DICOM part 10 file up to the pixel data element. Sequences are skipped; the
+    // pixel data must be native (defined length) - encapsulated pixel data is compressed. An element longer
+    // than the rest of the file fails the slice.
+    //------------------------------------------------------------------------------------------------------
+    bool DicomSeries::ParseHeader(const string& fileName, DicomSliceHeader& header)
+    {
+        ifstream file(fileName, ifstream::in | ifstream::binary);
+        file.seekg(0, file.end);
+        const UINT64 fileSize = static_cast<UINT64>(file.tellg());
+        file.seekg(0, file.beg);
+        char preamble[132];
+        file.read(preamble, sizeof(preamble));
+        if (!file || 0 != memcmp(preamble + 128, "DICM", 4))
+        {
+            return false;
+        }
+        header.fileName = fileName;
+
+        bool explicitVR = true;
+        UINT tag = 0, length = 0;
+        string value;
+        while (readElementHeader(file, fileSize, explicitVR, tag, length))
+        {
+            if (TAG_PIXEL_DATA == tag)
+            {
+                header.pixelDataOffset = static_cast<UINT64>(file.tellg());
+                header.pixelDataLength = length;
+                return UNDEFINED_LENGTH != length;
+            }
+            if (UNDEFINED_LENGTH == length)
+            {
+                if (!skipUndefinedLength(file, fileSize, explicitVR, (TAG_ITEM == tag) ? TAG_ITEM_DELIMITER : TAG_SEQUENCE_DELIMITER))
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            switch (tag)
+            {
+            case TAG_TRANSFER_SYNTAX:
+            case TAG_SLICE_THICKNESS:
+            case TAG_SERIES_INSTANCE_UID:
+            case TAG_IMAGE_POSITION:
+            case TAG_IMAGE_ORIENTATION:
+            case TAG_SAMPLES_PER_PIXEL:
+            case TAG_ROWS:
+            case TAG_COLUMNS:
+            case TAG_PIXEL_SPACING:
+            case TAG_BITS_ALLOCATED:
+            case TAG_BITS_STORED:
+            case TAG_HIGH_BIT:
+            case TAG_PIXEL_REPRESENTATION:
+            case TAG_RESCALE_INTERCEPT:
+            case TAG_RESCALE_SLOPE:
+                value.resize(length);
+                file.read(&value[0], length);
+                break;
+            default:
+                file.seekg(length, file.cur);
+                continue;
+            }
+            if (!file)
+            {
+                return false;
+            }
+
+            switch (tag)
+            {
+            case TAG_TRANSFER_SYNTAX:
+                trimValue(value);
+                if (value == IMPLICIT_VR_LITTLE_ENDIAN)
+                {
+                    explicitVR = false;
+                }
+                else if (value != EXPLICIT_VR_LITTLE_ENDIAN)
+                {
+                    // compressed or big endian
+                    return false;
+                }
+                break;
+            case TAG_SLICE_THICKNESS:
+                toDecimals(value, &header.sliceThickness, 1);
+                break;
+            case TAG_SERIES_INSTANCE_UID:
+                trimValue(value);
+                header.seriesInstanceUID = value;
+                break;
+            case TAG_IMAGE_POSITION:
+                header.hasImagePosition = (3 == toDecimals(value, header.imagePosition, 3));
+                break;
+            case TAG_IMAGE_ORIENTATION:
+                toDecimals(value, header.imageOrientation, 6);
+                break;
+            case TAG_SAMPLES_PER_PIXEL:
+                header.samplesPerPixel = toUnsignedShort(value);
+                break;
+            case TAG_ROWS:
+                header.rows = toUnsignedShort(value);
+                break;
+            case TAG_COLUMNS:
+                header.columns = toUnsignedShort(value);
+                break;
+            case TAG_PIXEL_SPACING:
+                toDecimals(value, header.pixelSpacing, 2);
+                break;
+            case TAG_BITS_ALLOCATED:
+                header.bitsAllocated = toUnsignedShort(value);
+                break;
+            case TAG_BITS_STORED:
+                header.bitsStored = toUnsignedShort(value);
+                break;
+            case TAG_HIGH_BIT:
+                header.highBit = toUnsignedShort(value);
+                break;
+            case TAG_PIXEL_REPRESENTATION:
+                header.pixelRepresentation = toUnsignedShort(value);
+                break;
+            case TAG_RESCALE_INTERCEPT:
+                toDecimals(value, &header.rescaleIntercept, 1);
+                break;
+            case TAG_RESCALE_SLOPE:
+                toDecimals(value, &header.rescaleSlope, 1);
+                break;
+            }
+        }
+        return false;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Sort the slices along the slice normal (cross product of the row and column directions) and check
+    // that they form one regular volume : same series, pixel format, size, orientation and pixel spacing,
+    // positions on a line along the normal (no gantry tilt) and a uniform slice distance (no gaps or
+    // duplicates). The voxel spacing is the pixel spacing and the mean slice distance.
+    //------------------------------------------------------------------------------------------------------
+    bool DicomSeries::SortAndCheckSlices(vector<DicomSliceHeader>& slices, VolumeDatasetInfo& datasetInfo)
+    {
+        if (slices.empty())
+        {
+            return false;
+        }
+
+        const DicomSliceHeader& first = slices.front();
+        if (0 == first.rows || 0 == first.columns || 1 != first.samplesPerPixel ||
+            (8 != first.bitsAllocated && 16 != first.bitsAllocated) ||
+            0 == first.bitsStored || first.highBit >= first.bitsAllocated || first.highBit + 1 < first.bitsStored)
+        {
+            // empty, color or unsupported pixel format
+            return false;
+        }
+        const UINT64 sliceSize = static_cast<UINT64>(first.rows) * first.columns * (first.bitsAllocated / 8);
+        for (const auto& slice : slices)
+        {
+            if (slice.seriesInstanceUID != first.seriesInstanceUID || slice.rows != first.rows || slice.columns != first.columns ||
+                slice.samplesPerPixel != first.samplesPerPixel || slice.bitsAllocated != first.bitsAllocated ||
+                slice.bitsStored != first.bitsStored || slice.highBit != first.highBit ||
+                slice.pixelRepresentation != first.pixelRepresentation || slice.pixelDataLength < sliceSize)
+            {
+                return false;
+            }
+            if (0.0 == slice.rescaleSlope || !isfinite(slice.rescaleSlope) || !isfinite(slice.rescaleIntercept))
+            {
+                // no modality values
+                return false;
+            }
+            for (int idx = 0; idx < 2; idx++)
+            {
+                if (fabs(slice.pixelSpacing[idx] - first.pixelSpacing[idx]) > GEOMETRY_TOLERANCE) return false;
+            }
+            for (int idx = 0; idx < 6; idx++)
+            {
+                if (fabs(slice.imageOrientation[idx] - first.imageOrientation[idx]) > GEOMETRY_TOLERANCE) return false;
+            }
+            if (!slice.hasImagePosition && slices.size() > 1)
+            {
+                return false;
+            }
+        }
+
+        // sort by the position along the slice normal
+        const double* pRow = first.imageOrientation;
+        const double* pColumn = first.imageOrientation + 3;
+        const double normal[3] = 
+        {
+            pRow[1] * pColumn[2] - pRow[2] * pColumn[1],
+            pRow[2] * pColumn[0] - pRow[0] * pColumn[2],
+            pRow[0] * pColumn[1] - pRow[1] * pColumn[0]
+        };
+        for (auto& slice : slices)
+        {
+            slice.slicePosition = slice.imagePosition[0] * normal[0] + slice.imagePosition[1] * normal[1] + slice.imagePosition[2] * normal[2];
+        }
+        sort(slices.begin(), slices.end(), [](const DicomSliceHeader& a, const DicomSliceHeader& b) { return a.slicePosition < b.slicePosition; });
+
+        double sliceDistance = (first.sliceThickness > 0.0) ? first.sliceThickness : first.pixelSpacing[0];
+        const size_t sliceCount = slices.size();
+        if (sliceCount > 1)
+        {
+            sliceDistance = (slices.back().slicePosition - slices.front().slicePosition) / (sliceCount - 1);
+            if (sliceDistance <= 0.0)
+            {
+                return false;
+            }
+            for (size_t sliceIdx = 1; sliceIdx < sliceCount; sliceIdx++)
+            {
+                const DicomSliceHeader& slice = slices[sliceIdx];
+                const double distance = slice.slicePosition - slices[sliceIdx - 1].slicePosition;
+                if (fabs(distance - sliceDistance) > SLICE_DISTANCE_TOLERANCE * sliceDistance)
+                {
+                    return false;
+                }
+                // in-plane offset from the first slice (tilted gantry or mixed stacks)
+                const double offsetAlongNormal = slice.slicePosition - slices.front().slicePosition;
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    const double inPlaneOffset = slice.imagePosition[axis] - slices.front().imagePosition[axis] - offsetAlongNormal * normal[axis];
+                    if (fabs(inPlaneOffset) > SLICE_DISTANCE_TOLERANCE * sliceDistance) return false;
+                }
+            }
+        }
+
+        // raw file layout : 8 bit allocated -> one byte per voxel, 16 bit allocated -> 9 .. 16 bits stored
+        const DicomSliceHeader& sorted = slices.front();
+        datasetInfo.volColumns = sorted.columns;
+        datasetInfo.volRows = sorted.rows;
+        datasetInfo.volSlices = static_cast<UINT>(sliceCount);
+        datasetInfo.bitsStored = (16 == sorted.bitsAllocated) ? max(9u, sorted.bitsStored) : 8;
+        datasetInfo.voxelSpacing[0] = static_cast<float>(sorted.pixelSpacing[1]);
+        datasetInfo.voxelSpacing[1] = static_cast<float>(sorted.pixelSpacing[0]);
+        datasetInfo.voxelSpacing[2] = static_cast<float>(sliceDistance);
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Read the pixel data of every slice straight into its place in the volume buffer (one slice per work
+    // item) and normalize it in place : bits stored moved to the bottom of the word, two's complement data
+    // shifted to unsigned (the minimum value maps to 0). A rescale shared by all slices with a positive slope
+    // maps the voxels linearly - the MIP and the window are the same for stored and modality values. Otherwise
+    // (per slice rescale, e.g. PET, or negative slope) every slice is rescaled to the modality values and
+    // these are mapped to the stored bits over the value range of the series.
+    //------------------------------------------------------------------------------------------------------
+    bool DicomSeries::decodeSlices()
+    {
+        const DicomSliceHeader& first = slices_.front();
+        const size_t voxelsPerSlice = static_cast<size_t>(first.rows) * first.columns;
+        const size_t sliceSize = voxelsPerSlice * (first.bitsAllocated / 8);
+        volumeData_.resize(sliceSize * slices_.size());
+
+        const UINT shift = first.highBit + 1 - first.bitsStored;
+        const UINT mask = (1u << first.bitsStored) - 1;
+        const UINT signBit = (0 != first.pixelRepresentation) ? 1u << (first.bitsStored - 1) : 0;
+
+        bool rescale = (first.rescaleSlope < 0.0);
+        for (const auto& slice : slices_)
+        {
+            if (slice.rescaleSlope != first.rescaleSlope || slice.rescaleIntercept != first.rescaleIntercept) rescale = true;
+        }
+        const bool normalize = (rescale || 0 != shift || 0 != signBit || first.bitsStored != first.bitsAllocated);
+
+        // modality value range of the series (stored values from -signBit to mask - signBit)
+        const double storedMin = -static_cast<double>(signBit);
+        const double storedMax = static_cast<double>(mask) - signBit;
+        double valueMin = DBL_MAX, valueMax = -DBL_MAX;
+        for (const auto& slice : slices_)
+        {
+            const double value0 = slice.rescaleSlope * storedMin + slice.rescaleIntercept;
+            const double value1 = slice.rescaleSlope * storedMax + slice.rescaleIntercept;
+            valueMin = min(valueMin, min(value0, value1));
+            valueMax = max(valueMax, max(value0, value1));
+        }
+        const double valueScale = static_cast<double>(mask) / (valueMax - valueMin);
+
+        return parallelFor(slices_.size(), [&](size_t sliceIdx)
+        {
+            const DicomSliceHeader& slice = slices_[sliceIdx];
+            char* pSlice = volumeData_.data() + sliceSize * sliceIdx;
+
+            ifstream file(slice.fileName, ifstream::in | ifstream::binary);
+            file.seekg(static_cast<streamoff>(slice.pixelDataOffset), file.beg);
+            file.read(pSlice, static_cast<streamsize>(sliceSize));
+            if (!file)
+            {
+                return false;
+            }
+
+            if (rescale)
+            {
+                // stored value (sign extended) -> modality value -> bits stored over the series range
+                const double scale = slice.rescaleSlope * valueScale;
+                const double offset = (slice.rescaleIntercept - valueMin) * valueScale + 0.5;
+                for (size_t idx = 0; idx < voxelsPerSlice; idx++)
+                {
+                    const UINT word = ((16 == first.bitsAllocated) ? reinterpret_cast<const UINT16*>(pSlice)[idx] : reinterpret_cast<const BYTE*>(pSlice)[idx]);
+                    const UINT stored = (word >> shift) & mask;
+                    const double value = static_cast<double>(static_cast<int>(stored ^ signBit) - static_cast<int>(signBit));
+                    const UINT voxel = static_cast<UINT>(min(static_cast<double>(mask), max(0.0, value * scale + offset)));
+                    if (16 == first.bitsAllocated)
+                    {
+                        reinterpret_cast<UINT16*>(pSlice)[idx] = static_cast<UINT16>(voxel);
+                    }
+                    else
+                    {
+                        reinterpret_cast<BYTE*>(pSlice)[idx] = static_cast<BYTE>(voxel);
+                    }
+                }
+            }
+            else if (normalize)
+            {
+                // two's complement -> offset binary : flip the sign bit of the stored bits
+                if (16 == first.bitsAllocated)
+                {
+                    UINT16* pVoxels = reinterpret_cast<UINT16*>(pSlice);
+                    for (size_t idx = 0; idx < voxelsPerSlice; idx++)
+                    {
+                        pVoxels[idx] = static_cast<UINT16>(((pVoxels[idx] >> shift) & mask) ^ signBit);
+                    }
+                }
+                else
+                {
+                    BYTE* pVoxels = reinterpret_cast<BYTE*>(pSlice);
+                    for (size_t idx = 0; idx < voxelsPerSlice; idx++)
+                    {
+                        pVoxels[idx] = static_cast<BYTE>(((pVoxels[idx] >> shift) & mask) ^ signBit);
+                    }
+                }
+            }
+            return true;
+        });
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Run work(index) for every index in [0, count) on a pool of hardware threads
+    //------------------------------------------------------------------------------------------------------
+    bool DicomSeries::parallelFor(size_t count, const function<bool(size_t)>& work)
+    {
+        const UINT threadCount = static_cast<UINT>(min(static_cast<size_t>(max(1u, thread::hardware_concurrency())), count));
+        atomic<size_t> nextIndex(0);
+        atomic<bool> failed(false);
+
+        vector<thread> workers;
+        for (UINT threadIdx = 0; threadIdx < threadCount; threadIdx++)
+        {
+            workers.emplace_back([&]
+            {
+                for (size_t index = nextIndex++; index < count && !failed; index = nextIndex++)
+                {
+                    if (!work(index)) failed = true;
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+
+        return !failed;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Write the given raw dataset as a synthetic series : one explicit VR little endian CT image per slice
+    // with image position, orientation (axial), pixel spacing (voxel spacing of the dataset) and the
+    // voxels of the slice as native pixel data
+    //------------------------------------------------------------------------------------------------------
+    bool DicomSeries::Export(const VolumeDatasetInfo& datasetInfo, const char* directory)
+    {
+        assert(datasetInfo.bitsStored >= 8 && datasetInfo.bitsStored <= 16);
+
+        const UINT bytesPerVoxel = (datasetInfo.bitsStored > 8) ? 2 : 1;
+        const size_t sliceSize = static_cast<size_t>(datasetInfo.volColumns) * datasetInfo.volRows * bytesPerVoxel;
+
+        ifstream rawFile(datasetInfo.fileName, ifstream::in | ifstream::binary);
+        if (!rawFile)
+        {
+            return false;
+        }
+        rawFile.seekg(0, rawFile.end);
+        if (static_cast<UINT64>(rawFile.tellg()) != static_cast<UINT64>(sliceSize) * datasetInfo.volSlices)
+        {
+            return false;
+        }
+        rawFile.seekg(0, rawFile.beg);
+        CreateDirectoryA(directory, nullptr);
+
+        // UIDs below the UUID derived root 2.25
+        const string studyUID = "2.25." + to_string(static_cast<UINT64>(datasetInfo.volColumns) * 1000003ull + datasetInfo.volRows * 1009ull + datasetInfo.volSlices);
+        const string seriesUID = studyUID + "1";
+        const string sopClassUID = "1.2.840.10008.5.1.4.1.1.2";     // CT image storage
+
+        const size_t bufferSize = 128;
+        char charBuffer[bufferSize];
+        vector<char> pixelData(sliceSize);
+        for (UINT slice = 0; slice < datasetInfo.volSlices; slice++)
+        {
+            rawFile.read(pixelData.data(), static_cast<streamsize>(sliceSize));
+            if (!rawFile)
+            {
+                return false;
+            }
+            const string sopInstanceUID = seriesUID + "2" + to_string(slice + 1);
+
+            // file meta information (its group length precedes it)
+            vector<char> metaElements;
+            const BYTE metaVersion[2] = { 0, 1 };
+            appendElement(metaElements, 0x00020001, "OB", metaVersion, sizeof(metaVersion));
+            appendString(metaElements, 0x00020002, "UI", sopClassUID);
+            appendString(metaElements, 0x00020003, "UI", sopInstanceUID);
+            appendString(metaElements, TAG_TRANSFER_SYNTAX, "UI", EXPLICIT_VR_LITTLE_ENDIAN);
+
+            vector<char> buffer(128, '\0');
+            buffer.insert(buffer.end(), { 'D', 'I', 'C', 'M' });
+            const UINT metaLength = static_cast<UINT>(metaElements.size());
+            appendElement(buffer, 0x00020000, "UL", &metaLength, sizeof(metaLength));
+            buffer.insert(buffer.end(), metaElements.begin(), metaElements.end());
+
+            // data set (ascending tags)
+            appendString(buffer, 0x00080016, "UI", sopClassUID);
+            appendString(buffer, 0x00080018, "UI", sopInstanceUID);
+            appendString(buffer, 0x00080060, "CS", "CT");
+            sprintf_s(charBuffer, bufferSize, "%.6g", datasetInfo.voxelSpacing[2]);
+            appendString(buffer, TAG_SLICE_THICKNESS, "DS", charBuffer);
+            appendString(buffer, 0x0020000D, "UI", studyUID);
+            appendString(buffer, TAG_SERIES_INSTANCE_UID, "UI", seriesUID);
+            appendString(buffer, 0x00200013, "IS", to_string(slice + 1));
+            sprintf_s(
+                charBuffer,
+                bufferSize,
+                "%.6g\\%.6g\\%.6g",
+                -0.5 * datasetInfo.volColumns * datasetInfo.voxelSpacing[0],
+                -0.5 * datasetInfo.volRows * datasetInfo.voxelSpacing[1],
+                static_cast<double>(slice) * datasetInfo.voxelSpacing[2]);
+            appendString(buffer, TAG_IMAGE_POSITION, "DS", charBuffer);
+            appendString(buffer, TAG_IMAGE_ORIENTATION, "DS", "1\\0\\0\\0\\1\\0");
+            appendUnsignedShort(buffer, TAG_SAMPLES_PER_PIXEL, 1);
+            appendString(buffer, 0x00280004, "CS", "MONOCHROME2");
+            appendUnsignedShort(buffer, TAG_ROWS, datasetInfo.volRows);
+            appendUnsignedShort(buffer, TAG_COLUMNS, datasetInfo.volColumns);
+            sprintf_s(charBuffer, bufferSize, "%.6g\\%.6g", datasetInfo.voxelSpacing[1], datasetInfo.voxelSpacing[0]);
+            appendString(buffer, TAG_PIXEL_SPACING, "DS", charBuffer);
+            appendUnsignedShort(buffer, TAG_BITS_ALLOCATED, 8 * bytesPerVoxel);
+            appendUnsignedShort(buffer, TAG_BITS_STORED, datasetInfo.bitsStored);
+            appendUnsignedShort(buffer, TAG_HIGH_BIT, datasetInfo.bitsStored - 1);
+            appendUnsignedShort(buffer, TAG_PIXEL_REPRESENTATION, 0);
+            appendElement(buffer, TAG_PIXEL_DATA, (2 == bytesPerVoxel) ? "OW" : "OB", pixelData.data(), static_cast<UINT>(sliceSize));
+
+            // files numbered in reverse slice order
+            char dicomFileName[MAX_PATH] = { 0 };
+            sprintf_s(dicomFileName, MAX_PATH, "%s\\IM%05u.dcm", directory, datasetInfo.volSlices - slice);
+            ofstream dicomFile(dicomFileName, ofstream::out | ofstream::binary | ofstream::trunc);
+            dicomFile.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+            if (!dicomFile)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    const VolumeDatasetInfo& DicomSeries::GetDatasetInfo() const
+    {
+        return datasetInfo_;
+    }
+
+    const vector<char>& DicomSeries::GetVolumeData() const
+    {
+        return volumeData_;
+    }
+}
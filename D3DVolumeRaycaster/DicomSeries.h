@@ -0,0 +1,111 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: DicomSeries.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: include file for implementation of the DicomSeries functionality. Parallel ingestion of an
+//          uncompressed DICOM series (one file per slice) into the volume buffer.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+#include "VolumeResource.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    // header fields of one DICOM slice file needed to assemble the volume
+    struct DicomSliceHeader
+    {
+        std::string fileName;
+        std::string seriesInstanceUID;
+        UINT        rows = 0;
+        UINT        columns = 0;
+        UINT        samplesPerPixel = 1;
+        UINT        bitsAllocated = 0;
+        UINT        bitsStored = 0;
+        UINT        highBit = 0;
+        UINT        pixelRepresentation = 0;                        // 0 = unsigned, 1 = two's complement
+        double      rescaleSlope = 1.0;                             // modality value = slope * stored value + intercept
+        double      rescaleIntercept = 0.0;
+        double      pixelSpacing[2] = { 1.0, 1.0 };                 // distance between rows, between columns (mm)
+        double      sliceThickness = 0.0;
+        double      imagePosition[3] = { 0.0, 0.0, 0.0 };           // patient position of the first voxel (mm)
+        double      imageOrientation[6] = { 1.0, 0.0, 0.0, 0.0, 1.0, 0.0 }; // row and column direction cosines
+        bool        hasImagePosition = false;
+        UINT64      pixelDataOffset = 0;                            // file offset of the pixel data value
+        UINT64      pixelDataLength = 0;
+        double      slicePosition = 0.0;                            // image position along the slice normal (sort key)
+    };
+
+    class DicomSeries
+    {
+    public:
+        // constructor / desctructor
+        DicomSeries();
+        virtual ~DicomSeries();
+
+        // avoid usage of copy constructor and =operator ...
+        DicomSeries(DicomSeries const&) = delete;
+        DicomSeries& operator= (DicomSeries const&) = delete;
+
+        // load the DICOM series in the given directory (one uncompressed little endian file per slice) : the headers
+        // are parsed in parallel, the slices sorted by image position and checked for consistency (one series, equal
+        // geometry and pixel format, uniform slice distance), then a thread pool decodes the pixel data straight into
+        // the volume buffer
+        bool Load(const char* directory);
+        // write the given raw dataset as a synthetic DICOM series into the given (existing or new) directory - test
+        // input for Load(); the files are numbered in reverse slice order, so the loader has to sort them
+        static bool Export(const VolumeDatasetInfo& datasetInfo, const char* directory);
+        // release the volume data
+        void Release();
+
+        // get the dataset info of the loaded series (file name = directory, voxel spacing from the headers)
+        const VolumeDatasetInfo& GetDatasetInfo() const;
+        // get the volume data in the raw file layout of the dataset info (unsigned voxels of bits stored, little-endian
+        // 16 bit words for more than 8 bits) - see VolumeResource::CreateFromMemory()
+        const std::vector<char>& GetVolumeData() const;
+
+        // parse the header of a DICOM file up to its pixel data (false : no DICOM file, no pixel data or not supported)
+        static bool ParseHeader(const std::string& fileName, DicomSliceHeader& header);
+        // sort the slices by image position, check their consistency and derive the dimensions, bits stored and voxel
+        // spacing of the dataset info (the file name is left unchanged)
+        static bool SortAndCheckSlices(std::vector<DicomSliceHeader>& slices, VolumeDatasetInfo& datasetInfo);
+
+    private:
+
+        // read the pixel data of all slices into the volume buffer (unsigned, bits stored at the bottom of the word) -
+        // slices with a rescale of their own are mapped to the modality value range of the series
+        bool decodeSlices();
+        // run work(index) for every index in [0, count) on a pool of hardware threads - every thread takes the next
+        // index when done (files differ in size and cache state); false if any work item failed
+        static bool parallelFor(size_t count, const std::function<bool(size_t)>& work);
+
+        // ------------------------------------------------------------------------------------------------------------
+
+        // maximum deviation of a slice distance from the mean distance (relative) and of direction cosines / pixel
+        // spacings between the slices (absolute)
+        static const double SLICE_DISTANCE_TOLERANCE;
+        static const double GEOMETRY_TOLERANCE;
+
+        std::string                     directory_;
+        std::vector<DicomSliceHeader>   slices_;
+        std::vector<char>               volumeData_;
+        VolumeDatasetInfo               datasetInfo_ = { nullptr, 0, 0, 0, 8, { 1.0f, 1.0f, 1.0f } };
+    };
+}
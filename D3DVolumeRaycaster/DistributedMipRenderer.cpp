@@ -0,0 +1,543 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: DistributedMipRenderer.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of the DistributedMipRenderer functionality. The compositor process
+//          launches one worker process per volume slab; the workers combine their partial MIP images
+//          by a tree reduction over their sockets with per-pixel max (MIP compositing is order
+//          independent) - only the final image reaches the compositor.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#include "stdafx.h"
+#include "DistributedMipRenderer.h"
+
+using namespace std;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    DistributedMipRenderer::DistributedMipRenderer()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    DistributedMipRenderer::~DistributedMipRenderer()
+    {
+        Shutdown();
+    }
+
+
+    //------------------------------------------------------------------------------------------------------
+    // Launch the worker processes and wait for their connections. Once all workers are connected, every
+    // worker is told where to send its reduced image (its parent in the reduction tree or the compositor).
+    //------------------------------------------------------------------------------------------------------
+    bool DistributedMipRenderer::Start(UINT workerCount)
+    {
+        if (0 == workerCount || workerCount > MAX_WORKERS)
+        {
+            return false;
+        }
+
+        socketsInitialized_ = SocketChannel::InitializeSockets();
+        if (!socketsInitialized_)
+        {
+            return false;
+        }
+
+        // listen on an ephemeral loopback port - the port is passed to the workers on their command line
+        if (!listenChannel_.Listen(0))
+        {
+            return false;
+        }
+        const UINT16 compositorPort = listenChannel_.GetLocalPort();
+
+        for (UINT workerIndex = 0; workerIndex < workerCount; workerIndex++)
+        {
+            if (!launchWorker(compositorPort, workerIndex, workerCount))
+            {
+                return false;
+            }
+        }
+
+        vector<UINT32> peerPorts;
+        if (!acceptWorkers(workerCount, peerPorts))
+        {
+            return false;
+        }
+        listenChannel_.Close();
+
+        for (UINT workerIndex = 0; workerIndex < workerCount; workerIndex++)
+        {
+            DistributedWorkerSetup setup;
+            setup.parentPort = (0 == workerIndex) ? 0 : peerPorts[GetReductionParent(workerIndex)];
+            if (!workerChannels_[workerIndex]->SendAll(&setup, sizeof(setup)))
+            {
+                return false;
+            }
+        }
+        pDecoder_ = make_unique<FrameDecoder>();
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Accept the worker connections - every worker introduces itself with its index and the port of its
+    // reduction children. Fails if not all workers are connected within CONNECT_TIMEOUT_MSEC or a worker 
+    // process exits before (e.g. it failed to start).
+    //------------------------------------------------------------------------------------------------------
+    bool DistributedMipRenderer::acceptWorkers(UINT workerCount, vector<UINT32>& peerPorts)
+    {
+        workerChannels_.resize(workerCount);
+        peerPorts.assign(workerCount, 0);
+
+        const chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::milliseconds(CONNECT_TIMEOUT_MSEC);
+        for (UINT connectionIdx = 0; connectionIdx < workerCount; connectionIdx++)
+        {
+            while (!listenChannel_.WaitReadable(CONNECT_POLL_MSEC))
+            {
+                if (hasWorkerExited() || chrono::steady_clock::now() > deadline)
+                {
+                    return false;
+                }
+            }
+            unique_ptr<SocketChannel> pChannel = make_unique<SocketChannel>();
+            if (!listenChannel_.Accept(*pChannel))
+            {
+                return false;
+            }
+            DistributedWorkerHello hello;
+            if (!pChannel->ReceiveAll(&hello, sizeof(hello)) || hello.workerIndex >= workerCount || workerChannels_[hello.workerIndex])
+            {
+                return false;
+            }
+            peerPorts[hello.workerIndex] = hello.peerPort;
+            workerChannels_[hello.workerIndex] = move(pChannel);
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Check if one of the launched worker processes has terminated
+    //------------------------------------------------------------------------------------------------------
+    bool DistributedMipRenderer::hasWorkerExited() const
+    {
+        for (const auto& processInfo : workerProcesses_)
+        {
+            if (WAIT_OBJECT_0 == WaitForSingleObject(processInfo.hProcess, 0))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Launch a worker process (same executable, worker mode selected by command line)
+    //------------------------------------------------------------------------------------------------------
+    bool DistributedMipRenderer::launchWorker(UINT16 compositorPort, UINT workerIndex, UINT workerCount)
+    {
+        WCHAR exePath[MAX_PATH] = { 0 };
+        if (0 == GetModuleFileNameW(nullptr, exePath, MAX_PATH))
+        {
+            return false;
+        }
+
+        WCHAR commandLine[2 * MAX_PATH] = { 0 };
+        swprintf_s(commandLine, L"\"%s\" --mip-worker %u %u %u", exePath, compositorPort, workerIndex, workerCount);
+
+        STARTUPINFOW startupInfo;
+        ZeroMemory(&startupInfo, sizeof(startupInfo));
+        startupInfo.cb = sizeof(startupInfo);
+
+        PROCESS_INFORMATION processInfo;
+        ZeroMemory(&processInfo, sizeof(processInfo));
+
+        if (!CreateProcessW(nullptr, commandLine, nullptr, nullptr, FALSE, CREATE_NO_WINDOW, nullptr, nullptr, &startupInfo, &processInfo))
+        {
+            return false;
+        }
+        CloseHandle(processInfo.hThread);
+        processInfo.hThread = nullptr;
+        workerProcesses_.push_back(processInfo);
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Send shutdown request to all worker processes and wait for their termination
+    //------------------------------------------------------------------------------------------------------
+    void DistributedMipRenderer::Shutdown()
+    {
+        DistributedFrameRequest request = { 0 };
+        request.shutdown = 1;
+        for (auto& pChannel : workerChannels_)
+        {
+            if (pChannel && pChannel->IsOpen())
+            {
+                pChannel->SendAll(&request, sizeof(request));
+                pChannel->Close();
+            }
+        }
+        workerChannels_.clear();
+        listenChannel_.Close();
+
+        for (auto& processInfo : workerProcesses_)
+        {
+            if (WAIT_OBJECT_0 != WaitForSingleObject(processInfo.hProcess, 5000))
+            {
+                // worker does not respond - kill it
+                TerminateProcess(processInfo.hProcess, 1);
+            }
+            CloseHandle(processInfo.hProcess);
+        }
+        workerProcesses_.clear();
+        encodedImage_.clear();
+        pDecoder_.reset();
+
+        if (socketsInitialized_)
+        {
+            SocketChannel::ShutdownSockets();
+            socketsInitialized_ = false;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Distribute the frame request and receive the composited MIP image. The partial images are reduced
+    // by the workers themselves (see RunWorker) - worker 0 sends the final image.
+    //------------------------------------------------------------------------------------------------------
+    bool DistributedMipRenderer::RenderFrame(DistributedFrameRequest& request, std::vector<BYTE>& compositeImage)
+    {
+        if (workerChannels_.empty())
+        {
+            return false;
+        }
+
+        request.frameId = ++frameId_;
+        request.shutdown = 0;
+        for (auto& pChannel : workerChannels_)
+        {
+            if (!pChannel->SendAll(&request, sizeof(request)))
+            {
+                return false;
+            }
+        }
+
+        DistributedFrameHeader header;
+        if (!receiveEncodedImage(*workerChannels_[0], request.frameId, header, encodedImage_) || 0 != header.workerIndex)
+        {
+            return false;
+        }
+        chrono::steady_clock::time_point decodeStart = chrono::steady_clock::now();
+        const size_t imageSize = static_cast<size_t>(request.canvasWidth) * request.canvasHeight;
+        if (!pDecoder_->Decode(encodedImage_.data(), encodedImage_.size()) || pDecoder_->GetFrame().size() != imageSize)
+        {
+            return false;
+        }
+        compositeImage = pDecoder_->GetFrame();
+
+        maxWorkerRenderTimeMSec_ = header.renderTimeMSec;
+        compositeTimeMSec_ = header.compositeTimeMSec + chrono::duration<float, milli>(chrono::steady_clock::now() - decodeStart).count();
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Receive the header and the encoded (reduced) image of the given frame from a worker
+    //------------------------------------------------------------------------------------------------------
+    bool DistributedMipRenderer::receiveEncodedImage(SocketChannel& channel, UINT32 frameId, DistributedFrameHeader& header, vector<BYTE>& encodedImage)
+    {
+        if (!channel.ReceiveAll(&header, sizeof(header)) || header.frameId != frameId)
+        {
+            return false;
+        }
+        // partial images are delta / run-length encoded - most of a slab's image is black or unchanged
+        encodedImage.resize(header.encodedSize);
+        return channel.ReceiveAll(encodedImage.data(), encodedImage.size());
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Reduction tree : parent of a worker (the worker index with its lowest set bit cleared)
+    //------------------------------------------------------------------------------------------------------
+    UINT DistributedMipRenderer::GetReductionParent(UINT workerIndex)
+    {
+        return workerIndex & (workerIndex - 1);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Reduction tree : children of a worker in the order their images are composited (stride 1, 2, 4, ...).
+    // ceil(log2(N)) rounds; the pairs of a round are composited concurrently by different workers.
+    //------------------------------------------------------------------------------------------------------
+    void DistributedMipRenderer::GetReductionChildren(UINT workerIndex, UINT workerCount, vector<UINT>& children)
+    {
+        children.clear();
+        for (UINT stride = 1; stride < workerCount && 0 == (workerIndex & stride); stride *= 2)
+        {
+            if (workerIndex + stride < workerCount)
+            {
+                children.push_back(workerIndex + stride);
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Worker : connect to the parent in the reduction tree (if any) and accept the connections of the
+    // children - every child introduces itself with its index
+    //------------------------------------------------------------------------------------------------------
+    bool DistributedMipRenderer::connectReductionTree(
+        UINT workerIndex, 
+        const vector<UINT>& children, 
+        UINT32 parentPort, 
+        SocketChannel& peerListenChannel, 
+        SocketChannel& parentChannel, 
+        vector<unique_ptr<SocketChannel>>& childChannels)
+    {
+        if (0 != parentPort)
+        {
+            UINT32 workerId = workerIndex;
+            if (!parentChannel.Connect("127.0.0.1", static_cast<UINT16>(parentPort)) || !parentChannel.SendAll(&workerId, sizeof(workerId)))
+            {
+                return false;
+            }
+        }
+
+        childChannels.clear();
+        childChannels.resize(children.size());
+        const chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::milliseconds(CONNECT_TIMEOUT_MSEC);
+        for (size_t connectionIdx = 0; connectionIdx < children.size(); connectionIdx++)
+        {
+            while (!peerListenChannel.WaitReadable(CONNECT_POLL_MSEC))
+            {
+                if (chrono::steady_clock::now() > deadline)
+                {
+                    return false;
+                }
+            }
+            unique_ptr<SocketChannel> pChannel = make_unique<SocketChannel>();
+            UINT32 childIndex = 0;
+            if (!peerListenChannel.Accept(*pChannel) || !pChannel->ReceiveAll(&childIndex, sizeof(childIndex)))
+            {
+                return false;
+            }
+            auto child = find(children.begin(), children.end(), childIndex);
+            if (child == children.end() || childChannels[child - children.begin()])
+            {
+                return false;
+            }
+            childChannels[child - children.begin()] = move(pChannel);
+        }
+        peerListenChannel.Close();
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Per-pixel max of two gray images (pDst = max(pDst, pSrc)) - 16 pixels per SSE2 instruction
+    //------------------------------------------------------------------------------------------------------
+    void DistributedMipRenderer::MaxComposite(BYTE* pDst, const BYTE* pSrc, size_t pixelCount)
+    {
+        size_t idx = 0;
+        for (; idx + 16 <= pixelCount; idx += 16)
+        {
+            __m128i dst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pDst + idx));
+            __m128i src = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + idx));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + idx), _mm_max_epu8(dst, src));
+        }
+        for (; idx < pixelCount; idx++)
+        {
+            pDst[idx] = max(pDst[idx], pSrc[idx]);
+        }
+    }
+
+    UINT DistributedMipRenderer::GetWorkerCount() const
+    {
+        return static_cast<UINT>(workerChannels_.size());
+    }
+
+    float DistributedMipRenderer::GetMaxWorkerRenderTimeMSec() const
+    {
+        return maxWorkerRenderTimeMSec_;
+    }
+
+    float DistributedMipRenderer::GetCompositeTimeMSec() const
+    {
+        return compositeTimeMSec_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Worker process entry : connect to the compositor and render the assigned slab on request.
+    // The worker only loads slices [index * S / count, (index + 1) * S / count) of the requested dataset.
+    // Its partial image is max-composited with the (reduced) images of its children in the reduction tree 
+    // and sent on to its parent - worker 0 sends the final image to the compositor.
+    //------------------------------------------------------------------------------------------------------
+    int DistributedMipRenderer::RunWorker(UINT16 compositorPort, UINT workerIndex, UINT workerCount)
+    {
+        if (0 == workerCount || workerIndex >= workerCount || !SocketChannel::InitializeSockets())
+        {
+            return 1;
+        }
+
+        int exitCode = 1;
+        {
+            SocketChannel channel;
+            SocketChannel peerListenChannel;
+            SocketChannel parentChannel;
+            vector<unique_ptr<SocketChannel>> childChannels;
+            RayCastRenderer renderer;
+
+            vector<UINT> children;
+            GetReductionChildren(workerIndex, workerCount, children);
+
+            DistributedWorkerHello hello;
+            hello.workerIndex = workerIndex;
+            hello.peerPort = 0;
+            bool connected = channel.Connect("127.0.0.1", compositorPort);
+            if (connected && !children.empty())
+            {
+                // the children connect once the compositor has told them the port
+                connected = peerListenChannel.Listen(0);
+                hello.peerPort = peerListenChannel.GetLocalPort();
+            }
+
+            DistributedWorkerSetup setup;
+            if (connected && 
+                channel.SendAll(&hello, sizeof(hello)) && 
+                renderer.InitializeOffscreen(64, 64) && 
+                channel.ReceiveAll(&setup, sizeof(setup)) && 
+                connectReductionTree(workerIndex, children, setup.parentPort, peerListenChannel, parentChannel, childChannels))
+            {
+                // the reduced image goes to the parent or (worker 0) to the compositor
+                SocketChannel& outputChannel = (0 != setup.parentPort) ? parentChannel : channel;
+
+                UINT32 loadedDataset = ~0u;
+                bool emptySlab = false;
+                vector<BYTE> partialImage;
+                vector<BYTE> encodedImage;
+                FrameEncoder encoder;
+                vector<unique_ptr<FrameDecoder>> childDecoders;
+                for (size_t childIdx = 0; childIdx < children.size(); childIdx++)
+                {
+                    childDecoders.push_back(make_unique<FrameDecoder>());
+                }
+                DistributedFrameRequest request;
+
+                while (channel.ReceiveAll(&request, sizeof(request)))
+                {
+                    if (request.shutdown)
+                    {
+                        exitCode = 0;
+                        break;
+                    }
+
+                    chrono::steady_clock::time_point renderStart = chrono::steady_clock::now();
+
+                    if (request.volumeDataset > static_cast<UINT32>(VOLUME_DATASET::MR_HEAD_TOF))
+                    {
+                        char charBuffer[128] = { 0 };
+                        sprintf_s(charBuffer, sizeof(charBuffer), "distributed worker %u : invalid dataset %u requested\n", workerIndex, request.volumeDataset);
+                        OutputDebugStringA(charBuffer);
+                        break;
+                    }
+                    if (request.volumeDataset != loadedDataset)
+                    {
+                        const VOLUME_DATASET volumeDataset = static_cast<VOLUME_DATASET>(request.volumeDataset);
+                        const UINT volSlices = GetVolumeDatasetInfo(volumeDataset).volSlices;
+                        const UINT sliceBegin = workerIndex * volSlices / workerCount;
+                        const UINT sliceEnd = (workerIndex + 1) * volSlices / workerCount;
+                        // an empty slab (more workers than slices) renders an empty image - the slab of the
+                        // previous dataset stays loaded but is not rendered
+                        emptySlab = (sliceBegin >= sliceEnd);
+                        if (!emptySlab && !renderer.LoadDatasetSlab(volumeDataset, sliceBegin, sliceEnd))
+                        {
+                            break;
+                        }
+                        loadedDataset = request.volumeDataset;
+                    }
+                    if (!renderer.ResizeOffscreen(request.canvasWidth, request.canvasHeight))
+                    {
+                        break;
+                    }
+                    renderer.SetCameraDistance(request.cameraDistance);
+                    renderer.SetRotation(request.quatRotation);
+                    renderer.SetRaycastParameters(request.raycastStepSize, request.raycastMaxSamples, request.raycastTraversal);
+
+                    if (emptySlab)
+                    {
+                        partialImage.assign(static_cast<size_t>(request.canvasWidth) * request.canvasHeight, static_cast<BYTE>(0));
+                    }
+                    else if (!renderer.RenderToImage(partialImage))
+                    {
+                        break;
+                    }
+
+                    DistributedFrameHeader header;
+                    header.frameId = request.frameId;
+                    header.workerIndex = workerIndex;
+                    header.width = request.canvasWidth;
+                    header.height = request.canvasHeight;
+                    header.renderTimeMSec = chrono::duration<float, milli>(chrono::steady_clock::now() - renderStart).count();
+                    header.compositeTimeMSec = 0.0f;
+
+                    // reduce the images of the children (stride 1, 2, 4, ...) into the partial image
+                    bool reduced = true;
+                    float childCompositeTimeMSec = 0.0f;
+                    for (size_t childIdx = 0; childIdx < children.size() && reduced; childIdx++)
+                    {
+                        DistributedFrameHeader childHeader;
+                        reduced = receiveEncodedImage(*childChannels[childIdx], request.frameId, childHeader, encodedImage) && childHeader.workerIndex == children[childIdx];
+                        if (reduced)
+                        {
+                            chrono::steady_clock::time_point compositeStart = chrono::steady_clock::now();
+                            FrameDecoder& decoder = *childDecoders[childIdx];
+                            reduced = decoder.Decode(encodedImage.data(), encodedImage.size()) && decoder.GetFrame().size() == partialImage.size();
+                            if (reduced)
+                            {
+                                MaxComposite(partialImage.data(), decoder.GetFrame().data(), partialImage.size());
+                            }
+                            header.compositeTimeMSec += chrono::duration<float, milli>(chrono::steady_clock::now() - compositeStart).count();
+                            header.renderTimeMSec = max(header.renderTimeMSec, childHeader.renderTimeMSec);
+                            childCompositeTimeMSec = max(childCompositeTimeMSec, childHeader.compositeTimeMSec);
+                        }
+                    }
+                    if (!reduced)
+                    {
+                        break;
+                    }
+                    header.compositeTimeMSec += childCompositeTimeMSec;
+
+                    encoder.Encode(partialImage.data(), request.canvasWidth, request.canvasHeight, encodedImage);
+                    header.encodedSize = static_cast<UINT32>(encodedImage.size());
+
+                    if (!outputChannel.SendAll(&header, sizeof(header)) || !outputChannel.SendAll(encodedImage.data(), encodedImage.size()))
+                    {
+                        break;
+                    }
+                }
+            }
+            renderer.Release();
+        }
+        SocketChannel::ShutdownSockets();
+
+        return exitCode;
+    }
+}
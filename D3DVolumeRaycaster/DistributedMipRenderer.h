@@ -0,0 +1,137 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: DistributedMipRenderer.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: include file for implementation of the DistributedMipRenderer functionality. Sort-last
+//          distributed MIP rendering across worker processes (one volume slab per worker), the partial
+//          images are reduced by the workers over their socket connections.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+#include "SocketChannel.h"
+#include "RayCastRenderer.h"
+#include "FrameCodec.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    // frame request sent by the compositor to every worker process
+    struct DistributedFrameRequest
+    {
+        UINT32  frameId;
+        UINT32  shutdown;               // != 0 : worker process shall terminate
+        UINT32  volumeDataset;          // VOLUME_DATASET to render
+        UINT32  canvasWidth;
+        UINT32  canvasHeight;
+        float   quatRotation[4];
+        float   cameraDistance;
+        float   raycastStepSize;
+        UINT32  raycastMaxSamples;
+        UINT32  raycastTraversal;
+    };
+
+    // sent by a worker process right after connecting to the compositor
+    struct DistributedWorkerHello
+    {
+        UINT32  workerIndex;
+        UINT32  peerPort;               // port the worker accepts the images of its reduction children on (0 = no children)
+    };
+
+    // sent by the compositor once all workers are connected : where a worker sends its reduced image to
+    struct DistributedWorkerSetup
+    {
+        UINT32  parentPort;             // port of the parent worker in the reduction tree (0 = send to the compositor)
+    };
+
+    // header of a (reduced) partial image sent to the parent worker or the compositor (followed by encodedSize bytes,
+    // see FrameEncoder)
+    struct DistributedFrameHeader
+    {
+        UINT32  frameId;
+        UINT32  workerIndex;
+        UINT32  width;
+        UINT32  height;
+        UINT32  encodedSize;
+        float   renderTimeMSec;         // slowest worker of the sub-tree
+        float   compositeTimeMSec;      // receive + decode + max-composite time along the slowest path of the sub-tree
+    };
+
+    class DistributedMipRenderer
+    {
+    public:
+        // constructor / desctructor
+        DistributedMipRenderer();
+        virtual ~DistributedMipRenderer();
+
+        // avoid usage of copy constructor and =operator ...
+        DistributedMipRenderer(DistributedMipRenderer const&) = delete;
+        DistributedMipRenderer& operator= (DistributedMipRenderer const&) = delete;
+
+        // launch the worker processes, wait for their connections (fails if a worker does not connect in time) and
+        // connect the workers to their reduction tree
+        bool Start(UINT workerCount);
+        // send shutdown request to all worker processes and wait for their termination
+        void Shutdown();
+        // distribute the frame request and receive the composited MIP image (reduced by the workers)
+        bool RenderFrame(DistributedFrameRequest& request, std::vector<BYTE>& compositeImage);
+
+        UINT GetWorkerCount() const;
+        float GetMaxWorkerRenderTimeMSec() const;
+        float GetCompositeTimeMSec() const;
+
+        // worker process entry : connect to the compositor and render the assigned slab on request; the partial image
+        // is max-composited with the images of the worker's reduction children and sent to its parent
+        static int RunWorker(UINT16 compositorPort, UINT workerIndex, UINT workerCount);
+        // per-pixel max of two gray images (pDst = max(pDst, pSrc))
+        static void MaxComposite(BYTE* pDst, const BYTE* pSrc, size_t pixelCount);
+        // reduction tree : in the round of stride s, worker i with i % 2s == s sends its image to worker i - s
+        static UINT GetReductionParent(UINT workerIndex);
+        static void GetReductionChildren(UINT workerIndex, UINT workerCount, std::vector<UINT>& children);
+
+    private:
+
+        bool launchWorker(UINT16 compositorPort, UINT workerIndex, UINT workerCount);
+        bool acceptWorkers(UINT workerCount, std::vector<UINT32>& peerPorts);
+        bool hasWorkerExited() const;
+        static bool receiveEncodedImage(SocketChannel& channel, UINT32 frameId, DistributedFrameHeader& header, std::vector<BYTE>& encodedImage);
+        static bool connectReductionTree(
+            UINT workerIndex, 
+            const std::vector<UINT>& children, 
+            UINT32 parentPort, 
+            SocketChannel& peerListenChannel, 
+            SocketChannel& parentChannel, 
+            std::vector<std::unique_ptr<SocketChannel>>& childChannels);
+
+        static const UINT MAX_WORKERS = 16;
+        static const DWORD CONNECT_TIMEOUT_MSEC = 10000;   // launch -> connection of all workers (and children to parents)
+        static const DWORD CONNECT_POLL_MSEC = 100;
+
+        SocketChannel                                   listenChannel_;
+        std::vector<std::unique_ptr<SocketChannel>>     workerChannels_;
+        std::vector<PROCESS_INFORMATION>                workerProcesses_;
+        std::vector<BYTE>                               encodedImage_;
+        std::unique_ptr<FrameDecoder>                   pDecoder_;          // delta reference of the image of worker 0
+        
+        UINT32  frameId_ = 0;
+        float   maxWorkerRenderTimeMSec_ = 0.0f;
+        float   compositeTimeMSec_ = 0.0f;
+        bool    socketsInitialized_ = false;
+    };
+}
@@ -0,0 +1,426 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: FrameCodec.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of the FrameEncoder / FrameDecoder functionality. Changed tiles are
+//          detected against the previous frame and their pixels are run-length encoded (SSE2).
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#include "stdafx.h"
+#include "FrameCodec.h"
+
+using namespace std;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    namespace
+    {
+        //------------------------------------------------------------------------------------------------------
+        // Length of the run of bytes equal to pData[0] (at most maxLength) - compares 16 bytes per step
+        //------------------------------------------------------------------------------------------------------
+        size_t measureRun(const BYTE* pData, size_t maxLength)
+        {
+            const BYTE value = pData[0];
+            const __m128i valueVec = _mm_set1_epi8(static_cast<char>(value));
+            size_t runLength = 1;
+            while (runLength + 16 <= maxLength)
+            {
+                __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + runLength));
+                int equalMask = _mm_movemask_epi8(_mm_cmpeq_epi8(data, valueVec));
+                if (0xFFFF != equalMask)
+                {
+                    unsigned long firstDifferent = 0;
+                    _BitScanForward(&firstDifferent, ~equalMask & 0xFFFF);
+                    return runLength + firstDifferent;
+                }
+                runLength += 16;
+            }
+            while (runLength < maxLength && pData[runLength] == value)
+            {
+                runLength++;
+            }
+            return runLength;
+        }
+
+        //------------------------------------------------------------------------------------------------------
+        // Offset of the first run of at least 3 equal bytes (maxLength if there is none) - 16 offsets per step
+        //------------------------------------------------------------------------------------------------------
+        size_t findRun(const BYTE* pData, size_t maxLength)
+        {
+            size_t offset = 0;
+            while (offset + 18 <= maxLength)
+            {
+                __m128i data0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + offset));
+                __m128i data1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + offset + 1));
+                __m128i data2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + offset + 2));
+                int runMask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(data0, data1), _mm_cmpeq_epi8(data0, data2)));
+                if (runMask)
+                {
+                    unsigned long firstRun = 0;
+                    _BitScanForward(&firstRun, runMask);
+                    return offset + firstRun;
+                }
+                offset += 16;
+            }
+            for (; offset + 2 < maxLength; offset++)
+            {
+                if (pData[offset] == pData[offset + 1] && pData[offset] == pData[offset + 2])
+                {
+                    return offset;
+                }
+            }
+            return maxLength;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Constructor
+    //------------------------------------------------------------------------------------------------------
+    FrameEncoder::FrameEncoder(UINT keyframeInterval)
+        : keyframeInterval_(keyframeInterval)
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    FrameEncoder::~FrameEncoder()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Encode a gray image as keyframe or as delta to the previous frame. A frame is a keyframe if it is
+    // the first one, the frame size has changed, a keyframe was forced or the keyframe interval is reached.
+    //------------------------------------------------------------------------------------------------------
+    void FrameEncoder::Encode(const BYTE* pImage, UINT width, UINT height, vector<BYTE>& encodedFrame)
+    {
+        chrono::steady_clock::time_point encodeStart = chrono::steady_clock::now();
+
+        const bool keyframe = forceKeyframe_ || width != width_ || height != height_ ||
+            (keyframeInterval_ > 0 && 0 == frameIndex_ % keyframeInterval_);
+
+        const UINT tileCountX = (width + TILE_SIZE - 1) / TILE_SIZE;
+        const UINT tileCountY = (height + TILE_SIZE - 1) / TILE_SIZE;
+        const UINT totalTiles = tileCountX * tileCountY;
+
+        width_ = width;
+        height_ = height;
+
+        // collect pixels of changed tiles
+        tilePixels_.clear();
+        tileMask_.assign((totalTiles + 7) / 8, 0);
+        UINT changedTiles = 0;
+        for (UINT tileY = 0; tileY < tileCountY; tileY++)
+        {
+            for (UINT tileX = 0; tileX < tileCountX; tileX++)
+            {
+                if (keyframe || isTileChanged(pImage, tileX, tileY))
+                {
+                    const UINT tileIndex = tileY * tileCountX + tileX;
+                    tileMask_[tileIndex >> 3] |= static_cast<BYTE>(1 << (tileIndex & 7));
+                    gatherTile(pImage, tileX, tileY);
+                    changedTiles++;
+                }
+            }
+        }
+
+        // header + tile mask (delta frames only) + run-length encoded tile pixels
+        encodedFrame.resize(sizeof(FrameCodecHeader));
+        if (!keyframe)
+        {
+            encodedFrame.insert(encodedFrame.end(), tileMask_.begin(), tileMask_.end());
+        }
+        const size_t pixelBlockOffset = encodedFrame.size();
+        EncodeRunLength(tilePixels_.data(), tilePixels_.size(), encodedFrame);
+
+        FrameCodecHeader header;
+        header.width = width;
+        header.height = height;
+        header.frameIndex = frameIndex_;
+        header.keyframe = keyframe ? 1 : 0;
+        header.changedTiles = changedTiles;
+        header.encodedPixelSize = static_cast<UINT32>(encodedFrame.size() - pixelBlockOffset);
+        memcpy(encodedFrame.data(), &header, sizeof(header));
+
+        // keep the frame as reference for the next delta frame
+        previousFrame_.assign(pImage, pImage + static_cast<size_t>(width) * height);
+        frameIndex_++;
+        forceKeyframe_ = false;
+
+        stats_.rawSize = previousFrame_.size();
+        stats_.encodedSize = encodedFrame.size();
+        stats_.changedTiles = changedTiles;
+        stats_.totalTiles = totalTiles;
+        stats_.keyframe = keyframe;
+        stats_.encodeTimeMSec = chrono::duration<float, milli>(chrono::steady_clock::now() - encodeStart).count();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Compare a tile against the previous frame
+    //------------------------------------------------------------------------------------------------------
+    bool FrameEncoder::isTileChanged(const BYTE* pImage, UINT tileX, UINT tileY) const
+    {
+        const UINT col = tileX * TILE_SIZE;
+        const UINT row = tileY * TILE_SIZE;
+        const UINT tileWidth = min(TILE_SIZE, width_ - col);
+        const UINT tileHeight = min(TILE_SIZE, height_ - row);
+
+        for (UINT tileRow = 0; tileRow < tileHeight; tileRow++)
+        {
+            const size_t offset = static_cast<size_t>(row + tileRow) * width_ + col;
+            const BYTE* pCurrent = pImage + offset;
+            const BYTE* pPrevious = previousFrame_.data() + offset;
+            if (TILE_SIZE == tileWidth)
+            {
+                __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pCurrent));
+                __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pPrevious));
+                if (0xFFFF != _mm_movemask_epi8(_mm_cmpeq_epi8(current, previous)))
+                {
+                    return true;
+                }
+            }
+            else if (0 != memcmp(pCurrent, pPrevious, tileWidth))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Append the pixels of a tile (row by row) to the tile pixel buffer
+    //------------------------------------------------------------------------------------------------------
+    void FrameEncoder::gatherTile(const BYTE* pImage, UINT tileX, UINT tileY)
+    {
+        const UINT col = tileX * TILE_SIZE;
+        const UINT row = tileY * TILE_SIZE;
+        const UINT tileWidth = min(TILE_SIZE, width_ - col);
+        const UINT tileHeight = min(TILE_SIZE, height_ - row);
+
+        for (UINT tileRow = 0; tileRow < tileHeight; tileRow++)
+        {
+            const BYTE* pRow = pImage + static_cast<size_t>(row + tileRow) * width_ + col;
+            tilePixels_.insert(tilePixels_.end(), pRow, pRow + tileWidth);
+        }
+    }
+
+    void FrameEncoder::ForceKeyframe()
+    {
+        forceKeyframe_ = true;
+    }
+
+    void FrameEncoder::SetKeyframeInterval(UINT keyframeInterval)
+    {
+        keyframeInterval_ = keyframeInterval;
+    }
+
+    const FrameCodecStats& FrameEncoder::GetLastStats() const
+    {
+        return stats_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Run-length encode a byte stream and append it to encodedData
+    //------------------------------------------------------------------------------------------------------
+    void FrameEncoder::EncodeRunLength(const BYTE* pData, size_t size, vector<BYTE>& encodedData)
+    {
+        size_t idx = 0;
+        while (idx < size)
+        {
+            const size_t runLength = measureRun(pData + idx, min(size - idx, static_cast<size_t>(130)));
+            if (runLength >= 3)
+            {
+                encodedData.push_back(static_cast<BYTE>(runLength + 125));
+                encodedData.push_back(pData[idx]);
+                idx += runLength;
+                continue;
+            }
+
+            // literal block up to the next run of at least 3 equal bytes
+            const size_t literalLength = min(findRun(pData + idx, min(size - idx, static_cast<size_t>(130))), static_cast<size_t>(128));
+            encodedData.push_back(static_cast<BYTE>(literalLength - 1));
+            encodedData.insert(encodedData.end(), pData + idx, pData + idx + literalLength);
+            idx += literalLength;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Decode a run-length encoded byte stream - the decoded size needs to match exactly
+    //------------------------------------------------------------------------------------------------------
+    bool FrameEncoder::DecodeRunLength(const BYTE* pEncodedData, size_t encodedSize, BYTE* pData, size_t size)
+    {
+        size_t srcIdx = 0;
+        size_t dstIdx = 0;
+        while (srcIdx < encodedSize)
+        {
+            const BYTE control = pEncodedData[srcIdx++];
+            if (control < 128)
+            {
+                const size_t literalLength = control + 1;
+                if (srcIdx + literalLength > encodedSize || dstIdx + literalLength > size) return false;
+                memcpy(pData + dstIdx, pEncodedData + srcIdx, literalLength);
+                srcIdx += literalLength;
+                dstIdx += literalLength;
+            }
+            else
+            {
+                const size_t runLength = control - 125;
+                if (srcIdx >= encodedSize || dstIdx + runLength > size) return false;
+                memset(pData + dstIdx, pEncodedData[srcIdx++], runLength);
+                dstIdx += runLength;
+            }
+        }
+        return dstIdx == size;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    FrameDecoder::FrameDecoder()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    FrameDecoder::~FrameDecoder()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Decode an encoded frame and update the current frame; delta frames need the preceding frame. A delta
+    // frame that does not directly follow the current frame (frames lost, sender restarted) would be 
+    // applied to a stale base - it fails and only a keyframe resynchronizes the decoder.
+    //------------------------------------------------------------------------------------------------------
+    bool FrameDecoder::Decode(const BYTE* pEncodedFrame, size_t encodedSize)
+    {
+        FrameCodecHeader header;
+        if (encodedSize < sizeof(header))
+        {
+            return false;
+        }
+        memcpy(&header, pEncodedFrame, sizeof(header));
+        if (0 == header.width || 0 == header.height || header.width > MAX_FRAME_SIZE || header.height > MAX_FRAME_SIZE)
+        {
+            // corrupt stream
+            hasFrame_ = false;
+            return false;
+        }
+
+        const bool keyframe = (0 != header.keyframe);
+        if (!keyframe && (!hasFrame_ || header.width != width_ || header.height != height_ || header.frameIndex != frameIndex_ + 1))
+        {
+            // delta frame without matching reference frame
+            hasFrame_ = false;
+            return false;
+        }
+
+        const UINT tileSize = FrameEncoder::TILE_SIZE;
+        const UINT tileCountX = (header.width + tileSize - 1) / tileSize;
+        const UINT tileCountY = (header.height + tileSize - 1) / tileSize;
+        const size_t maskSize = keyframe ? 0 : (static_cast<size_t>(tileCountX) * tileCountY + 7) / 8;
+        if (encodedSize < sizeof(header) + maskSize + header.encodedPixelSize)
+        {
+            hasFrame_ = false;
+            return false;
+        }
+        const BYTE* pTileMask = pEncodedFrame + sizeof(header);
+        const BYTE* pPixelBlock = pTileMask + maskSize;
+
+        auto isTileChanged = [&](UINT tileIndex) { return keyframe || 0 != (pTileMask[tileIndex >> 3] & (1 << (tileIndex & 7))); };
+
+        // decode the pixels of all changed tiles
+        size_t tilePixelCount = 0;
+        for (UINT tileY = 0; tileY < tileCountY; tileY++)
+        {
+            for (UINT tileX = 0; tileX < tileCountX; tileX++)
+            {
+                if (isTileChanged(tileY * tileCountX + tileX))
+                {
+                    tilePixelCount += min(tileSize, header.width - tileX * tileSize) * min(tileSize, header.height - tileY * tileSize);
+                }
+            }
+        }
+        // a control byte expands to at most 130 pixels
+        if (tilePixelCount > static_cast<size_t>(header.encodedPixelSize) * 130)
+        {
+            hasFrame_ = false;
+            return false;
+        }
+        tilePixels_.resize(tilePixelCount);
+        if (!FrameEncoder::DecodeRunLength(pPixelBlock, header.encodedPixelSize, tilePixels_.data(), tilePixelCount))
+        {
+            hasFrame_ = false;
+            return false;
+        }
+
+        if (keyframe)
+        {
+            width_ = header.width;
+            height_ = header.height;
+            frame_.resize(static_cast<size_t>(width_) * height_);
+        }
+
+        // scatter the changed tiles into the current frame
+        const BYTE* pTilePixels = tilePixels_.data();
+        for (UINT tileY = 0; tileY < tileCountY; tileY++)
+        {
+            for (UINT tileX = 0; tileX < tileCountX; tileX++)
+            {
+                if (!isTileChanged(tileY * tileCountX + tileX))
+                {
+                    continue;
+                }
+                const UINT col = tileX * tileSize;
+                const UINT row = tileY * tileSize;
+                const UINT tileWidth = min(tileSize, width_ - col);
+                const UINT tileHeight = min(tileSize, height_ - row);
+                for (UINT tileRow = 0; tileRow < tileHeight; tileRow++)
+                {
+                    memcpy(frame_.data() + static_cast<size_t>(row + tileRow) * width_ + col, pTilePixels, tileWidth);
+                    pTilePixels += tileWidth;
+                }
+            }
+        }
+        frameIndex_ = header.frameIndex;
+        hasFrame_ = true;
+
+        return true;
+    }
+
+    bool FrameDecoder::NeedsKeyframe() const
+    {
+        return !hasFrame_;
+    }
+
+    const vector<BYTE>& FrameDecoder::GetFrame() const
+    {
+        return frame_;
+    }
+
+    UINT FrameDecoder::GetWidth() const
+    {
+        return width_;
+    }
+
+    UINT FrameDecoder::GetHeight() const
+    {
+        return height_;
+    }
+}
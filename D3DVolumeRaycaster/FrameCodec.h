@@ -0,0 +1,134 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: FrameCodec.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: include file for implementation of the FrameEncoder / FrameDecoder functionality.
+//          Delta and run-length codec for gray MIP frames (tile change detection + keyframes).
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    // header of an encoded frame; followed by the changed-tile bit mask (delta frames only) and the
+    // run-length encoded pixels of all changed tiles (tile by tile, row by row within a tile)
+    struct FrameCodecHeader
+    {
+        UINT32  width;
+        UINT32  height;
+        UINT32  frameIndex;
+        UINT32  keyframe;               // != 0 : all tiles are encoded, no previous frame needed
+        UINT32  changedTiles;
+        UINT32  encodedPixelSize;       // size of the run-length encoded pixel block in bytes
+    };
+
+    // statistics of the last encoded frame
+    struct FrameCodecStats
+    {
+        size_t  rawSize = 0;
+        size_t  encodedSize = 0;
+        UINT    changedTiles = 0;
+        UINT    totalTiles = 0;
+        bool    keyframe = false;
+        float   encodeTimeMSec = 0.0f;
+    };
+
+    class FrameEncoder
+    {
+    public:
+        // edge length of a change detection tile in pixels
+        static const UINT TILE_SIZE = 16;
+
+        // constructor / desctructor
+        FrameEncoder(UINT keyframeInterval = 30);
+        virtual ~FrameEncoder();
+
+        // avoid usage of copy constructor and =operator ...
+        FrameEncoder(FrameEncoder const&) = delete;
+        FrameEncoder& operator= (FrameEncoder const&) = delete;
+
+        // encode a gray image (one byte per pixel, row-major) as keyframe or delta to the previous frame
+        void Encode(const BYTE* pImage, UINT width, UINT height, std::vector<BYTE>& encodedFrame);
+        // encode the next frame as keyframe (e.g. a new consumer has attached)
+        void ForceKeyframe();
+        // set the keyframe interval in frames (0 = only the first frame is a keyframe)
+        void SetKeyframeInterval(UINT keyframeInterval);
+        // get statistics of the last encoded frame
+        const FrameCodecStats& GetLastStats() const;
+
+        // run-length encode / decode a byte stream : control byte n < 128 -> n + 1 literal bytes follow,
+        // n >= 128 -> the next byte is repeated n - 125 times (3..130)
+        static void EncodeRunLength(const BYTE* pData, size_t size, std::vector<BYTE>& encodedData);
+        static bool DecodeRunLength(const BYTE* pEncodedData, size_t encodedSize, BYTE* pData, size_t size);
+
+    private:
+
+        // compare a tile against the previous frame
+        bool isTileChanged(const BYTE* pImage, UINT tileX, UINT tileY) const;
+        // append the pixels of a tile to the tile pixel buffer
+        void gatherTile(const BYTE* pImage, UINT tileX, UINT tileY);
+
+        std::vector<BYTE>   previousFrame_;
+        std::vector<BYTE>   tilePixels_;            // pixels of all changed tiles (scratch buffer)
+        std::vector<BYTE>   tileMask_;              // changed-tile bit mask (scratch buffer)
+        UINT                width_ = 0;
+        UINT                height_ = 0;
+        UINT                frameIndex_ = 0;
+        UINT                keyframeInterval_ = 30;
+        bool                forceKeyframe_ = true;
+        FrameCodecStats     stats_;
+    };
+
+    class FrameDecoder
+    {
+    public:
+        // largest frame edge length accepted from a stream (largest render target)
+        static const UINT MAX_FRAME_SIZE = D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION;
+
+        // constructor / desctructor
+        FrameDecoder();
+        virtual ~FrameDecoder();
+
+        // avoid usage of copy constructor and =operator ...
+        FrameDecoder(FrameDecoder const&) = delete;
+        FrameDecoder& operator= (FrameDecoder const&) = delete;
+
+        // decode an encoded frame and update the current frame; delta frames need the preceding frame (a delta frame
+        // that does not follow the current frame fails and the decoder waits for the next keyframe); frames larger
+        // than MAX_FRAME_SIZE and pixel blocks that cannot hold the frame are rejected before any allocation
+        bool Decode(const BYTE* pEncodedFrame, size_t encodedSize);
+        // check if the decoder has no valid reference frame - the sender shall be asked for a keyframe
+        bool NeedsKeyframe() const;
+        // get the current (decoded) frame
+        const std::vector<BYTE>& GetFrame() const;
+        UINT GetWidth() const;
+        UINT GetHeight() const;
+
+    private:
+
+        std::vector<BYTE>   frame_;
+        std::vector<BYTE>   tilePixels_;            // decoded pixels of all changed tiles (scratch buffer)
+        UINT                width_ = 0;
+        UINT                height_ = 0;
+        UINT                frameIndex_ = 0;        // frame index of the current frame
+        bool                hasFrame_ = false;
+    };
+}
@@ -0,0 +1,157 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: FramePacer.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of FramePacer functionality.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#include "stdafx.h"
+#include "FramePacer.h"
+
+using namespace std::chrono;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    const microseconds FramePacer::SPIN_MARGIN = microseconds(1500);
+
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    FramePacer::FramePacer()
+        : period_(duration_cast<steady_clock::duration>(duration<double>(1.0 / 60)))
+    {
+        // high resolution timers wake up within ~0.5 ms (Windows 10 1803+); fall back to a standard timer
+        hWaitableTimer_ = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (nullptr == hWaitableTimer_)
+        {
+            hWaitableTimer_ = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    FramePacer::~FramePacer()
+    {
+        if (nullptr != hWaitableTimer_)
+        {
+            CloseHandle(hWaitableTimer_);
+            hWaitableTimer_ = nullptr;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Set the target frame rate
+    //------------------------------------------------------------------------------------------------------
+    void FramePacer::SetTargetFPS(UINT targetFPS)
+    {
+        const steady_clock::duration period = duration_cast<steady_clock::duration>(duration<double>(1.0 / max(targetFPS, 1u)));
+        if (period != period_)
+        {
+            period_ = period;
+            scheduleStarted_ = false;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Wait until the deadline of the next frame. Deadlines are start + k * period (the schedule never
+    // accumulates the wake up latency of individual frames); a missed deadline moves the schedule by
+    // whole periods, so the frame phase is kept.
+    //------------------------------------------------------------------------------------------------------
+    bool FramePacer::WaitForNextFrame()
+    {
+        steady_clock::time_point now = steady_clock::now();
+        if (!scheduleStarted_)
+        {
+            // the first frame starts the schedule
+            nextDeadline_ = now;
+            scheduleStarted_ = true;
+        }
+
+        bool deadlineMet = true;
+        if (now > nextDeadline_ + SPIN_MARGIN)
+        {
+            // too late - deliver immediately and continue with the next deadline of the schedule
+            deadlineMet = false;
+            missedDeadlines_++;
+            lastDeviationMSec_ = duration<double, std::milli>(now - nextDeadline_).count();
+            const auto missedPeriods = (now - nextDeadline_) / period_;
+            nextDeadline_ += (missedPeriods + 1) * period_;
+        }
+        else
+        {
+            waitUntil(nextDeadline_);
+            lastDeviationMSec_ = duration<double, std::milli>(steady_clock::now() - nextDeadline_).count();
+            nextDeadline_ += period_;
+        }
+
+        frameCount_++;
+        return deadlineMet;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Wait until the given time point : coarse timer wait up to SPIN_MARGIN before, then spin
+    //------------------------------------------------------------------------------------------------------
+    void FramePacer::waitUntil(steady_clock::time_point deadline)
+    {
+        steady_clock::duration remaining = deadline - steady_clock::now();
+        if (nullptr != hWaitableTimer_ && remaining > SPIN_MARGIN)
+        {
+            // relative due time in 100 ns units (negative value)
+            LARGE_INTEGER dueTime;
+            dueTime.QuadPart = -static_cast<LONGLONG>(duration_cast<nanoseconds>(remaining - SPIN_MARGIN).count() / 100);
+            if (SetWaitableTimer(hWaitableTimer_, &dueTime, 0, nullptr, nullptr, FALSE))
+            {
+                WaitForSingleObject(hWaitableTimer_, INFINITE);
+            }
+        }
+
+        while (steady_clock::now() < deadline)
+        {
+            _mm_pause();
+        }
+    }
+
+    void FramePacer::Reset()
+    {
+        scheduleStarted_ = false;
+    }
+
+    UINT64 FramePacer::GetFrameCount() const
+    {
+        return frameCount_;
+    }
+
+    UINT64 FramePacer::GetMissedDeadlines() const
+    {
+        return missedDeadlines_;
+    }
+
+    double FramePacer::GetLastDeviationMSec() const
+    {
+        return lastDeviationMSec_;
+    }
+
+    void FramePacer::ResetStatistics()
+    {
+        frameCount_ = 0;
+        missedDeadlines_ = 0;
+        lastDeviationMSec_ = 0.0;
+    }
+}
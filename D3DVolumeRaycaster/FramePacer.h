@@ -0,0 +1,76 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: FramePacer.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: deadline based frame pacer - drift-free frame schedule on steady_clock deadlines
+//          with a coarse timer wait and a short spin, reports missed deadlines.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    class FramePacer
+    {
+    public:
+        // constructor / desctructor
+        FramePacer();
+        virtual ~FramePacer();
+
+        // avoid usage of copy constructor and =operator ...
+        FramePacer(FramePacer const&) = delete;
+        FramePacer& operator= (FramePacer const&) = delete;
+
+        // set the target frame rate - the schedule restarts with the next frame if the period changes
+        void SetTargetFPS(UINT targetFPS);
+        // wait until the deadline of the next frame; returns false if the deadline was already missed
+        // (the frame is delivered immediately and the schedule skips the missed periods)
+        bool WaitForNextFrame();
+        // restart the schedule with the next frame (e.g. after the pacing was switched off)
+        void Reset();
+
+        // get the number of paced frames and of missed deadlines since the last reset of the statistics
+        UINT64 GetFrameCount() const;
+        UINT64 GetMissedDeadlines() const;
+        // get the deviation of the last frame from its deadline in ms (positive : late)
+        double GetLastDeviationMSec() const;
+        // reset frame count and missed deadlines
+        void ResetStatistics();
+
+    private:
+
+        // wait until the given time point : coarse timer wait up to SPIN_MARGIN before, then spin
+        void waitUntil(std::chrono::steady_clock::time_point deadline);
+
+        // ------------------------------------------------------------------------------------------------------------
+
+        // the final part of the wait is spun - timer waits wake up late by up to the timer resolution
+        static const std::chrono::microseconds SPIN_MARGIN;
+
+        HANDLE                                  hWaitableTimer_ = nullptr;
+        std::chrono::steady_clock::duration     period_;
+        std::chrono::steady_clock::time_point   nextDeadline_;
+        bool                                    scheduleStarted_ = false;
+        UINT64                                  frameCount_ = 0;
+        UINT64                                  missedDeadlines_ = 0;
+        double                                  lastDeviationMSec_ = 0.0;
+    };
+}
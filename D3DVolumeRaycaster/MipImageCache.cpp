@@ -0,0 +1,374 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: MipImageCache.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of the MipImageCache functionality.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#include "stdafx.h"
+#include "MipImageCache.h"
+#include "RayCastRenderer.h"
+
+using namespace DirectX;
+using namespace std;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    //------------------------------------------------------------------------------------------------------
+    // Compare two cache keys
+    //------------------------------------------------------------------------------------------------------
+    bool MipImageKey::operator== (const MipImageKey& other) const
+    {
+        return quatRotation[0] == other.quatRotation[0] &&
+               quatRotation[1] == other.quatRotation[1] &&
+               quatRotation[2] == other.quatRotation[2] &&
+               quatRotation[3] == other.quatRotation[3] &&
+               cameraDistance == other.cameraDistance &&
+               canvasWidth == other.canvasWidth &&
+               canvasHeight == other.canvasHeight &&
+               raycastStepSize == other.raycastStepSize &&
+               raycastMaxSamples == other.raycastMaxSamples &&
+               raycastTraversal == other.raycastTraversal &&
+               displayMapping == other.displayMapping &&
+               volumeDataset == other.volumeDataset;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Hash function of the cache key (FNV-1a over the key fields)
+    //------------------------------------------------------------------------------------------------------
+    size_t MipImageKeyHash::operator() (const MipImageKey& key) const
+    {
+        UINT64 hash = 14695981039346656037ull;
+        auto hashValue = [&hash](UINT32 value)
+        {
+            for (int byteIdx = 0; byteIdx < 4; byteIdx++)
+            {
+                hash ^= (value >> (8 * byteIdx)) & 0xFF;
+                hash *= 1099511628211ull;
+            }
+        };
+        auto floatBits = [](float value)
+        {
+            UINT32 bits;
+            memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        };
+        hashValue((static_cast<UINT16>(key.quatRotation[0]) << 16) | static_cast<UINT16>(key.quatRotation[1]));
+        hashValue((static_cast<UINT16>(key.quatRotation[2]) << 16) | static_cast<UINT16>(key.quatRotation[3]));
+        hashValue(floatBits(key.cameraDistance));
+        hashValue(key.canvasWidth);
+        hashValue(key.canvasHeight);
+        hashValue(floatBits(key.raycastStepSize));
+        hashValue(key.raycastMaxSamples);
+        hashValue(key.raycastTraversal);
+        hashValue(floatBits(key.displayMapping.windowCenter));
+        hashValue(floatBits(key.displayMapping.windowWidth));
+        hashValue(floatBits(key.displayMapping.gamma));
+        hashValue(key.displayMapping.invert ? 1 : 0);
+        hashValue(key.volumeDataset);
+        return static_cast<size_t>(hash);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    MipImageCache::MipImageCache()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    MipImageCache::~MipImageCache()
+    {
+        StopPrecompute();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Quantize a rotation quaternion. q and -q describe the same rotation - the sign is chosen so that
+    // w >= 0 (and the first non-zero component is positive for w == 0), which gives one key per orientation.
+    //------------------------------------------------------------------------------------------------------
+    void MipImageCache::QuantizeRotation(const float quaternion[4], INT16 quantized[4])
+    {
+        float sign = 1.0f;
+        if (quaternion[3] < 0.0f)
+        {
+            sign = -1.0f;
+        }
+        else if (0.0f == quaternion[3])
+        {
+            for (int idx = 0; idx < 3; idx++)
+            {
+                if (0.0f != quaternion[idx])
+                {
+                    sign = quaternion[idx] < 0.0f ? -1.0f : 1.0f;
+                    break;
+                }
+            }
+        }
+        for (int idx = 0; idx < 4; idx++)
+        {
+            quantized[idx] = static_cast<INT16>(floorf(sign * quaternion[idx] * ROTATION_QUANTIZATION + 0.5f));
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the normalized rotation quaternion of a quantized rotation
+    //------------------------------------------------------------------------------------------------------
+    void MipImageCache::DequantizeRotation(const INT16 quantized[4], float quaternion[4])
+    {
+        XMVECTOR quatRotation = XMQuaternionNormalize(XMVectorSet(quantized[0], quantized[1], quantized[2], quantized[3]));
+        quaternion[0] = XMVectorGetX(quatRotation);
+        quaternion[1] = XMVectorGetY(quatRotation);
+        quaternion[2] = XMVectorGetZ(quatRotation);
+        quaternion[3] = XMVectorGetW(quatRotation);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Set the byte budget - least recently used images are evicted
+    //------------------------------------------------------------------------------------------------------
+    void MipImageCache::SetBudget(size_t budgetBytes)
+    {
+        lock_guard<mutex> lock(mutex_);
+
+        budget_ = budgetBytes;
+        evict();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the image for the key (nullptr on miss); a hit marks the image as most recently used
+    //------------------------------------------------------------------------------------------------------
+    shared_ptr<const vector<BYTE>> MipImageCache::Lookup(const MipImageKey& key)
+    {
+        lock_guard<mutex> lock(mutex_);
+
+        auto indexIt = index_.find(key);
+        if (indexIt == index_.end())
+        {
+            misses_++;
+            return nullptr;
+        }
+        hits_++;
+        entries_.splice(entries_.begin(), entries_, indexIt->second);
+        return indexIt->second->image;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Check if an image is cached for the key (no statistics, no LRU update)
+    //------------------------------------------------------------------------------------------------------
+    bool MipImageCache::Contains(const MipImageKey& key)
+    {
+        lock_guard<mutex> lock(mutex_);
+
+        return index_.find(key) != index_.end();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Add the image for the key (replaces an existing image of the same key)
+    //------------------------------------------------------------------------------------------------------
+    void MipImageCache::Insert(const MipImageKey& key, std::vector<BYTE>&& image)
+    {
+        lock_guard<mutex> lock(mutex_);
+
+        if (image.size() > budget_)
+        {
+            // would evict everything else
+            return;
+        }
+
+        auto indexIt = index_.find(key);
+        if (indexIt != index_.end())
+        {
+            memorySize_ -= indexIt->second->image->size();
+            entries_.erase(indexIt->second);
+            index_.erase(indexIt);
+        }
+
+        memorySize_ += image.size();
+        CacheEntry entry;
+        entry.key = key;
+        entry.image = make_shared<const vector<BYTE>>(move(image));
+        entries_.push_front(move(entry));
+        index_[key] = entries_.begin();
+
+        evict();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Remove the images of a volume
+    //------------------------------------------------------------------------------------------------------
+    void MipImageCache::RemoveVolume(UINT volumeDataset)
+    {
+        lock_guard<mutex> lock(mutex_);
+
+        for (auto entryIt = entries_.begin(); entryIt != entries_.end(); )
+        {
+            if (entryIt->key.volumeDataset == volumeDataset)
+            {
+                memorySize_ -= entryIt->image->size();
+                index_.erase(entryIt->key);
+                entryIt = entries_.erase(entryIt);
+            }
+            else
+            {
+                ++entryIt;
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Remove all images
+    //------------------------------------------------------------------------------------------------------
+    void MipImageCache::Clear()
+    {
+        lock_guard<mutex> lock(mutex_);
+
+        index_.clear();
+        entries_.clear();
+        memorySize_ = 0;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the cache statistics
+    //------------------------------------------------------------------------------------------------------
+    MipImageCacheStats MipImageCache::GetStats()
+    {
+        lock_guard<mutex> lock(mutex_);
+
+        MipImageCacheStats stats;
+        stats.hits = hits_;
+        stats.misses = misses_;
+        stats.evictions = evictions_;
+        stats.imageCount = static_cast<UINT>(entries_.size());
+        stats.memorySize = memorySize_;
+        stats.precomputedImages = precomputedImages_;
+        return stats;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Evict least recently used images until the budget is met (cache lock needs to be held)
+    //------------------------------------------------------------------------------------------------------
+    void MipImageCache::evict()
+    {
+        while (memorySize_ > budget_ && !entries_.empty())
+        {
+            const CacheEntry& entry = entries_.back();
+            memorySize_ -= entry.image->size();
+            index_.erase(entry.key);
+            entries_.pop_back();
+            evictions_++;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Start the background precomputation of one full rotation about the given axis
+    //------------------------------------------------------------------------------------------------------
+    bool MipImageCache::StartPrecompute(const MipImageKey& startKey, const float rotationAxis[3])
+    {
+        StopPrecompute();
+
+        XMFLOAT3 axis(rotationAxis[0], rotationAxis[1], rotationAxis[2]);
+        if (XMVectorGetX(XMVector3LengthSq(XMLoadFloat3(&axis))) < 1.0e-6f)
+        {
+            // no rotation axis selected
+            return false;
+        }
+
+        stopPrecompute_ = false;
+        precomputing_ = true;
+        precomputedImages_ = 0;
+        precomputeThread_ = thread(&MipImageCache::precomputeLoop, this, startKey, axis);
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Stop the background precomputation
+    //------------------------------------------------------------------------------------------------------
+    void MipImageCache::StopPrecompute()
+    {
+        stopPrecompute_ = true;
+        if (precomputeThread_.joinable())
+        {
+            precomputeThread_.join();
+        }
+        precomputing_ = false;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Check if the background precomputation is running
+    //------------------------------------------------------------------------------------------------------
+    bool MipImageCache::IsPrecomputing() const
+    {
+        return precomputing_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Background precomputation of one full rotation. The rotation is sampled densely enough that every
+    // quantized orientation along the path is visited; every orientation is rendered only once, with the
+    // dequantized rotation - the same rotation the interactive renderer uses for the key.
+    //------------------------------------------------------------------------------------------------------
+    void MipImageCache::precomputeLoop(MipImageKey startKey, XMFLOAT3 rotationAxis)
+    {
+        // own device - the device of the interactive renderer is bound to the UI thread
+        RayCastRenderer renderer;
+        if (!renderer.InitializeOffscreen(startKey.canvasWidth, startKey.canvasHeight) ||
+            !renderer.LoadDataset(static_cast<VOLUME_DATASET>(startKey.volumeDataset)))
+        {
+            renderer.Release();
+            precomputing_ = false;
+            return;
+        }
+        renderer.SetCameraDistance(startKey.cameraDistance);
+        renderer.SetRaycastParameters(startKey.raycastStepSize, startKey.raycastMaxSamples, startKey.raycastTraversal);
+        renderer.SetDisplayMapping(startKey.displayMapping);
+
+        float startRotation[4];
+        DequantizeRotation(startKey.quatRotation, startRotation);
+        const XMVECTOR quatStart = XMVectorSet(startRotation[0], startRotation[1], startRotation[2], startRotation[3]);
+        const XMVECTOR axis = XMVector3Normalize(XMLoadFloat3(&rotationAxis));
+
+        MipImageKey key = startKey;
+        vector<BYTE> image;
+        for (UINT sampleIdx = 0; sampleIdx < PRECOMPUTE_SAMPLES && !stopPrecompute_; sampleIdx++)
+        {
+            // start rotation followed by the rotation about the axis (same order as the auto-rotation)
+            float angle = XM_2PI * sampleIdx / PRECOMPUTE_SAMPLES;
+            XMVECTOR quatSample = XMQuaternionMultiply(quatStart, XMQuaternionRotationAxis(axis, angle));
+            float quaternion[4] = { XMVectorGetX(quatSample), XMVectorGetY(quatSample), XMVectorGetZ(quatSample), XMVectorGetW(quatSample) };
+            QuantizeRotation(quaternion, key.quatRotation);
+            if (Contains(key))
+            {
+                continue;
+            }
+
+            DequantizeRotation(key.quatRotation, quaternion);
+            renderer.SetRotation(quaternion);
+            if (!renderer.RenderToImage(image))
+            {
+                break;
+            }
+            Insert(key, move(image));
+            precomputedImages_++;
+        }
+
+        renderer.Release();
+        precomputing_ = false;
+    }
+}
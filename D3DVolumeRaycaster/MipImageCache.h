@@ -0,0 +1,137 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: MipImageCache.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: include file for implementation of the MipImageCache functionality. LRU cache of
+//          rendered MIP images keyed by quantized rotation and view parameters (auto-rotation playback),
+//          with background precomputation of a full rotation.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+#include "WindowLevelPass.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    // cache key : quantized rotation and all parameters which change the MIP image
+    struct MipImageKey
+    {
+        INT16   quatRotation[4];        // quantized rotation quaternion (x, y, z, w) with w >= 0
+        float   cameraDistance;
+        UINT    canvasWidth;
+        UINT    canvasHeight;
+        float   raycastStepSize;
+        UINT    raycastMaxSamples;
+        UINT    raycastTraversal;
+        DisplayMapping displayMapping;  // cached images are display gray values
+        UINT    volumeDataset;
+
+        bool operator== (const MipImageKey& other) const;
+    };
+
+    // hash function of the cache key
+    struct MipImageKeyHash
+    {
+        size_t operator() (const MipImageKey& key) const;
+    };
+
+    // cache statistics
+    struct MipImageCacheStats
+    {
+        UINT64  hits;
+        UINT64  misses;
+        UINT64  evictions;
+        UINT    imageCount;
+        size_t  memorySize;             // bytes of all cached images
+        UINT    precomputedImages;      // images rendered by the background precomputation
+    };
+
+    class MipImageCache
+    {
+    public:
+        // constructor / desctructor
+        MipImageCache();
+        virtual ~MipImageCache();
+
+        // avoid usage of copy constructor and =operator ...
+        MipImageCache(MipImageCache const&) = delete;
+        MipImageCache& operator= (MipImageCache const&) = delete;
+
+        // quantize a rotation quaternion (q and -q are the same rotation -> canonical sign w >= 0)
+        static void QuantizeRotation(const float quaternion[4], INT16 quantized[4]);
+        // get the normalized rotation quaternion of a quantized rotation - images are rendered with this rotation
+        static void DequantizeRotation(const INT16 quantized[4], float quaternion[4]);
+
+        // set the byte budget - least recently used images are evicted
+        void SetBudget(size_t budgetBytes);
+        // get the image for the key (nullptr on miss); a hit marks the image as most recently used
+        std::shared_ptr<const std::vector<BYTE>> Lookup(const MipImageKey& key);
+        // check if an image is cached for the key (no statistics, no LRU update)
+        bool Contains(const MipImageKey& key);
+        // add the image (8 bit gray, canvas size) for the key
+        void Insert(const MipImageKey& key, std::vector<BYTE>&& image);
+        // remove the images of the given volume (e.g. its content was updated) - the images of other volumes stay cached
+        void RemoveVolume(UINT volumeDataset);
+        // remove all images
+        void Clear();
+        // get the cache statistics
+        MipImageCacheStats GetStats();
+
+        // render one full rotation about the given axis, starting at the rotation of the key, in the background
+        // (own offscreen renderer) - already cached orientations are skipped
+        bool StartPrecompute(const MipImageKey& startKey, const float rotationAxis[3]);
+        // stop the background precomputation
+        void StopPrecompute();
+        // check if the background precomputation is running
+        bool IsPrecomputing() const;
+
+    private:
+
+        struct CacheEntry
+        {
+            MipImageKey                                 key;
+            std::shared_ptr<const std::vector<BYTE>>    image;
+        };
+
+        // evict least recently used images until the budget is met (cache lock needs to be held)
+        void evict();
+        // background precomputation of one full rotation
+        void precomputeLoop(MipImageKey startKey, DirectX::XMFLOAT3 rotationAxis);
+
+        // ------------------------------------------------------------------------------------------------------------
+
+        static const int  ROTATION_QUANTIZATION = 64;   // quantization steps per unit of a quaternion component
+        static const UINT PRECOMPUTE_SAMPLES = 8 * ROTATION_QUANTIZATION;  // rotation samples of the precomputation
+
+        std::mutex                      mutex_;
+        std::list<CacheEntry>           entries_;       // most recently used first
+        std::unordered_map<MipImageKey, std::list<CacheEntry>::iterator, MipImageKeyHash> index_;
+        size_t                          budget_ = 256 * 1024 * 1024;
+        size_t                          memorySize_ = 0;
+        UINT64                          hits_ = 0;
+        UINT64                          misses_ = 0;
+        UINT64                          evictions_ = 0;
+
+        std::thread                     precomputeThread_;
+        std::atomic<bool>               stopPrecompute_ { false };
+        std::atomic<bool>               precomputing_ { false };
+        std::atomic<UINT>               precomputedImages_ { 0 };
+    };
+}
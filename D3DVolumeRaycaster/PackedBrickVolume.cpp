@@ -0,0 +1,317 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: PackedBrickVolume.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of PackedBrickVolume functionality.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "PackedBrickVolume.h"
+
+using namespace std;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    PackedBrickVolume::PackedBrickVolume()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    PackedBrickVolume::~PackedBrickVolume()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Compute minimum and bit width of the bricks of the given brick layers (z-direction)
+    //------------------------------------------------------------------------------------------------------
+    template <typename T>
+    void PackedBrickVolume::measureBrickLayers(const T* pVolumeData, UINT brickLayerBegin, UINT brickLayerEnd)
+    {
+        const size_t slicePitch = static_cast<size_t>(volDimensions_[0]) * volDimensions_[1];
+
+        for (UINT bz = brickLayerBegin; bz < brickLayerEnd; bz++)
+        {
+            const UINT zEnd = min((bz + 1) * BRICK_SIZE, volDimensions_[2]);
+            for (UINT by = 0; by < brickCount_[1]; by++)
+            {
+                const UINT yEnd = min((by + 1) * BRICK_SIZE, volDimensions_[1]);
+                for (UINT bx = 0; bx < brickCount_[0]; bx++)
+                {
+                    const UINT xEnd = min((bx + 1) * BRICK_SIZE, volDimensions_[0]);
+
+                    UINT minValue = 0xFFFF, maxValue = 0;
+                    for (UINT z = bz * BRICK_SIZE; z < zEnd; z++)
+                    {
+                        for (UINT y = by * BRICK_SIZE; y < yEnd; y++)
+                        {
+                            const T* pRow = pVolumeData + z * slicePitch + static_cast<size_t>(y) * volDimensions_[0];
+                            for (UINT x = bx * BRICK_SIZE; x < xEnd; x++)
+                            {
+                                minValue = min(minValue, static_cast<UINT>(pRow[x]));
+                                maxValue = max(maxValue, static_cast<UINT>(pRow[x]));
+                            }
+                        }
+                    }
+
+                    // bit width of the value range (0 : constant brick, nothing to store)
+                    UINT bitWidth = 0;
+                    while ((maxValue - minValue) >> bitWidth)
+                    {
+                        bitWidth++;
+                    }
+                    brickTable_[(static_cast<size_t>(bz) * brickCount_[1] + by) * brickCount_[0] + bx].minAndBitWidth = minValue | (bitWidth << 16);
+                }
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Pack the deltas of the bricks of the given brick layers (z-direction). The deltas of a brick form one
+    // bit stream (voxels in scan-line order, least significant bits first) - a delta may span two words.
+    //------------------------------------------------------------------------------------------------------
+    template <typename T>
+    void PackedBrickVolume::packBrickLayers(const T* pVolumeData, UINT brickLayerBegin, UINT brickLayerEnd)
+    {
+        const size_t slicePitch = static_cast<size_t>(volDimensions_[0]) * volDimensions_[1];
+
+        for (UINT bz = brickLayerBegin; bz < brickLayerEnd; bz++)
+        {
+            const UINT zEnd = min((bz + 1) * BRICK_SIZE, volDimensions_[2]);
+            for (UINT by = 0; by < brickCount_[1]; by++)
+            {
+                const UINT yEnd = min((by + 1) * BRICK_SIZE, volDimensions_[1]);
+                for (UINT bx = 0; bx < brickCount_[0]; bx++)
+                {
+                    const UINT xEnd = min((bx + 1) * BRICK_SIZE, volDimensions_[0]);
+                    const PackedBrickEntry& entry = brickTable_[(static_cast<size_t>(bz) * brickCount_[1] + by) * brickCount_[0] + bx];
+                    const UINT minValue = entry.minAndBitWidth & 0xFFFF;
+                    const UINT bitWidth = entry.minAndBitWidth >> 16;
+                    if (0 == bitWidth)
+                    {
+                        continue;
+                    }
+
+                    UINT* pWords = data_.data() + entry.firstWord;
+                    for (UINT z = bz * BRICK_SIZE; z < zEnd; z++)
+                    {
+                        for (UINT y = by * BRICK_SIZE; y < yEnd; y++)
+                        {
+                            const T* pRow = pVolumeData + z * slicePitch + static_cast<size_t>(y) * volDimensions_[0];
+                            const UINT rowIdx = ((z % BRICK_SIZE) * BRICK_SIZE + y % BRICK_SIZE) * BRICK_SIZE;
+                            for (UINT x = bx * BRICK_SIZE; x < xEnd; x++)
+                            {
+                                const UINT delta = static_cast<UINT>(pRow[x]) - minValue;
+                                const UINT bitPos = (rowIdx + x % BRICK_SIZE) * bitWidth;
+                                const UINT shift = bitPos & 31;
+                                pWords[bitPos >> 5] |= delta << shift;
+                                if (shift + bitWidth > 32)
+                                {
+                                    pWords[(bitPos >> 5) + 1] |= delta >> (32 - shift);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Run the given member on all brick layers, split over the available hardware threads
+    //------------------------------------------------------------------------------------------------------
+    template <typename T>
+    void PackedBrickVolume::forBrickLayers(void (PackedBrickVolume::*pLayerFunction)(const T*, UINT, UINT), const T* pVolumeData)
+    {
+        UINT threadCount = max(1u, min(thread::hardware_concurrency(), brickCount_[2]));
+        UINT layersPerThread = (brickCount_[2] + threadCount - 1) / threadCount;
+        vector<thread> workers;
+        for (UINT threadIdx = 0; threadIdx < threadCount; threadIdx++)
+        {
+            UINT layerBegin = threadIdx * layersPerThread;
+            UINT layerEnd = min(layerBegin + layersPerThread, brickCount_[2]);
+            if (layerBegin < layerEnd)
+            {
+                workers.emplace_back(pLayerFunction, this, pVolumeData, layerBegin, layerEnd);
+            }
+        }
+        for (auto& worker : workers) worker.join();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Pack the given volume : pass 1 measures minimum and bit width of every brick, the prefix sum of the
+    // brick sizes gives the word offsets, pass 2 packs the deltas. Both passes run in parallel over brick
+    // layers (z-direction).
+    //------------------------------------------------------------------------------------------------------
+    bool PackedBrickVolume::Build(const void* pVolumeData, const UINT dimensions[3], UINT bytesPerVoxel)
+    {
+        Release();
+
+        if (nullptr == pVolumeData || 0 == dimensions[0] || 0 == dimensions[1] || 0 == dimensions[2])
+        {
+            return false;
+        }
+        if (1 != bytesPerVoxel && 2 != bytesPerVoxel)
+        {
+            return false;
+        }
+
+        bytesPerVoxel_ = bytesPerVoxel;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            volDimensions_[axis] = dimensions[axis];
+            brickCount_[axis] = (volDimensions_[axis] + BRICK_SIZE - 1) / BRICK_SIZE;
+        }
+        const size_t totalBricks = static_cast<size_t>(brickCount_[0]) * brickCount_[1] * brickCount_[2];
+        brickTable_.assign(totalBricks, PackedBrickEntry{ 0, 0 });
+
+        // pass 1 : minimum and bit width per brick
+        if (2 == bytesPerVoxel_)
+        {
+            forBrickLayers(&PackedBrickVolume::measureBrickLayers<UINT16>, static_cast<const UINT16*>(pVolumeData));
+        }
+        else
+        {
+            forBrickLayers(&PackedBrickVolume::measureBrickLayers<BYTE>, static_cast<const BYTE*>(pVolumeData));
+        }
+
+        // prefix sum -> first word per brick (a brick of bit width b takes BRICK_VOXELS * b / 32 words)
+        UINT64 wordCount = 0;
+        for (PackedBrickEntry& entry : brickTable_)
+        {
+            if (wordCount > 0xFFFFFFFF)
+            {
+                // word offsets are 32 bit
+                Release();
+                return false;
+            }
+            entry.firstWord = static_cast<UINT>(wordCount);
+            wordCount += (BRICK_VOXELS / 32) * (entry.minAndBitWidth >> 16);
+        }
+        data_.assign(static_cast<size_t>(wordCount), 0);
+
+        // pass 2 : pack the deltas
+        if (2 == bytesPerVoxel_)
+        {
+            forBrickLayers(&PackedBrickVolume::packBrickLayers<UINT16>, static_cast<const UINT16*>(pVolumeData));
+        }
+        else
+        {
+            forBrickLayers(&PackedBrickVolume::packBrickLayers<BYTE>, static_cast<const BYTE*>(pVolumeData));
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Release all allocated memory
+    //------------------------------------------------------------------------------------------------------
+    void PackedBrickVolume::Release()
+    {
+        brickTable_.clear();
+        brickTable_.shrink_to_fit();
+        data_.clear();
+        data_.shrink_to_fit();
+        brickCount_[0] = brickCount_[1] = brickCount_[2] = 0;
+        volDimensions_[0] = volDimensions_[1] = volDimensions_[2] = 0;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Decode a single voxel - same steps as the ray-casting shader's decoder (PackedVoxel)
+    //------------------------------------------------------------------------------------------------------
+    UINT PackedBrickVolume::DecodeVoxel(UINT column, UINT row, UINT slice) const
+    {
+        assert(column < volDimensions_[0] && row < volDimensions_[1] && slice < volDimensions_[2]);
+
+        const PackedBrickEntry& entry = brickTable_[
+            (static_cast<size_t>(slice / BRICK_SIZE) * brickCount_[1] + row / BRICK_SIZE) * brickCount_[0] + column / BRICK_SIZE];
+        const UINT bitWidth = entry.minAndBitWidth >> 16;
+        UINT value = entry.minAndBitWidth & 0xFFFF;
+        if (bitWidth > 0)
+        {
+            const UINT voxelIdx = ((slice % BRICK_SIZE) * BRICK_SIZE + row % BRICK_SIZE) * BRICK_SIZE + column % BRICK_SIZE;
+            const UINT bitPos = voxelIdx * bitWidth;
+            const UINT shift = bitPos & 31;
+            const UINT* pWords = data_.data() + entry.firstWord + (bitPos >> 5);
+            UINT bits = pWords[0] >> shift;
+            if (shift + bitWidth > 32)
+            {
+                bits |= pWords[1] << (32 - shift);
+            }
+            value += bits & ((1u << bitWidth) - 1);
+        }
+        return value;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the brick table (x-fastest brick order, same as the brick max grid)
+    //------------------------------------------------------------------------------------------------------
+    const PackedBrickEntry* PackedBrickVolume::GetBrickTable() const
+    {
+        return brickTable_.data();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the number of bricks in x-, y- and z-direction
+    //------------------------------------------------------------------------------------------------------
+    void PackedBrickVolume::GetBrickCount(UINT brickCount[3]) const
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            brickCount[axis] = brickCount_[axis];
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the packed deltas of all bricks
+    //------------------------------------------------------------------------------------------------------
+    const UINT* PackedBrickVolume::GetData() const
+    {
+        return data_.data();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the number of 32 bit words of the packed deltas
+    //------------------------------------------------------------------------------------------------------
+    UINT64 PackedBrickVolume::GetDataWordCount() const
+    {
+        return data_.size();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the size in bytes of the packed volume (brick table and packed deltas)
+    //------------------------------------------------------------------------------------------------------
+    UINT64 PackedBrickVolume::GetPackedSize() const
+    {
+        return static_cast<UINT64>(brickTable_.size()) * sizeof(PackedBrickEntry) + static_cast<UINT64>(data_.size()) * sizeof(UINT);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the size in bytes of the unpacked voxels
+    //------------------------------------------------------------------------------------------------------
+    UINT64 PackedBrickVolume::GetRawSize() const
+    {
+        return static_cast<UINT64>(volDimensions_[0]) * volDimensions_[1] * volDimensions_[2] * bytesPerVoxel_;
+    }
+}
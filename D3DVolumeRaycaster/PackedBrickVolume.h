@@ -0,0 +1,100 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: PackedBrickVolume.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: include file for implementation of the PackedBrickVolume functionality. Lossless in-memory
+//          compression of a volume : per brick minimum and bit-packed deltas of fixed width.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "stdafx.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    // brick table entry of a packed brick
+    // -> memory layout matches the structured buffer element uint2 of the ray-casting shader
+    struct PackedBrickEntry
+    {
+        UINT firstWord;         // index of the first 32 bit word of the packed deltas
+        UINT minAndBitWidth;    // brick minimum (bits 0 .. 15) and bit width of the deltas (bits 16 .. 20, 0 = constant brick)
+    };
+
+    class PackedBrickVolume
+    {
+    public:
+        // edge length of a brick in voxels - must match VolumeResource::MAX_BRICK_SIZE (the brick max grid skips the
+        // same bricks) and the shader's MAX_BRICK_SIZE
+        static const UINT BRICK_SIZE = 8;
+        // number of voxels of a brick; BRICK_VOXELS * bitWidth is a multiple of 32, so every brick starts at a word
+        static const UINT BRICK_VOXELS = BRICK_SIZE * BRICK_SIZE * BRICK_SIZE;
+
+        // constructor / desctructor
+        PackedBrickVolume();
+        virtual ~PackedBrickVolume();
+
+        // avoid usage of copy constructor and =operator ...
+        PackedBrickVolume(PackedBrickVolume const&) = delete;
+        PackedBrickVolume& operator= (PackedBrickVolume const&) = delete;
+
+        // pack the given volume (1 or 2 bytes per voxel) : every brick stores its minimum and the deltas to it with
+        // the bit width of the brick's value range; voxels of the border bricks outside the volume are stored as 0 deltas
+        bool Build(const void* pVolumeData, const UINT dimensions[3], UINT bytesPerVoxel);
+        // release all allocated memory
+        void Release();
+
+        // decode a single voxel (reference of the shader's decoder - random access, no neighbour voxels are needed)
+        UINT DecodeVoxel(UINT column, UINT row, UINT slice) const;
+
+        // get the brick table (x-fastest brick order, same as the brick max grid)
+        const PackedBrickEntry* GetBrickTable() const;
+        // get the number of bricks in x-, y- and z-direction
+        void GetBrickCount(UINT brickCount[3]) const;
+        // get the packed deltas of all bricks
+        const UINT* GetData() const;
+        // get the number of 32 bit words of the packed deltas
+        UINT64 GetDataWordCount() const;
+        // get the size in bytes of the packed volume (brick table and packed deltas)
+        UINT64 GetPackedSize() const;
+        // get the size in bytes of the unpacked voxels
+        UINT64 GetRawSize() const;
+
+    private:
+
+        // compute minimum and bit width of the bricks of the given brick layers (z-direction)
+        template <typename T>
+        void measureBrickLayers(const T* pVolumeData, UINT brickLayerBegin, UINT brickLayerEnd);
+        // pack the deltas of the bricks of the given brick layers (z-direction)
+        // note : the brick table must contain the word offsets; every brick owns its words
+        template <typename T>
+        void packBrickLayers(const T* pVolumeData, UINT brickLayerBegin, UINT brickLayerEnd);
+        // run the given member on all brick layers, split over the available hardware threads
+        template <typename T>
+        void forBrickLayers(void (PackedBrickVolume::*pLayerFunction)(const T*, UINT, UINT), const T* pVolumeData);
+
+        // ------------------------------------------------------------------------------------------------------------
+
+        std::vector<PackedBrickEntry>   brickTable_;
+        std::vector<UINT>               data_;
+        UINT                            brickCount_[3] = { 0, 0, 0 };
+        UINT                            volDimensions_[3] = { 0, 0, 0 };
+        UINT                            bytesPerVoxel_ = 1;
+    };
+}
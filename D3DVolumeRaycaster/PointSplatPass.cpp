@@ -0,0 +1,287 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: PointSplatPass.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of PointSplatPass functionality.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "PointSplatPass.h"
+
+using namespace DirectX;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    PointSplatPass::PointSplatPass()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    PointSplatPass::~PointSplatPass()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create Vertex-Shader, Geometry-Shader, Pixel-Shader and input layout objects
+    //------------------------------------------------------------------------------------------------------
+    bool PointSplatPass::createShaderObjectsAndInputLayout(ID3D11Device* pD3DDevice)
+    {
+        HRESULT hr = S_OK;
+
+        // compile the vertex shader
+        ID3DBlob* pVSBlob = nullptr;
+        hr = CompileShaderFromFile(L"PointSplatShader.fx", "VS", "vs_5_0", &pVSBlob);
+        if (FAILED(hr))
+        {
+            MessageBox(
+                nullptr,
+                L"The FX file PointSplatShader.fx cannot be compiled.  Please run this executable from the directory that contains the FX file.",
+                L"Error",
+                MB_OK
+            );
+            return false;
+        }
+
+        // create the vertex shader
+        hr = pD3DDevice->CreateVertexShader(pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), nullptr, &pSplatVertexShader_);
+        if (FAILED(hr))
+        {
+            SAFE_RELEASE(pVSBlob);
+            return false;
+        }
+
+        // define the input layout : voxel position (column, row, slice) + intensity packed as 4 x 16 bit
+        D3D11_INPUT_ELEMENT_DESC layoutDesc[] =
+        {
+            { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UINT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+        };
+        UINT numElements = ARRAYSIZE(layoutDesc);
+
+        // create the input layout
+        hr = pD3DDevice->CreateInputLayout(
+            layoutDesc,
+            numElements,
+            pVSBlob->GetBufferPointer(),
+            pVSBlob->GetBufferSize(),
+            &pSplatVertexLayout_
+        );
+        SAFE_RELEASE(pVSBlob);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        // compile the geometry shader
+        ID3DBlob* pGSBlob = nullptr;
+        hr = CompileShaderFromFile(L"PointSplatShader.fx", "GS", "gs_5_0", &pGSBlob);
+        if (FAILED(hr))
+        {
+            MessageBox(
+                nullptr,
+                L"The FX file PointSplatShader.fx cannot be compiled.  Please run this executable from the directory that contains the FX file.",
+                L"Error",
+                MB_OK);
+            return false;
+        }
+
+        // create the geometry shader
+        hr = pD3DDevice->CreateGeometryShader(pGSBlob->GetBufferPointer(), pGSBlob->GetBufferSize(), nullptr, &pSplatGeometryShader_);
+        SAFE_RELEASE(pGSBlob);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        // compile the pixel shader
+        ID3DBlob* pPSBlob = nullptr;
+        hr = CompileShaderFromFile(L"PointSplatShader.fx", "PS", "ps_5_0", &pPSBlob);
+        if (FAILED(hr))
+        {
+            MessageBox(
+                nullptr,
+                L"The FX file PointSplatShader.fx cannot be compiled.  Please run this executable from the directory that contains the FX file.",
+                L"Error",
+                MB_OK);
+            return false;
+        }
+
+        // create the pixel shader
+        hr = pD3DDevice->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, &pSplatPixelShader_);
+        SAFE_RELEASE(pPSBlob);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create constant buffers used to pass uniform data to the shader stages
+    //------------------------------------------------------------------------------------------------------
+    bool PointSplatPass::createConstantBuffers(ID3D11Device* pD3DDevice)
+    {
+        HRESULT hr = S_OK;
+
+        D3D11_BUFFER_DESC bufferDsc = { 0 };
+        bufferDsc.Usage = D3D11_USAGE_DEFAULT;
+        bufferDsc.ByteWidth = sizeof(ConstantBufferSplat);
+        bufferDsc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        bufferDsc.CPUAccessFlags = 0;
+        hr = pD3DDevice->CreateBuffer(&bufferDsc, nullptr, &pConstantBuffer_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create blend and rasterizer state objects
+    //------------------------------------------------------------------------------------------------------
+    bool PointSplatPass::createPipelineStateObjects(ID3D11Device* pD3DDevice)
+    {
+        HRESULT hr = S_OK;
+
+        // max-blending : the Output-Merger keeps the per-pixel maximum of all splats covering a pixel
+        // -> order independent, no sorting of the voxels necessary
+        D3D11_BLEND_DESC blendDesc;
+        ZeroMemory(&blendDesc, sizeof(D3D11_BLEND_DESC));
+        blendDesc.RenderTarget[0].BlendEnable = TRUE;
+        blendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
+        blendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_ONE;
+        blendDesc.RenderTarget[0].BlendOp = D3D11_BLEND_OP_MAX;
+        blendDesc.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+        blendDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ONE;
+        blendDesc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_MAX;
+        blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+
+        hr = pD3DDevice->CreateBlendState(&blendDesc, &pMaxBlendState_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        // splats are screen-aligned quads - culling is not needed
+        D3D11_RASTERIZER_DESC rasterStateDsc;
+        ZeroMemory(&rasterStateDsc, sizeof(rasterStateDsc));
+        rasterStateDsc.FillMode = D3D11_FILL_SOLID;
+        rasterStateDsc.CullMode = D3D11_CULL_NONE;
+        rasterStateDsc.DepthClipEnable = true;
+        hr = pD3DDevice->CreateRasterizerState(&rasterStateDsc, &pNoCullingRasterizerState_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Initialize point splatting pass renderer - create Direct3D resources
+    //------------------------------------------------------------------------------------------------------
+    bool PointSplatPass::Initialize(ID3D11Device* pD3DDevice)
+    {
+        assert(pD3DDevice);
+
+        // create vertex-shader, geometry-shader, pixel-shader and input layout
+        if (!createShaderObjectsAndInputLayout(pD3DDevice)) return false;
+
+        // create constant buffers used for passing uniform data to shader stages
+        if (!createConstantBuffers(pD3DDevice)) return false;
+
+        // create blend and rasterizer states
+        if (!createPipelineStateObjects(pD3DDevice)) return false;
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Release all allocated resources 
+    //------------------------------------------------------------------------------------------------------
+    void PointSplatPass::Release()
+    {
+        SAFE_RELEASE(pNoCullingRasterizerState_);
+        SAFE_RELEASE(pMaxBlendState_);
+        SAFE_RELEASE(pConstantBuffer_);
+        SAFE_RELEASE(pSplatPixelShader_);
+        SAFE_RELEASE(pSplatGeometryShader_);
+        SAFE_RELEASE(pSplatVertexLayout_);
+        SAFE_RELEASE(pSplatVertexShader_);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Splat all sparse voxels of the given volume into the currently bound render target (max-blending)
+    //------------------------------------------------------------------------------------------------------
+    void PointSplatPass::Render(ID3D11DeviceContext* pDeviceContext, const VolumeResource& volume, const XMMATRIX* pMatrixWVP, UINT canvasWidth, UINT canvasHeight, float splatSize, UINT splatThreshold) const
+    {
+        ID3D11Buffer* pPointBuffer = volume.GetPointBuffer();
+        const UINT pointCount = volume.GetSparseVolume().GetVoxelCount();
+        if (nullptr == pPointBuffer || 0 == pointCount)
+        {
+            return;
+        }
+        UINT volDimensions[3];
+        volume.GetDimensions(volDimensions);
+
+        // update constant buffer
+        ConstantBufferSplat cb;
+        cb.matrixWVP = *pMatrixWVP;
+        cb.volumeDimensions[0] = static_cast<float>(volDimensions[0]);
+        cb.volumeDimensions[1] = static_cast<float>(volDimensions[1]);
+        cb.volumeDimensions[2] = static_cast<float>(volDimensions[2]);
+        cb.splatSize = max(splatSize, 1.0f);
+        cb.canvasPixelResolution[0] = 1.0f / canvasWidth;
+        cb.canvasPixelResolution[1] = 1.0f / canvasHeight;
+        cb.intensityScale = 1.0f / 255.0f;
+        cb.splatThreshold = splatThreshold;
+        pDeviceContext->UpdateSubresource(pConstantBuffer_, 0, nullptr, &cb, 0, 0);
+
+        // set input assembler state : one point per sparse voxel
+        UINT stride = sizeof(SparseVoxel);
+        UINT offset = 0;
+        pDeviceContext->IASetInputLayout(pSplatVertexLayout_);
+        pDeviceContext->IASetVertexBuffers(0, 1, &pPointBuffer, &stride, &offset);
+        pDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_POINTLIST);
+
+        // set shaders
+        pDeviceContext->VSSetShader(pSplatVertexShader_, nullptr, 0);
+        pDeviceContext->VSSetConstantBuffers(0, 1, &pConstantBuffer_);
+        pDeviceContext->GSSetShader(pSplatGeometryShader_, nullptr, 0);
+        pDeviceContext->GSSetConstantBuffers(0, 1, &pConstantBuffer_);
+        pDeviceContext->PSSetShader(pSplatPixelShader_, nullptr, 0);
+
+        // set pipeline states
+        pDeviceContext->RSSetState(pNoCullingRasterizerState_);
+        pDeviceContext->OMSetBlendState(pMaxBlendState_, nullptr, 0xFFFFFFFF);
+
+        pDeviceContext->Draw(pointCount, 0);
+
+        // restore default blend state and unbind geometry shader
+        pDeviceContext->OMSetBlendState(nullptr, nullptr, 0xFFFFFFFF);
+        pDeviceContext->GSSetShader(nullptr, nullptr, 0);
+    }
+}
@@ -0,0 +1,84 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: PointSplatPass.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: include file for implementation of PointSplatPass functionality. Projects the voxels of
+//          a SparseVolume as screen-space splats into the MIP image using max-blending.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+#include "VolumeResource.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    // constant buffer for passing data to HLSL point splatting shaders
+    struct ConstantBufferSplat
+    {
+        DirectX::XMMATRIX matrixWVP;        // concatenated world-view-projection matrix
+        float volumeDimensions[3];          // volume dimensions in voxels (columns, rows, slices)
+        float splatSize;                    // splat edge length in pixels (= projected voxel footprint)
+        float canvasPixelResolution[2];     // pixel size in x- and y-direction (1 / canvas resolution)
+        float intensityScale;               // maps stored voxel values to 0.0 .. 1.0
+        UINT  splatThreshold;               // voxels with value <= threshold are discarded
+    };
+
+    class PointSplatPass
+    {
+    public:
+        // constructor / desctructor
+        PointSplatPass();
+        virtual ~PointSplatPass();
+
+        // avoid usage of copy constructor and =operator ...
+        PointSplatPass(PointSplatPass const&) = delete;
+        PointSplatPass& operator= (PointSplatPass const&) = delete;
+
+        // initialize point splatting pass renderer - create Direct3D resources
+        bool Initialize(ID3D11Device* pD3DDevice);
+        // release all allocated resources 
+        void Release();
+        // splat all sparse voxels of the given volume into the currently bound render target (max-blending);
+        // the pass holds no per-frame state, so it may record into several (deferred) device contexts concurrently
+        void Render(ID3D11DeviceContext* pDeviceContext, const VolumeResource& volume, const DirectX::XMMATRIX* pMatrixWVP, UINT canvasWidth, UINT canvasHeight, float splatSize, UINT splatThreshold) const;
+
+    private:
+
+        // create Vertex-Shader, Geometry-Shader, Pixel-Shader and input layout objects
+        bool createShaderObjectsAndInputLayout(ID3D11Device* pD3DDevice);
+        // create constant buffers used to pass uniform data to the shader stages
+        bool createConstantBuffers(ID3D11Device* pD3DDevice);
+        // create blend and rasterizer state objects
+        bool createPipelineStateObjects(ID3D11Device* pD3DDevice);
+
+        // ------------------------------------------------------------------------------------------------------------
+
+        // constant buffer for parameter transfer to shader
+        ID3D11Buffer*               pConstantBuffer_ = nullptr;
+        // shaders for projecting the sparse voxels
+        ID3D11VertexShader*         pSplatVertexShader_ = nullptr;
+        ID3D11GeometryShader*       pSplatGeometryShader_ = nullptr;
+        ID3D11PixelShader*          pSplatPixelShader_ = nullptr;
+        ID3D11InputLayout*          pSplatVertexLayout_ = nullptr;
+        // pipeline states : max-blending (order independent MIP), no culling
+        ID3D11BlendState*           pMaxBlendState_ = nullptr;
+        ID3D11RasterizerState*      pNoCullingRasterizerState_ = nullptr;
+    };
+}
@@ -0,0 +1,99 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: PointSplatShader.fx
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: HLSL
+//
+// Descrip: vertex-, geometry- and pixel-shader for point-based (splatting) 3D MIP rendering of sparse volumes.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------
+// Constant Buffer Variables
+//--------------------------------------------------------------------------------------
+cbuffer ConstantBufferSplat : register(b0)
+{
+    matrix matrixWVP;           // concatenated world-view-projection matrix
+    float3 volumeDimensions;    // volume dimensions in voxels (columns, rows, slices)
+    float  splatSize;           // splat edge length in pixels (= projected voxel footprint)
+    float2 canvasPixResolution; // pixel size in x- and y-direction (1 / canvas resolution)
+    float  intensityScale;      // maps stored voxel values to 0.0 .. 1.0
+    uint   splatThreshold;      // voxels with value <= threshold are discarded
+}
+
+//--------------------------------------------------------------------------------------
+// Structs defining shader stage outputs
+//--------------------------------------------------------------------------------------
+struct VS_OUTPUT
+{
+    float4 Pos   : SV_POSITION;
+    float  Value : INTENSITY;
+};
+
+struct GS_OUTPUT
+{
+    float4 Pos   : SV_POSITION;
+    float  Value : INTENSITY;
+};
+
+//--------------------------------------------------------------------------------------
+// Vertex Shader - transforms voxel position (column, row, slice) to clip space
+//--------------------------------------------------------------------------------------
+VS_OUTPUT VS(uint4 Voxel : POSITION)
+{
+    VS_OUTPUT output = (VS_OUTPUT)0;
+    // voxel center in normalized texture coordinates (0.0 .. 1.0) shifted to model space (-0.5 .. 0.5)
+    float3 posModel = ((float3)Voxel.xyz + 0.5) / volumeDimensions - 0.5;
+    output.Pos = mul(float4(posModel, 1.0), matrixWVP);
+    output.Value = (Voxel.w > splatThreshold) ? Voxel.w * intensityScale : -1.0;
+    return output;
+}
+
+//--------------------------------------------------------------------------------------
+// Geometry Shader - expands each voxel point to a screen-aligned quad covering its footprint
+//--------------------------------------------------------------------------------------
+[maxvertexcount(4)]
+void GS(point VS_OUTPUT input[1], inout TriangleStream<GS_OUTPUT> stream)
+{
+    // cull voxels below threshold and voxels behind the camera
+    if (input[0].Value < 0.0 || input[0].Pos.w <= 0.0)
+    {
+        return;
+    }
+
+    // half splat extent in clip space (NDC extent is 2.0 per canvas width/height)
+    float2 halfExtent = splatSize * canvasPixResolution * input[0].Pos.w;
+
+    const float2 corners[4] = { float2(-1.0, 1.0), float2(1.0, 1.0), float2(-1.0, -1.0), float2(1.0, -1.0) };
+
+    GS_OUTPUT output;
+    output.Value = input[0].Value;
+    [unroll]
+    for (int idx = 0; idx < 4; idx++)
+    {
+        output.Pos = input[0].Pos + float4(corners[idx] * halfExtent, 0.0, 0.0);
+        stream.Append(output);
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// Pixel Shader - the MIP value is resolved by max-blending in the Output-Merger stage
+//--------------------------------------------------------------------------------------
+float4 PS(GS_OUTPUT input) : SV_Target
+{
+    return float4(input.Value, input.Value, input.Value, 1.0);
+}
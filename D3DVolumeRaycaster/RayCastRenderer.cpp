@@ -24,16 +24,15 @@
 
 #include "stdafx.h"
 #include "RayCastRenderer.h"
+#include "DistributedMipRenderer.h"
+#include "SharedFrameRingBuffer.h"
+#include "DicomSeries.h"
 
 using namespace DirectX;
 using namespace std;
 
 namespace D3D11_VOLUME_RAYCASTER
 {
-    //--------------------------------------------------------------------------------------
-    // RayCastRenderer implementation 
-    //--------------------------------------------------------------------------------------
-    
     //------------------------------------------------------------------------------------------------------
     // Default constructor
     //------------------------------------------------------------------------------------------------------
@@ -48,10 +47,24 @@ namespace D3D11_VOLUME_RAYCASTER
     {
     }
 
+    //--------------------------------------------------------------------------------------
+    // RayCastRenderer implementation 
+    //--------------------------------------------------------------------------------------
+    
     //------------------------------------------------------------------------------------------------------
     // Create Direct3D device, device context and DXGI swapchain
     //------------------------------------------------------------------------------------------------------
     bool RayCastRenderer::createDeviceAndSwapChain()
+    {
+        if (!createDevice()) return false;
+
+        return createSwapChain();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create Direct3D device and device context
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::createDevice()
     {
         HRESULT hr = S_OK;
 
@@ -100,7 +113,19 @@ namespace D3D11_VOLUME_RAYCASTER
         {
             return false;
         }
-        
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create DXGI swapchain for the canvas window
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::createSwapChain()
+    {
+        HRESULT hr = S_OK;
+
+        assert(pD3DDevice_);
+
         // obtain DXGI factory from device ...
         IDXGIFactory1* dxgiFactory = nullptr;
         {
@@ -184,6 +209,57 @@ namespace D3D11_VOLUME_RAYCASTER
         return true;
     }
     
+    //------------------------------------------------------------------------------------------------------
+    // Create offscreen render target and staging texture for read back (offscreen rendering without swap chain)
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::createOffscreenRenderTarget()
+    {
+        HRESULT hr = S_OK;
+
+        assert(pD3DDevice_);
+        assert(pImmediateContext_);
+
+        // render target texture - same format as the swap chain back buffer
+        D3D11_TEXTURE2D_DESC texDesc = { 0 };
+        texDesc.Width = canvasWidth_;
+        texDesc.Height = canvasHeight_;
+        texDesc.MipLevels = 1;
+        texDesc.ArraySize = 1;
+        texDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        texDesc.SampleDesc.Count = 1;
+        texDesc.Usage = D3D11_USAGE_DEFAULT;
+        texDesc.BindFlags = D3D11_BIND_RENDER_TARGET;
+        texDesc.CPUAccessFlags = 0;
+
+        hr = pD3DDevice_->CreateTexture2D(&texDesc, nullptr, &pOffscreenTexture_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        hr = pD3DDevice_->CreateRenderTargetView(pOffscreenTexture_, nullptr, &pRenderTargetView_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        // staging texture for CPU read back of the rendered frame
+        texDesc.Usage = D3D11_USAGE_STAGING;
+        texDesc.BindFlags = 0;
+        texDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+        hr = pD3DDevice_->CreateTexture2D(&texDesc, nullptr, &pStagingTexture_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        // bind the render target view to the pipeline (Output-Merger stage)
+        pImmediateContext_->OMSetRenderTargets(1, &pRenderTargetView_, nullptr);
+
+        return true;
+    }
+
     //------------------------------------------------------------------------------------------------------
     // Set the rendering viewport. This method needs to be called on initialization and every time the
     // hosting window is resized.
@@ -281,6 +357,126 @@ namespace D3D11_VOLUME_RAYCASTER
             return false;
         }
         
+        // compile the ray-casting pixel shader with exact cell-by-cell (DDA) traversal
+        hr = CompileShaderFromFile(L"RayCastingShader.fx", "PS_RAYCASTING_DDA", "ps_5_0", &pPSBlob);
+        if (FAILED(hr))
+        {
+            MessageBox(
+                nullptr,
+                L"The FX file RayCastingShader.fx cannot be compiled.  Please run this executable from the directory that contains the FX file.",
+                L"Error",
+                MB_OK);
+            return false;
+        }
+
+        // create the ray-casting DDA pixel shader
+        hr = pD3DDevice_->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, &pRayCastingDDAPS_);
+        SAFE_RELEASE(pPSBlob);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        // compile the ray-casting pixel shader with brick skipping and temporal seeding
+        hr = CompileShaderFromFile(L"RayCastingShader.fx", "PS_RAYCASTING_SEEDED", "ps_5_0", &pPSBlob);
+        if (FAILED(hr))
+        {
+            MessageBox(
+                nullptr,
+                L"The FX file RayCastingShader.fx cannot be compiled.  Please run this executable from the directory that contains the FX file.",
+                L"Error",
+                MB_OK);
+            return false;
+        }
+
+        // create the seeded ray-casting pixel shader
+        hr = pD3DDevice_->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, &pRayCastingSeededPS_);
+        SAFE_RELEASE(pPSBlob);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        // compile the multi-projection (MIP, MinIP, AIP) ray-casting pixel shader
+        hr = CompileShaderFromFile(L"RayCastingShader.fx", "PS_RAYCASTING_MULTI", "ps_5_0", &pPSBlob);
+        if (FAILED(hr))
+        {
+            MessageBox(
+                nullptr,
+                L"The FX file RayCastingShader.fx cannot be compiled.  Please run this executable from the directory that contains the FX file.",
+                L"Error",
+                MB_OK);
+            return false;
+        }
+
+        // create the multi-projection ray-casting pixel shader
+        hr = pD3DDevice_->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, &pRayCastingMultiPS_);
+        SAFE_RELEASE(pPSBlob);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        // compile the paged (out-of-core) ray-casting pixel shader
+        hr = CompileShaderFromFile(L"RayCastingShader.fx", "PS_RAYCASTING_PAGED", "ps_5_0", &pPSBlob);
+        if (FAILED(hr))
+        {
+            MessageBox(
+                nullptr,
+                L"The FX file RayCastingShader.fx cannot be compiled.  Please run this executable from the directory that contains the FX file.",
+                L"Error",
+                MB_OK);
+            return false;
+        }
+
+        // create the paged ray-casting pixel shader
+        hr = pD3DDevice_->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, &pRayCastingPagedPS_);
+        SAFE_RELEASE(pPSBlob);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        // compile the packed bricks ray-casting pixel shader
+        hr = CompileShaderFromFile(L"RayCastingShader.fx", "PS_RAYCASTING_PACKED", "ps_5_0", &pPSBlob);
+        if (FAILED(hr))
+        {
+            MessageBox(
+                nullptr,
+                L"The FX file RayCastingShader.fx cannot be compiled.  Please run this executable from the directory that contains the FX file.",
+                L"Error",
+                MB_OK);
+            return false;
+        }
+
+        // create the packed bricks ray-casting pixel shader
+        hr = pD3DDevice_->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, &pRayCastingPackedPS_);
+        SAFE_RELEASE(pPSBlob);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        // compile the fused (two volume) ray-casting pixel shader
+        hr = CompileShaderFromFile(L"RayCastingShader.fx", "PS_RAYCASTING_FUSED", "ps_5_0", &pPSBlob);
+        if (FAILED(hr))
+        {
+            MessageBox(
+                nullptr,
+                L"The FX file RayCastingShader.fx cannot be compiled.  Please run this executable from the directory that contains the FX file.",
+                L"Error",
+                MB_OK);
+            return false;
+        }
+
+        // create the fused ray-casting pixel shader
+        hr = pD3DDevice_->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, &pRayCastingFusedPS_);
+        SAFE_RELEASE(pPSBlob);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
         // compile the ray-setup debug pixel shader
         hr = CompileShaderFromFile(L"RayCastingShader.fx", "PS_RAYSETUP", "ps_5_0", &pPSBlob);
         if (FAILED(hr))
@@ -396,6 +592,21 @@ namespace D3D11_VOLUME_RAYCASTER
         return true;
     }
     
+    //------------------------------------------------------------------------------------------------------
+    // Bind vertex buffer, index buffer and input layout of the proxy geometry (bounding cube).
+    // Needs to be called every frame, as other render passes (e.g. point splatting) use their own geometry.
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::bindProxyGeometry(ID3D11DeviceContext* pDeviceContext) const
+    {
+        UINT stride = sizeof(VertexPos);
+        UINT offset = 0;
+        ID3D11Buffer* pVertexBuffer = pVertexBuffer_;
+        pDeviceContext->IASetInputLayout(pVertexLayout_);
+        pDeviceContext->IASetVertexBuffers(0, 1, &pVertexBuffer, &stride, &offset);
+        pDeviceContext->IASetIndexBuffer(pIndexBuffer_, DXGI_FORMAT_R16_UINT, 0);
+        pDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    }
+
     //------------------------------------------------------------------------------------------------------
     // Create constant buffers used to pass uniform data to the shader stages
     //------------------------------------------------------------------------------------------------------
@@ -444,6 +655,19 @@ namespace D3D11_VOLUME_RAYCASTER
             return false;
         }
 
+        // create the constant buffer for the second volume of the fused MIP
+        D3D11_BUFFER_DESC bufferDescFusionPS { 0 };
+        bufferDescFusionPS.Usage = D3D11_USAGE_DEFAULT;
+        bufferDescFusionPS.ByteWidth = sizeof(ConstantBufferFusionPS);
+        bufferDescFusionPS.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        bufferDescFusionPS.CPUAccessFlags = 0;
+
+        hr = pD3DDevice_->CreateBuffer(&bufferDescFusionPS, nullptr, &pConstantBufferFusionPS_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
         return true;
     }
 
@@ -477,76 +701,115 @@ namespace D3D11_VOLUME_RAYCASTER
     }
 
     //------------------------------------------------------------------------------------------------------
-    // Calculate bounding volume scale matrix depending of dimensions of volume raw data
+    // Calculate the projected size of one voxel in pixels at the center of the volume (screen footprint).
+    // The voxel edges along the three volume axes are projected with the actual world-view-projection matrix;
+    // the longest projected edge is returned.
     //------------------------------------------------------------------------------------------------------
-    void RayCastRenderer::calcScaleMatrix(UINT dimX, UINT dimY, UINT dimZ)
+    float RayCastRenderer::calcProjectedVoxelFootprint(const FrameContext& frame)
     {
-        // get the dimension with maximum value - this will map to the max norm value 1.0f
-        UINT maxDimValue = dimX;
-        
-        if (dimY > maxDimValue)
+        UINT volDimensions[3];
+        frame.pVolume->GetDimensions(volDimensions);
+
+        // voxel edge vectors in model space (the unit cube is mapped to the volume by the world matrix)
+        XMVECTOR voxelEdges[3] =
         {
-            maxDimValue = dimY;
-        }
-        if (dimZ > maxDimValue)
+            XMVectorSet(1.0f / volDimensions[0], 0.0f, 0.0f, 1.0f),
+            XMVectorSet(0.0f, 1.0f / volDimensions[1], 0.0f, 1.0f),
+            XMVectorSet(0.0f, 0.0f, 1.0f / volDimensions[2], 1.0f)
+        };
+        
+        XMVECTOR center = XMVector3TransformCoord(XMVectorZero(), frame.matrixWVP);
+        float footprint = 0.0f;
+        for (int axis = 0; axis < 3; axis++)
         {
-            maxDimValue = dimZ;
+            // projected edge in normalized device coordinates (-1.0 .. 1.0) -> pixels
+            XMVECTOR edge = XMVectorSubtract(XMVector3TransformCoord(voxelEdges[axis], frame.matrixWVP), center);
+            float edgeX = 0.5f * XMVectorGetX(edge) * frame.canvasWidth;
+            float edgeY = 0.5f * XMVectorGetY(edge) * frame.canvasHeight;
+            footprint = max(footprint, sqrtf(edgeX * edgeX + edgeY * edgeY));
         }
-        
-        float scaleValues[3] = { 1.0f, 1.0f, 1.0f };
-        scaleValues[0] = static_cast<float>(dimX) / maxDimValue;
-        scaleValues[1] = static_cast<float>(dimY) / maxDimValue;
-        scaleValues[2] = static_cast<float>(dimZ) / maxDimValue;
-        
-        matrixScale_ = XMMatrixScaling(scaleValues[0], scaleValues[1], scaleValues[2]);
+        return footprint;
     }
 
     //------------------------------------------------------------------------------------------------------
-    // Load volume raw data to internal buffer
+    // Select the coarsest volume resolution level whose voxels (2^level voxels of the full resolution) still
+    // project to at most one pixel - distant and thumbnail-sized renders sample fewer, coarser voxels
     //------------------------------------------------------------------------------------------------------
-    bool RayCastRenderer::loadVolumeData(char* dataFileName, UINT volColumns, UINT volRows, UINT volSlices)
+    UINT RayCastRenderer::selectVolumeLod(const FrameContext& frame)
     {
-        bool bRetVal = false;
-        
-        ifstream volDataFile(dataFileName, ifstream::in | ifstream::binary);
-        volColumns_ = volColumns;
-        volRows_ = volRows;
-        volSlices_ = volSlices;
-
-        size_t expectedSize = volColumns_ * volRows_ * volSlices_;
-
-        if (volDataFile)
+        if (!frame.footprintLod)
         {
-            // get length of file 
-            volDataFile.seekg(0, volDataFile.end);
-            size_t length = volDataFile.tellg();
-            volDataFile.seekg(0, volDataFile.beg);
-
-            assert(length == expectedSize);
-
-            pVolumeData_ = new char[length];
-
-            // read data block
-            volDataFile.read(pVolumeData_, length);
+            return 0;
+        }
 
-            if (volDataFile)
-            {
-                bRetVal = true;
-            }
-            volDataFile.close();
+        const float footprint = calcProjectedVoxelFootprint(frame);
+        UINT volumeLod = 0;
+        while (volumeLod + 1 < frame.pVolume->GetLodLevelCount() && footprint * static_cast<float>(2u << volumeLod) <= 1.0f)
+        {
+            volumeLod++;
         }
-        if (bRetVal)
+        return volumeLod;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Fused 3D MIP : the ray setup cube spans the union of the world boxes of both volumes. Get the transform of
+    // the unit-cube to the union box (in unit-cube coordinates of the first volume, applied before the world-view-
+    // projection matrix of the frame), the ray setup to texture coordinate transforms of both volumes and the
+    // intensity mappings.
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::calcFusionTransforms(
+        const FrameContext& frame, 
+        XMMATRIX& matrixUnionBox, 
+        float texCoordScale[3], 
+        float texCoordOffset[3], 
+        ConstantBufferFusionPS& cbFusionPS)
+    {
+        float primaryMin[3], primaryMax[3], fusionMin[3], fusionMax[3];
+        frame.pVolume->GetWorldBounds(primaryMin, primaryMax);
+        frame.pFusionVolume->GetWorldBounds(fusionMin, fusionMax);
+        float primaryScale[3], primaryOffset[3], fusionScale[3], fusionOffset[3];
+        frame.pVolume->GetTexCoordTransform(primaryScale, primaryOffset);
+        frame.pFusionVolume->GetTexCoordTransform(fusionScale, fusionOffset);
+
+        float unionExtent[3], unionCenterInPrimary[3], unionScaleInPrimary[3];
+        for (int axis = 0; axis < 3; axis++)
         {
-            calcScaleMatrix(volColumns_, volRows_, volSlices_);
+            const float unionMin = min(primaryMin[axis], fusionMin[axis]);
+            const float unionMax = max(primaryMax[axis], fusionMax[axis]);
+            const float primaryExtent = primaryMax[axis] - primaryMin[axis];
+            const float fusionExtent = fusionMax[axis] - fusionMin[axis];
+            unionExtent[axis] = unionMax - unionMin;
+            unionScaleInPrimary[axis] = unionExtent[axis] / primaryExtent;
+            unionCenterInPrimary[axis] = (0.5f * (unionMin + unionMax) - 0.5f * (primaryMin[axis] + primaryMax[axis])) / primaryExtent;
+
+            // ray setup coordinate s (0 .. 1 over the union box) -> (s * unionExtent + unionMin - volumeMin) / volumeExtent
+            // -> texture coordinates of the (slab of the) volume
+            texCoordScale[axis] = unionExtent[axis] / primaryExtent * primaryScale[axis];
+            texCoordOffset[axis] = (unionMin - primaryMin[axis]) / primaryExtent * primaryScale[axis] + primaryOffset[axis];
+            cbFusionPS.fusionTexCoordScale[axis] = unionExtent[axis] / fusionExtent * fusionScale[axis];
+            cbFusionPS.fusionTexCoordOffset[axis] = (unionMin - fusionMin[axis]) / fusionExtent * fusionScale[axis] + fusionOffset[axis];
         }
-        else
+        matrixUnionBox = XMMatrixScaling(unionScaleInPrimary[0], unionScaleInPrimary[1], unionScaleInPrimary[2]) *
+            XMMatrixTranslation(unionCenterInPrimary[0], unionCenterInPrimary[1], unionCenterInPrimary[2]);
+
+        UINT fusionDimensions[3], fusionBrickGridDimensions[3];
+        frame.pFusionVolume->GetLevelDimensions(0, fusionDimensions);
+        frame.pFusionVolume->GetBrickGridDimensions(fusionBrickGridDimensions);
+        for (int axis = 0; axis < 3; axis++)
         {
-            matrixScale_ = XMMatrixIdentity();
+            cbFusionPS.fusionVolumeDimensions[axis] = static_cast<float>(fusionDimensions[axis]);
+            cbFusionPS.fusionBrickGridDimensions[axis] = static_cast<float>(fusionBrickGridDimensions[axis]);
         }
-        
-        return bRetVal;
+
+        // saturate((value - center) / width + 0.5) = saturate(value * scale + offset)
+        const float primaryWidth = max(frame.primaryIntensity.windowWidth, 1.0f / 65535.0f);
+        const float fusionWidth = max(frame.fusionIntensity.windowWidth, 1.0f / 65535.0f);
+        cbFusionPS.primaryIntensityScale = 1.0f / primaryWidth;
+        cbFusionPS.primaryIntensityOffset = 0.5f - frame.primaryIntensity.windowCenter / primaryWidth;
+        cbFusionPS.fusionIntensityScale = 1.0f / fusionWidth;
+        cbFusionPS.fusionIntensityOffset = 0.5f - frame.fusionIntensity.windowCenter / fusionWidth;
     }
-    
+
     //------------------------------------------------------------------------------------------------------
     // Create pipeline state objects for the fixed-function units of the Direct3D 11 pipeline
     //------------------------------------------------------------------------------------------------------
@@ -609,60 +872,36 @@ namespace D3D11_VOLUME_RAYCASTER
             return false;
         }
 
-        return true;
-    }
-
-    //------------------------------------------------------------------------------------------------------
-    // Create 3D texture for volume raw data        
-    //------------------------------------------------------------------------------------------------------
-    bool RayCastRenderer::createVolumeTexture()
-    {
-        HRESULT hr = S_OK;
-        
-        assert(pD3DDevice_);
-        assert(pVolumeData_);
-
-        // create 3D texture for volume data
-        D3D11_TEXTURE3D_DESC texDesc { 0 };
-        texDesc.Width = volColumns_;
-        texDesc.Height = volRows_;
-        texDesc.Depth = volSlices_;
-        texDesc.MipLevels = 1;
-        texDesc.Format = DXGI_FORMAT_R8_UNORM;
-        texDesc.Usage = D3D11_USAGE_DEFAULT;
-        texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-        texDesc.CPUAccessFlags = 0;
-        texDesc.MiscFlags = 0;
-
-        // initialize texel data with loaded volume raw data
-        D3D11_SUBRESOURCE_DATA tex3DRawData { 0 };
-        tex3DRawData.pSysMem = pVolumeData_;
-        tex3DRawData.SysMemPitch = volColumns_;                 // -> row pitch in bytes
-        tex3DRawData.SysMemSlicePitch = volRows_ * volColumns_; // -> slice pitch in bytes
-
-        hr = pD3DDevice_->CreateTexture3D(&texDesc, &tex3DRawData, &p3DTexture_);
+        // create blend state keeping the per-pixel maximum (MIP of a partitioned volume - one pass per partition)
+        D3D11_BLEND_DESC blendDesc;
+        ZeroMemory(&blendDesc, sizeof(D3D11_BLEND_DESC));
+        blendDesc.RenderTarget[0].BlendEnable = TRUE;
+        blendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
+        blendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_ONE;
+        blendDesc.RenderTarget[0].BlendOp = D3D11_BLEND_OP_MAX;
+        blendDesc.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+        blendDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ONE;
+        blendDesc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_MAX;
+        blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+
+        hr = pD3DDevice_->CreateBlendState(&blendDesc, &pMaxBlendState_);
         if (FAILED(hr))
         {
             return false;
         }
 
-        // loaded raw data buffer can be deleted now 
-        SAFE_DELETE_ARRAY(pVolumeData_);
-
         return true;
     }
 
     //------------------------------------------------------------------------------------------------------
-    // Create texture and corresponding sampler state objects
+    // Create sampler state objects
     //------------------------------------------------------------------------------------------------------
-    bool RayCastRenderer::createTextureAndSamplerObjects()
+    bool RayCastRenderer::createSamplerStates()
     {
         HRESULT hr = S_OK;
 
         assert(pD3DDevice_);
 
-        if (!createVolumeTexture()) return false;
-
         // create texture sampler state
         D3D11_SAMPLER_DESC samplerDesc;
         ZeroMemory(&samplerDesc, sizeof(D3D11_SAMPLER_DESC));
@@ -686,28 +925,9 @@ namespace D3D11_VOLUME_RAYCASTER
             return false;
         }
         
-        pImmediateContext_->PSSetSamplers(0, 1, &pLinearTexSamplerState_);
-        
         return true;
     }
     
-    //------------------------------------------------------------------------------------------------------
-    // Create shader resource views for volume ray casting
-    //------------------------------------------------------------------------------------------------------
-    bool RayCastRenderer::createRaycastShaderResourceViews()
-    {
-        HRESULT hr = S_OK;
-
-        assert(pD3DDevice_);
-
-        hr = pD3DDevice_->CreateShaderResourceView(p3DTexture_, nullptr, &pRaycastShaderResView_);
-        if (FAILED(hr))
-        {
-            return false;
-        }
-        return true;
-    }
-
     //------------------------------------------------------------------------------------------------------
     // Get the camera distance (= z position of camera)
     //------------------------------------------------------------------------------------------------------
@@ -730,10 +950,11 @@ namespace D3D11_VOLUME_RAYCASTER
 
     //------------------------------------------------------------------------------------------------------
     // GUI callback to get the camera distance
+    // (GUI callbacks run with guiMutex_ held and only edit the UI copy of the render parameters)
     //------------------------------------------------------------------------------------------------------
     void RayCastRenderer::guiCallbackGetCameraDistance(void* value, void* clientData)
     {
-        *static_cast<float*>(value) = static_cast<RayCastRenderer*>(clientData)->GetCameraDistance();
+        *static_cast<float*>(value) = static_cast<RayCastRenderer*>(clientData)->uiParameters_.cameraDistance;
     }
 
     //------------------------------------------------------------------------------------------------------
@@ -741,7 +962,26 @@ namespace D3D11_VOLUME_RAYCASTER
     //------------------------------------------------------------------------------------------------------
     void RayCastRenderer::guiCallbackSetCameraDistance(const void* value, void* clientData)
     {
-        static_cast<RayCastRenderer*>(clientData)->SetCameraDistance(*(const float*)value);
+        static_cast<RayCastRenderer*>(clientData)->uiParameters_.cameraDistance = *(const float*)value;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // GUI callback to get the rotation quaternion (trackball control)
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::guiCallbackGetRotation(void* value, void* clientData)
+    {
+        const RenderParameters& parameters = static_cast<RayCastRenderer*>(clientData)->uiParameters_;
+        memcpy(value, parameters.quatRotation, sizeof(parameters.quatRotation));
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // GUI callback to set the rotation quaternion (trackball control)
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::guiCallbackSetRotation(const void* value, void* clientData)
+    {
+        RenderParameters& parameters = static_cast<RayCastRenderer*>(clientData)->uiParameters_;
+        memcpy(parameters.quatRotation, value, sizeof(parameters.quatRotation));
+        parameters.rotationSerial++;
     }
     
     //------------------------------------------------------------------------------------------------------
@@ -749,10 +989,9 @@ namespace D3D11_VOLUME_RAYCASTER
     //------------------------------------------------------------------------------------------------------
     void RayCastRenderer::guiCallbackBtnDataCTHead(void *clientData)
     {
-        if (!static_cast<RayCastRenderer*>(clientData)->LoadDataset(VOLUME_DATASET::CT_HEAD))
-        {
-            MessageBox(nullptr, L"Unable to load volume dataset CT Head. Ray Casting will fail!", L"Error", MB_OK);
-        }
+        RenderParameters& parameters = static_cast<RayCastRenderer*>(clientData)->uiParameters_;
+        parameters.volumeDataset = VOLUME_DATASET::CT_HEAD;
+        parameters.datasetSerial++;
     }
     
     //------------------------------------------------------------------------------------------------------
@@ -760,10 +999,9 @@ namespace D3D11_VOLUME_RAYCASTER
     //------------------------------------------------------------------------------------------------------
     void RayCastRenderer::guiCallbackBtnDataCTHeadAngio(void *clientData)
     {
-        if (!static_cast<RayCastRenderer*>(clientData)->LoadDataset(VOLUME_DATASET::CT_HEAD_ANGIO))
-        {
-            MessageBox(nullptr, L"Unable to load volume dataset CT Head Angio. Ray Casting will fail!", L"Error", MB_OK);
-        }
+        RenderParameters& parameters = static_cast<RayCastRenderer*>(clientData)->uiParameters_;
+        parameters.volumeDataset = VOLUME_DATASET::CT_HEAD_ANGIO;
+        parameters.datasetSerial++;
     }
 
     //------------------------------------------------------------------------------------------------------
@@ -771,10 +1009,9 @@ namespace D3D11_VOLUME_RAYCASTER
     //------------------------------------------------------------------------------------------------------
     void RayCastRenderer::guiCallbackBtnDataMRAbdomen(void *clientData)
     {
-        if (!static_cast<RayCastRenderer*>(clientData)->LoadDataset(VOLUME_DATASET::MR_ABDOMEN))
-        {
-            MessageBox(nullptr, L"Unable to load volume dataset MR Abdomen. Ray Casting will fail!", L"Error", MB_OK);
-        }
+        RenderParameters& parameters = static_cast<RayCastRenderer*>(clientData)->uiParameters_;
+        parameters.volumeDataset = VOLUME_DATASET::MR_ABDOMEN;
+        parameters.datasetSerial++;
     }
     
     //------------------------------------------------------------------------------------------------------
@@ -782,459 +1019,2210 @@ namespace D3D11_VOLUME_RAYCASTER
     //------------------------------------------------------------------------------------------------------
     void RayCastRenderer::guiCallbackBtnDataMRHeadTOFAngio(void *clientData)
     {
-        if (!static_cast<RayCastRenderer*>(clientData)->LoadDataset(VOLUME_DATASET::MR_HEAD_TOF))
-        {
-            MessageBox(nullptr, L"Unable to load volume dataset MR Head TOF Angio. Ray Casting will fail!", L"Error", MB_OK);
-        }
+        RenderParameters& parameters = static_cast<RayCastRenderer*>(clientData)->uiParameters_;
+        parameters.volumeDataset = VOLUME_DATASET::MR_HEAD_TOF;
+        parameters.datasetSerial++;
     }
     
     //------------------------------------------------------------------------------------------------------
-    // Load given dataset for volume rendering        
+    // GUI callback for button 'Precompute Rotation' click handler -> render one full auto-rotation (about the
+    // selected rotation axes) into the image cache in the background
     //------------------------------------------------------------------------------------------------------
-    bool RayCastRenderer::LoadDataset(VOLUME_DATASET volumeDataset)
+    void RayCastRenderer::guiCallbackBtnPrecomputeRotation(void *clientData)
     {
-        bool retVal = true;
-        
-        // reset world, scale and rotate matrix
-        matrixWorld_ = XMMatrixIdentity();
-        matrixScale_ = XMMatrixIdentity();
-        matrixRotate_ = XMMatrixIdentity();
-        
-        // load volume raw data - scale matrix will be correctly initialized depending on volume dimensions
-        switch (volumeDataset)
-        {
-        case VOLUME_DATASET::CT_HEAD :
-            if (!loadVolumeData("..\\..\\data\\CT_head_c256_r256_s225.raw", 256, 256, 225)) return false;
-            break;
-        case VOLUME_DATASET::CT_HEAD_ANGIO :
-            if (!loadVolumeData("..\\..\\data\\CTA_c512_r512_s79.raw", 512, 512, 79)) return false;
-            break;
-        case VOLUME_DATASET::MR_ABDOMEN :
-            if (!loadVolumeData("..\\..\\data\\MR_abdomen_c384_r512_s80.raw", 384, 512, 80)) return false;
-            break;
-        case VOLUME_DATASET::MR_HEAD_TOF :
-            if (!loadVolumeData("..\\..\\data\\MR_TOF_Angio_c416_r512_s112.raw", 416, 512, 112)) return false;
-            break;
-        default:
-            if (!loadVolumeData("..\\..\\data\\MR_abdomen_c384_r512_s80.raw", 384, 512, 80)) return false;
-            break;
-        }
-        
-        // update world matrix
-        matrixWorld_ *= matrixScale_;
+        RenderParameters& parameters = static_cast<RayCastRenderer*>(clientData)->uiParameters_;
+        parameters.imageCacheEnabled = true;
+        parameters.precomputeRotationSerial++;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // GUI callback for button 'Clear Image Cache' click handler
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::guiCallbackBtnClearImageCache(void *clientData)
+    {
+        static_cast<RayCastRenderer*>(clientData)->uiParameters_.clearImageCacheSerial++;
+    }
 
-        // 3D texture for volume data as well as shader resource view for ray casting shader need to be re-created
-        // -> release these resources first
-        SAFE_RELEASE(p3DTexture_);
-        SAFE_RELEASE(pRaycastShaderResView_);
+    //------------------------------------------------------------------------------------------------------
+    // Fill the image cache with one full auto-rotation (about the selected rotation axes) in the background
+    // (the button enabled the image cache in the same parameter snapshot)
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::precomputeRotation()
+    {
+        // one animation step rotates about x, y and z in turn - for small steps this is a rotation about the sum
+        const float rotationAxis[3] = 
+        { 
+            rotateX_ ? 1.0f : 0.0f, 
+            rotateY_ ? 1.0f : 0.0f, 
+            rotateZ_ ? 1.0f : 0.0f 
+        };
+        imageCache_.SetBudget(static_cast<size_t>(imageCacheBudgetMB_) * 1024 * 1024);
+        if (volumeId_ >= EXTERNAL_VOLUME_ID)
+        {
+            // the precomputation loads the volume on a device of its own - only the demo datasets can be loaded there
+            MessageBox(nullptr, L"Unable to precompute the rotation. Only demo datasets can be precomputed!", L"Error", MB_OK);
+            return;
+        }
+        if (!imageCache_.StartPrecompute(makeImageCacheKey(), rotationAxis))
+        {
+            MessageBox(nullptr, L"Unable to precompute the rotation. Select at least one rotation axis!", L"Error", MB_OK);
+        }
+    }
 
-        // re-create 3D texture
-        if (!createVolumeTexture()) return false;
+    //------------------------------------------------------------------------------------------------------
+    // Load given dataset for volume rendering        
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::LoadDataset(VOLUME_DATASET volumeDataset)
+    {
+        if (pDistributedRenderer_)
+        {
+            // distributed rendering : the worker processes load their slabs with the next frame request
+            currentDataset_ = volumeDataset;
+            return true;
+        }
 
-        // re-create shader resource view
-        if (!createRaycastShaderResourceViews()) return false;
-        
-        return retVal;
+        const VolumeDatasetInfo& datasetInfo = GetVolumeDatasetInfo(volumeDataset);
+        return LoadDatasetSlab(volumeDataset, 0, datasetInfo.volSlices);
     }
 
     //------------------------------------------------------------------------------------------------------
-    // Initialize GUI controls
+    // Load given dataset progressively : the volume is rendered from the first slice chunk on while the
+    // loader thread reads the remaining slices. Once all slices are read the complete volume (resolution
+    // levels, sparse voxel list) is created through the volume library and replaces the streamed volume.
     //------------------------------------------------------------------------------------------------------
-    bool RayCastRenderer::initGUI()
+    bool RayCastRenderer::LoadDatasetStreaming(VOLUME_DATASET volumeDataset)
     {
-        bool retVal = true;
+        if (nullptr == pD3DDevice_) return false;
+        if (pDistributedRenderer_)
+        {
+            return LoadDataset(volumeDataset);
+        }
 
-        // initialize AntTweakBar which provides UI controls in combination with Direct3D 11 rendering context
-        // see http://anttweakbar.sourceforge.net/doc/
-        if (!TwInit(TW_DIRECT3D11, pD3DDevice_))
+        volumeStreamer_.Stop();
+
+        // resident datasets need no loading (a new vessel threshold only builds the sparse voxel list)
+        VolumeHandle volume;
+        if (volumeLibrary_.IsResident(volumeDataset, volumeStorage_))
+        {
+            if (!AcquireVolume(volumeDataset, volume))
+            {
+                return false;
+            }
+            brickPagingPass_.Release();
+            useVolume(std::move(volume), volumeDataset);
+            return true;
+        }
+
+        const VolumeDatasetInfo& datasetInfo = GetVolumeDatasetInfo(volumeDataset);
+        const VOLUME_STORAGE storage = volumeStorage_;
+        const UINT sparseThreshold = sparseThreshold_;
+        auto acquireComplete = [this, volumeDataset, storage, sparseThreshold](VolumeHandle& completeVolume)
+        {
+            return volumeLibrary_.Acquire(pD3DDevice_, volumeDataset, storage, sparseThreshold, completeVolume);
+        };
+        if (!volumeStreamer_.Start(pD3DDevice_, pImmediateContext_, datasetInfo, GetNativeVoxelFormat(datasetInfo), acquireComplete, volume))
+        {
+            // not streamable (partitioned volume) - load it at once
+            return LoadDataset(volumeDataset);
+        }
+        brickPagingPass_.Release();
+        useVolume(std::move(volume), volumeDataset);
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Load only the slab [sliceBegin, sliceEnd) of the given dataset - renders the partial MIP of the slab
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::LoadDatasetSlab(VOLUME_DATASET volumeDataset, UINT sliceBegin, UINT sliceEnd)
+    {
+        if (nullptr == pD3DDevice_) return false;
+
+        // full volumes are shared through the volume library, slabs are private to the renderer
+        const VolumeDatasetInfo& datasetInfo = GetVolumeDatasetInfo(volumeDataset);
+        VolumeHandle volume;
+        bool volumeLoaded = false;
+        if (0 == sliceBegin && datasetInfo.volSlices == sliceEnd)
+        {
+            volumeLoaded = AcquireVolume(volumeDataset, volume);
+        }
+        else
+        {
+            volumeLoaded = VolumeResource::Create(
+                pD3DDevice_,
+                datasetInfo,
+                sliceBegin,
+                sliceEnd,
+                GetNativeVoxelFormat(datasetInfo),
+                volumeStorage_,
+                sparseThreshold_,
+                volume);
+        }
+        if (!volumeLoaded)
         {
             return false;
         }
+        volumeStreamer_.Stop();
+        brickPagingPass_.Release();
+        useVolume(std::move(volume), volumeDataset);
 
-        // provide window canvas dimensions to GUI system
-        TwWindowSize(canvasWidth_, canvasHeight_);
+        return true;
+    }
 
-        // create a tweak bar
-        TwBar *guiBar = TwNewBar("Settings");
-        TwDefine(" GLOBAL help='Ray-Caster Renderer Test Viewer' "); // message added to the help bar
-        int guiBarSize[2] = { 300, 520 };
-        TwSetParam(guiBar, nullptr, "size", TW_PARAM_INT32, 2, guiBarSize);
-        
-        // rendering settings
-        TwAddVarRW(guiBar, "Wireframe Mode", TW_TYPE_BOOLCPP, &renderWireframe_, "group=Rendering key=w");
-        TwAddVarRW(guiBar, "Disable Culling", TW_TYPE_BOOLCPP, &disableCulling_, "group=Rendering key=c");
-        TwAddSeparator(guiBar, nullptr, "group=Rendering");
-        TwAddVarRW(guiBar, "Render Mode", TW_TYPE_UINT32, &renderMode_, "group=Rendering min=0 max=3 keyincr=Right keydecr=Left");
-        TwAddButton(guiBar, "CommentRenderMode", nullptr, nullptr, "label='0=MIP,1=Front-Faces,2=Back-Faces,3=Ray Direction' group=Rendering");
-        TwAddSeparator(guiBar, nullptr, "group=Rendering");
-        TwAddVarCB(
-            guiBar, 
-            "Camera Distance", 
-            TW_TYPE_FLOAT, 
-            guiCallbackSetCameraDistance, 
-            guiCallbackGetCameraDistance, 
-            this, 
-            "group=Rendering min=-6 max=-0.75 step=0.01 keyincr=+ keydecr=-");
-        TwAddSeparator(guiBar, nullptr, nullptr);
-        // raycasting settings
-        TwAddVarRW(guiBar, "Sampling Step Size", TW_TYPE_FLOAT, &raycastStepSize_, "group=Ray-Casting min=0.0001 max=0.1 step=0.0001");
-        TwAddVarRW(guiBar, "Maximum Samples per Ray", TW_TYPE_UINT32, &raycastMaxSamples_, "group=Ray-Casting min=10 max=800");
-        TwAddSeparator(guiBar, nullptr, nullptr);
-        // animation settings
-        TwAddVarRW(guiBar, "Animate", TW_TYPE_BOOLCPP, &doAnimation_, "group=Animation key=a");
-        TwAddVarRW(guiBar, "Animation Speed", TW_TYPE_FLOAT, &animationSpeed_, "group=Animation min=0.0 max=4.0 step=0.01 keyincr=Up keydecr=Down");
-        TwAddVarRW(guiBar, "Target Frame-Rate (FPS)", TW_TYPE_UINT32, &targetFPS_, "group=Animation min=5 max=120");
-        TwAddVarRW(guiBar, "Lock to Target Frame-Rate", TW_TYPE_BOOLCPP, &lockToTargetFPS_, "group=Animation key=l");
-        TwAddVarRW(guiBar, "Rotation", TW_TYPE_QUAT4F, &quatRotation_, "opened=true axisz=-z group=Animation");
-        TwAddVarRW(guiBar, "Rotate X", TW_TYPE_BOOLCPP, &rotateX_, "group=Animation key=x");
-        TwAddVarRW(guiBar, "Rotate Y", TW_TYPE_BOOLCPP, &rotateY_, "group=Animation key=y");
-        TwAddVarRW(guiBar, "Rotate Z", TW_TYPE_BOOLCPP, &rotateZ_, "group=Animation key=z");
-        TwAddSeparator(guiBar, nullptr, nullptr);
-        // dataset settings
-        TwAddButton(guiBar, "CTHead", guiCallbackBtnDataCTHead, this, "group=Dataset label='CT Head'");
-        TwAddButton(guiBar, "CTHeadAngio", guiCallbackBtnDataCTHeadAngio, this, "group=Dataset label='CT Head Angio'");
-        TwAddButton(guiBar, "MRAbdomen", guiCallbackBtnDataMRAbdomen, this, "group=Dataset label='MR Abdomen'");
-        TwAddButton(guiBar, "MRHeadTOF", guiCallbackBtnDataMRHeadTOFAngio, this, "group=Dataset label='MR Head TOF Angio'");
+    //------------------------------------------------------------------------------------------------------
+    // Load the given dataset with the given voxel format and storage (private copy - not shared through the volume 
+    // library)
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::LoadDatasetAs(VOLUME_DATASET volumeDataset, VOXEL_FORMAT voxelFormat, VOLUME_STORAGE storage)
+    {
+        if (nullptr == pD3DDevice_) return false;
 
-        return retVal;
+        const VolumeDatasetInfo& datasetInfo = GetVolumeDatasetInfo(volumeDataset);
+        VolumeHandle volume;
+        if (!VolumeResource::Create(pD3DDevice_, datasetInfo, 0, datasetInfo.volSlices, voxelFormat, storage, sparseThreshold_, volume))
+        {
+            return false;
+        }
+        volumeStreamer_.Stop();
+        brickPagingPass_.Release();
+        useVolume(std::move(volume), volumeDataset);
+
+        return true;
     }
 
     //------------------------------------------------------------------------------------------------------
-    // Initialize Ray-Caster renderer - create Direct3D device and swap chain
+    // Page the bricks of a bricked volume file (see BrickedVolume::Convert) into a brick pool of at most 
+    // poolBudget bytes. The volume texture holds the coarse level of the file - rays fall back to it for 
+    // bricks that are not resident yet.
     //------------------------------------------------------------------------------------------------------
-    bool RayCastRenderer::Initialize(HWND canvasHWND)
+    bool RayCastRenderer::LoadPagedDataset(const char* brickedFileName, UINT64 poolBudget)
     {
-        HRESULT hr = S_OK;
-        
-        if (!loadVolumeData("..\\..\\data\\MR_TOF_Angio_c416_r512_s112.raw", 416, 512, 112))
+        if (nullptr == pD3DDevice_ || pDistributedRenderer_) return false;
+
+        volumeStreamer_.Stop();
+        if (!brickPagingPass_.Initialize(pD3DDevice_, brickedFileName, poolBudget))
         {
-            MessageBox(
-                nullptr,
-                L"Unable to load volume raw data. Ray Casting will fail!",
-                L"Error",
-                MB_OK
-            );
+            brickPagingPass_.Release();
+            return false;
         }
-        
-        // store window handle of rendering canvas
-        canvasHWND_ = canvasHWND;
 
-        RECT rc;
-        GetClientRect(canvasHWND_, &rc);
-        UINT _canvasWidth = rc.right - rc.left;
-        UINT _canvasHeight = rc.bottom - rc.top;
-        
-        // create Direct3D device, device context and DXGI swapchain
-        if (!createDeviceAndSwapChain()) return false;
-        
-        // create a render target view
-        if (!createAndBindRenderTargetView()) return false;
+        // coarse fallback level - private to the renderer
+        const VolumeDatasetInfo& coarseInfo = brickPagingPass_.GetBrickedVolume().GetCoarseDatasetInfo();
+        VolumeHandle volume;
+        if (!VolumeResource::Create(pD3DDevice_, coarseInfo, 0, coarseInfo.volSlices, GetNativeVoxelFormat(coarseInfo), VOLUME_STORAGE::TEXTURE, sparseThreshold_, volume))
+        {
+            brickPagingPass_.Release();
+            return false;
+        }
+        useExternalVolume(std::move(volume));
 
-        // set initial viewport
-        setViewport();
+        // the world box follows the full resolution dimensions (the coarse level is rounded up) and the voxel spacing
+        const BrickedVolumeHeader& header = brickPagingPass_.GetBrickedVolume().GetHeader();
+        const float volDimensions[3] = 
+        {
+            header.volDimensions[0] * header.voxelSpacing[0],
+            header.volDimensions[1] * header.voxelSpacing[1],
+            header.volDimensions[2] * header.voxelSpacing[2]
+        };
+        const float maxDimValue = max(max(volDimensions[0], volDimensions[1]), volDimensions[2]);
+        matrixWorld_ = XMMatrixScaling(volDimensions[0] / maxDimValue, volDimensions[1] / maxDimValue, volDimensions[2] / maxDimValue);
+        calcWorldViewProjectionMatrix();
 
-        // create vertex-shader, pixel-shader and input layout
-        if (!createShaderObjectsAndInputLayout()) return false;
+        return true;
+    }
 
-        // setup geometry : create vertex and index buffer for indexed rendering
-        if (!createVertexAndIndexBuffer()) return false;
+    //------------------------------------------------------------------------------------------------------
+    // Load a raw volume file of the given description. Unlike the demo datasets the volume may exceed the
+    // 3D texture limits - it is partitioned then (see VolumeResource::Create).
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::LoadRawVolume(const VolumeDatasetInfo& datasetInfo)
+    {
+        if (nullptr == pD3DDevice_ || pDistributedRenderer_) return false;
+        if (nullptr == datasetInfo.fileName || 0 == datasetInfo.volColumns || 0 == datasetInfo.volRows || 0 == datasetInfo.volSlices ||
+            datasetInfo.bitsStored < 8 || datasetInfo.bitsStored > 16)
+        {
+            return false;
+        }
+        for (int axis = 0; axis < 3; axis++)
+        {
+            if (!(datasetInfo.voxelSpacing[axis] > 0.0f))
+            {
+                return false;
+            }
+        }
 
-        // create constant buffers used for passing uniform data to shader stages
-        if (!createConstantBuffers()) return false;
-        
-        // create pipeline state objects for the fixed-function units of the D3D11 pipeline 
-        if (!createPipelineStateObjects()) return false;
+        VolumeHandle volume;
+        if (!VolumeResource::Create(
+            pD3DDevice_, 
+            datasetInfo, 
+            0, 
+            datasetInfo.volSlices, 
+            GetNativeVoxelFormat(datasetInfo), 
+            VOLUME_STORAGE::TEXTURE, 
+            sparseThreshold_, 
+            volume))
+        {
+            return false;
+        }
+        volumeStreamer_.Stop();
+        brickPagingPass_.Release();
+        useExternalVolume(std::move(volume));
 
-        // create all textures with corresponding sampler states
-        if (!createTextureAndSamplerObjects()) return false;
-        
-        // create the shader resource view for ray casting through the volume data
-        if (!createRaycastShaderResourceViews()) return false;
+        return true;
+    }
 
-        // setup transformation matrices ...
-        // note : we work with a left-handed coordinate system
-        // -> matrices are row-major aligned
-        // -> polygon definition in clockwise (CW) order means front-face; backface culling is ON per default
-        // NOTE : HLSL expects column-major aligned matrices; that's why all matrices are transposed before
-        //        they are passed to the vertex shader
+    //------------------------------------------------------------------------------------------------------
+    // Load the DICOM series in the given directory : the series is ingested in parallel into one volume
+    // buffer (see DicomSeries), which is uploaded like a raw file
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::LoadDicomSeries(const char* directory)
+    {
+        if (nullptr == pD3DDevice_ || pDistributedRenderer_) return false;
 
-        // initialize world-view-projection matrix
-        matrixWVP_ = XMMatrixIdentity();
-        // initialize the world matrix
-        matrixWorld_ = XMMatrixIdentity();
-        // scale the unit cube to volume boundaries
-        matrixWorld_ *= matrixScale_;
-        // initialize rotation matrix
-        matrixRotate_ = XMMatrixIdentity();
+        DicomSeries dicomSeries;
+        if (!dicomSeries.Load(directory))
+        {
+            return false;
+        }
+        const VolumeDatasetInfo& datasetInfo = dicomSeries.GetDatasetInfo();
+        VolumeHandle volume;
+        if (!VolumeResource::CreateFromMemory(
+            pD3DDevice_, 
+            datasetInfo, 
+            dicomSeries.GetVolumeData(), 
+            GetNativeVoxelFormat(datasetInfo), 
+            VOLUME_STORAGE::TEXTURE, 
+            sparseThreshold_, 
+            volume))
+        {
+            return false;
+        }
+        volumeStreamer_.Stop();
+        brickPagingPass_.Release();
+        useExternalVolume(std::move(volume));
 
-        // initialize the view matrix with initial camera distance
-        setViewMatrix(cameraDistance_);
+        return true;
+    }
 
-        // initialize the projection matrix
-        setProjectionMatrix();
-        // update world-view-projection matrix
-        calcWorldViewProjectionMatrix();
-        
-        // initialize the ray setup controller which renders cube back-faces and front-faces to separate render targets
-        if (!raySetupPass_.Initialize(pD3DDevice_, _canvasWidth, _canvasHeight)) return false;
-        
-        // initialize rotation quaternion to identity
-        quatRotation_[0] = 0.0f;
-        quatRotation_[1] = 0.0f;
-        quatRotation_[2] = 0.0f;
-        quatRotation_[3] = 1.0f;
-        
-        // initialize GUI
-        if (!initGUI())
+    //------------------------------------------------------------------------------------------------------
+    // Load a live volume : an updatable volume whose regions are replaced while it is rendered. Updates are
+    // queued by UpdateVolumeRegion() and applied by the render thread (Update()); each one only recomputes 
+    // and uploads the parts of the resolution levels and of the brick max grid covering its region.
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::LoadLiveVolume(const VolumeDatasetInfo& datasetInfo, const std::vector<char>* pVolumeData)
+    {
+        if (nullptr == pD3DDevice_ || pDistributedRenderer_) return false;
+
+        std::shared_ptr<VolumeResource> pLiveVolume;
+        if (!VolumeResource::CreateUpdatable(pD3DDevice_, datasetInfo, pVolumeData, GetNativeVoxelFormat(datasetInfo), pLiveVolume))
         {
             return false;
         }
+        volumeStreamer_.Stop();
+        brickPagingPass_.Release();
+        useExternalVolume(VolumeHandle(pLiveVolume));
 
-        // finally initialize performance counters
-        QueryPerformanceFrequency(&perfCounterFreq_);
-        QueryPerformanceCounter(&lastPerfCounter_);
+        std::lock_guard<std::mutex> updateLock(liveUpdateMutex_);
+        pLiveVolume_ = std::move(pLiveVolume);
+        liveDatasetInfo_ = datasetInfo;
+        liveDatasetInfo_.fileName = nullptr;
+        liveVolumeGeneration_++;
+        liveUpdates_.clear();
 
         return true;
     }
-    
+
     //------------------------------------------------------------------------------------------------------
-    // Release all allocated resources 
+    // Queue the replacement of the box [regionBegin, regionEnd) of the live volume (thread-safe). The voxels
+    // are converted to the storage format here, so the render thread only copies and uploads them. A queued
+    // update of the same box is superseded; a full queue rejects the update (the render thread falls behind).
     //------------------------------------------------------------------------------------------------------
-    void RayCastRenderer::Release()
+    bool RayCastRenderer::UpdateVolumeRegion(const UINT regionBegin[3], const UINT regionEnd[3], const char* pRegionData)
     {
-        // release GUI resources
-        TwTerminate();
-        // reset pipeline state
-        if (pImmediateContext_) pImmediateContext_->ClearState();
-        // rlease resources of ray setup controller
-        raySetupPass_.Release();
-        // release Direct3D COM objects ...
-        SAFE_RELEASE(pRaycastShaderResView_);
-        SAFE_RELEASE(pLinearTexSamplerState_);
-        SAFE_RELEASE(p3DTexture_);
-        SAFE_RELEASE(pSolidNoCullingRS_);
-        SAFE_RELEASE(pSolidRS_);
-        SAFE_RELEASE(pWireFrameNoCullingRS_);
-        SAFE_RELEASE(pWireFrameRS_);
-        SAFE_RELEASE(pConstantBufferDebugPS_);
-        SAFE_RELEASE(pConstantBufferPS_);
-        SAFE_RELEASE(pConstantBufferVS_);
-        SAFE_RELEASE(pVertexBuffer_);
-        SAFE_RELEASE(pIndexBuffer_);
-        SAFE_RELEASE(pVertexLayout_);
-        SAFE_RELEASE(pRayCastingVS_);
-        SAFE_RELEASE(pRayCastingPS_);
-        SAFE_RELEASE(pRaySetupDebugPS_);
-        SAFE_RELEASE(pRenderTargetView_);
-        SAFE_RELEASE(pSwapChain_);
-        SAFE_RELEASE(pImmediateContext_);
-        SAFE_RELEASE(pD3DDevice_);
-        // release internal buffer and other resources
-        SAFE_DELETE_ARRAY(pVolumeData_);
+        LiveVolumeUpdate update;
+        VolumeDatasetInfo datasetInfo;
+        {
+            std::lock_guard<std::mutex> updateLock(liveUpdateMutex_);
+            datasetInfo = liveDatasetInfo_;
+            update.generation = liveVolumeGeneration_;
+        }
+        const UINT volDimensions[3] = { datasetInfo.volColumns, datasetInfo.volRows, datasetInfo.volSlices };
+        size_t regionVoxels = 1;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            if (regionBegin[axis] >= regionEnd[axis] || regionEnd[axis] > volDimensions[axis])
+            {
+                // no live volume or invalid region
+                return false;
+            }
+            update.regionBegin[axis] = regionBegin[axis];
+            update.regionEnd[axis] = regionEnd[axis];
+            regionVoxels *= regionEnd[axis] - regionBegin[axis];
+        }
+        const size_t fileBytesPerVoxel = (datasetInfo.bitsStored > 8) ? 2 : 1;
+        update.regionData.assign(pRegionData, pRegionData + regionVoxels * fileBytesPerVoxel);
+        VolumeResource::ConvertVoxels(datasetInfo, GetNativeVoxelFormat(datasetInfo), update.regionData);
+
+        std::lock_guard<std::mutex> updateLock(liveUpdateMutex_);
+        if (0 == liveDatasetInfo_.volColumns || update.generation != liveVolumeGeneration_)
+        {
+            // the live volume was replaced meanwhile
+            return false;
+        }
+        auto sameRegion = [&update](const LiveVolumeUpdate& queued)
+        {
+            return 0 == memcmp(queued.regionBegin, update.regionBegin, sizeof(update.regionBegin)) && 
+                   0 == memcmp(queued.regionEnd, update.regionEnd, sizeof(update.regionEnd));
+        };
+        liveUpdates_.erase(std::remove_if(liveUpdates_.begin(), liveUpdates_.end(), sameRegion), liveUpdates_.end());
+        if (liveUpdates_.size() >= MAX_QUEUED_LIVE_UPDATES)
+        {
+            return false;
+        }
+        liveUpdates_.push_back(std::move(update));
+
+        return true;
     }
 
     //------------------------------------------------------------------------------------------------------
-    // Update hook (timing, animation, ...)
+    // Apply the queued region updates to the live volume (render thread). The live volume is dropped once
+    // another volume replaced it; updates queued for a previous live volume are skipped. The live volume keeps
+    // its image cache identity - the cached images of the previous content are removed.
     //------------------------------------------------------------------------------------------------------
-    void RayCastRenderer::Update()
+    void RayCastRenderer::applyLiveUpdates()
     {
-        if (nullptr == pImmediateContext_ || nullptr == pD3DDevice_ || IsIconic(canvasHWND_))
+        std::shared_ptr<VolumeResource> pLiveVolume;
+        std::deque<LiveVolumeUpdate> liveUpdates;
+        UINT64 liveVolumeGeneration = 0;
+        {
+            std::lock_guard<std::mutex> updateLock(liveUpdateMutex_);
+            if (!volume_ || volume_.operator->() != pLiveVolume_.get())
+            {
+                pLiveVolume_.reset();
+                liveDatasetInfo_ = { nullptr, 0, 0, 0, 8, { 1.0f, 1.0f, 1.0f } };
+                liveVolumeGeneration_++;
+                liveUpdates_.clear();
+                return;
+            }
+            pLiveVolume = pLiveVolume_;
+            liveVolumeGeneration = liveVolumeGeneration_;
+            liveUpdates.swap(liveUpdates_);
+        }
+        bool volumeUpdated = false;
+        for (const LiveVolumeUpdate& update : liveUpdates)
+        {
+            if (update.generation != liveVolumeGeneration)
+            {
+                continue;
+            }
+            if (pLiveVolume->UpdateRegion(pImmediateContext_, update.regionBegin, update.regionEnd, update.regionData.data(), update.regionData.size()))
+            {
+                volumeUpdated = true;
+            }
+        }
+        if (volumeUpdated)
+        {
+            mipImageValid_ = false;
+            imageCache_.RemoveVolume(volumeId_);
+            for (ImageCacheReadback& readback : imageCacheReadbacks_)
+            {
+                if (readback.pending && readback.key.volumeDataset == volumeId_)
+                {
+                    // rendered before the update
+                    readback.pending = false;
+                }
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Load a second, co-registered dataset - the 3D MIP takes the maximum over both volumes in one traversal.
+    // Both volumes keep their own world box (scale); the ray setup spans the union of both boxes.
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::LoadFusionDataset(VOLUME_DATASET volumeDataset)
+    {
+        if (nullptr == pD3DDevice_) return false;
+
+        // the fused MIP samples the texture of the fusion volume - always a 3D texture, whatever the storage of the demo datasets
+        VolumeHandle volume;
+        if (!volumeLibrary_.Acquire(pD3DDevice_, volumeDataset, VOLUME_STORAGE::TEXTURE, sparseThreshold_, volume))
+        {
+            return false;
+        }
+        if (volume->GetPartitionCount() > 1)
+        {
+            // the fused MIP samples both volume textures in one traversal - not possible for a partitioned volume
+            return false;
+        }
+        fusionVolume_ = std::move(volume);
+        mipImageValid_ = false;
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Remove the second dataset (single volume 3D MIP)
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::ClearFusionDataset()
+    {
+        fusionVolume_.Reset();
+        mipImageValid_ = false;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Set the intensity mappings of the volumes of the fused 3D MIP
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::SetIntensityMappings(const IntensityMapping& primaryIntensity, const IntensityMapping& fusionIntensity)
+    {
+        primaryIntensity_ = primaryIntensity;
+        fusionIntensity_ = fusionIntensity;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Make the given volume the rendered volume and reset the world and rotation matrix
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::useVolume(VolumeHandle&& volume, VOLUME_DATASET volumeDataset)
+    {
+        // the previous volume is released with its last handle
+        volume_ = std::move(volume);
+        currentDataset_ = volumeDataset;
+        volumeId_ = static_cast<UINT>(volumeDataset);
+        mipImageValid_ = false;
+
+        // reset world and rotate matrix - the world matrix maps the unit-cube to the (slab of the) volume
+        matrixWorld_ = volume_->GetWorldMatrix();
+        if (!offscreenMode_)
+        {
+            // offscreen rendering : rotation is controlled by the caller
+            matrixRotate_ = XMMatrixIdentity();
+        }
+        calcWorldViewProjectionMatrix();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Make the given volume of no demo dataset the rendered volume : the current dataset is kept (distributed
+    // rendering, reload), the image cache key gets an identity no other volume had
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::useExternalVolume(VolumeHandle&& volume)
+    {
+        useVolume(std::move(volume), currentDataset_);
+        volumeId_ = EXTERNAL_VOLUME_ID + externalVolumeCount_++;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Can the given volume be shown in the given render mode : the multi-projection shader samples the volume
+    // texture, packed volumes have none
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::isRenderModeAvailable(const VolumeResource* pVolume, UINT renderMode)
+    {
+        if (nullptr == pVolume) return true;
+        if (pVolume->GetPartitionCount() > 1 && (4 == renderMode || 5 == renderMode)) return false;
+        return !(VOLUME_STORAGE::PACKED_BRICKS == pVolume->GetStorage() && 5 == renderMode);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the rotation quaternion (x, y, z, w)
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::GetRotation(float quaternion[4])
+    {
+        for (int idx = 0; idx < 4; idx++)
+        {
+            quaternion[idx] = quatRotation_[idx];
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Set the rotation quaternion (x, y, z, w) - disables auto-rotation
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::SetRotation(const float quaternion[4])
+    {
+        for (int idx = 0; idx < 4; idx++)
+        {
+            quatRotation_[idx] = quaternion[idx];
+        }
+        doAnimation_ = false;
+        
+        // update rotation matrix from rotation quaternion
+        matrixRotate_ = XMMatrixRotationQuaternion(XMVectorSet(quatRotation_[0], quatRotation_[1], quatRotation_[2], quatRotation_[3]));
+        calcWorldViewProjectionMatrix();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Set ray casting parameters : sampling step size, maximum samples per ray and traversal mode
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::SetRaycastParameters(float raycastStepSize, UINT raycastMaxSamples, UINT raycastTraversal)
+    {
+        raycastStepSize_ = raycastStepSize;
+        raycastMaxSamples_ = raycastMaxSamples;
+        raycastTraversal_ = raycastTraversal;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Set the mapping of the MIP values to display gray values (window/level, gamma, inversion)
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::SetDisplayMapping(const DisplayMapping& displayMapping)
+    {
+        displayMapping_ = displayMapping;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Enable adaptive image-space refinement with the given gray value threshold
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::SetAdaptiveRefinement(bool enabled, float refineThreshold)
+    {
+        adaptiveRefinement_ = enabled;
+        refineThreshold_ = refineThreshold;
+    }
+
+    const AdaptiveRefinementStats& RayCastRenderer::GetAdaptiveRefinementStats() const
+    {
+        return refinementPass_.GetStats();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the GPU memory of the loaded volume (all levels and acceleration structures) in bytes
+    //------------------------------------------------------------------------------------------------------
+    size_t RayCastRenderer::GetVolumeMemorySize() const
+    {
+        return volume_ ? volume_->GetMemorySize() : 0;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Enable sort-last distributed rendering across the given number of worker processes.
+    // Every worker process loads and ray-casts one slab of the volume; the workers composite the partial
+    // MIP images with a per-pixel max (tree reduction over their sockets, MIP compositing is order
+    // independent). Fails if a worker process does not connect in time.
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::EnableDistributedRendering(UINT workerCount)
+    {
+        pDistributedRenderer_ = make_unique<DistributedMipRenderer>();
+        if (!pDistributedRenderer_->Start(workerCount))
+        {
+            pDistributedRenderer_->Shutdown();
+            pDistributedRenderer_.reset();
+            return false;
+        }
+
+        // the volume is held by the worker processes - release the local copy
+        volume_.Reset();
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Enable the output of every rendered frame (8 bit gray, without UI controls) to a named shared memory
+    // ring buffer. Slots are sized for the virtual screen, so the window can be resized freely.
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::EnableFrameOutput(const wchar_t* sharedMemoryName, UINT slotCount)
+    {
+        const UINT maxWidth = max(static_cast<UINT>(GetSystemMetrics(SM_CXVIRTUALSCREEN)), canvasWidth_);
+        const UINT maxHeight = max(static_cast<UINT>(GetSystemMetrics(SM_CYVIRTUALSCREEN)), canvasHeight_);
+
+        pFrameOutput_ = make_unique<SharedFrameRingBuffer>();
+        if (!pFrameOutput_->Create(sharedMemoryName, slotCount, maxWidth, maxHeight))
+        {
+            pFrameOutput_.reset();
+            return false;
+        }
+        outputFrameCount_ = 0;
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the Direct3D device
+    //------------------------------------------------------------------------------------------------------
+    ID3D11Device* RayCastRenderer::GetDevice()
+    {
+        return pD3DDevice_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the immediate device context
+    //------------------------------------------------------------------------------------------------------
+    ID3D11DeviceContext* RayCastRenderer::GetImmediateContext()
+    {
+        return pImmediateContext_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get a handle to the given dataset. The dataset is loaded only if it is not resident yet; all handles
+    // to the same dataset, storage (and vessel threshold) share one immutable volume resource, other thresholds share
+    // its voxels.
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::AcquireVolume(VOLUME_DATASET volumeDataset, VolumeHandle& volumeHandle)
+    {
+        if (nullptr == pD3DDevice_) return false;
+
+        return volumeLibrary_.Acquire(pD3DDevice_, volumeDataset, volumeStorage_, sparseThreshold_, volumeHandle);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the volume library (resident volumes)
+    //------------------------------------------------------------------------------------------------------
+    VolumeLibrary& RayCastRenderer::GetVolumeLibrary()
+    {
+        return volumeLibrary_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Initialize GUI controls
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::initGUI()
+    {
+        bool retVal = true;
+
+        // initialize AntTweakBar which provides UI controls in combination with Direct3D 11 rendering context
+        // see http://anttweakbar.sourceforge.net/doc/
+        if (!TwInit(TW_DIRECT3D11, pD3DDevice_))
+        {
+            return false;
+        }
+
+        // provide window canvas dimensions to GUI system
+        TwWindowSize(canvasWidth_, canvasHeight_);
+
+        // the GUI controls edit the UI copy of the render parameters - start with the current renderer state
+        uiParameters_.cameraDistance = cameraDistance_;
+        GetRotation(uiParameters_.quatRotation);
+        uiParameters_.raycastStepSize = raycastStepSize_;
+        uiParameters_.raycastMaxSamples = raycastMaxSamples_;
+        uiParameters_.raycastTraversal = raycastTraversal_;
+        uiParameters_.renderMode = renderMode_;
+        uiParameters_.renderWireframe = renderWireframe_;
+        uiParameters_.disableCulling = disableCulling_;
+        uiParameters_.footprintLod = footprintLod_;
+        uiParameters_.sparseThreshold = sparseThreshold_;
+        uiParameters_.volumeStorage = static_cast<UINT>(volumeStorage_);
+        uiParameters_.temporalSeeding = temporalSeeding_;
+        uiParameters_.seedMargin = seedMargin_;
+        uiParameters_.seedStatistics = seedStatistics_;
+        uiParameters_.adaptiveRefinement = adaptiveRefinement_;
+        uiParameters_.refineThreshold = refineThreshold_;
+        uiParameters_.displayMapping = displayMapping_;
+        uiParameters_.projection = projection_;
+        uiParameters_.primaryIntensity = primaryIntensity_;
+        uiParameters_.fusionIntensity = fusionIntensity_;
+        uiParameters_.adaptiveStepSize = adaptiveStepSize_;
+        uiParameters_.latencyBudgetMSec = latencyBudgetMSec_;
+        uiParameters_.coarsestStepSize = coarsestStepSize_;
+        uiParameters_.idleFramesToRefine = idleFramesToRefine_;
+        uiParameters_.doAnimation = doAnimation_;
+        uiParameters_.animationSpeed = animationSpeed_;
+        uiParameters_.targetFPS = targetFPS_;
+        uiParameters_.lockToTargetFPS = lockToTargetFPS_;
+        uiParameters_.rotateX = rotateX_;
+        uiParameters_.rotateY = rotateY_;
+        uiParameters_.rotateZ = rotateZ_;
+        uiParameters_.imageCacheEnabled = imageCacheEnabled_;
+        uiParameters_.imageCacheBudgetMB = imageCacheBudgetMB_;
+        uiParameters_.volumeDataset = currentDataset_;
+        appliedParameters_ = uiParameters_;
+
+        // create a tweak bar (every control edits uiParameters_ - the render thread reads its own copies only)
+        TwBar *guiBar = TwNewBar("Settings");
+        TwDefine(" GLOBAL help='Ray-Caster Renderer Test Viewer' "); // message added to the help bar
+        int guiBarSize[2] = { 300, 640 };
+        TwSetParam(guiBar, nullptr, "size", TW_PARAM_INT32, 2, guiBarSize);
+        
+        // rendering settings
+        TwAddVarRW(guiBar, "Wireframe Mode", TW_TYPE_BOOLCPP, &uiParameters_.renderWireframe, "group=Rendering key=w");
+        TwAddVarRW(guiBar, "Disable Culling", TW_TYPE_BOOLCPP, &uiParameters_.disableCulling, "group=Rendering key=c");
+        TwAddSeparator(guiBar, nullptr, "group=Rendering");
+        TwAddVarRW(guiBar, "Render Mode", TW_TYPE_UINT32, &uiParameters_.renderMode, "group=Rendering min=0 max=5 keyincr=Right keydecr=Left");
+        TwAddButton(guiBar, "CommentRenderMode", nullptr, nullptr, "label='0=MIP,1=Front-Faces,2=Back-Faces,3=Ray Direction,4=Sparse Point MIP,5=Multi-Projection' group=Rendering");
+        TwAddVarRW(guiBar, "Projection", TW_TYPE_UINT32, &uiParameters_.projection, "group=Rendering min=0 max=2 key=p help='Render mode 5 : all three projections are computed in one traversal, switching does not re-cast the rays.'");
+        TwAddButton(guiBar, "CommentProjection", nullptr, nullptr, "label='0=MIP,1=MinIP,2=AIP' group=Rendering");
+        TwAddVarRW(guiBar, "Footprint LOD", TW_TYPE_BOOLCPP, &uiParameters_.footprintLod, "group=Rendering help='Sample a coarser (max down-sampled) volume level when voxels project to less than a pixel.'");
+        TwAddVarRW(guiBar, "Vessel Threshold", TW_TYPE_UINT32, &uiParameters_.sparseThreshold, "group=Rendering min=0 max=254 help='Sparse point MIP threshold. Lower values take effect on next dataset load.'");
+        TwAddVarRW(guiBar, "Volume Storage", TW_TYPE_UINT32, &uiParameters_.volumeStorage, "group=Rendering min=0 max=1 help='Storage of the demo datasets. Changing it reloads the rendered demo dataset.'");
+        TwAddButton(guiBar, "CommentVolumeStorage", nullptr, nullptr, "label='0=3D Texture,1=Packed Bricks' group=Rendering");
+        TwAddSeparator(guiBar, nullptr, "group=Rendering");
+        TwAddVarCB(
+            guiBar, 
+            "Camera Distance", 
+            TW_TYPE_FLOAT, 
+            guiCallbackSetCameraDistance, 
+            guiCallbackGetCameraDistance, 
+            this, 
+            "group=Rendering min=-6 max=-0.75 step=0.01 keyincr=+ keydecr=-");
+        TwAddSeparator(guiBar, nullptr, nullptr);
+        // raycasting settings
+        TwAddVarRW(guiBar, "Sampling Step Size", TW_TYPE_FLOAT, &uiParameters_.raycastStepSize, "group=Ray-Casting min=0.0001 max=0.1 step=0.0001");
+        TwAddVarRW(guiBar, "Maximum Samples per Ray", TW_TYPE_UINT32, &uiParameters_.raycastMaxSamples, "group=Ray-Casting min=10 max=800");
+        TwAddVarRW(guiBar, "Traversal Mode", TW_TYPE_UINT32, &uiParameters_.raycastTraversal, "group=Ray-Casting min=0 max=1 key=t");
+        TwAddButton(guiBar, "CommentTraversal", nullptr, nullptr, "label='0=Fixed Step,1=Exact Cell DDA' group=Ray-Casting");
+        TwAddVarRW(guiBar, "Temporal Seeding", TW_TYPE_BOOLCPP, &uiParameters_.temporalSeeding, "group=Ray-Casting key=s help='Fixed step only: skip bricks below the previous MIP image (exact).'");
+        TwAddVarRW(guiBar, "Seed Margin", TW_TYPE_FLOAT, &uiParameters_.seedMargin, "group=Ray-Casting min=0.0 max=0.25 step=0.002");
+        TwAddVarRW(guiBar, "Seed Statistics", TW_TYPE_BOOLCPP, &uiParameters_.seedStatistics, "group=Ray-Casting");
+        TwAddVarRW(guiBar, "Adaptive Refinement", TW_TYPE_BOOLCPP, &uiParameters_.adaptiveRefinement, "group=Ray-Casting key=r help='Fixed step only: cast every 4th ray, refine where neighbours differ.'");
+        TwAddVarRW(guiBar, "Refine Threshold", TW_TYPE_FLOAT, &uiParameters_.refineThreshold, "group=Ray-Casting min=0.0 max=0.5 step=0.005");
+        TwAddSeparator(guiBar, nullptr, nullptr);
+        // display mapping of the MIP values (applied after ray-casting - changing it does not re-cast the rays)
+        TwAddVarRW(guiBar, "Window Center", TW_TYPE_FLOAT, &uiParameters_.displayMapping.windowCenter, "group=Display min=0.0 max=1.0 step=0.002");
+        TwAddVarRW(guiBar, "Window Width", TW_TYPE_FLOAT, &uiParameters_.displayMapping.windowWidth, "group=Display min=0.002 max=1.0 step=0.002");
+        TwAddVarRW(guiBar, "Gamma", TW_TYPE_FLOAT, &uiParameters_.displayMapping.gamma, "group=Display min=0.1 max=5.0 step=0.01");
+        TwAddVarRW(guiBar, "Invert", TW_TYPE_BOOLCPP, &uiParameters_.displayMapping.invert, "group=Display key=n");
+        TwAddSeparator(guiBar, nullptr, nullptr);
+        // fused MIP of a second, co-registered dataset (intensity mappings are applied per sample, before the maximum)
+        TwAddVarRW(guiBar, "Fusion Dataset", TW_TYPE_UINT32, &uiParameters_.fusionDataset, "group=Fusion min=0 max=4");
+        TwAddButton(guiBar, "CommentFusionDataset", nullptr, nullptr, "label='0=Off,1=CT Head,2=CT Angio,3=MR Abdomen,4=MR TOF' group=Fusion");
+        TwAddVarRW(guiBar, "Primary Center", TW_TYPE_FLOAT, &uiParameters_.primaryIntensity.windowCenter, "group=Fusion min=0.0 max=1.0 step=0.002");
+        TwAddVarRW(guiBar, "Primary Width", TW_TYPE_FLOAT, &uiParameters_.primaryIntensity.windowWidth, "group=Fusion min=0.002 max=1.0 step=0.002");
+        TwAddVarRW(guiBar, "Fusion Center", TW_TYPE_FLOAT, &uiParameters_.fusionIntensity.windowCenter, "group=Fusion min=0.0 max=1.0 step=0.002");
+        TwAddVarRW(guiBar, "Fusion Width", TW_TYPE_FLOAT, &uiParameters_.fusionIntensity.windowWidth, "group=Fusion min=0.002 max=1.0 step=0.002");
+        TwAddSeparator(guiBar, nullptr, nullptr);
+        // frame budget sampling
+        TwAddVarRW(guiBar, "Adaptive Step Size", TW_TYPE_BOOLCPP, &uiParameters_.adaptiveStepSize, "group='Frame Budget' key=b help='Coarsen the step size while interacting to meet the budget (target frame-rate if locked).'");
+        TwAddVarRW(guiBar, "Latency Budget (ms)", TW_TYPE_FLOAT, &uiParameters_.latencyBudgetMSec, "group='Frame Budget' min=2 max=200 step=0.5");
+        TwAddVarRW(guiBar, "Coarsest Step Size", TW_TYPE_FLOAT, &uiParameters_.coarsestStepSize, "group='Frame Budget' min=0.0001 max=0.1 step=0.0005");
+        TwAddVarRW(guiBar, "Idle Frames to Refine", TW_TYPE_UINT32, &uiParameters_.idleFramesToRefine, "group='Frame Budget' min=1 max=240");
+        TwAddSeparator(guiBar, nullptr, nullptr);
+        // animation settings
+        TwAddVarRW(guiBar, "Animate", TW_TYPE_BOOLCPP, &uiParameters_.doAnimation, "group=Animation key=a");
+        TwAddVarRW(guiBar, "Animation Speed", TW_TYPE_FLOAT, &uiParameters_.animationSpeed, "group=Animation min=0.0 max=4.0 step=0.01 keyincr=Up keydecr=Down");
+        TwAddVarRW(guiBar, "Target Frame-Rate (FPS)", TW_TYPE_UINT32, &uiParameters_.targetFPS, "group=Animation min=5 max=120");
+        TwAddVarRW(guiBar, "Lock to Target Frame-Rate", TW_TYPE_BOOLCPP, &uiParameters_.lockToTargetFPS, "group=Animation key=l");
+        TwAddVarCB(guiBar, "Rotation", TW_TYPE_QUAT4F, guiCallbackSetRotation, guiCallbackGetRotation, this, "opened=true axisz=-z group=Animation");
+        TwAddVarRW(guiBar, "Rotate X", TW_TYPE_BOOLCPP, &uiParameters_.rotateX, "group=Animation key=x");
+        TwAddVarRW(guiBar, "Rotate Y", TW_TYPE_BOOLCPP, &uiParameters_.rotateY, "group=Animation key=y");
+        TwAddVarRW(guiBar, "Rotate Z", TW_TYPE_BOOLCPP, &uiParameters_.rotateZ, "group=Animation key=z");
+        TwAddSeparator(guiBar, nullptr, nullptr);
+        // image cache settings
+        TwAddVarRW(guiBar, "Enable Image Cache", TW_TYPE_BOOLCPP, &uiParameters_.imageCacheEnabled, "group='Image Cache' key=i help='Serve repeated orientations (3D MIP) from cached images.'");
+        TwAddVarRW(guiBar, "Cache Budget (MB)", TW_TYPE_UINT32, &uiParameters_.imageCacheBudgetMB, "group='Image Cache' min=16 max=8192 step=16");
+        TwAddButton(guiBar, "PrecomputeRotation", guiCallbackBtnPrecomputeRotation, this, "group='Image Cache' label='Precompute Rotation'");
+        TwAddButton(guiBar, "ClearImageCache", guiCallbackBtnClearImageCache, this, "group='Image Cache' label='Clear Image Cache'");
+        TwAddSeparator(guiBar, nullptr, nullptr);
+        // dataset settings
+        TwAddButton(guiBar, "CTHead", guiCallbackBtnDataCTHead, this, "group=Dataset label='CT Head'");
+        TwAddButton(guiBar, "CTHeadAngio", guiCallbackBtnDataCTHeadAngio, this, "group=Dataset label='CT Head Angio'");
+        TwAddButton(guiBar, "MRAbdomen", guiCallbackBtnDataMRAbdomen, this, "group=Dataset label='MR Abdomen'");
+        TwAddButton(guiBar, "MRHeadTOF", guiCallbackBtnDataMRHeadTOFAngio, this, "group=Dataset label='MR Head TOF Angio'");
+
+        publishRenderParameters();
+
+        return retVal;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Initialize Ray-Caster renderer - create Direct3D device and swap chain
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::Initialize(HWND canvasHWND)
+    {
+        HRESULT hr = S_OK;
+        
+        // store window handle of rendering canvas
+        canvasHWND_ = canvasHWND;
+
+        RECT rc;
+        GetClientRect(canvasHWND_, &rc);
+        UINT _canvasWidth = rc.right - rc.left;
+        UINT _canvasHeight = rc.bottom - rc.top;
+        
+        // create Direct3D device, device context and DXGI swapchain
+        if (!createDeviceAndSwapChain()) return false;
+        
+        // create a render target view
+        if (!createAndBindRenderTargetView()) return false;
+
+        // set initial viewport
+        setViewport();
+
+        // create vertex-shader, pixel-shader and input layout
+        if (!createShaderObjectsAndInputLayout()) return false;
+
+        // setup geometry : create vertex and index buffer for indexed rendering
+        if (!createVertexAndIndexBuffer()) return false;
+
+        // create constant buffers used for passing uniform data to shader stages
+        if (!createConstantBuffers()) return false;
+        
+        // create pipeline state objects for the fixed-function units of the D3D11 pipeline 
+        if (!createPipelineStateObjects()) return false;
+
+        // create sampler states for volume texture sampling
+        if (!createSamplerStates()) return false;
+
+        // setup transformation matrices ...
+        // note : we work with a left-handed coordinate system
+        // -> matrices are row-major aligned
+        // -> polygon definition in clockwise (CW) order means front-face; backface culling is ON per default
+        // NOTE : HLSL expects column-major aligned matrices; that's why all matrices are transposed before
+        //        they are passed to the vertex shader
+
+        // initialize world-view-projection matrix
+        matrixWVP_ = XMMatrixIdentity();
+        // initialize the world matrix (scaled to volume boundaries when the volume is loaded)
+        matrixWorld_ = XMMatrixIdentity();
+        // initialize rotation matrix
+        matrixRotate_ = XMMatrixIdentity();
+
+        // initialize the view matrix with initial camera distance
+        setViewMatrix(cameraDistance_);
+
+        // initialize the projection matrix
+        setProjectionMatrix();
+        // update world-view-projection matrix
+        calcWorldViewProjectionMatrix();
+        
+        // initialize the ray setup controller which renders cube back-faces and front-faces to separate render targets
+        if (!raySetupPass_.Initialize(pD3DDevice_, _canvasWidth, _canvasHeight)) return false;
+
+        // initialize the history and statistics of the temporal seeding
+        if (!temporalSeedPass_.Initialize(pD3DDevice_, _canvasWidth, _canvasHeight)) return false;
+
+        // initialize the adaptive image-space refinement
+        if (!refinementPass_.Initialize(pD3DDevice_, _canvasWidth, _canvasHeight)) return false;
+
+        // initialize the raw MIP image and its window/level mapping
+        if (!windowLevelPass_.Initialize(pD3DDevice_, _canvasWidth, _canvasHeight)) return false;
+
+        // initialize the point splatting pass
+        if (!pointSplatPass_.Initialize(pD3DDevice_)) return false;
+
+        // load the initial dataset progressively (streamed volume texture, replaced by the complete volume)
+        if (!LoadDatasetStreaming(currentDataset_))
+        {
+            MessageBox(
+                nullptr,
+                L"Unable to load volume raw data. Ray Casting will fail!",
+                L"Error",
+                MB_OK
+            );
+        }
+        
+        // initialize rotation quaternion to identity
+        quatRotation_[0] = 0.0f;
+        quatRotation_[1] = 0.0f;
+        quatRotation_[2] = 0.0f;
+        quatRotation_[3] = 1.0f;
+        
+        // initialize GUI
+        if (!initGUI())
+        {
+            return false;
+        }
+
+        // finally initialize performance counters
+        QueryPerformanceFrequency(&perfCounterFreq_);
+        QueryPerformanceCounter(&lastPerfCounter_);
+
+        return true;
+    }
+    
+    //------------------------------------------------------------------------------------------------------
+    // Initialize the renderer for offscreen rendering (no window, no swap chain, no GUI). A dataset needs to
+    // be loaded with LoadDataset() or LoadDatasetSlab() before rendering.
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::InitializeOffscreen(UINT canvasWidth, UINT canvasHeight)
+    {
+        offscreenMode_ = true;
+        doAnimation_ = false;
+        canvasHWND_ = nullptr;
+        canvasWidth_ = max(canvasWidth, 1u);
+        canvasHeight_ = max(canvasHeight, 1u);
+
+        // create Direct3D device and device context
+        if (!createDevice()) return false;
+
+        // create offscreen render target and staging texture for read-back
+        if (!createOffscreenRenderTarget()) return false;
+
+        setViewport();
+
+        if (!createShaderObjectsAndInputLayout()) return false;
+        if (!createVertexAndIndexBuffer()) return false;
+        if (!createConstantBuffers()) return false;
+        if (!createPipelineStateObjects()) return false;
+        if (!createSamplerStates()) return false;
+
+        // setup transformation matrices (see Initialize())
+        matrixWVP_ = XMMatrixIdentity();
+        matrixWorld_ = XMMatrixIdentity();
+        matrixRotate_ = XMMatrixIdentity();
+        setViewMatrix(cameraDistance_);
+        setProjectionMatrix();
+        calcWorldViewProjectionMatrix();
+
+        if (!raySetupPass_.Initialize(pD3DDevice_, canvasWidth_, canvasHeight_)) return false;
+        if (!pointSplatPass_.Initialize(pD3DDevice_)) return false;
+        if (!refinementPass_.Initialize(pD3DDevice_, canvasWidth_, canvasHeight_)) return false;
+        if (!windowLevelPass_.Initialize(pD3DDevice_, canvasWidth_, canvasHeight_)) return false;
+
+        // initialize rotation quaternion to identity
+        quatRotation_[0] = 0.0f;
+        quatRotation_[1] = 0.0f;
+        quatRotation_[2] = 0.0f;
+        quatRotation_[3] = 1.0f;
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Resize the offscreen render target
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::ResizeOffscreen(UINT canvasWidth, UINT canvasHeight)
+    {
+        if (!offscreenMode_ || nullptr == pD3DDevice_) return false;
+
+        canvasWidth = max(canvasWidth, 1u);
+        canvasHeight = max(canvasHeight, 1u);
+        if (canvasWidth == canvasWidth_ && canvasHeight == canvasHeight_) return true;
+
+        canvasWidth_ = canvasWidth;
+        canvasHeight_ = canvasHeight;
+
+        SAFE_RELEASE(pRenderTargetView_);
+        SAFE_RELEASE(pImageTexture_);
+        SAFE_RELEASE(pStagingTexture_);
+        SAFE_RELEASE(pOffscreenTexture_);
+
+        if (!createOffscreenRenderTarget()) return false;
+
+        setViewport();
+        setProjectionMatrix();
+        calcWorldViewProjectionMatrix();
+        mipImageValid_ = false;
+
+        return raySetupPass_.OnResize(pD3DDevice_, canvasWidth_, canvasHeight_) &&
+            refinementPass_.OnResize(pD3DDevice_, canvasWidth_, canvasHeight_) &&
+            windowLevelPass_.OnResize(pD3DDevice_, canvasWidth_, canvasHeight_);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Render a frame offscreen and read back the gray image (one byte per pixel, row-major, canvas size)
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::RenderToImage(std::vector<BYTE>& grayImage)
+    {
+        HRESULT hr = S_OK;
+
+        if (!offscreenMode_ || nullptr == pImmediateContext_ || nullptr == pRayCastingVS_ || nullptr == pRayCastingPS_)
+        {
+            return false;
+        }
+
+        grayImage.resize(static_cast<size_t>(canvasWidth_) * canvasHeight_);
+        if (!volume_)
+        {
+            // nothing loaded - empty image
+            std::fill(grayImage.begin(), grayImage.end(), static_cast<BYTE>(0));
+            return true;
+        }
+        if (pLiveVolume_)
+        {
+            // no render thread offscreen - the region updates queued since the last image are applied here
+            applyLiveUpdates();
+        }
+
+        renderFrame(matrixWVP_);
+
+        // read back render target (R-channel holds the MIP value)
+        pImmediateContext_->CopyResource(pStagingTexture_, pOffscreenTexture_);
+
+        D3D11_MAPPED_SUBRESOURCE mappedResource;
+        hr = pImmediateContext_->Map(pStagingTexture_, 0, D3D11_MAP_READ, 0, &mappedResource);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        const BYTE* pSrcRow = static_cast<const BYTE*>(mappedResource.pData);
+        BYTE* pDst = grayImage.data();
+        for (UINT row = 0; row < canvasHeight_; row++)
+        {
+            for (UINT col = 0; col < canvasWidth_; col++)
+            {
+                *pDst++ = pSrcRow[4 * col];
+            }
+            pSrcRow += mappedResource.RowPitch;
+        }
+        pImmediateContext_->Unmap(pStagingTexture_, 0);
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Release all allocated resources 
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::Release()
+    {
+        // the render thread must not touch the resources below any more
+        StopRenderThread();
+        // stop the worker processes of distributed rendering
+        if (pDistributedRenderer_)
+        {
+            pDistributedRenderer_->Shutdown();
+            pDistributedRenderer_.reset();
+        }
+        // stop the image cache precomputation (uses its own device)
+        imageCache_.StopPrecompute();
+        releaseImageCacheReadbacks();
+        // release GUI resources
+        if (!offscreenMode_) TwTerminate();
+        // reset pipeline state
+        if (pImmediateContext_) pImmediateContext_->ClearState();
+        // rlease resources of ray setup controller
+        raySetupPass_.Release();
+        temporalSeedPass_.Release();
+        refinementPass_.Release();
+        windowLevelPass_.Release();
+        brickPagingPass_.Release();
+        volumeStreamer_.Stop();
+        volumeStreamer_.WaitForAbandoned();
+        {
+            std::lock_guard<std::mutex> updateLock(liveUpdateMutex_);
+            pLiveVolume_.reset();
+            liveDatasetInfo_ = { nullptr, 0, 0, 0, 8, { 1.0f, 1.0f, 1.0f } };
+            liveVolumeGeneration_++;
+            liveUpdates_.clear();
+        }
+        // release frame output
+        for (UINT idx = 0; idx < FRAME_OUTPUT_LATENCY; idx++)
+        {
+            SAFE_RELEASE(pOutputStagingTextures_[idx]);
+        }
+        pFrameOutput_.reset();
+        // release resources of point splatting pass and the volumes (resources shared with render sessions
+        // are released with the last session)
+        pointSplatPass_.Release();
+        volume_.Reset();
+        fusionVolume_.Reset();
+        // release Direct3D COM objects ...
+        SAFE_RELEASE(pLinearTexSamplerState_);
+        SAFE_RELEASE(pMaxBlendState_);
+        SAFE_RELEASE(pSolidNoCullingRS_);
+        SAFE_RELEASE(pSolidRS_);
+        SAFE_RELEASE(pWireFrameNoCullingRS_);
+        SAFE_RELEASE(pWireFrameRS_);
+        SAFE_RELEASE(pConstantBufferDebugPS_);
+        SAFE_RELEASE(pConstantBufferFusionPS_);
+        SAFE_RELEASE(pConstantBufferPS_);
+        SAFE_RELEASE(pConstantBufferVS_);
+        SAFE_RELEASE(pVertexBuffer_);
+        SAFE_RELEASE(pIndexBuffer_);
+        SAFE_RELEASE(pVertexLayout_);
+        SAFE_RELEASE(pRayCastingVS_);
+        SAFE_RELEASE(pRayCastingPS_);
+        SAFE_RELEASE(pRayCastingDDAPS_);
+        SAFE_RELEASE(pRayCastingSeededPS_);
+        SAFE_RELEASE(pRayCastingMultiPS_);
+        SAFE_RELEASE(pRayCastingPagedPS_);
+        SAFE_RELEASE(pRayCastingPackedPS_);
+        SAFE_RELEASE(pRayCastingFusedPS_);
+        SAFE_RELEASE(pRaySetupDebugPS_);
+        SAFE_RELEASE(pRenderTargetView_);
+        SAFE_RELEASE(pImageTexture_);
+        SAFE_RELEASE(pStagingTexture_);
+        SAFE_RELEASE(pOffscreenTexture_);
+        SAFE_RELEASE(pSwapChain_);
+        SAFE_RELEASE(pImmediateContext_);
+        SAFE_RELEASE(pD3DDevice_);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Update hook (timing, animation, ...)
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::Update()
+    {
+        if (nullptr == pImmediateContext_ || nullptr == pD3DDevice_ || (canvasHWND_ && IsIconic(canvasHWND_)))
+        {
+            // renderer not yet initialized or window is minimized - do nothing
+            return;
+        }
+        
+        // take over the GUI changes published since the last frame
+        applyRenderParameters();
+
+        if (volumeStreamer_.IsActive())
+        {
+            // progressive loading : upload the slices read since the last frame; the complete volume replaces the
+            // streamed one without resetting the rotation
+            if (volumeStreamer_.Upload(pImmediateContext_))
+            {
+                mipImageValid_ = false;
+            }
+            VolumeHandle completeVolume;
+            if (volumeStreamer_.TakeCompleteVolume(completeVolume))
+            {
+                volume_ = std::move(completeVolume);
+                mipImageValid_ = false;
+            }
+        }
+        if (pLiveVolume_)
+        {
+            // live volume : apply the region updates queued since the last frame
+            applyLiveUpdates();
+        }
+
+        // update target render time first (depends on GUI parameter - relevant for "locked" frame rate rendering)
+        targetRenderTime_ = 1.0 / targetFPS_;
+        // update image cache budget (GUI parameter)
+        imageCache_.SetBudget(static_cast<size_t>(imageCacheBudgetMB_) * 1024 * 1024);
+
+        if (lockToTargetFPS_)
+        {
+            // locked to target frame rate - the frame pacer holds back Present() until the frame's deadline
+            framePacer_.SetTargetFPS(targetFPS_);
+        }
+        else
+        {
+            // free running - the schedule restarts with the next locked frame
+            framePacer_.Reset();
+        }
+
+        // measure rendering timing (raw frame time in ms + frames per second (FPS) + average FPS) ...
+        // (in locked mode the measured frame time is the interval between the paced presents)
+        QueryPerformanceCounter(&currentPerfCounter_);
+        double frameTime = (double)(currentPerfCounter_.QuadPart - lastPerfCounter_.QuadPart) / perfCounterFreq_.QuadPart;
+        lastPerfCounter_ = currentPerfCounter_;
+
+        // choose the sampling step size of this frame from the render times of the previous frames
+        updateStepSizeController();
+
+        elapsedTime_ += frameTime;              // _elapsedTime since simulation start
+        double currentFPS = 1.0 / frameTime;    // current FPS jitters depending on background load and position of bounding cube
+                                                // calculate average FPS which gives a smoother measure of rendering performance 
+        sumFPS_ += currentFPS;
+        frameCounter_++;
+        averageFPS_ = sumFPS_ / (frameCounter_ > 0 ? frameCounter_ : 60); // in case of frameCounter overflow we assume 60 FPS
+                                                                          // dump timing info in title bar of hosting window
+        const size_t bufferSize = 512;
+        char charBuffer[bufferSize] = { 0 };
+        sprintf_s(
+            charBuffer,
+            bufferSize,
+            "D3D11 Volume Ray-Caster - frame time : %4.2f ms, FPS : %4.1f, average FPS : %4.1f - total time : %4.2f s",
+            1000.0f * frameTime,
+            currentFPS,
+            averageFPS_,
+            elapsedTime_);
+        if (!isRenderModeAvailable(volume_.operator->(), renderMode_))
+        {
+            size_t titleLength = strlen(charBuffer);
+            sprintf_s(
+                charBuffer + titleLength,
+                bufferSize - titleLength,
+                " - render mode %u not available for this volume (3D MIP shown)",
+                renderMode_);
+        }
+        else if (4 == renderMode_ && volume_)
+        {
+            // point-based MIP : show the amount of splatted voxels
+            size_t titleLength = strlen(charBuffer);
+            sprintf_s(
+                charBuffer + titleLength,
+                bufferSize - titleLength,
+                " - splats : %u (%4.2f %%)",
+                volume_->GetSparseVolume().GetVoxelCount(),
+                100.0f * volume_->GetSparseVolume().GetOccupancy());
+        }
+        if (imageCacheEnabled_)
+        {
+            // image cache : hit rate and memory usage
+            MipImageCacheStats cacheStats = imageCache_.GetStats();
+            UINT64 lookups = cacheStats.hits + cacheStats.misses;
+            size_t titleLength = strlen(charBuffer);
+            sprintf_s(
+                charBuffer + titleLength,
+                bufferSize - titleLength,
+                " - image cache : %u images (%u MB), hits : %4.1f %%%s",
+                cacheStats.imageCount,
+                static_cast<UINT>(cacheStats.memorySize / (1024 * 1024)),
+                lookups > 0 ? 100.0f * cacheStats.hits / lookups : 0.0f,
+                imageCache_.IsPrecomputing() ? " (precomputing)" : "");
+        }
+        if (adaptiveStepSize_)
+        {
+            // frame budget sampling : current step size and the render time predicted for it
+            size_t titleLength = strlen(charBuffer);
+            sprintf_s(
+                charBuffer + titleLength,
+                bufferSize - titleLength,
+                " - step size : %6.4f (%4.1f ms predicted)",
+                stepSizeController_.GetStepSize(),
+                stepSizeController_.GetPredictedTimeMSec());
+        }
+        if (lockToTargetFPS_)
+        {
+            // frame pacing : deadlines missed by the locked frames
+            size_t titleLength = strlen(charBuffer);
+            sprintf_s(
+                charBuffer + titleLength,
+                bufferSize - titleLength,
+                " - missed deadlines : %llu / %llu",
+                framePacer_.GetMissedDeadlines(),
+                framePacer_.GetFrameCount());
+        }
+        if (isAdaptiveRefinementActive())
+        {
+            // adaptive refinement : rays cast relative to the pixel count
+            const AdaptiveRefinementStats& refineStats = refinementPass_.GetStats();
+            size_t titleLength = strlen(charBuffer);
+            sprintf_s(
+                charBuffer + titleLength,
+                bufferSize - titleLength,
+                " - refinement : %4.1f %% rays",
+                refineStats.pixelCount > 0 ? 100.0 * refineStats.raysCast / refineStats.pixelCount : 0.0);
+        }
+        if (isTemporalSeedingActive() && seedStatistics_)
+        {
+            // temporal seeding : samples saved by the seed (net of re-traced rays) relative to brick skipping alone
+            const TemporalSeedStats& seedStats = temporalSeedPass_.GetStats();
+            const double samplesSaved = static_cast<double>(seedStats.samplesSkippedBySeed) - static_cast<double>(seedStats.samplesRetraced);
+            const double samplesUnseeded = static_cast<double>(seedStats.samplesTaken) + samplesSaved;
+            size_t titleLength = strlen(charBuffer);
+            sprintf_s(
+                charBuffer + titleLength,
+                bufferSize - titleLength,
+                " - seeding : %4.1f %% samples saved, %4.2f %% rays re-traced",
+                samplesUnseeded > 0.0 ? 100.0 * samplesSaved / samplesUnseeded : 0.0,
+                seedStats.raysSeeded > 0 ? 100.0 * seedStats.raysRetraced / seedStats.raysSeeded : 0.0);
+        }
+        if (volumeStreamer_.IsActive())
+        {
+            // progressive loading : slices uploaded so far
+            size_t titleLength = strlen(charBuffer);
+            sprintf_s(
+                charBuffer + titleLength,
+                bufferSize - titleLength,
+                " - loading : %u / %u slices",
+                volumeStreamer_.GetLoadedSlices(),
+                volumeStreamer_.GetSliceCount());
+        }
+        if (brickPagingPass_.IsActive())
+        {
+            // out-of-core paging : resident bricks, brick cache hit rate and read throughput of the I/O threads
+            const BrickPagingStats& pagingStats = brickPagingPass_.GetStats();
+            size_t titleLength = strlen(charBuffer);
+            sprintf_s(
+                charBuffer + titleLength,
+                bufferSize - titleLength,
+                " - paging : %u / %u bricks resident, hits : %4.1f %%, I/O : %4.1f MB/s",
+                pagingStats.residentBricks,
+                pagingStats.poolSlots,
+                pagingStats.bricksTouched > 0 ? 100.0 * pagingStats.cacheHits / pagingStats.bricksTouched : 0.0,
+                pagingStats.ioThroughputMBs);
+        }
+        if (pFrameOutput_)
+        {
+            // frame output : frames the consumer did not pick up in time
+            size_t titleLength = strlen(charBuffer);
+            sprintf_s(
+                charBuffer + titleLength,
+                bufferSize - titleLength,
+                " - output frames : %llu (dropped : %llu)",
+                pFrameOutput_->GetPublishedFrames(),
+                pFrameOutput_->GetDroppedFrames());
+        }
+        if (pDistributedRenderer_)
+        {
+            // distributed rendering : show slowest worker and compositing time
+            size_t titleLength = strlen(charBuffer);
+            sprintf_s(
+                charBuffer + titleLength,
+                bufferSize - titleLength,
+                " - workers : %u (render : %4.2f ms, composite : %4.2f ms)",
+                pDistributedRenderer_->GetWorkerCount(),
+                pDistributedRenderer_->GetMaxWorkerRenderTimeMSec(),
+                pDistributedRenderer_->GetCompositeTimeMSec());
+        }
+        SetWindowTextA(canvasHWND_, charBuffer);
+
+        if (doAnimation_) // == auto-rotation mode
+        {
+            // calculate rotation angle in radians 
+            // (based on measured frame time, to ensure consistent animation behaviour on different hardware)
+            float rotAngle = XM_PI * static_cast<float>(frameTime) * animationSpeed_;
+            // rotate volume depending on GUI settings ...
+            if (rotateZ_) matrixRotate_ *= XMMatrixRotationZ(rotAngle);
+            if (rotateY_) matrixRotate_ *= XMMatrixRotationY(rotAngle);
+            if (rotateX_) matrixRotate_ *= XMMatrixRotationX(rotAngle);
+            
+            // get rotation quaternion from rotation matrix (needed to update track-ball control in GUI)
+            XMVECTOR quatRotation = XMQuaternionRotationMatrix(matrixRotate_);
+            quatRotation_[0] = XMVectorGetX(quatRotation);
+            quatRotation_[1] = XMVectorGetY(quatRotation);
+            quatRotation_[2] = XMVectorGetZ(quatRotation);
+            quatRotation_[3] = XMVectorGetW(quatRotation);
+        }
+        else // manual rotation using trackball control
+        {
+            // update rotation matrix from rotation quaternion
+            XMVECTOR quatRotation = XMVectorSet(quatRotation_[0], quatRotation_[1], quatRotation_[2], quatRotation_[3]);
+            matrixRotate_ = XMMatrixRotationQuaternion(quatRotation);
+        }
+        
+        // update world-view-projection matrix
+        calcWorldViewProjectionMatrix();
+
+        // update ray controller state
+        raySetupPass_.Update();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Render frame
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::Render()
+    {
+        if (nullptr == pImmediateContext_ || nullptr == pD3DDevice_ || (canvasHWND_ && IsIconic(canvasHWND_)))
+        {
+            // renderer not yet initialized or window is minimized - do nothing
+            return;
+        }
+        if (nullptr == pRayCastingVS_ || nullptr == pRayCastingPS_)
+        {
+            // shader compilation failed - pipeline is not usable
+            return;
+        }
+
+        if (pDistributedRenderer_)
+        {
+            // distributed rendering : every worker renders the partial MIP of its slab, partial images are max-composited
+            DistributedFrameRequest request = { 0 };
+            request.volumeDataset = static_cast<UINT32>(currentDataset_);
+            request.canvasWidth = canvasWidth_;
+            request.canvasHeight = canvasHeight_;
+            GetRotation(request.quatRotation);
+            request.cameraDistance = cameraDistance_;
+            getFrameSampling(request.raycastStepSize, request.raycastMaxSamples);
+            request.raycastTraversal = raycastTraversal_;
+
+            if (pDistributedRenderer_->RenderFrame(request, compositeImage_))
+            {
+                presentGrayImage(compositeImage_);
+            }
+            else
+            {
+                // lost connection to (at least) one worker - fall back to local rendering
+                pDistributedRenderer_->Shutdown();
+                pDistributedRenderer_.reset();
+                LoadDataset(currentDataset_);
+            }
+        }
+        else if (isImageCacheable())
+        {
+            // repeated orientations (auto-rotation playback) are served from the image cache
+            MipImageKey imageKey = makeImageCacheKey();
+            shared_ptr<const vector<BYTE>> pCachedImage = imageCache_.Lookup(imageKey);
+            if (pCachedImage)
+            {
+                presentGrayImage(*pCachedImage);
+                updateImageCache(nullptr);
+            }
+            else
+            {
+                // render with the quantized rotation - the image is valid for all orientations of the key
+                float quaternion[4];
+                MipImageCache::DequantizeRotation(imageKey.quatRotation, quaternion);
+                XMMATRIX matrixRotate = XMMatrixRotationQuaternion(XMVectorSet(quaternion[0], quaternion[1], quaternion[2], quaternion[3]));
+                renderFrame(matrixWorld_ * matrixRotate * matrixView_ * matrixProjection_);
+                updateImageCache(&imageKey);
+            }
+        }
+        else
+        {
+            renderFrame(matrixWVP_);
+        }
+
+        // hand the frame (without UI controls) to the consumer process
+        if (pFrameOutput_)
+        {
+            writeFrameOutput();
+        }
+
+        // render UI controls - the trackball shows the rotation of this frame (auto-rotation)
+        {
+            std::lock_guard<std::mutex> guiLock(guiMutex_);
+            GetRotation(uiParameters_.quatRotation);
+            TwDraw();
+        }
+
+        // locked frame rate : wait for the deadline of this frame (coarse sleep + spin) before presenting it
+        pacingWaitTime_ = 0.0;
+        if (lockToTargetFPS_)
+        {
+            LARGE_INTEGER waitStart, waitEnd;
+            QueryPerformanceCounter(&waitStart);
+            framePacer_.WaitForNextFrame();
+            QueryPerformanceCounter(&waitEnd);
+            pacingWaitTime_ = (double)(waitEnd.QuadPart - waitStart.QuadPart) / perfCounterFreq_.QuadPart;
+        }
+
+        // promote back buffer to front buffer (swap buffers)
+        pSwapChain_->Present(0, 0);
+        
+        postRenderHook();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Render the volume to the current render target (back buffer or offscreen texture)
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::renderFrame(const DirectX::XMMATRIX& matrixWVP)
+    {
+        FrameContext frame;
+        frame.matrixWVP = matrixWVP;
+        frame.pDeviceContext = pImmediateContext_;
+        frame.pRenderTargetView = pRenderTargetView_;
+        frame.pRaySetupPass = &raySetupPass_;
+        frame.pVolume = volume_ ? &*volume_ : nullptr;
+        frame.pFusionVolume = fusionVolume_ ? &*fusionVolume_ : nullptr;
+        frame.primaryIntensity = primaryIntensity_;
+        frame.fusionIntensity = fusionIntensity_;
+        frame.canvasWidth = canvasWidth_;
+        frame.canvasHeight = canvasHeight_;
+        getFrameSampling(frame.raycastStepSize, frame.raycastMaxSamples);
+        frame.raycastTraversal = raycastTraversal_;
+        // render modes not available for the volume fall back to the 3D MIP (reported in the title bar)
+        frame.renderMode = isRenderModeAvailable(volume_.operator->(), renderMode_) ? renderMode_ : 0;
+        frame.sparseThreshold = sparseThreshold_;
+        frame.renderWireframe = renderWireframe_;
+        frame.disableCulling = disableCulling_;
+        frame.pTemporalSeedPass = isTemporalSeedingActive() ? &temporalSeedPass_ : nullptr;
+        frame.seedMargin = seedMargin_;
+        frame.seedStatistics = seedStatistics_;
+        frame.pRefinementPass = isAdaptiveRefinementActive() ? &refinementPass_ : nullptr;
+        frame.refineThreshold = refineThreshold_;
+        frame.footprintLod = footprintLod_;
+        frame.pWindowLevelPass = &windowLevelPass_;
+        frame.displayMapping = displayMapping_;
+        frame.projection = projection_;
+        frame.pPagingPass = brickPagingPass_.IsActive() ? &brickPagingPass_ : nullptr;
+
+        if (isMipImageReusable(frame))
+        {
+            // only display parameters changed - map the MIP values of the last frame again
+            windowLevelPass_.Resolve(pImmediateContext_, pRenderTargetView_, displayMapping_, (5 == frame.renderMode) ? frame.projection : 0);
+            return;
+        }
+        lastMipFrame_ = frame;
+        mipImageValid_ = ((0 == frame.renderMode || 5 == frame.renderMode) && nullptr != frame.pVolume);
+
+        if (nullptr == frame.pTemporalSeedPass)
+        {
+            if (nullptr != frame.pPagingPass)
+            {
+                brickPagingPass_.BeginFrame(pImmediateContext_);
+            }
+            RecordFrame(frame);
+            if (nullptr != frame.pRefinementPass)
+            {
+                refinementPass_.EndFrame(pImmediateContext_, offscreenMode_);
+            }
+            if (nullptr != frame.pPagingPass)
+            {
+                brickPagingPass_.EndFrame(pImmediateContext_);
+            }
+            return;
+        }
+
+        temporalSeedPass_.BeginFrame(pImmediateContext_);
+        RecordFrame(frame);
+
+        // keep the raw MIP image (before window/level, without UI controls) as seed of the next frame
+        temporalSeedPass_.EndFrame(pImmediateContext_, windowLevelPass_.GetMipTexture(), matrixWVP);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Does the MIP image hold the given frame (only the window differs - no ray-casting needed)
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::isMipImageReusable(const FrameContext& frame) const
+    {
+        if (!mipImageValid_ || (0 != frame.renderMode && 5 != frame.renderMode) || nullptr != frame.pPagingPass)
+        {
+            // paged volumes : the image improves with every brick that arrives
+            return false;
+        }
+
+        // the projection images of render mode 5 are computed together - the displayed one is not compared
+        const FrameContext& last = lastMipFrame_;
+        return 0 == memcmp(&frame.matrixWVP, &last.matrixWVP, sizeof(XMMATRIX)) &&
+            frame.renderMode == last.renderMode &&
+            frame.pVolume == last.pVolume &&
+            frame.pFusionVolume == last.pFusionVolume &&
+            frame.primaryIntensity.windowCenter == last.primaryIntensity.windowCenter &&
+            frame.primaryIntensity.windowWidth == last.primaryIntensity.windowWidth &&
+            frame.fusionIntensity.windowCenter == last.fusionIntensity.windowCenter &&
+            frame.fusionIntensity.windowWidth == last.fusionIntensity.windowWidth &&
+            frame.canvasWidth == last.canvasWidth &&
+            frame.canvasHeight == last.canvasHeight &&
+            frame.raycastStepSize == last.raycastStepSize &&
+            frame.raycastMaxSamples == last.raycastMaxSamples &&
+            frame.raycastTraversal == last.raycastTraversal &&
+            frame.renderWireframe == last.renderWireframe &&
+            frame.disableCulling == last.disableCulling &&
+            frame.pTemporalSeedPass == last.pTemporalSeedPass &&
+            frame.seedMargin == last.seedMargin &&
+            frame.pRefinementPass == last.pRefinementPass &&
+            frame.refineThreshold == last.refineThreshold &&
+            frame.footprintLod == last.footprintLod;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Record a frame to the device context of the frame context. All pipeline state is set explicitly, as
+    // deferred device contexts start every command list with the default state.
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::RecordFrame(const FrameContext& frame) const
+    {
+        if (!isRenderModeAvailable(frame.pVolume, frame.renderMode))
+        {
+            // render sessions pass their own render mode - show the 3D MIP rather than sampling a missing resource
+            FrameContext mipFrame = frame;
+            mipFrame.renderMode = 0;
+            RecordFrame(mipFrame);
+            return;
+        }
+
+        ID3D11DeviceContext* pContext = frame.pDeviceContext;
+
+        // clear the render target
+        pContext->ClearRenderTargetView(frame.pRenderTargetView, Colors::Black);
+        if (nullptr == frame.pVolume)
+        {
+            // nothing loaded - empty frame
+            return;
+        }
+
+        // 3D MIP : ray-cast the raw maximum values into the MIP image, window/level maps them to the render target;
+        // multi-projection : ray-cast into all projection images (without them only the MIP reaches the target)
+        const bool windowLevel = ((0 == frame.renderMode || 5 == frame.renderMode) && nullptr != frame.pWindowLevelPass);
+        ID3D11RenderTargetView* const* rayCastTargetViews = windowLevel ? frame.pWindowLevelPass->GetProjectionRenderTargetViews() : &frame.pRenderTargetView;
+        const UINT rayCastTargetCount = (windowLevel && 5 == frame.renderMode) ? WindowLevelPass::PROJECTION_COUNT : 1;
+        if (windowLevel)
+        {
+            for (UINT targetIdx = 0; targetIdx < rayCastTargetCount; targetIdx++)
+            {
+                pContext->ClearRenderTargetView(rayCastTargetViews[targetIdx], Colors::Black);
+            }
+        }
+
+        D3D11_VIEWPORT viewPort;
+        viewPort.Width = static_cast<FLOAT>(frame.canvasWidth);
+        viewPort.Height = static_cast<FLOAT>(frame.canvasHeight);
+        viewPort.MinDepth = 0.0f;
+        viewPort.MaxDepth = 1.0f;
+        viewPort.TopLeftX = 0;
+        viewPort.TopLeftY = 0;
+        pContext->RSSetViewports(1, &viewPort);
+
+        const bool partitioned = (frame.pVolume->GetPartitionCount() > 1);
+        const bool raySetupDebug = (frame.renderMode >= 1 && frame.renderMode <= 3);
+        if (partitioned && !raySetupDebug)
+        {
+            // volume split into partitions (3D texture limits) : ray-cast every partition within its own box and keep the
+            // per-pixel maximum - the MIP is order independent and the overlap voxels make the samples at the partition
+            // boundaries match. Partitioned volumes render the plain 3D MIP (fixed step or cell-by-cell traversal); they
+            // have no sparse voxel list (mode 4), and the minimum and average projections (mode 5) do not composite.
+            FrameContext partitionFrame = frame;
+            partitionFrame.renderMode = 0;
+            partitionFrame.pFusionVolume = nullptr;
+            partitionFrame.pTemporalSeedPass = nullptr;
+            partitionFrame.pRefinementPass = nullptr;
+            partitionFrame.pPagingPass = nullptr;
+            const XMMATRIX matrixVolumeToUnitCube = XMMatrixInverse(nullptr, frame.pVolume->GetWorldMatrix());
+            for (UINT partitionIdx = 0; partitionIdx < frame.pVolume->GetPartitionCount(); partitionIdx++)
+            {
+                const VolumeResource& partition = frame.pVolume->GetPartition(partitionIdx);
+                partitionFrame.pVolume = &partition;
+                partitionFrame.matrixWVP = partition.GetWorldMatrix() * matrixVolumeToUnitCube * frame.matrixWVP;
+                recordRayCasting(partitionFrame, rayCastTargetViews, 1, pMaxBlendState_);
+            }
+        }
+        else if (4 == frame.renderMode)
+        {
+            ///////////////////////////////////////////////////////////////////////
+            // point-based MIP : splat the sparse voxels directly into the back buffer (no ray setup needed)
+            XMMATRIX transposedMatrixWVP = XMMatrixTranspose(frame.matrixWVP);
+            pContext->OMSetRenderTargets(1, &frame.pRenderTargetView, nullptr);
+            pointSplatPass_.Render(
+                pContext,
+                *frame.pVolume,
+                &transposedMatrixWVP,
+                frame.canvasWidth,
+                frame.canvasHeight,
+                calcProjectedVoxelFootprint(frame),
+                frame.sparseThreshold);
+            return;
+        }
+        else
+        {
+            // ray setup debug modes of a partitioned volume : the ray setup of the whole volume box (no volume sampling)
+            recordRayCasting(frame, rayCastTargetViews, rayCastTargetCount, nullptr);
+        }
+
+        if (windowLevel)
+        {
+            frame.pWindowLevelPass->Resolve(pContext, frame.pRenderTargetView, frame.displayMapping, (5 == frame.renderMode && !partitioned) ? frame.projection : 0);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Record the ray setup and ray-casting passes of one volume (or partition) to the given ray-casting targets;
+    // the blend state applies to the ray-casting pass only (nullptr -> the targets are overwritten)
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::recordRayCasting(
+        const FrameContext& frame, 
+        ID3D11RenderTargetView* const* rayCastTargetViews, 
+        UINT rayCastTargetCount, 
+        ID3D11BlendState* pBlendState) const
+    {
+        ID3D11DeviceContext* pContext = frame.pDeviceContext;
+        ID3D11RenderTargetView* pRayCastTargetView = rayCastTargetViews[0];
+
+        XMMATRIX transposedMatrixWVP = XMMatrixTranspose(frame.matrixWVP);
+
+        // paged 3D MIP : fixed step sampling of the resident bricks (full resolution) or the coarse level
+        const bool pagedMip = (0 == frame.renderMode && nullptr != frame.pPagingPass);
+
+        // packed 3D MIP : the sampler decodes the packed bricks of the full resolution level
+        const bool packedMip = (0 == frame.renderMode && VOLUME_STORAGE::PACKED_BRICKS == frame.pVolume->GetStorage());
+
+        // fused 3D MIP : ray setup over the union box of both volumes
+        const bool fusedMip = (0 == frame.renderMode && nullptr != frame.pFusionVolume && !pagedMip && !packedMip);
+        float fusedTexCoordScale[3], fusedTexCoordOffset[3];
+        ConstantBufferFusionPS cbFusionPS;
+        if (fusedMip)
+        {
+            XMMATRIX matrixUnionBox;
+            calcFusionTransforms(frame, matrixUnionBox, fusedTexCoordScale, fusedTexCoordOffset, cbFusionPS);
+            transposedMatrixWVP = XMMatrixTranspose(matrixUnionBox * frame.matrixWVP);
+        }
+
+        // restore proxy geometry input (other render passes may have changed the input-assembler state)
+        bindProxyGeometry(pContext);
+
+        ///////////////////////////////////////////////////////////////////////
+        // ray setup render pass (render results to 2D textures) ...
+
+        // render back- and front-faces textures needed for ray setup
+        frame.pRaySetupPass->Render(pContext, &transposedMatrixWVP, indexCount_);
+        // get resource views to back- and front-faces textures needed for ray-casting
+        ID3D11ShaderResourceView *texCubeFacesRV[2] = { nullptr, nullptr };
+        frame.pRaySetupPass->GetTextureResourceViews(texCubeFacesRV);
+
+        ///////////////////////////////////////////////////////////////////////
+        // ray-casting render pass ... 
+
+        // bind the render target view of the frame (or the projection images) to the pipeline (Output-Merger stage)
+        pContext->OMSetRenderTargets(rayCastTargetCount, rayCastTargetViews, nullptr);
+        
+        // set rasterizer state to wireframe mode if required
+        if (frame.renderWireframe)
+        {
+            if (frame.disableCulling)
+            {
+                pContext->RSSetState(pWireFrameNoCullingRS_);
+            }
+            else
+            {
+                pContext->RSSetState(pWireFrameRS_);
+            }
+        }
+        else // solid shading with or without backface culling
+        {
+            if (frame.disableCulling)
+            {
+                pContext->RSSetState(pSolidNoCullingRS_);
+            }
+            else
+            {
+                pContext->RSSetState(pSolidRS_);
+            }
+        }
+
+        // update constant buffer for VS and PS
+        ConstantBufferVS cbVS;
+        cbVS.matrixWVP = transposedMatrixWVP;
+        pContext->UpdateSubresource(pConstantBufferVS_, 0, nullptr, &cbVS, 0, 0);
+
+        // resolution level from the projected voxel footprint; the step size scales with the voxel size of
+        // the level (same samples per voxel), the sample count inversely (same ray length)
+        // (multi-projection : minimum and average need the full resolution level; fused MIP : the brick max grids
+        // bound the samples of the full resolution level only)
+        const UINT volumeLod = (5 == frame.renderMode || fusedMip || pagedMip || packedMip) ? 0 : selectVolumeLod(frame);
+        UINT volDimensions[3];
+        frame.pVolume->GetLevelDimensions(volumeLod, volDimensions);
+
+        ConstantBufferPS cbPS;
+        cbPS.canvasPixelResolution[0] = 1.0f / frame.canvasWidth;
+        cbPS.canvasPixelResolution[1] = 1.0f / frame.canvasHeight;
+        cbPS.raycastStepSize = frame.raycastStepSize * (1u << volumeLod);
+        cbPS.raycastMaxSamples = (frame.raycastMaxSamples + (1u << volumeLod) - 1) >> volumeLod;
+        cbPS.volumeLod = static_cast<float>(volumeLod);
+        cbPS.volumeDimensions[0] = static_cast<float>(volDimensions[0]);
+        cbPS.volumeDimensions[1] = static_cast<float>(volDimensions[1]);
+        cbPS.volumeDimensions[2] = static_cast<float>(volDimensions[2]);
+        cbPS.raycastMaxCells = volDimensions[0] + volDimensions[1] + volDimensions[2] + 3; // upper bound for cells crossed by a ray
+        cbPS.packedValueScale = (VOXEL_FORMAT::UINT16 == frame.pVolume->GetVoxelFormat()) ? 1.0f / 65535.0f : 1.0f / 255.0f;
+        frame.pVolume->GetTexCoordTransform(cbPS.texCoordScale, cbPS.texCoordOffset);
+        if (fusedMip)
+        {
+            memcpy(cbPS.texCoordScale, fusedTexCoordScale, sizeof(fusedTexCoordScale));
+            memcpy(cbPS.texCoordOffset, fusedTexCoordOffset, sizeof(fusedTexCoordOffset));
+        }
+
+        UINT brickGridDimensions[3];
+        frame.pVolume->GetBrickGridDimensions(brickGridDimensions);
+        cbPS.brickGridDimensions[0] = static_cast<float>(brickGridDimensions[0]);
+        cbPS.brickGridDimensions[1] = static_cast<float>(brickGridDimensions[1]);
+        cbPS.brickGridDimensions[2] = static_cast<float>(brickGridDimensions[2]);
+        const bool seedingActive = (nullptr != frame.pTemporalSeedPass && frame.pTemporalSeedPass->HasHistory());
+        cbPS.temporalSeeding = seedingActive ? 1 : 0;
+        cbPS.matrixPrevSetupToClip = seedingActive ?
+            XMMatrixTranspose(XMMatrixTranslation(-0.5f, -0.5f, -0.5f) * frame.pTemporalSeedPass->GetHistoryMatrixWVP()) :
+            XMMatrixIdentity();
+        cbPS.seedMargin = frame.seedMargin;
+        cbPS.collectStatistics = frame.seedStatistics ? 1 : 0;
+        pContext->UpdateSubresource(pConstantBufferPS_, 0, nullptr, &cbPS, 0, 0);
+
+        // set vertex- and pixel-shader
+        ID3D11Buffer* pConstantBufferVS = pConstantBufferVS_;
+        ID3D11Buffer* pConstantBufferPS = pConstantBufferPS_;
+        pContext->VSSetShader(pRayCastingVS_, nullptr, 0);
+        pContext->VSSetConstantBuffers(0, 1, &pConstantBufferVS);
+        pContext->PSSetConstantBuffers(0, 1, &pConstantBufferPS);
+
+        if (pagedMip) // 3D MIP of an out-of-core volume - brick pool, page table and paging constants (t8, t9, b4)
+        {
+            frame.pPagingPass->Bind(pContext);
+            pContext->PSSetShader(pRayCastingPagedPS_, nullptr, 0);
+        }
+        else if (packedMip) // 3D MIP of packed bricks - brick max grid, brick table and packed deltas (t4, t10, t11)
+        {
+            ID3D11ShaderResourceView* pBrickMaxResView = frame.pVolume->GetBrickMaxResourceView();
+            ID3D11ShaderResourceView* packedBrickResViews[2];
+            frame.pVolume->GetPackedBrickResourceViews(packedBrickResViews);
+            pContext->PSSetShaderResources(4, 1, &pBrickMaxResView);
+            pContext->PSSetShaderResources(10, 2, packedBrickResViews);
+            pContext->PSSetShader(pRayCastingPackedPS_, nullptr, 0);
+        }
+        else if (fusedMip) // 3D MIP over two volumes - fixed step sampling with joint brick skipping
+        {
+            pContext->UpdateSubresource(pConstantBufferFusionPS_, 0, nullptr, &cbFusionPS, 0, 0);
+            ID3D11Buffer* pConstantBufferFusionPS = pConstantBufferFusionPS_;
+            pContext->PSSetConstantBuffers(3, 1, &pConstantBufferFusionPS);
+            pContext->PSSetShader(pRayCastingFusedPS_, nullptr, 0);
+        }
+        else if (0 == frame.renderMode) // default render mode : 3D MIP
+        {
+            if (1 == frame.raycastTraversal)
+            {
+                // exact cell-by-cell traversal - step size and maximum sample count are not used
+                pContext->PSSetShader(pRayCastingDDAPS_, nullptr, 0);
+            }
+            else if (nullptr != frame.pRefinementPass)
+            {
+                // coarse ray-casting with adaptive refinement (compute) - the pixel shader only copies the result
+                frame.pRefinementPass->Render(
+                    pContext, 
+                    pConstantBufferPS_, 
+                    frame.pVolume->GetShaderResourceView(), 
+                    texCubeFacesRV, 
+                    pLinearTexSamplerState_, 
+                    frame.refineThreshold);
+                ID3D11ShaderResourceView* pRefineResView = frame.pRefinementPass->GetImageResourceView();
+                pContext->PSSetShaderResources(5, 1, &pRefineResView);
+                pContext->PSSetShader(frame.pRefinementPass->GetResolvePixelShader(), nullptr, 0);
+            }
+            else if (nullptr != frame.pTemporalSeedPass && 0 == volumeLod)
+            {
+                // fixed step sampling with brick skipping, seeded by the previous frame (the brick max grid bounds
+                // the samples of the full resolution level only)
+                pContext->PSSetShader(pRayCastingSeededPS_, nullptr, 0);
+            }
+            else
+            {
+                pContext->PSSetShader(pRayCastingPS_, nullptr, 0);
+            }
+        }
+        else if (5 == frame.renderMode) // MIP, MinIP and AIP in one traversal
+        {
+            pContext->PSSetShader(pRayCastingMultiPS_, nullptr, 0);
+        }
+        else // debug render mode : 1 = front-face, 2 = back-face, 3 = ray vector
+        {
+            ConstantBufferDebugPS cbDbgPS;
+            cbDbgPS.raySetupMode = frame.renderMode;
+            pContext->UpdateSubresource(pConstantBufferDebugPS_, 0, nullptr, &cbDbgPS, 0, 0);
+            ID3D11Buffer* pConstantBufferDebugPS = pConstantBufferDebugPS_;
+            pContext->PSSetShader(pRaySetupDebugPS_, nullptr, 0);
+            pContext->PSSetConstantBuffers(1, 1, &pConstantBufferDebugPS);
+        }
+
+        // set texture resources and sampler state
+        ID3D11ShaderResourceView* pVolumeResView = frame.pVolume->GetShaderResourceView();
+        ID3D11SamplerState* pSamplerState = pLinearTexSamplerState_;
+        pContext->PSSetShaderResources(0, 1, &pVolumeResView);
+        pContext->PSSetShaderResources(1, 2, texCubeFacesRV);
+        pContext->PSSetSamplers(0, 1, &pSamplerState);
+
+        const bool seededTraversal = (0 == frame.renderMode && 0 == frame.raycastTraversal && nullptr == frame.pRefinementPass && nullptr != frame.pTemporalSeedPass && 0 == volumeLod);
+        if (seededTraversal)
+        {
+            // previous MIP image and brick max grid (t3, t4) - statistics counters follow the render target (u1)
+            ID3D11ShaderResourceView* seedResView[2] = { frame.pTemporalSeedPass->GetHistoryResourceView(), frame.pVolume->GetBrickMaxResourceView() };
+            ID3D11UnorderedAccessView* pStatisticsView = frame.pTemporalSeedPass->GetStatisticsView();
+            pContext->PSSetShaderResources(3, 2, seedResView);
+            pContext->OMSetRenderTargetsAndUnorderedAccessViews(1, &pRayCastTargetView, nullptr, 1, 1, &pStatisticsView, nullptr);
+        }
+
+        if (fusedMip)
+        {
+            // brick max grid of the first volume (t4), second volume and its brick max grid (t6, t7)
+            ID3D11ShaderResourceView* pBrickMaxResView = frame.pVolume->GetBrickMaxResourceView();
+            ID3D11ShaderResourceView* fusionResView[2] = { frame.pFusionVolume->GetShaderResourceView(), frame.pFusionVolume->GetBrickMaxResourceView() };
+            pContext->PSSetShaderResources(4, 1, &pBrickMaxResView);
+            pContext->PSSetShaderResources(6, 2, fusionResView);
+        }
+
+        if (pagedMip)
+        {
+            // brick usage bits (u3) - marks resident bricks as used and requests the missing ones
+            ID3D11UnorderedAccessView* pUsageView = frame.pPagingPass->GetUsageView();
+            pContext->OMSetRenderTargetsAndUnorderedAccessViews(1, &pRayCastTargetView, nullptr, 3, 1, &pUsageView, nullptr);
+        }
+
+        pContext->OMSetBlendState(pBlendState, nullptr, 0xFFFFFFFF);
+        pContext->DrawIndexed(indexCount_, 0, 0);
+        pContext->OMSetBlendState(nullptr, nullptr, 0xFFFFFFFF);
+        
+        // unbind texture resources
+        ID3D11ShaderResourceView* nullResView[12] = { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
+        pContext->PSSetShaderResources(0, 12, nullResView);
+        if (pagedMip)
+        {
+            ID3D11UnorderedAccessView* pNullView = nullptr;
+            pContext->OMSetRenderTargetsAndUnorderedAccessViews(D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL, nullptr, nullptr, 3, 1, &pNullView, nullptr);
+        }
+        if (seededTraversal)
+        {
+            ID3D11UnorderedAccessView* pNullView = nullptr;
+            pContext->OMSetRenderTargetsAndUnorderedAccessViews(D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL, nullptr, nullptr, 1, 1, &pNullView, nullptr);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Copy a gray image (canvas size, one byte per pixel) to the back buffer (or offscreen texture)
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::presentGrayImage(const std::vector<BYTE>& grayImage)
+    {
+        HRESULT hr = S_OK;
+
+        if (grayImage.size() != static_cast<size_t>(canvasWidth_) * canvasHeight_)
+        {
+            // image was rendered for a previous canvas size (resize in progress) - skip it
+            return;
+        }
+
+        if (nullptr == pImageTexture_)
+        {
+            D3D11_TEXTURE2D_DESC descTex;
+            ZeroMemory(&descTex, sizeof(descTex));
+            descTex.Width = canvasWidth_;
+            descTex.Height = canvasHeight_;
+            descTex.MipLevels = 1;
+            descTex.ArraySize = 1;
+            descTex.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+            descTex.SampleDesc.Count = 1;
+            descTex.SampleDesc.Quality = 0;
+            descTex.Usage = D3D11_USAGE_DEFAULT;
+            descTex.BindFlags = 0;
+            descTex.CPUAccessFlags = 0;
+            descTex.MiscFlags = 0;
+            hr = pD3DDevice_->CreateTexture2D(&descTex, nullptr, &pImageTexture_);
+            if (FAILED(hr))
+            {
+                return;
+            }
+        }
+
+        // expand gray values to RGBA
+        std::vector<UINT32> rgbaImage(grayImage.size());
+        for (size_t idx = 0; idx < grayImage.size(); idx++)
+        {
+            UINT32 gray = grayImage[idx];
+            rgbaImage[idx] = 0xFF000000 | (gray << 16) | (gray << 8) | gray;
+        }
+        pImmediateContext_->UpdateSubresource(pImageTexture_, 0, nullptr, rgbaImage.data(), canvasWidth_ * sizeof(UINT32), 0);
+
+        if (offscreenMode_)
+        {
+            pImmediateContext_->CopyResource(pOffscreenTexture_, pImageTexture_);
+        }
+        else
+        {
+            ID3D11Texture2D* pBackBuffer = nullptr;
+            hr = pSwapChain_->GetBuffer(0, __uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&pBackBuffer));
+            if (SUCCEEDED(hr))
+            {
+                pImmediateContext_->CopyResource(pBackBuffer, pImageTexture_);
+                pBackBuffer->Release();
+            }
+        }
+    }
+    
+    //------------------------------------------------------------------------------------------------------
+    // Copy the back buffer to the frame output ring buffer. The back buffer is copied to one of
+    // FRAME_OUTPUT_LATENCY staging textures; the oldest staging texture (rendered FRAME_OUTPUT_LATENCY - 1
+    // frames ago) is mapped and its gray values are written directly to the shared memory slot.
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::writeFrameOutput()
+    {
+        HRESULT hr = S_OK;
+
+        const UINT stagingIdx = static_cast<UINT>(outputFrameCount_ % FRAME_OUTPUT_LATENCY);
+        if (nullptr == pOutputStagingTextures_[stagingIdx])
         {
-            // renderer not yet initialized or window is minimized - do nothing
-            return;
+            D3D11_TEXTURE2D_DESC descTex;
+            ZeroMemory(&descTex, sizeof(descTex));
+            descTex.Width = canvasWidth_;
+            descTex.Height = canvasHeight_;
+            descTex.MipLevels = 1;
+            descTex.ArraySize = 1;
+            descTex.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+            descTex.SampleDesc.Count = 1;
+            descTex.Usage = D3D11_USAGE_STAGING;
+            descTex.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+            hr = pD3DDevice_->CreateTexture2D(&descTex, nullptr, &pOutputStagingTextures_[stagingIdx]);
+            if (FAILED(hr))
+            {
+                return;
+            }
         }
-        
-        // update target render time first (depends on GUI parameter - relevant for "locked" frame rate rendering)
-        targetRenderTime_ = 1.0 / targetFPS_;
 
-        if (lockToTargetFPS_ && deltaTimeMSec_ > 1.0)
+        ID3D11Texture2D* pBackBuffer = nullptr;
+        hr = pSwapChain_->GetBuffer(0, __uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&pBackBuffer));
+        if (FAILED(hr))
         {
-            // locked to target frame rate - if we are too fast we let sleep the render thread to "cool down" the GPU
-            Sleep(static_cast<DWORD>(deltaTimeMSec_));
+            return;
         }
+        pImmediateContext_->CopyResource(pOutputStagingTextures_[stagingIdx], pBackBuffer);
+        pBackBuffer->Release();
+        outputFrameCount_++;
 
-        // measure rendering timing (raw frame time in ms + frames per second (FPS) + average FPS) ...
-        double frameTime = 0.0;
-        QueryPerformanceCounter(&currentPerfCounter_);
-        if (lockToTargetFPS_ && deltaTimeMSec_ > 1.0)
-        { 
-            // frame rate is locked and our hardware would still be capable to render faster than the target render time
-            frameTime = targetRenderTime_;
-        }
-        else
+        if (outputFrameCount_ < FRAME_OUTPUT_LATENCY)
         {
-            // hardware renders as fast as possible (maybe also slower as the given target render time) - measure timing
-            frameTime = (double)(currentPerfCounter_.QuadPart - lastPerfCounter_.QuadPart) / perfCounterFreq_.QuadPart;
+            // pipeline not yet filled
+            return;
         }
-        lastPerfCounter_ = currentPerfCounter_;
-
-        elapsedTime_ += frameTime;              // _elapsedTime since simulation start
-        double currentFPS = 1.0 / frameTime;    // current FPS jitters depending on background load and position of bounding cube
-                                                // calculate average FPS which gives a smoother measure of rendering performance 
-        sumFPS_ += currentFPS;
-        frameCounter_++;
-        averageFPS_ = sumFPS_ / (frameCounter_ > 0 ? frameCounter_ : 60); // in case of frameCounter overflow we assume 60 FPS
-                                                                          // dump timing info in title bar of hosting window
-        const size_t bufferSize = 256;
-        char charBuffer[bufferSize] = { 0 };
-        sprintf_s(
-            charBuffer,
-            bufferSize,
-            "D3D11 Volume Ray-Caster - frame time : %4.2f ms, FPS : %4.1f, average FPS : %4.1f - total time : %4.2f s",
-            1000.0f * frameTime,
-            currentFPS,
-            averageFPS_,
-            elapsedTime_);
-        SetWindowTextA(canvasHWND_, charBuffer);
 
-        if (doAnimation_) // == auto-rotation mode
+        // oldest staging texture = the one which is overwritten next
+        ID3D11Texture2D* pReadTexture = pOutputStagingTextures_[outputFrameCount_ % FRAME_OUTPUT_LATENCY];
+        D3D11_MAPPED_SUBRESOURCE mappedResource;
+        hr = pImmediateContext_->Map(pReadTexture, 0, D3D11_MAP_READ, 0, &mappedResource);
+        if (FAILED(hr))
         {
-            // calculate rotation angle in radians 
-            // (based on measured frame time, to ensure consistent animation behaviour on different hardware)
-            float rotAngle = XM_PI * static_cast<float>(frameTime) * animationSpeed_;
-            // rotate volume depending on GUI settings ...
-            if (rotateZ_) matrixRotate_ *= XMMatrixRotationZ(rotAngle);
-            if (rotateY_) matrixRotate_ *= XMMatrixRotationY(rotAngle);
-            if (rotateX_) matrixRotate_ *= XMMatrixRotationX(rotAngle);
-            
-            // get rotation quaternion from rotation matrix (needed to update track-ball control in GUI)
-            XMVECTOR quatRotation = XMQuaternionRotationMatrix(matrixRotate_);
-            quatRotation_[0] = XMVectorGetX(quatRotation);
-            quatRotation_[1] = XMVectorGetY(quatRotation);
-            quatRotation_[2] = XMVectorGetZ(quatRotation);
-            quatRotation_[3] = XMVectorGetW(quatRotation);
+            return;
         }
-        else // manual rotation using trackball control
+        BYTE* pDst = pFrameOutput_->BeginWrite(canvasWidth_, canvasHeight_);
+        if (pDst)
         {
-            // update rotation matrix from rotation quaternion
-            XMVECTOR quatRotation = XMVectorSet(quatRotation_[0], quatRotation_[1], quatRotation_[2], quatRotation_[3]);
-            matrixRotate_ = XMMatrixRotationQuaternion(quatRotation);
+            const BYTE* pSrcRow = static_cast<const BYTE*>(mappedResource.pData);
+            for (UINT row = 0; row < canvasHeight_; row++)
+            {
+                for (UINT col = 0; col < canvasWidth_; col++)
+                {
+                    *pDst++ = pSrcRow[4 * col];
+                }
+                pSrcRow += mappedResource.RowPitch;
+            }
+            pFrameOutput_->EndWrite();
         }
-        
-        // update world-view-projection matrix
-        calcWorldViewProjectionMatrix();
-
-        // update ray controller state
-        raySetupPass_.Update();
+        pImmediateContext_->Unmap(pReadTexture, 0);
     }
 
     //------------------------------------------------------------------------------------------------------
-    // Render frame
+    // Check if the current frame can be served from / added to the image cache (3D MIP only - debug modes,
+    // wireframe and double-sided rendering are not cached)
     //------------------------------------------------------------------------------------------------------
-    void RayCastRenderer::Render()
+    bool RayCastRenderer::isImageCacheable() const
     {
-        if (nullptr == pImmediateContext_ || nullptr == pD3DDevice_ || IsIconic(canvasHWND_))
-        {
-            // renderer not yet initialized or window is minimized - do nothing
-            return;
-        }
-        if (nullptr == pRayCastingVS_ || nullptr == pRayCastingPS_)
-        {
-            // shader compilation failed - pipeline is not usable
-            return;
-        }
-
-        // clear the back buffer
-        pImmediateContext_->ClearRenderTargetView(pRenderTargetView_, Colors::Black);
+        // refined images are approximations - they are not cached
+        return imageCacheEnabled_ && !adaptiveRefinement_ && !offscreenMode_ && volume_ && !fusionVolume_ && !brickPagingPass_.IsActive() && !volumeStreamer_.IsActive() && 0 == renderMode_ && !renderWireframe_ && !disableCulling_;
+    }
 
-        XMMATRIX transposedMatrixWVP = XMMatrixTranspose(matrixWVP_);
+    //------------------------------------------------------------------------------------------------------
+    // Temporal seeding applies to the fixed step 3D MIP of the window (the history is the back buffer)
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::isTemporalSeedingActive() const
+    {
+        return temporalSeeding_ && !adaptiveRefinement_ && !offscreenMode_ && volume_ && 1 == volume_->GetPartitionCount() && VOLUME_STORAGE::TEXTURE == volume_->GetStorage() && !fusionVolume_ && !brickPagingPass_.IsActive() && !volumeStreamer_.IsActive() && 0 == renderMode_ && 0 == raycastTraversal_;
+    }
 
-        ///////////////////////////////////////////////////////////////////////
-        // ray setup render pass (render results to 2D textures) ...
+    //------------------------------------------------------------------------------------------------------
+    // Adaptive refinement applies to the fixed step 3D MIP (solid - the resolve pass draws the bounding cube)
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::isAdaptiveRefinementActive() const
+    {
+        return adaptiveRefinement_ && volume_ && 1 == volume_->GetPartitionCount() && VOLUME_STORAGE::TEXTURE == volume_->GetStorage() && !fusionVolume_ && !brickPagingPass_.IsActive() && 0 == renderMode_ && 0 == raycastTraversal_ && !renderWireframe_;
+    }
 
-        // render back- and front-faces textures needed for ray setup
-        raySetupPass_.Render(pImmediateContext_, &transposedMatrixWVP, indexCount_);
-        // get resource views to back- and front-faces textures needed for ray-casting
-        ID3D11ShaderResourceView *texCubeFacesRV[2] = { nullptr, nullptr };
-        raySetupPass_.GetTextureResourceViews(texCubeFacesRV);
+    //------------------------------------------------------------------------------------------------------
+    // Get the image cache key of the current view
+    //------------------------------------------------------------------------------------------------------
+    MipImageKey RayCastRenderer::makeImageCacheKey() const
+    {
+        MipImageKey imageKey;
+        MipImageCache::QuantizeRotation(quatRotation_, imageKey.quatRotation);
+        imageKey.cameraDistance = cameraDistance_;
+        imageKey.canvasWidth = canvasWidth_;
+        imageKey.canvasHeight = canvasHeight_;
+        getFrameSampling(imageKey.raycastStepSize, imageKey.raycastMaxSamples);
+        imageKey.raycastTraversal = raycastTraversal_;
+        imageKey.displayMapping = displayMapping_;
+        imageKey.volumeDataset = volumeId_;
+        return imageKey;
+    }
 
-        ///////////////////////////////////////////////////////////////////////
-        // ray-casting render pass ... 
+    //------------------------------------------------------------------------------------------------------
+    // Add completed back buffer read backs to the image cache and start the read back of a missed key.
+    // As for the frame output, a staging texture is mapped IMAGE_CACHE_LATENCY - 1 frames after the copy,
+    // so the read back does not stall the pipeline. Misses are skipped while all staging textures are busy.
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::updateImageCache(const MipImageKey* pMissKey)
+    {
+        HRESULT hr = S_OK;
 
-        // bind the default render target view to the pipeline (Output-Merger stage)
-        pImmediateContext_->OMSetRenderTargets(1, &pRenderTargetView_, nullptr);
-        
-        // set rasterizer state to wireframe mode if required
-        if (renderWireframe_)
+        for (ImageCacheReadback& readback : imageCacheReadbacks_)
         {
-            if (disableCulling_)
+            if (!readback.pending || frameCounter_ - readback.frame < IMAGE_CACHE_LATENCY - 1)
             {
-                pImmediateContext_->RSSetState(pWireFrameNoCullingRS_);
+                continue;
             }
-            else
+            readback.pending = false;
+
+            D3D11_MAPPED_SUBRESOURCE mappedResource;
+            hr = pImmediateContext_->Map(readback.pStagingTexture, 0, D3D11_MAP_READ, 0, &mappedResource);
+            if (FAILED(hr))
             {
-                pImmediateContext_->RSSetState(pWireFrameRS_);
+                continue;
+            }
+            std::vector<BYTE> grayImage(static_cast<size_t>(readback.key.canvasWidth) * readback.key.canvasHeight);
+            const BYTE* pSrcRow = static_cast<const BYTE*>(mappedResource.pData);
+            BYTE* pDst = grayImage.data();
+            for (UINT row = 0; row < readback.key.canvasHeight; row++)
+            {
+                for (UINT col = 0; col < readback.key.canvasWidth; col++)
+                {
+                    *pDst++ = pSrcRow[4 * col];
+                }
+                pSrcRow += mappedResource.RowPitch;
             }
+            pImmediateContext_->Unmap(readback.pStagingTexture, 0);
+
+            imageCache_.Insert(readback.key, std::move(grayImage));
         }
-        else // solid shading with or without backface culling
+
+        if (nullptr == pMissKey)
+        {
+            return;
+        }
+        for (ImageCacheReadback& readback : imageCacheReadbacks_)
         {
-            if (disableCulling_)
+            if (readback.pending)
             {
-                pImmediateContext_->RSSetState(pSolidNoCullingRS_);
+                continue;
             }
-            else
+            if (nullptr == readback.pStagingTexture)
             {
-                pImmediateContext_->RSSetState(pSolidRS_);
+                D3D11_TEXTURE2D_DESC descTex;
+                ZeroMemory(&descTex, sizeof(descTex));
+                descTex.Width = canvasWidth_;
+                descTex.Height = canvasHeight_;
+                descTex.MipLevels = 1;
+                descTex.ArraySize = 1;
+                descTex.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+                descTex.SampleDesc.Count = 1;
+                descTex.Usage = D3D11_USAGE_STAGING;
+                descTex.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+                hr = pD3DDevice_->CreateTexture2D(&descTex, nullptr, &readback.pStagingTexture);
+                if (FAILED(hr))
+                {
+                    return;
+                }
             }
-        }
-
-        // update constant buffer for VS and PS
-        ConstantBufferVS cbVS;
-        cbVS.matrixWVP = transposedMatrixWVP;
-        pImmediateContext_->UpdateSubresource(pConstantBufferVS_, 0, nullptr, &cbVS, 0, 0);
 
-        ConstantBufferPS cbPS;
-        cbPS.canvasPixelResolution[0] = 1.0f / canvasWidth_;
-        cbPS.canvasPixelResolution[1] = 1.0f / canvasHeight_;
-        cbPS.raycastStepSize = raycastStepSize_;
-        cbPS.raycastMaxSamples = raycastMaxSamples_;
-        pImmediateContext_->UpdateSubresource(pConstantBufferPS_, 0, nullptr, &cbPS, 0, 0);
+            ID3D11Texture2D* pBackBuffer = nullptr;
+            hr = pSwapChain_->GetBuffer(0, __uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&pBackBuffer));
+            if (FAILED(hr))
+            {
+                return;
+            }
+            pImmediateContext_->CopyResource(readback.pStagingTexture, pBackBuffer);
+            pBackBuffer->Release();
 
-        // set vertex- and pixel-shader
-        pImmediateContext_->VSSetShader(pRayCastingVS_, nullptr, 0);
-        pImmediateContext_->VSSetConstantBuffers(0, 1, &pConstantBufferVS_);
-        pImmediateContext_->PSSetConstantBuffers(0, 1, &pConstantBufferPS_);
+            readback.key = *pMissKey;
+            readback.frame = frameCounter_;
+            readback.pending = true;
+            return;
+        }
+    }
 
-        if (0 == renderMode_) // default render mode : 3D MIP
+    //------------------------------------------------------------------------------------------------------
+    // Release the staging textures of the image cache read back (re-created with the current canvas size)
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::releaseImageCacheReadbacks()
+    {
+        for (ImageCacheReadback& readback : imageCacheReadbacks_)
         {
-            pImmediateContext_->PSSetShader(pRayCastingPS_, nullptr, 0);
+            SAFE_RELEASE(readback.pStagingTexture);
+            readback.pending = false;
         }
-        else // debug render mode : 1 = front-face, 2 = back-face, 3 = ray vector
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Feed the render time of the last frame to the step size controller. The view counts as interactive
+    // while rotation or camera distance change. Locked to the target frame rate, the budget is the target
+    // render time : the controller spends the time the lock would otherwise sleep on finer sampling (down
+    // to the GUI step size) and coarsens the sampling if the target frame rate is missed.
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::updateStepSizeController()
+    {
+        StepSizeControllerSettings settings;
+        settings.fineStepSize = raycastStepSize_;
+        settings.coarsestStepSize = coarsestStepSize_;
+        settings.budgetMSec = lockToTargetFPS_ ? 1000.0 * targetRenderTime_ : latencyBudgetMSec_;
+        settings.idleFramesToRefine = idleFramesToRefine_;
+        stepSizeController_.Configure(settings);
+
+        const bool interacting =
+            0 != memcmp(lastQuatRotation_, quatRotation_, sizeof(quatRotation_)) ||
+            lastCameraDistance_ != cameraDistance_;
+        memcpy(lastQuatRotation_, quatRotation_, sizeof(quatRotation_));
+        lastCameraDistance_ = cameraDistance_;
+
+        if (!adaptiveStepSize_)
         {
-            ConstantBufferDebugPS cbDbgPS;
-            cbDbgPS.raySetupMode = renderMode_;
-            pImmediateContext_->UpdateSubresource(pConstantBufferDebugPS_, 0, nullptr, &cbDbgPS, 0, 0);
-            pImmediateContext_->PSSetShader(pRaySetupDebugPS_, nullptr, 0);
-            pImmediateContext_->PSSetConstantBuffers(1, 1, &pConstantBufferDebugPS_);
+            stepSizeController_.Reset();
+            return;
         }
+        stepSizeController_.Update(1000.0 * renderTime_, interacting);
+    }
 
-        // set texture resources
-        pImmediateContext_->PSSetShaderResources(0, 1, &pRaycastShaderResView_);
-        pImmediateContext_->PSSetShaderResources(1, 2, texCubeFacesRV);
-
-        pImmediateContext_->DrawIndexed(indexCount_, 0, 0);
-        
-        // unbind texture resources
-        ID3D11ShaderResourceView* nullResView[3] = { nullptr, nullptr, nullptr };
-        pImmediateContext_->PSSetShaderResources(0, 3, nullResView);
-        
-        // render UI controls
-        TwDraw();
-
-        // promote back buffer to front buffer (swap buffers)
-        pSwapChain_->Present(0, 0);
-        
-        postRenderHook();
+    //------------------------------------------------------------------------------------------------------
+    // Get the step size and maximum samples per ray of the current frame
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::getFrameSampling(float& raycastStepSize, UINT& raycastMaxSamples) const
+    {
+        if (adaptiveStepSize_ && !offscreenMode_)
+        {
+            raycastStepSize = stepSizeController_.GetStepSize();
+            raycastMaxSamples = stepSizeController_.GetMaxSamples(raycastMaxSamples_);
+        }
+        else
+        {
+            raycastStepSize = raycastStepSize_;
+            raycastMaxSamples = raycastMaxSamples_;
+        }
     }
-    
+
     //------------------------------------------------------------------------------------------------------
     // Post-render hook which is called immediately after frame is rendered
     //------------------------------------------------------------------------------------------------------
     void RayCastRenderer::postRenderHook()
     {
-        // post-render timing ...
+        // post-render timing ... (without the time the frame pacer waited for the present deadline)
         QueryPerformanceCounter(&currentPerfCounter_);
-        renderTime_ = (double)(currentPerfCounter_.QuadPart - lastPerfCounter_.QuadPart) / perfCounterFreq_.QuadPart;
+        renderTime_ = (double)(currentPerfCounter_.QuadPart - lastPerfCounter_.QuadPart) / perfCounterFreq_.QuadPart - pacingWaitTime_;
 
         if (lockToTargetFPS_)
         {
@@ -1245,10 +3233,11 @@ namespace D3D11_VOLUME_RAYCASTER
             sprintf_s(
                 charBuffer,
                 bufferSize,
-                "target render time : %4.2f ms, render time : %4.2f ms, delta time : %4.2f ms\n",
+                "target render time : %4.2f ms, render time : %4.2f ms, delta time : %4.2f ms, present deviation : %4.2f ms\n",
                 1000.0f * targetRenderTime_,
                 1000.0f * renderTime_,
-                deltaTimeMSec_);
+                deltaTimeMSec_,
+                framePacer_.GetLastDeviationMSec());
             OutputDebugStringA(charBuffer);
 #endif
         }
@@ -1261,6 +3250,21 @@ namespace D3D11_VOLUME_RAYCASTER
     // - resets the projection matrix
     //------------------------------------------------------------------------------------------------------
     bool RayCastRenderer::OnResize()
+    {
+        if (renderThread_.joinable())
+        {
+            // the swap chain is used by the render thread - it resizes before its next frame
+            resizePending_ = true;
+            return true;
+        }
+
+        return resizeSwapChain();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Resize swap chain, render target and ray setup targets to the client area of the canvas window
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::resizeSwapChain()
     {
         HRESULT hr = S_OK;
 
@@ -1279,6 +3283,15 @@ namespace D3D11_VOLUME_RAYCASTER
         // -> avoid memory leak
         // -> resize swap chain buffers would fail if associated resources are not yet released!
         SAFE_RELEASE(pRenderTargetView_);
+        SAFE_RELEASE(pImageTexture_);
+        // frame output staging textures are re-created with the new size
+        for (UINT idx = 0; idx < FRAME_OUTPUT_LATENCY; idx++)
+        {
+            SAFE_RELEASE(pOutputStagingTextures_[idx]);
+        }
+        outputFrameCount_ = 0;
+        // image cache read back staging textures are re-created with the new size
+        releaseImageCacheReadbacks();
 
         // resize the swap chain
         hr = pSwapChain_->ResizeBuffers(1, canvasWidth_, canvasHeight_, DXGI_FORMAT_R8G8B8A8_UNORM, 0);
@@ -1300,6 +3313,16 @@ namespace D3D11_VOLUME_RAYCASTER
         calcWorldViewProjectionMatrix();
 
         bool bRetVal = raySetupPass_.OnResize(pD3DDevice_, canvasWidth_, canvasHeight_);
+        bRetVal = bRetVal && temporalSeedPass_.OnResize(pD3DDevice_, canvasWidth_, canvasHeight_);
+        bRetVal = bRetVal && refinementPass_.OnResize(pD3DDevice_, canvasWidth_, canvasHeight_);
+        bRetVal = bRetVal && windowLevelPass_.OnResize(pD3DDevice_, canvasWidth_, canvasHeight_);
+        mipImageValid_ = false;
+
+        // provide the new canvas dimensions to the GUI system (not done by the message handler - see HandleMessage())
+        {
+            std::lock_guard<std::mutex> guiLock(guiMutex_);
+            TwWindowSize(canvasWidth_, canvasHeight_);
+        }
 
         return bRetVal;
     }
@@ -1309,7 +3332,187 @@ namespace D3D11_VOLUME_RAYCASTER
     //------------------------------------------------------------------------------------------------------
     int CALLBACK RayCastRenderer::HandleMessage(HWND wnd, UINT message, WPARAM wParam, LPARAM lParam)
     {
-        // route message to AntTweakBar
-        return TwEventWin(wnd, message, wParam, lParam);
+        if (WM_SIZE == message)
+        {
+            // AntTweakBar would resize its graphics resources on the UI thread - the GUI is resized together with
+            // the swap chain instead
+            return 0;
+        }
+
+        // route message to AntTweakBar - changed controls are handed to the render thread as new snapshot
+        std::lock_guard<std::mutex> guiLock(guiMutex_);
+        int handled = TwEventWin(wnd, message, wParam, lParam);
+        if (handled)
+        {
+            publishRenderParameters();
+        }
+        return handled;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Start rendering on a dedicated render thread. The UI thread keeps handling window messages; GUI
+    // changes reach the render thread as parameter snapshots, so a heavy frame in flight never blocks input.
+    //------------------------------------------------------------------------------------------------------
+    bool RayCastRenderer::StartRenderThread()
+    {
+        if (offscreenMode_ || nullptr == pD3DDevice_ || renderThread_.joinable())
+        {
+            return false;
+        }
+
+        stopRenderThread_ = false;
+        renderThread_ = std::thread(&RayCastRenderer::renderThreadLoop, this);
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Stop the render thread
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::StopRenderThread()
+    {
+        if (!renderThread_.joinable())
+        {
+            return;
+        }
+
+        stopRenderThread_ = true;
+        // the render thread may wait in SetWindowText() for this (UI) thread - dispatch sent messages until it has finished
+        HANDLE hRenderThread = renderThread_.native_handle();
+        while (WAIT_OBJECT_0 != MsgWaitForMultipleObjects(1, &hRenderThread, FALSE, INFINITE, QS_SENDMESSAGE))
+        {
+            MSG msg;
+            PeekMessage(&msg, nullptr, 0, 0, PM_NOREMOVE);
+        }
+        renderThread_.join();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Render thread : resize on request, update and render until stopped
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::renderThreadLoop()
+    {
+        while (!stopRenderThread_)
+        {
+            if (resizePending_.exchange(false))
+            {
+                resizeSwapChain();
+            }
+            if (IsIconic(canvasHWND_))
+            {
+                // window is minimized - nothing to present
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                continue;
+            }
+
+            Update();
+            Render();
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // UI thread : publish the GUI parameters as new snapshot (caller holds guiMutex_)
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::publishRenderParameters()
+    {
+        parameterBuffer_.Back() = uiParameters_;
+        parameterBuffer_.Publish();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Render thread : apply the latest parameter snapshot. Only the newest snapshot counts - snapshots published
+    // while a frame was in flight are skipped; commands are counters and are executed once when they change.
+    //------------------------------------------------------------------------------------------------------
+    void RayCastRenderer::applyRenderParameters()
+    {
+        if (!parameterBuffer_.Consume())
+        {
+            return;
+        }
+        const RenderParameters& parameters = parameterBuffer_.Front();
+
+        volumeStorage_ = (0 == parameters.volumeStorage) ? VOLUME_STORAGE::TEXTURE : VOLUME_STORAGE::PACKED_BRICKS;
+        if (parameters.datasetSerial != appliedParameters_.datasetSerial)
+        {
+            if (!LoadDatasetStreaming(parameters.volumeDataset))
+            {
+                MessageBox(nullptr, L"Unable to load volume dataset. Ray Casting will fail!", L"Error", MB_OK);
+            }
+        }
+        else if (parameters.volumeStorage != appliedParameters_.volumeStorage)
+        {
+            // only a demo dataset is reloaded in the new storage - external, paged and live volumes keep their own
+            const bool demoVolume = (volume_ && volumeId_ == static_cast<UINT>(currentDataset_) && !brickPagingPass_.IsActive() && !pLiveVolume_);
+            if (demoVolume && !LoadDatasetStreaming(currentDataset_))
+            {
+                MessageBox(nullptr, L"Unable to load volume dataset. Ray Casting will fail!", L"Error", MB_OK);
+            }
+        }
+        if (parameters.cameraDistance != cameraDistance_)
+        {
+            SetCameraDistance(parameters.cameraDistance);
+        }
+        if (parameters.rotationSerial != appliedParameters_.rotationSerial)
+        {
+            // trackball rotation - auto-rotation continues from the new orientation
+            for (int idx = 0; idx < 4; idx++)
+            {
+                quatRotation_[idx] = parameters.quatRotation[idx];
+            }
+            matrixRotate_ = XMMatrixRotationQuaternion(XMVectorSet(quatRotation_[0], quatRotation_[1], quatRotation_[2], quatRotation_[3]));
+        }
+        raycastStepSize_ = parameters.raycastStepSize;
+        raycastMaxSamples_ = parameters.raycastMaxSamples;
+        raycastTraversal_ = parameters.raycastTraversal;
+        renderMode_ = parameters.renderMode;
+        renderWireframe_ = parameters.renderWireframe;
+        disableCulling_ = parameters.disableCulling;
+        footprintLod_ = parameters.footprintLod;
+        sparseThreshold_ = parameters.sparseThreshold;
+        temporalSeeding_ = parameters.temporalSeeding;
+        seedMargin_ = parameters.seedMargin;
+        seedStatistics_ = parameters.seedStatistics;
+        adaptiveRefinement_ = parameters.adaptiveRefinement;
+        refineThreshold_ = parameters.refineThreshold;
+        displayMapping_ = parameters.displayMapping;
+        projection_ = parameters.projection;
+        primaryIntensity_ = parameters.primaryIntensity;
+        fusionIntensity_ = parameters.fusionIntensity;
+        adaptiveStepSize_ = parameters.adaptiveStepSize;
+        latencyBudgetMSec_ = parameters.latencyBudgetMSec;
+        coarsestStepSize_ = parameters.coarsestStepSize;
+        idleFramesToRefine_ = parameters.idleFramesToRefine;
+        doAnimation_ = parameters.doAnimation;
+        animationSpeed_ = parameters.animationSpeed;
+        targetFPS_ = parameters.targetFPS;
+        lockToTargetFPS_ = parameters.lockToTargetFPS;
+        rotateX_ = parameters.rotateX;
+        rotateY_ = parameters.rotateY;
+        rotateZ_ = parameters.rotateZ;
+        imageCacheEnabled_ = parameters.imageCacheEnabled;
+        imageCacheBudgetMB_ = parameters.imageCacheBudgetMB;
+        if (parameters.fusionDataset != appliedParameters_.fusionDataset)
+        {
+            if (0 == parameters.fusionDataset)
+            {
+                ClearFusionDataset();
+            }
+            else if (!LoadFusionDataset(static_cast<VOLUME_DATASET>(parameters.fusionDataset - 1)))
+            {
+                MessageBox(nullptr, L"Unable to load fusion dataset.", L"Error", MB_OK);
+            }
+        }
+
+        if (parameters.clearImageCacheSerial != appliedParameters_.clearImageCacheSerial)
+        {
+            imageCache_.StopPrecompute();
+            imageCache_.Clear();
+        }
+        if (parameters.precomputeRotationSerial != appliedParameters_.precomputeRotationSerial)
+        {
+            precomputeRotation();
+        }
+
+        appliedParameters_ = parameters;
     }
 }
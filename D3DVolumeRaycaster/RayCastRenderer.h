@@ -25,6 +25,17 @@
 
 #include "stdafx.h"
 #include "RaySetupPass.h"
+#include "VolumeLibrary.h"
+#include "PointSplatPass.h"
+#include "MipImageCache.h"
+#include "TemporalSeedPass.h"
+#include "AdaptiveRefinementPass.h"
+#include "StepSizeController.h"
+#include "FramePacer.h"
+#include "WindowLevelPass.h"
+#include "BrickPagingPass.h"
+#include "StreamingVolumeLoader.h"
+#include "TripleBuffer.h"
 #include "../extern/include/AntTweakBar.h"
 
 namespace D3D11_VOLUME_RAYCASTER
@@ -51,6 +62,18 @@ namespace D3D11_VOLUME_RAYCASTER
         float canvasPixelResolution[2];     // pixel-space resolution in x- and y-direction
         float raycastStepSize;              // sampling step size for ray casting
         UINT  raycastMaxSamples;            // maximum number of ray casting samples
+        float volumeDimensions[3];          // volume dimensions in voxels (columns, rows, slices)
+        UINT  raycastMaxCells;              // maximum number of voxel cells visited by the DDA traversal
+        float texCoordScale[3];             // maps ray setup coordinates to volume texture coordinates (scale) ...
+        float volumeLod;                    // resolution level of the volume texture (volumeDimensions are those of the level)
+        float texCoordOffset[3];            // ... and offset - identity unless only a part of the volume is loaded
+        float packedValueScale;             // packed bricks : 1 / maximum voxel value of the voxel format
+        float brickGridDimensions[3];       // dimensions of the brick max grid (empty-space skipping)
+        UINT  temporalSeeding;              // != 0 : seed the rays with the reprojected MIP image of the previous frame
+        DirectX::XMMATRIX matrixPrevSetupToClip; // ray setup coordinates -> clip space of the previous frame (transposed)
+        float seedMargin;                   // safety margin subtracted from the reprojected MIP value
+        UINT  collectStatistics;            // != 0 : count the samples of the seeded traversal
+        float padding2[2];
     };
 
     // constant buffer for passing data to HLSL debug pixel-shader
@@ -59,16 +82,108 @@ namespace D3D11_VOLUME_RAYCASTER
         UINT raySetupMode;  // debug render mode : 1 = front-face, 2 = back-face, 3 = ray vector
         UINT padding[3];    // pad constant buffer content to 16 byte
     };
-    
-    // enum for identifying the volume dataset to load
-    enum class VOLUME_DATASET
+
+    // constant buffer for passing the second volume of the fused MIP to the HLSL ray casting pixel-shader
+    struct ConstantBufferFusionPS
+    {
+        float fusionTexCoordScale[3];       // maps ray setup coordinates to texture coordinates of the second volume ...
+        float primaryIntensityScale;        // intensity mapping of the first volume : saturate(value * scale + offset)
+        float fusionTexCoordOffset[3];      // ... and offset
+        float primaryIntensityOffset;
+        float fusionVolumeDimensions[3];    // full resolution dimensions of the second volume in voxels
+        float fusionIntensityScale;         // intensity mapping of the second volume
+        float fusionBrickGridDimensions[3]; // dimensions of the brick max grid of the second volume
+        float fusionIntensityOffset;
+    };
+
+    // linear mapping of the voxel values of one volume of the fused MIP, applied per sample before the maximum
+    // (brings the series to a common intensity scale - the display mapping is applied after the maximum)
+    struct IntensityMapping
+    {
+        float windowCenter = 0.5f;  // voxel value mapped to 0.5 (0.0 .. 1.0 = full range of the voxel format)
+        float windowWidth = 1.0f;   // voxel value range mapped to 0.0 .. 1.0
+    };
+
+    // everything needed to record one frame - the target, the per-frame parameters and the volume to render
+    struct FrameContext
+    {
+        DirectX::XMMATRIX       matrixWVP;              // concatenated world-view-projection matrix (not transposed)
+        ID3D11DeviceContext*    pDeviceContext;         // immediate or deferred device context to record to
+        ID3D11RenderTargetView* pRenderTargetView;      // target of the frame
+        RaySetupPass*           pRaySetupPass;          // ray setup pass with render targets of the frame size
+        const VolumeResource*   pVolume;                // volume to render (nullptr -> empty frame)
+        const VolumeResource*   pFusionVolume;          // second, co-registered volume of the fused 3D MIP (nullptr -> single volume)
+        IntensityMapping        primaryIntensity;       // intensity mappings of the fused 3D MIP
+        IntensityMapping        fusionIntensity;
+        UINT                    canvasWidth;
+        UINT                    canvasHeight;
+        float                   raycastStepSize;
+        UINT                    raycastMaxSamples;
+        UINT                    raycastTraversal;
+        UINT                    renderMode;
+        UINT                    sparseThreshold;
+        bool                    renderWireframe;
+        bool                    disableCulling;
+        TemporalSeedPass*       pTemporalSeedPass;      // brick skipping seeded by the previous frame (nullptr -> off)
+        float                   seedMargin;
+        bool                    seedStatistics;
+        AdaptiveRefinementPass* pRefinementPass;        // adaptive image-space refinement (nullptr -> every ray cast)
+        float                   refineThreshold;
+        bool                    footprintLod;           // choose the volume resolution level from the projected voxel footprint
+        WindowLevelPass*        pWindowLevelPass;       // 3D MIP into the raw MIP image + display mapping (nullptr -> MIP straight to target)
+        DisplayMapping          displayMapping;
+        UINT                    projection;             // displayed projection of render mode 5 : 0 = MIP, 1 = MinIP, 2 = AIP
+        BrickPagingPass*        pPagingPass;            // out-of-core paging of the full resolution bricks (nullptr -> volume texture only)
+    };
+
+    // the parameters the UI thread hands to the render thread - the GUI controls edit the UI thread's copy,
+    // every change is published as an immutable snapshot (commands are counters, so no request is lost)
+    struct RenderParameters
     {
-        CT_HEAD = 0,
-        CT_HEAD_ANGIO,
-        MR_ABDOMEN,
-        MR_HEAD_TOF
+        float           cameraDistance = -3.0f;
+        float           quatRotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        UINT            rotationSerial = 0;         // incremented by trackball changes (the render thread animates in between)
+        float           raycastStepSize = 0.003f;
+        UINT            raycastMaxSamples = 550;
+        UINT            raycastTraversal = 0;
+        UINT            renderMode = 0;
+        bool            renderWireframe = false;
+        bool            disableCulling = false;
+        bool            footprintLod = true;
+        UINT            sparseThreshold = 64;
+        UINT            volumeStorage = 0;          // storage of the demo datasets : 0 = 3D texture, 1 = packed bricks
+        bool            temporalSeeding = false;
+        float           seedMargin = 2.0f / 255.0f;
+        bool            seedStatistics = true;
+        bool            adaptiveRefinement = false;
+        float           refineThreshold = 0.03f;
+        DisplayMapping  displayMapping;
+        UINT            projection = 0;
+        UINT            fusionDataset = 0;          // 0 = no fusion, 1 .. 4 = demo dataset fused with the rendered one
+        IntensityMapping primaryIntensity;
+        IntensityMapping fusionIntensity;
+        bool            adaptiveStepSize = false;
+        float           latencyBudgetMSec = 33.3f;
+        float           coarsestStepSize = 0.02f;
+        UINT            idleFramesToRefine = 20;
+        bool            doAnimation = true;
+        float           animationSpeed = 0.5f;
+        UINT            targetFPS = 60;
+        bool            lockToTargetFPS = false;
+        bool            rotateX = true;
+        bool            rotateY = true;
+        bool            rotateZ = false;
+        bool            imageCacheEnabled = false;
+        UINT            imageCacheBudgetMB = 256;
+        VOLUME_DATASET  volumeDataset = VOLUME_DATASET::MR_HEAD_TOF;
+        UINT            datasetSerial = 0;          // incremented by every dataset button click (also reloads the same dataset)
+        UINT            precomputeRotationSerial = 0;
+        UINT            clearImageCacheSerial = 0;
     };
     
+    class DistributedMipRenderer;
+    class SharedFrameRingBuffer;
+
     class RayCastRenderer
     {
     public:
@@ -85,6 +200,8 @@ namespace D3D11_VOLUME_RAYCASTER
         
         // initialize RayCastRenderer - create Direct3D device and swap chain
         bool Initialize(HWND canvasHWND);
+        // initialize RayCastRenderer for offscreen rendering - create Direct3D device and offscreen render target
+        bool InitializeOffscreen(UINT canvasWidth, UINT canvasHeight);
         // release all allocated resources 
         void Release();
         // update hook (timing, animation, ...)
@@ -93,8 +210,17 @@ namespace D3D11_VOLUME_RAYCASTER
         void Render();
         // resize handler - resizes swap chain and recreates render target 
         bool OnResize();
+        // resize the offscreen render target (offscreen rendering only)
+        bool ResizeOffscreen(UINT canvasWidth, UINT canvasHeight);
+        // render a frame to the offscreen render target and read back the 8 bit gray image (offscreen rendering only)
+        bool RenderToImage(std::vector<BYTE>& grayImage);
         // message handler callback
         int CALLBACK HandleMessage(HWND wnd, UINT message, WPARAM wParam, LPARAM lParam);
+        // start rendering on a dedicated render thread (Update() + Render() loop); the calling thread keeps
+        // handling the window messages and hands GUI changes to the render thread as parameter snapshots
+        bool StartRenderThread();
+        // stop the render thread (call from the UI thread before the window is destroyed)
+        void StopRenderThread();
 
         // ------------------------------------------------------------------------------------------------------------
         
@@ -104,11 +230,80 @@ namespace D3D11_VOLUME_RAYCASTER
         void SetCameraDistance(float cameraDistance);
         // load given dataset for volume rendering        
         bool LoadDataset(VOLUME_DATASET volumeDataset);
+        // load only the slab [sliceBegin, sliceEnd) of the given dataset - renders the partial MIP of the slab
+        bool LoadDatasetSlab(VOLUME_DATASET volumeDataset, UINT sliceBegin, UINT sliceEnd);
+        // load given dataset progressively - rendering starts with the first slices, the complete volume replaces the
+        // streamed one once it is resident (resident datasets are used right away)
+        bool LoadDatasetStreaming(VOLUME_DATASET volumeDataset);
+        // load the given dataset with the given voxel format and storage (private copy - not shared through the volume
+        // library); packed bricks render the 3D MIP (render mode 0) and point splatting only
+        bool LoadDatasetAs(VOLUME_DATASET volumeDataset, VOXEL_FORMAT voxelFormat, VOLUME_STORAGE storage);
+        // page the bricks of a bricked volume file into a brick pool of at most poolBudget bytes - the 3D MIP falls back
+        // to the coarse level of the file for bricks not (yet) resident
+        bool LoadPagedDataset(const char* brickedFileName, UINT64 poolBudget);
+        // load a raw volume file of the given description (private copy - not shared through the volume library); volumes
+        // exceeding the 3D texture limits (e.g. whole-body scans) are partitioned and render the 3D MIP and the ray setup
+        // modes (render modes 4 and 5 fall back to the 3D MIP)
+        bool LoadRawVolume(const VolumeDatasetInfo& datasetInfo);
+        // load the uncompressed DICOM series in the given directory (private copy - not shared through the volume library);
+        // the world box follows the voxel spacing of the series
+        bool LoadDicomSeries(const char* directory);
+        // load a live volume of the given dataset description (e.g. an ongoing acquisition) : the initial voxels are taken
+        // from pVolumeData (raw file layout) or are 0 for nullptr; regions are replaced with UpdateVolumeRegion()
+        bool LoadLiveVolume(const VolumeDatasetInfo& datasetInfo, const std::vector<char>* pVolumeData);
+        // replace the voxels of the box [regionBegin, regionEnd) of the live volume (raw file layout, x fastest) - may be
+        // called from any thread, the update is applied by the render thread before the next frame (offscreen : before the
+        // next RenderToImage()); false if the live volume was replaced meanwhile or too many updates are queued
+        bool UpdateVolumeRegion(const UINT regionBegin[3], const UINT regionEnd[3], const char* pRegionData);
+        // load a second, co-registered dataset - the 3D MIP takes the maximum over both volumes in one traversal
+        bool LoadFusionDataset(VOLUME_DATASET volumeDataset);
+        // remove the second dataset (single volume 3D MIP)
+        void ClearFusionDataset();
+        // set the intensity mappings of the volumes of the fused 3D MIP
+        void SetIntensityMappings(const IntensityMapping& primaryIntensity, const IntensityMapping& fusionIntensity);
+        // get the rotation quaternion (x, y, z, w)
+        void GetRotation(float quaternion[4]);
+        // set the rotation quaternion (x, y, z, w) - disables auto-rotation
+        void SetRotation(const float quaternion[4]);
+        // set ray casting parameters : sampling step size, maximum samples per ray and traversal mode
+        void SetRaycastParameters(float raycastStepSize, UINT raycastMaxSamples, UINT raycastTraversal);
+        // set the mapping of the MIP values to display gray values (window/level, gamma, inversion)
+        void SetDisplayMapping(const DisplayMapping& displayMapping);
+        // enable adaptive image-space refinement (fixed step 3D MIP) with the given gray value threshold (0..1)
+        void SetAdaptiveRefinement(bool enabled, float refineThreshold);
+        // get the statistics of the latest refined frame
+        const AdaptiveRefinementStats& GetAdaptiveRefinementStats() const;
+        // get the GPU memory of the loaded volume (all levels and acceleration structures) in bytes
+        size_t GetVolumeMemorySize() const;
+        // enable sort-last distributed rendering across the given number of worker processes
+        bool EnableDistributedRendering(UINT workerCount);
+        // enable the output of every rendered frame (8 bit gray) to a named shared memory ring buffer
+        bool EnableFrameOutput(const wchar_t* sharedMemoryName, UINT slotCount);
+
+        // ------------------------------------------------------------------------------------------------------------
+        // render sessions : several sessions share the device, the pipeline objects and the volumes of one renderer
+
+        // get the Direct3D device and immediate device context
+        ID3D11Device* GetDevice();
+        ID3D11DeviceContext* GetImmediateContext();
+        // get a handle to the given dataset - sessions rendering the same dataset share one volume resource
+        bool AcquireVolume(VOLUME_DATASET volumeDataset, VolumeHandle& volumeHandle);
+        // get the volume library (resident volumes)
+        VolumeLibrary& GetVolumeLibrary();
+        // record a frame to the device context of the frame context; the renderer state is only read,
+        // so frames of different sessions can be recorded concurrently to deferred device contexts
+        void RecordFrame(const FrameContext& frame) const;
         
     protected:
 
         // create Direct3D device, device context and DXGI swapchain
         bool createDeviceAndSwapChain();
+        // create Direct3D device and device context
+        bool createDevice();
+        // create DXGI swapchain for the canvas window
+        bool createSwapChain();
+        // create offscreen render target and staging texture for read back
+        bool createOffscreenRenderTarget();
         // create render target view and bind it to the Output-Merger stage
         bool createAndBindRenderTargetView();
         // set rendering viewport; needs to be called on initialization and every time the hosting window is resized
@@ -125,20 +320,77 @@ namespace D3D11_VOLUME_RAYCASTER
         void setProjectionMatrix();
         // calculate/update combined World-View-Projection matrix
         void calcWorldViewProjectionMatrix();
-        // load volume raw data to internal buffer
-        bool loadVolumeData(char* dataFileName, UINT volColumns, UINT volRows, UINT volSlices);
         // create pipeline state objects for the fixed-function units of the Direct3D 11 pipeline
         bool createPipelineStateObjects();
-        // create 3D texture for volume raw data        
-        bool createVolumeTexture();
-        // create texture and corresponding sampler state objects
-        bool createTextureAndSamplerObjects();
-        // create shader resource views for volume ray casting
-        bool createRaycastShaderResourceViews();
-        // calculate bounding volume scale matrix depending of dimensions of volume raw data
-        void calcScaleMatrix(UINT dimX, UINT dimY, UINT dimZ);
+        // create sampler state objects
+        bool createSamplerStates();
+        // calculate the projected size of one voxel in pixels at the center of the volume (screen footprint)
+        static float calcProjectedVoxelFootprint(const FrameContext& frame);
+        // select the coarsest volume resolution level whose voxels still project to at most one pixel
+        static UINT selectVolumeLod(const FrameContext& frame);
+        // fused 3D MIP : get the transform of the unit-cube to the union box of both volumes (in unit-cube coordinates
+        // of the first volume) and the transforms of the ray setup coordinates of the union box to both volumes
+        static void calcFusionTransforms(
+            const FrameContext& frame, 
+            DirectX::XMMATRIX& matrixUnionBox, 
+            float texCoordScale[3], 
+            float texCoordOffset[3], 
+            ConstantBufferFusionPS& cbFusionPS);
+        // record the ray setup and ray-casting passes of the volume (or partition) of the frame context to the given
+        // targets (the blend state applies to the ray-casting pass - nullptr overwrites the targets)
+        void recordRayCasting(
+            const FrameContext& frame, 
+            ID3D11RenderTargetView* const* rayCastTargetViews, 
+            UINT rayCastTargetCount, 
+            ID3D11BlendState* pBlendState) const;
+        // bind vertex buffer, index buffer and input layout of the proxy geometry (bounding cube)
+        void bindProxyGeometry(ID3D11DeviceContext* pDeviceContext) const;
+        // make the given volume the rendered volume and reset the world and rotation matrix
+        void useVolume(VolumeHandle&& volume, VOLUME_DATASET volumeDataset);
+        // make the given volume of no demo dataset (raw file, DICOM series, ...) the rendered volume - it gets an image
+        // cache identity of its own
+        void useExternalVolume(VolumeHandle&& volume);
+        // can the given volume be shown in the given render mode (partitioned volumes : no sparse voxel list and no
+        // composite of the minimum and average projections; packed volumes : no multi-projection sampler)
+        static bool isRenderModeAvailable(const VolumeResource* pVolume, UINT renderMode);
+        // render the frame content to the render target (without GUI and present)
+        void renderFrame(const DirectX::XMMATRIX& matrixWVP);
+        // does the MIP image hold the given frame (only the window differs - no ray-casting needed)
+        bool isMipImageReusable(const FrameContext& frame) const;
+        // check if the current frame can be served from / added to the image cache
+        bool isImageCacheable() const;
+        // apply the queued region updates to the live volume (render thread) - updated content gets a new image cache identity
+        void applyLiveUpdates();
+        // is the current frame rendered with the seeded brick skipping traversal
+        bool isTemporalSeedingActive() const;
+        // is the current frame rendered with adaptive image-space refinement
+        bool isAdaptiveRefinementActive() const;
+        // feed the render time of the last frame to the step size controller (frame budget sampling)
+        void updateStepSizeController();
+        // get the step size and maximum samples per ray of the current frame (GUI values or controller output)
+        void getFrameSampling(float& raycastStepSize, UINT& raycastMaxSamples) const;
+        // get the image cache key of the current view
+        MipImageKey makeImageCacheKey() const;
+        // add completed back buffer read backs to the image cache and start the read back of a missed key
+        void updateImageCache(const MipImageKey* pMissKey);
+        // release the staging textures of the image cache read back
+        void releaseImageCacheReadbacks();
+        // copy an 8 bit gray image (canvas size) to the back buffer
+        void presentGrayImage(const std::vector<BYTE>& grayImage);
+        // copy the back buffer to the frame output ring buffer (read back is delayed to avoid pipeline stalls)
+        void writeFrameOutput();
         // post-render hook which is called immediately after frame is rendered
         void postRenderHook();
+        // resize swap chain, render target and ray setup targets to the client area of the canvas window
+        bool resizeSwapChain();
+        // render thread : resize on request, update and render until stopped
+        void renderThreadLoop();
+        // UI thread : publish the GUI parameters as new snapshot (caller holds guiMutex_)
+        void publishRenderParameters();
+        // render thread : apply the latest parameter snapshot (if a new one was published)
+        void applyRenderParameters();
+        // fill the image cache with one full auto-rotation (about the selected rotation axes) in the background
+        void precomputeRotation();
         
         // ------------------------------------------------------------------------------------------------------------
         // GUI handling methods/callbacks ...
@@ -149,6 +401,10 @@ namespace D3D11_VOLUME_RAYCASTER
         static void TW_CALL guiCallbackGetCameraDistance(void* value, void* clientData);
         // GUI callback to set the camera distance
         static void TW_CALL guiCallbackSetCameraDistance(const void* value, void* clientData);
+        // GUI callback to get the rotation quaternion (trackball control)
+        static void TW_CALL guiCallbackGetRotation(void* value, void* clientData);
+        // GUI callback to set the rotation quaternion (trackball control)
+        static void TW_CALL guiCallbackSetRotation(const void* value, void* clientData);
         // GUI callback for button 'CT Head' click handler -> load demo dataset CT_head_c256_r256_s225.raw
         static void TW_CALL guiCallbackBtnDataCTHead(void *clientData);
         // GUI callback for button 'CT Head Angio' click handler -> load demo dataset CTA_c512_r512_s79.raw
@@ -157,6 +413,10 @@ namespace D3D11_VOLUME_RAYCASTER
         static void TW_CALL guiCallbackBtnDataMRAbdomen(void *clientData);
         // GUI callback for button 'MR Head TOF Angio' click handler -> load demo dataset MR_TOF_Angio_c416_r512_s112.raw
         static void TW_CALL guiCallbackBtnDataMRHeadTOFAngio(void *clientData);
+        // GUI callback for button 'Precompute Rotation' click handler -> fill image cache for one auto-rotation
+        static void TW_CALL guiCallbackBtnPrecomputeRotation(void *clientData);
+        // GUI callback for button 'Clear Image Cache' click handler
+        static void TW_CALL guiCallbackBtnClearImageCache(void *clientData);
 
         // ------------------------------------------------------------------------------------------------------------
         
@@ -172,9 +432,19 @@ namespace D3D11_VOLUME_RAYCASTER
         IDXGISwapChain*             pSwapChain_ = nullptr;
         
         ID3D11RenderTargetView*     pRenderTargetView_ = nullptr;
+        ID3D11Texture2D*            pOffscreenTexture_ = nullptr;   // render target in offscreen mode (no swap chain)
+        ID3D11Texture2D*            pStagingTexture_ = nullptr;     // CPU read back of the offscreen render target
+        ID3D11Texture2D*            pImageTexture_ = nullptr;       // upload of CPU generated images for presentation
+        bool                        offscreenMode_ = false;
         
         ID3D11VertexShader*         pRayCastingVS_ = nullptr;
         ID3D11PixelShader*          pRayCastingPS_ = nullptr;
+        ID3D11PixelShader*          pRayCastingDDAPS_ = nullptr;
+        ID3D11PixelShader*          pRayCastingSeededPS_ = nullptr;
+        ID3D11PixelShader*          pRayCastingMultiPS_ = nullptr;
+        ID3D11PixelShader*          pRayCastingPagedPS_ = nullptr;
+        ID3D11PixelShader*          pRayCastingPackedPS_ = nullptr;
+        ID3D11PixelShader*          pRayCastingFusedPS_ = nullptr;
         ID3D11PixelShader*          pRaySetupDebugPS_ = nullptr;
 
         ID3D11InputLayout*          pVertexLayout_ = nullptr;
@@ -184,21 +454,21 @@ namespace D3D11_VOLUME_RAYCASTER
         ID3D11Buffer*               pConstantBufferVS_ = nullptr;
         ID3D11Buffer*               pConstantBufferPS_ = nullptr;
         ID3D11Buffer*               pConstantBufferDebugPS_ = nullptr;
+        ID3D11Buffer*               pConstantBufferFusionPS_ = nullptr;
 
-        ID3D11Texture3D*            p3DTexture_ = nullptr;
         ID3D11SamplerState*         pLinearTexSamplerState_ = nullptr;
-        ID3D11ShaderResourceView*   pRaycastShaderResView_ = nullptr;
         
         ID3D11RasterizerState*      pWireFrameRS_ = nullptr;
         ID3D11RasterizerState*      pWireFrameNoCullingRS_ = nullptr;
         ID3D11RasterizerState*      pSolidRS_ = nullptr;
         ID3D11RasterizerState*      pSolidNoCullingRS_ = nullptr;
 
+        ID3D11BlendState*           pMaxBlendState_ = nullptr;
+
         DirectX::XMMATRIX           matrixWorld_;           // needs to be passed every frame on animation/transformation - otherwise constant
         DirectX::XMMATRIX           matrixView_;            // only needs to be passed on view setup changes (e.g. new camera position) 
         DirectX::XMMATRIX           matrixProjection_;      // only needs to be passed when projection params change (view frustum setup, window resize)
         DirectX::XMMATRIX           matrixWVP_;             // concatenated world-view-projection matrix
-        DirectX::XMMATRIX           matrixScale_;           // scale matrix used to scale the unit-cube to the dimension ratio of the raw volume data
         DirectX::XMMATRIX           matrixRotate_;          // rotation matrix controlled by rotation quaternion
 
         UINT                        vertexCount_ = 0;
@@ -217,11 +487,8 @@ namespace D3D11_VOLUME_RAYCASTER
         double      targetRenderTime_ = 1.0 / 60;   // the target render time to achieve the target FPS
         double      deltaTimeMSec_ = 0.0;           // = _targetRenderTime - _renderTime in ms
         bool        lockToTargetFPS_ = false;       // lock-down frame rate to target FPS (default: 60 FPS)
-
-        char*       pVolumeData_ = nullptr;
-        UINT        volColumns_ = 1;
-        UINT        volRows_ = 1;
-        UINT        volSlices_ = 1;
+        FramePacer  framePacer_;                    // locked mode : presents frames on a drift-free schedule of target FPS deadlines
+        double      pacingWaitTime_ = 0.0;          // time spent waiting for the present deadline of the current frame (s)
 
         float       cameraDistance_ = -3.0f;
         bool        renderWireframe_ = false;
@@ -236,8 +503,90 @@ namespace D3D11_VOLUME_RAYCASTER
 
         float       raycastStepSize_ = 0.003f; // sampling step size for ray casting
         UINT        raycastMaxSamples_ = 550;  // maximum number of ray casting samples
-        UINT        renderMode_ = 0;           // render mode : 0 = 3D MIP (default), 1 = front-face, 2 = back-face, 3 = ray vector
+        UINT        raycastTraversal_ = 0;     // ray traversal : 0 = fixed step sampling (default), 1 = exact cell-by-cell DDA
+        UINT        renderMode_ = 0;           // render mode : 0 = 3D MIP (default), 1 = front-face, 2 = back-face, 3 = ray vector, 4 = sparse point MIP, 5 = MIP / MinIP / AIP in one traversal
+        UINT        sparseThreshold_ = 64;     // vessel threshold for the sparse point representation (8 bit intensity)
+        VOLUME_STORAGE volumeStorage_ = VOLUME_STORAGE::TEXTURE; // storage of the demo datasets loaded through the volume library
+        bool        footprintLod_ = true;      // choose the volume resolution level and step size from the projected voxel footprint
+        DisplayMapping displayMapping_;        // window/level, gamma and inversion applied to the MIP values
+        UINT        projection_ = 0;           // displayed projection of render mode 5 : 0 = MIP, 1 = MinIP, 2 = AIP
         
         RaySetupPass    raySetupPass_;  // the render pass to create the ray vector setup
+        PointSplatPass  pointSplatPass_;// the render pass projecting the sparse voxels (point-based MIP)
+        WindowLevelPass windowLevelPass_; // raw MIP image of the last frame and its mapping to gray values
+        FrameContext    lastMipFrame_;  // the frame the MIP image holds
+        bool            mipImageValid_ = false;
+        TemporalSeedPass temporalSeedPass_; // previous MIP image as lower bound of the rays (fixed step 3D MIP only)
+        bool            temporalSeeding_ = false;
+        float           seedMargin_ = 2.0f / 255.0f;
+        bool            seedStatistics_ = true;
+        AdaptiveRefinementPass refinementPass_; // coarse ray-casting with refinement where neighbours disagree
+        bool            adaptiveRefinement_ = false;
+        float           refineThreshold_ = 0.03f;
+        BrickPagingPass brickPagingPass_; // out-of-core volume : resident brick pool fed by I/O threads
+        StreamingVolumeLoader volumeStreamer_; // progressive loading : slice chunks uploaded while the volume is rendered
+
+        // live volume : region updates queued by any thread, applied by the render thread
+        struct LiveVolumeUpdate
+        {
+            UINT                regionBegin[3];
+            UINT                regionEnd[3];
+            std::vector<char>   regionData;     // voxels of the region in the storage format of the live volume
+            UINT64              generation;     // live volume the update was converted for
+        };
+        static const size_t MAX_QUEUED_LIVE_UPDATES = 64;   // updates beyond are rejected until the render thread caught up
+        std::shared_ptr<VolumeResource> pLiveVolume_;   // the updatable volume (also held by volume_ while rendered)
+        VolumeDatasetInfo               liveDatasetInfo_ = { nullptr, 0, 0, 0, 8, { 1.0f, 1.0f, 1.0f } };
+        UINT64                          liveVolumeGeneration_ = 0;  // incremented whenever the live volume is replaced or dropped
+        std::mutex                      liveUpdateMutex_;           // guards the live volume, its description and the update queue
+        std::deque<LiveVolumeUpdate>    liveUpdates_;
+
+        StepSizeController stepSizeController_; // frame budget sampling : step size per frame from measured render times
+        bool            adaptiveStepSize_ = false;
+        float           latencyBudgetMSec_ = 33.3f; // render time budget while interacting (unless locked to target FPS)
+        float           coarsestStepSize_ = 0.02f;
+        UINT            idleFramesToRefine_ = 20;
+        float           lastQuatRotation_[4] = { 0.0f, 0.0f, 0.0f, 1.0f }; // view of the previous frame (interaction detection)
+        float           lastCameraDistance_ = 0.0f;
+        VolumeLibrary   volumeLibrary_; // resident volumes, shared by the renderer and its render sessions
+        VolumeHandle    volume_;        // the volume rendered by the renderer itself (GPU texture + sparse voxels)
+        VolumeHandle    fusionVolume_;  // second volume of the fused 3D MIP (empty handle -> single volume)
+        IntensityMapping primaryIntensity_;
+        IntensityMapping fusionIntensity_;
+
+        std::unique_ptr<DistributedMipRenderer> pDistributedRenderer_;  // sort-last compositor (distributed rendering only)
+        VOLUME_DATASET  currentDataset_ = VOLUME_DATASET::MR_HEAD_TOF;
+        static const UINT EXTERNAL_VOLUME_ID = 0x10000;   // image cache identities of external volumes start here
+        UINT            volumeId_ = static_cast<UINT>(VOLUME_DATASET::MR_HEAD_TOF); // image cache identity of the rendered volume
+        UINT            externalVolumeCount_ = 0;
+        std::vector<BYTE> compositeImage_;  // composited gray image of the distributed rendering
+
+        static const UINT FRAME_OUTPUT_LATENCY = 3;                     // number of staging textures for frame output
+        std::unique_ptr<SharedFrameRingBuffer> pFrameOutput_;           // shared memory frame output (optional)
+        ID3D11Texture2D*    pOutputStagingTextures_[FRAME_OUTPUT_LATENCY] = { nullptr, nullptr, nullptr };
+        UINT64              outputFrameCount_ = 0;                      // frames copied to the staging textures
+
+        // back buffer read back of a rendered frame for the image cache
+        struct ImageCacheReadback
+        {
+            ID3D11Texture2D*    pStagingTexture = nullptr;
+            MipImageKey         key;
+            UINT64              frame = 0;                              // frame counter at copy time
+            bool                pending = false;
+        };
+        static const UINT IMAGE_CACHE_LATENCY = 3;                      // number of staging textures for cache read back
+        MipImageCache       imageCache_;                                // MIP images of repeated orientations (auto-rotation)
+        ImageCacheReadback  imageCacheReadbacks_[IMAGE_CACHE_LATENCY];
+        bool                imageCacheEnabled_ = false;
+        UINT                imageCacheBudgetMB_ = 256;
+
+        // render thread : GUI changes reach the render thread as snapshots through a lock-free triple buffer
+        std::thread                     renderThread_;
+        std::atomic<bool>               stopRenderThread_ { false };
+        std::atomic<bool>               resizePending_ { false };   // window resized - the render thread resizes the swap chain
+        std::mutex                      guiMutex_;                  // AntTweakBar is not thread-safe : event handling vs. TwDraw()
+        RenderParameters                uiParameters_;              // edited by the GUI controls (guarded by guiMutex_)
+        TripleBuffer<RenderParameters>  parameterBuffer_;
+        RenderParameters                appliedParameters_;         // the snapshot applied last (render thread)
     };
 }
@@ -28,7 +28,17 @@
 Texture3D<float>  texVolumeData     : register(t0);
 Texture2D<float4> texCubeFrontFaces : register(t1);
 Texture2D<float4> texCubeBackFaces  : register(t2); 
+Texture2D<float>  texPrevMip        : register(t3);     // raw MIP image of the previous frame (temporal seeding)
+Texture3D<float>  texBrickMax       : register(t4);     // maximum per MAX_BRICK_SIZE^3 brick (including a one voxel apron)
 SamplerState      linearTexSampler  : register(s0);
+Texture3D<float>  texFusionVolumeData : register(t6);   // second, co-registered volume of the fused MIP
+Texture3D<float>  texFusionBrickMax   : register(t7);   // brick max grid of the second volume
+
+// seeding statistics : samples taken, samples skipped by the seed, samples of re-traced rays, seeded rays, re-traced rays
+RWByteAddressBuffer seedStatistics  : register(u1);
+
+// edge length in voxels of a brick of the brick max grid - must match VolumeResource::MAX_BRICK_SIZE
+#define MAX_BRICK_SIZE 8.0
 
 //--------------------------------------------------------------------------------------
 // Constant Buffer Variables
@@ -45,6 +55,18 @@ cbuffer ConstantBufferPS : register(b0)
     float2 canvasPixResolution;
     float raycastStepSize;
     uint raycastMaxSamples;
+    float3 volumeDimensions;
+    uint raycastMaxCells;
+    float3 texCoordScale;       // maps ray setup coordinates of a (slab) volume to texture coordinates
+    float volumeLod;            // resolution level of the volume texture (volumeDimensions are those of the level)
+    float3 texCoordOffset;
+    float packedValueScale;     // packed bricks : 1 / maximum voxel value of the voxel format
+    float3 brickGridDimensions; // dimensions of the brick max grid
+    uint temporalSeeding;       // != 0 : seed the rays with the reprojected MIP image of the previous frame
+    matrix matrixPrevSetupToClip; // ray setup coordinates -> clip space of the previous frame
+    float seedMargin;           // safety margin subtracted from the reprojected MIP value
+    uint collectStatistics;     // != 0 : count samples in seedStatistics
+    float2 padding2;
 }
 
 // consumed by debug pixel-shader only
@@ -72,16 +94,10 @@ VS_OUTPUT VS_RAYCASTING(float4 Pos : POSITION)
 }
 
 //--------------------------------------------------------------------------------------
-// Ray Casting Pixel Shader (3D MIP)
+// Fixed step MIP along the ray from posRayEntry to posRayExit (volume texture coordinates)
 //--------------------------------------------------------------------------------------
-float4 PS_RAYCASTING(VS_OUTPUT input) : SV_Target
+float RaycastFixedStep(float3 posRayEntry, float3 posRayExit)
 {
-    // calculate 2D texture coordinates in pixel-space for position look-up
-    float2 tex = input.Pos.xy * canvasPixResolution;
-    // lookup ray entry end exit position in respective 2D textures
-    float3 posRayEntry = (float3)texCubeFrontFaces.SampleLevel(linearTexSampler, tex, 0);
-    float3 posRayExit = (float3)texCubeBackFaces.SampleLevel(linearTexSampler, tex, 0);
-
     // calculate normalized ray vector
     float3 vecRayNorm = normalize(posRayExit - posRayEntry);
 
@@ -97,14 +113,766 @@ float4 PS_RAYCASTING(VS_OUTPUT input) : SV_Target
     for (uint idx = 0; idx < raycastMaxSamples; idx++)
     {
         // note : use the 'SampleLevel' method instead of 'Sample' to avoid gradient calculation to pixel neighborhood for LOD calculations;
-        // -> our 3D texture has only one mipmap level so we can set LOD level to zero; 
-        // -> LOD = Level Of Detail, used to correctly interpolate between two adjacent mipmaps depending on depth value, if required;
-        maxSampleValue = max(maxSampleValue, texVolumeData.SampleLevel(linearTexSampler, posData, 0));
+        // -> the resolution level is chosen per frame from the projected voxel footprint (volumeLod);
+        // -> LOD = Level Of Detail, the levels of our 3D texture are max down-sampled (MIP preserving);
+        maxSampleValue = max(maxSampleValue, texVolumeData.SampleLevel(linearTexSampler, posData, volumeLod));
+        posData += sampleStep;
+    }
+    return maxSampleValue;
+}
+
+//--------------------------------------------------------------------------------------
+// Ray Casting Pixel Shader (3D MIP)
+//--------------------------------------------------------------------------------------
+float4 PS_RAYCASTING(VS_OUTPUT input) : SV_Target
+{
+    // calculate 2D texture coordinates in pixel-space for position look-up
+    float2 tex = input.Pos.xy * canvasPixResolution;
+    // lookup ray entry end exit position in respective 2D textures
+    float3 posRayEntry = (float3)texCubeFrontFaces.SampleLevel(linearTexSampler, tex, 0);
+    float3 posRayExit = (float3)texCubeBackFaces.SampleLevel(linearTexSampler, tex, 0);
+    posRayEntry = posRayEntry * texCoordScale + texCoordOffset;
+    posRayExit = posRayExit * texCoordScale + texCoordOffset;
+
+    float maxSampleValue = RaycastFixedStep(posRayEntry, posRayExit);
+    return float4(maxSampleValue, maxSampleValue, maxSampleValue, 1.0);
+}
+
+//--------------------------------------------------------------------------------------
+// Multi-Projection Pixel Shader - maximum (MIP), minimum (MinIP) and average (AIP) intensity
+// of the same samples in one traversal, written to three render targets. Unlike the MIP,
+// minimum and average must not see samples outside the volume, so the ray is sampled from
+// entry to exit only. The full resolution level is sampled (the coarser levels are max
+// down-sampled and would bias the minimum and the average).
+//--------------------------------------------------------------------------------------
+struct PS_MULTI_PROJECTION_OUTPUT
+{
+    float MaxIntensity : SV_Target0;
+    float MinIntensity : SV_Target1;
+    float AvgIntensity : SV_Target2;
+};
+
+PS_MULTI_PROJECTION_OUTPUT PS_RAYCASTING_MULTI(VS_OUTPUT input)
+{
+    PS_MULTI_PROJECTION_OUTPUT output = (PS_MULTI_PROJECTION_OUTPUT)0;
+
+    float4 setupEntry = texCubeFrontFaces.Load(int3(input.Pos.xy, 0));
+    if (setupEntry.a == 0.0)
+    {
+        // pixel not covered by the bounding cube
+        return output;
+    }
+    float3 posRayEntry = setupEntry.xyz * texCoordScale + texCoordOffset;
+    float3 posRayExit = (float3)texCubeBackFaces.Load(int3(input.Pos.xy, 0)) * texCoordScale + texCoordOffset;
+
+    float rayLength = length(posRayExit - posRayEntry);
+    float3 sampleStep = (rayLength > 0.0) ? (posRayExit - posRayEntry) * (raycastStepSize / rayLength) : 0.0;
+    uint sampleCount = min((uint)(rayLength / raycastStepSize) + 1, raycastMaxSamples);
+
+    float3 posData = posRayEntry;
+    float maxSampleValue = 0.0;
+    float minSampleValue = 1.0;
+    float sampleSum = 0.0;
+    for (uint idx = 0; idx < sampleCount; idx++)
+    {
+        float sampleValue = texVolumeData.SampleLevel(linearTexSampler, posData, 0);
+        maxSampleValue = max(maxSampleValue, sampleValue);
+        minSampleValue = min(minSampleValue, sampleValue);
+        sampleSum += sampleValue;
+        posData += sampleStep;
+    }
+
+    output.MaxIntensity = maxSampleValue;
+    output.MinIntensity = minSampleValue;
+    output.AvgIntensity = sampleSum / sampleCount;
+    return output;
+}
+
+//--------------------------------------------------------------------------------------
+// Adaptive image-space refinement (compute shaders)
+// The rays of every REFINE_COARSE_STEP-th pixel in x and y are cast first. Each following level
+// halves the lattice spacing : a new pixel is ray-cast if its parent pixels of the coarser level
+// (edge end points or cell corners) differ by more than refineThreshold, otherwise it is
+// interpolated from them. Smooth (mostly dark) regions are therefore interpolated over all
+// levels, while edges and vessels are refined down to single pixels.
+//--------------------------------------------------------------------------------------
+RWTexture2D<float>  refineImage      : register(u0);    // refined MIP image (compute shaders)
+RWByteAddressBuffer refineStatistics : register(u2);    // number of rays cast
+Texture2D<float>    texRefineImage   : register(t5);    // refined MIP image (resolve pixel shader)
+
+cbuffer ConstantBufferRefine : register(b2)
+{
+    uint  refineStep;           // lattice spacing of the current level
+    float refineThreshold;      // maximum difference of parent pixels that is interpolated
+    uint2 refineImageSize;      // image size in pixels
+}
+
+#define REFINE_GROUP_SIZE 8
+
+//--------------------------------------------------------------------------------------
+// Cast the ray of a pixel - pixels not covered by the bounding cube are empty
+//--------------------------------------------------------------------------------------
+float RefineTracePixel(int2 pixel)
+{
+    float4 setupEntry = texCubeFrontFaces.Load(int3(pixel, 0));
+    if (setupEntry.a == 0.0)
+    {
+        return 0.0;
+    }
+    float3 setupExit = (float3)texCubeBackFaces.Load(int3(pixel, 0));
+    refineStatistics.InterlockedAdd(0, 1);
+    return RaycastFixedStep(setupEntry.xyz * texCoordScale + texCoordOffset, setupExit * texCoordScale + texCoordOffset);
+}
+
+// coarse level : cast the rays of the lattice with spacing refineStep
+[numthreads(REFINE_GROUP_SIZE, REFINE_GROUP_SIZE, 1)]
+void CS_REFINE_COARSE(uint3 threadId : SV_DispatchThreadID)
+{
+    uint2 pixel = threadId.xy * refineStep;
+    if (all(pixel < refineImageSize))
+    {
+        refineImage[pixel] = RefineTracePixel((int2)pixel);
+    }
+}
+
+// refinement level : thread (i, j) handles pixel (i, j) * refineStep unless it is part of the coarser level
+[numthreads(REFINE_GROUP_SIZE, REFINE_GROUP_SIZE, 1)]
+void CS_REFINE_LEVEL(uint3 threadId : SV_DispatchThreadID)
+{
+    bool2 odd = (threadId.xy & 1) != 0;
+    int2 pixel = (int2)(threadId.xy * refineStep);
+    if (!any(odd) || any(pixel >= (int2)refineImageSize))
+    {
+        return;
+    }
+
+    // parents : the cell corners (odd x and y) or the end points of the cell edge
+    int step = (int)refineStep;
+    int2 parentOffsets[4];
+    uint parentCount = 2;
+    if (all(odd))
+    {
+        parentOffsets[0] = int2(-step, -step);
+        parentOffsets[1] = int2(step, -step);
+        parentOffsets[2] = int2(-step, step);
+        parentOffsets[3] = int2(step, step);
+        parentCount = 4;
+    }
+    else
+    {
+        int2 axis = odd.x ? int2(step, 0) : int2(0, step);
+        parentOffsets[0] = -axis;
+        parentOffsets[1] = axis;
+        parentOffsets[2] = axis;
+        parentOffsets[3] = axis;
+    }
+
+    float minValue = 1.0;
+    float maxValue = 0.0;
+    float sumValue = 0.0;
+    bool parentsInside = true;
+    [unroll]
+    for (uint idx = 0; idx < 4; idx++)
+    {
+        if (idx < parentCount)
+        {
+            int2 parent = pixel + parentOffsets[idx];
+            parentsInside = parentsInside && all(parent < (int2)refineImageSize);
+            float value = refineImage[clamp(parent, 0, (int2)refineImageSize - 1)];
+            minValue = min(minValue, value);
+            maxValue = max(maxValue, value);
+            sumValue += value;
+        }
+    }
+
+    // the image border beyond the last coarse column / row has no complete parents - always cast
+    if (!parentsInside || maxValue - minValue > refineThreshold)
+    {
+        refineImage[pixel] = RefineTracePixel(pixel);
+    }
+    else
+    {
+        refineImage[pixel] = sumValue / parentCount;
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// Resolve Pixel Shader - copies the refined MIP image to the pixels of the bounding cube
+//--------------------------------------------------------------------------------------
+float4 PS_REFINE_RESOLVE(VS_OUTPUT input) : SV_Target
+{
+    float value = texRefineImage.Load(int3(input.Pos.xy, 0));
+    return float4(value, value, value, 1.0);
+}
+
+//--------------------------------------------------------------------------------------
+// Fixed-step MIP along a ray with brick skipping. Bricks whose maximum cannot exceed
+// max(current MIP, lowerBound) are skipped as a whole; all other samples are taken at
+// the same positions as in PS_RAYCASTING.
+// - samplesSkippedByBound : samples skipped only because of the lower bound
+//--------------------------------------------------------------------------------------
+float TraceBrickSkipping(float3 posRayEntry, float3 sampleStep, float lowerBound, inout uint samplesTaken, inout uint samplesSkippedByBound)
+{
+    float3 brickExtent = MAX_BRICK_SIZE / volumeDimensions;
+    bool3 stepsAlongAxis = (abs(sampleStep) > 1e-12);
+    float3 safeSampleStep = stepsAlongAxis ? sampleStep : 1.0;
+    int3 maxBrick = (int3)brickGridDimensions - 1;
+
+    // initialize MIP value
+    float maxSampleValue = 0.0;
+
+    [loop]
+    for (uint idx = 0; idx < raycastMaxSamples; )
+    {
+        float3 posData = posRayEntry + idx * sampleStep;
+
+        // positions outside the volume map to the border bricks - their apron bounds the border samples
+        int3 brick = clamp((int3)floor(posData / brickExtent), 0, maxBrick);
+        float brickMax = texBrickMax.Load(int4(brick, 0));
+        if (brickMax <= max(maxSampleValue, lowerBound))
+        {
+            // advance to the first sample position at or beyond the brick boundary in ray direction
+            float3 boundary = brick * brickExtent + ((sampleStep > 0.0) ? brickExtent : 0.0);
+            float3 tBoundary = stepsAlongAxis ? (boundary - posData) / safeSampleStep : 1e30;
+            float tExit = min(min(tBoundary.x, tBoundary.y), tBoundary.z);
+            uint skip = (uint)clamp(ceil(tExit), 1.0, (float)(raycastMaxSamples - idx));
+            if (brickMax > maxSampleValue)
+            {
+                samplesSkippedByBound += skip;
+            }
+            idx += skip;
+        }
+        else
+        {
+            maxSampleValue = max(maxSampleValue, texVolumeData.SampleLevel(linearTexSampler, posData, 0));
+            samplesTaken++;
+            idx++;
+        }
+    }
+    return maxSampleValue;
+}
+
+//--------------------------------------------------------------------------------------
+// Ray Casting Pixel Shader (3D MIP) - brick skipping with temporal seeding
+// The MIP value of the previous frame at the reprojected ray center (minus a safety margin) is
+// used as lower bound of the ray maximum, which lets the traversal skip all bricks below it.
+// A ray whose maximum stays below its seed may have skipped its true maximum and is re-traced
+// without seed -> the result equals PS_RAYCASTING.
+//--------------------------------------------------------------------------------------
+float4 PS_RAYCASTING_SEEDED(VS_OUTPUT input) : SV_Target
+{
+    // calculate 2D texture coordinates in pixel-space for position look-up
+    float2 tex = input.Pos.xy * canvasPixResolution;
+    // lookup ray entry end exit position in respective 2D textures
+    float3 posSetupEntry = (float3)texCubeFrontFaces.SampleLevel(linearTexSampler, tex, 0);
+    float3 posSetupExit = (float3)texCubeBackFaces.SampleLevel(linearTexSampler, tex, 0);
+    float3 posRayEntry = posSetupEntry * texCoordScale + texCoordOffset;
+    float3 posRayExit = posSetupExit * texCoordScale + texCoordOffset;
+
+    // calculate sampling step size
+    float3 sampleStep = raycastStepSize * normalize(posRayExit - posRayEntry);
+
+    // seed : lowest previous MIP value of the 2x2 pixels around the reprojected ray center
+    float seed = 0.0;
+    if (0 != temporalSeeding)
+    {
+        float4 posPrevClip = mul(float4(0.5 * (posSetupEntry + posSetupExit), 1.0), matrixPrevSetupToClip);
+        if (posPrevClip.w > 0.0)
+        {
+            float2 texPrev = float2(0.5, -0.5) * posPrevClip.xy / posPrevClip.w + 0.5;
+            float4 prevMip = texPrevMip.GatherRed(linearTexSampler, texPrev);
+            seed = min(min(prevMip.x, prevMip.y), min(prevMip.z, prevMip.w)) - seedMargin;
+        }
+    }
+
+    uint samplesTaken = 0;
+    uint samplesSkippedBySeed = 0;
+    uint samplesRetraced = 0;
+    float maxSampleValue = TraceBrickSkipping(posRayEntry, sampleStep, seed, samplesTaken, samplesSkippedBySeed);
+
+    // every skipped brick is bounded by max(MIP, seed) -> exact if MIP >= seed, re-trace otherwise
+    bool retraced = (maxSampleValue < seed);
+    if (retraced)
+    {
+        uint samplesSkippedUnused = 0;
+        maxSampleValue = TraceBrickSkipping(posRayEntry, sampleStep, 0.0, samplesRetraced, samplesSkippedUnused);
+    }
+
+    if (0 != collectStatistics)
+    {
+        seedStatistics.InterlockedAdd(0, samplesTaken + samplesRetraced);
+        seedStatistics.InterlockedAdd(4, samplesSkippedBySeed);
+        seedStatistics.InterlockedAdd(8, samplesRetraced);
+        seedStatistics.InterlockedAdd(12, (seed > 0.0) ? 1 : 0);
+        seedStatistics.InterlockedAdd(16, retraced ? 1 : 0);
+    }
+    return float4(maxSampleValue, maxSampleValue, maxSampleValue, 1.0);
+}
+
+//--------------------------------------------------------------------------------------
+// Evaluate cubic polynomial c0 + c1*s + c2*s^2 + c3*s^3 (Horner scheme)
+//--------------------------------------------------------------------------------------
+float EvalCubic(float4 c, float s)
+{
+    return ((c.w * s + c.z) * s + c.y) * s + c.x;
+}
+
+//--------------------------------------------------------------------------------------
+// Exact maximum of the trilinear interpolant inside one voxel cell along a ray segment.
+// - cellCorners[0..7] : voxel values at the cell corners, index = x + 2*y + 4*z
+// - a                 : local cell coordinates (0..1) of the segment start
+// - b                 : ray direction in voxel units (local coordinates are a + b*s)
+// - sEnd              : segment length in ray parameter units
+// Along a straight line the trilinear interpolant is a cubic polynomial in s, so its maximum
+// is located either at one of the segment end points or at a root of the (quadratic) derivative.
+//--------------------------------------------------------------------------------------
+float CellSegmentMax(float cellCorners[8], float3 a, float3 b, float sEnd)
+{
+    // trilinear interpolant in monomial form : k0 + k1*x + k2*y + k3*z + k4*xy + k5*xz + k6*yz + k7*xyz
+    float k0 = cellCorners[0];
+    float k1 = cellCorners[1] - cellCorners[0];
+    float k2 = cellCorners[2] - cellCorners[0];
+    float k3 = cellCorners[4] - cellCorners[0];
+    float k4 = cellCorners[3] - cellCorners[1] - cellCorners[2] + cellCorners[0];
+    float k5 = cellCorners[5] - cellCorners[1] - cellCorners[4] + cellCorners[0];
+    float k6 = cellCorners[6] - cellCorners[2] - cellCorners[4] + cellCorners[0];
+    float k7 = cellCorners[7] - cellCorners[3] - cellCorners[5] - cellCorners[6]
+             + cellCorners[1] + cellCorners[2] + cellCorners[4] - cellCorners[0];
+
+    // substitute x = a.x + b.x*s, y = a.y + b.y*s, z = a.z + b.z*s -> cubic polynomial in s
+    float4 c;
+    c.x = k0 + k1 * a.x + k2 * a.y + k3 * a.z + k4 * a.x * a.y + k5 * a.x * a.z + k6 * a.y * a.z + k7 * a.x * a.y * a.z;
+    c.y = k1 * b.x + k2 * b.y + k3 * b.z
+        + k4 * (a.x * b.y + b.x * a.y) + k5 * (a.x * b.z + b.x * a.z) + k6 * (a.y * b.z + b.y * a.z)
+        + k7 * (b.x * a.y * a.z + a.x * b.y * a.z + a.x * a.y * b.z);
+    c.z = k4 * b.x * b.y + k5 * b.x * b.z + k6 * b.y * b.z
+        + k7 * (a.x * b.y * b.z + b.x * a.y * b.z + b.x * b.y * a.z);
+    c.w = k7 * b.x * b.y * b.z;
+
+    // candidates : segment end points ...
+    float maxValue = max(EvalCubic(c, 0.0), EvalCubic(c, sEnd));
+
+    // ... and the stationary points : c1 + 2*c2*s + 3*c3*s^2 = 0
+    float qa = 3.0 * c.w;
+    float qb = 2.0 * c.z;
+    float qc = c.y;
+    if (abs(qa) > 1e-8)
+    {
+        float discriminant = qb * qb - 4.0 * qa * qc;
+        if (discriminant >= 0.0)
+        {
+            float sqrtDisc = sqrt(discriminant);
+            float s0 = (-qb - sqrtDisc) / (2.0 * qa);
+            float s1 = (-qb + sqrtDisc) / (2.0 * qa);
+            if (s0 > 0.0 && s0 < sEnd) maxValue = max(maxValue, EvalCubic(c, s0));
+            if (s1 > 0.0 && s1 < sEnd) maxValue = max(maxValue, EvalCubic(c, s1));
+        }
+    }
+    else if (abs(qb) > 1e-8)
+    {
+        float s0 = -qc / qb;
+        if (s0 > 0.0 && s0 < sEnd) maxValue = max(maxValue, EvalCubic(c, s0));
+    }
+    return maxValue;
+}
+
+//--------------------------------------------------------------------------------------
+// Ray Casting Pixel Shader (3D MIP) - exact cell-by-cell traversal
+// The ray walks through the voxel cells with a 3D DDA (Amanatides & Woo); every cell intersected
+// by the ray is visited exactly once and contributes the exact maximum of the trilinear interpolant
+// along the ray segment inside the cell -> no sampling step size and no missed maxima between samples.
+//--------------------------------------------------------------------------------------
+float4 PS_RAYCASTING_DDA(VS_OUTPUT input) : SV_Target
+{
+    // calculate 2D texture coordinates in pixel-space for position look-up
+    float2 tex = input.Pos.xy * canvasPixResolution;
+    // lookup ray entry end exit position in respective 2D textures
+    float3 posRayEntry = (float3)texCubeFrontFaces.SampleLevel(linearTexSampler, tex, 0);
+    float3 posRayExit = (float3)texCubeBackFaces.SampleLevel(linearTexSampler, tex, 0);
+    posRayEntry = posRayEntry * texCoordScale + texCoordOffset;
+    posRayExit = posRayExit * texCoordScale + texCoordOffset;
+
+    // transform ray to voxel space : voxel centers are located at integer coordinates, the cell
+    // [i, i+1] interpolates between voxel i and voxel i+1 (same convention as the linear sampler)
+    float3 posVoxelEntry = posRayEntry * volumeDimensions - 0.5;
+    float3 vecRayVoxel = (posRayExit - posRayEntry) * volumeDimensions;
+
+    // DDA setup - ray parameter t runs from 0 (entry) to 1 (exit)
+    int3   cell = (int3)floor(posVoxelEntry);
+    int3   cellStep = int3(vecRayVoxel.x >= 0.0 ? 1 : -1, vecRayVoxel.y >= 0.0 ? 1 : -1, vecRayVoxel.z >= 0.0 ? 1 : -1);
+    float3 absRayVoxel = max(abs(vecRayVoxel), 1e-6);
+    float3 tDelta = 1.0 / absRayVoxel;
+    float3 nextBoundary = (float3)cell + (float3)(cellStep > 0);
+    float3 tMax = abs(nextBoundary - posVoxelEntry) * tDelta;
+
+    // initialize MIP value
+    float maxSampleValue = 0.0;
+    float tCurrent = 0.0;
+
+    for (uint idx = 0; idx < raycastMaxCells && tCurrent < 1.0; idx++)
+    {
+        float tNext = min(min(min(tMax.x, tMax.y), tMax.z), 1.0);
+
+        // fetch cell corners (out-of-range loads return zero - matches the border color of the sampler)
+        float cellCorners[8];
+        [unroll]
+        for (int corner = 0; corner < 8; corner++)
+        {
+            int3 offset = int3(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1);
+            cellCorners[corner] = texVolumeData.Load(int4(cell + offset, (int)volumeLod));
+        }
+
+        // the trilinear interpolant is bounded by its corner values - skip the analytic evaluation
+        // if the cell cannot raise the current maximum
+        float cornerMax = max(
+            max(max(cellCorners[0], cellCorners[1]), max(cellCorners[2], cellCorners[3])),
+            max(max(cellCorners[4], cellCorners[5]), max(cellCorners[6], cellCorners[7])));
+        if (cornerMax > maxSampleValue)
+        {
+            float3 posLocal = saturate(posVoxelEntry + tCurrent * vecRayVoxel - (float3)cell);
+            maxSampleValue = max(maxSampleValue, CellSegmentMax(cellCorners, posLocal, vecRayVoxel, tNext - tCurrent));
+        }
+
+        // step to the neighbour cell across the nearest cell boundary
+        if (tMax.x <= tMax.y && tMax.x <= tMax.z)
+        {
+            cell.x += cellStep.x;
+            tMax.x += tDelta.x;
+        }
+        else if (tMax.y <= tMax.z)
+        {
+            cell.y += cellStep.y;
+            tMax.y += tDelta.y;
+        }
+        else
+        {
+            cell.z += cellStep.z;
+            tMax.z += tDelta.z;
+        }
+        tCurrent = tNext;
+    }
+    return float4(maxSampleValue, maxSampleValue, maxSampleValue, 1.0);
+}
+
+//--------------------------------------------------------------------------------------
+// Fused MIP of two co-registered volumes (one traversal, shared ray setup)
+// The ray setup cube spans the union of both volume boxes; each volume maps the setup
+// coordinates to its own texture coordinates and the samples of each volume pass its own
+// linear intensity mapping before the maximum is taken. Both brick max grids skip empty
+// space jointly : a volume is only sampled where its (mapped) brick maximum can raise the
+// ray maximum, and the ray advances to the next position where one of them can.
+//--------------------------------------------------------------------------------------
+cbuffer ConstantBufferFusionPS : register(b3)
+{
+    float3 fusionTexCoordScale;         // maps ray setup coordinates to texture coordinates of the second volume ...
+    float  primaryIntensityScale;       // intensity mapping of the first volume : saturate(value * scale + offset)
+    float3 fusionTexCoordOffset;        // ... and offset
+    float  primaryIntensityOffset;
+    float3 fusionVolumeDimensions;      // full resolution dimensions of the second volume in voxels
+    float  fusionIntensityScale;        // intensity mapping of the second volume
+    float3 fusionBrickGridDimensions;   // dimensions of the brick max grid of the second volume
+    float  fusionIntensityOffset;
+}
+
+//--------------------------------------------------------------------------------------
+// Sample interval [first, last] of the ray inside the texture coordinate box of a volume
+//--------------------------------------------------------------------------------------
+float2 FusionSampleInterval(float3 posEntry, float3 sampleStep, uint sampleCount)
+{
+    bool3 stepsAlongAxis = (abs(sampleStep) > 1e-12);
+    float3 safeSampleStep = stepsAlongAxis ? sampleStep : 1.0;
+    float3 tBox0 = -posEntry / safeSampleStep;
+    float3 tBox1 = (1.0 - posEntry) / safeSampleStep;
+    // rays parallel to an axis are either inside the box slab of that axis for all samples or never
+    float3 insideSlab = (posEntry >= 0.0 && posEntry <= 1.0) ? 1e30 : -1e30;
+    float3 tMin = stepsAlongAxis ? min(tBox0, tBox1) : -insideSlab;
+    float3 tMax = stepsAlongAxis ? max(tBox0, tBox1) : insideSlab;
+    return float2(
+        max(ceil(max(max(tMin.x, tMin.y), tMin.z)), 0.0),
+        min(floor(min(min(tMax.x, tMax.y), tMax.z)), sampleCount - 1.0));
+}
+
+//--------------------------------------------------------------------------------------
+// Next sample index at which a volume can raise the ray maximum (idx itself : sample now)
+//--------------------------------------------------------------------------------------
+float FusionNextSample(
+    Texture3D<float> texBrickMaxGrid, float3 posData, float3 sampleStep, float3 brickExtent, int3 maxBrick,
+    float2 sampleInterval, float idx, float intensityScale, float intensityOffset, float maxSampleValue)
+{
+    if (idx < sampleInterval.x)
+    {
+        return sampleInterval.x;
+    }
+    if (idx > sampleInterval.y)
+    {
+        return 1e30;
+    }
+
+    // the intensity mapping is monotonic - the mapped brick maximum bounds the mapped samples of the brick
+    int3 brick = clamp((int3)floor(posData / brickExtent), 0, maxBrick);
+    float brickMax = saturate(texBrickMaxGrid.Load(int4(brick, 0)) * intensityScale + intensityOffset);
+    if (brickMax > maxSampleValue)
+    {
+        return idx;
+    }
+
+    // first sample position at or beyond the brick boundary in ray direction
+    bool3 stepsAlongAxis = (abs(sampleStep) > 1e-12);
+    float3 safeSampleStep = stepsAlongAxis ? sampleStep : 1.0;
+    float3 boundary = brick * brickExtent + ((sampleStep > 0.0) ? brickExtent : 0.0);
+    float3 tBoundary = stepsAlongAxis ? (boundary - posData) / safeSampleStep : 1e30;
+    return idx + max(ceil(min(min(tBoundary.x, tBoundary.y), tBoundary.z)), 1.0);
+}
+
+float4 PS_RAYCASTING_FUSED(VS_OUTPUT input) : SV_Target
+{
+    float4 setupEntry = texCubeFrontFaces.Load(int3(input.Pos.xy, 0));
+    if (setupEntry.a == 0.0)
+    {
+        // pixel not covered by the bounding cube
+        return float4(0.0, 0.0, 0.0, 1.0);
+    }
+    float3 setupExit = (float3)texCubeBackFaces.Load(int3(input.Pos.xy, 0));
+
+    // shared sample positions along the ray (ray setup coordinates)
+    float rayLength = length(setupExit - setupEntry.xyz);
+    float3 setupStep = (rayLength > 0.0) ? (setupExit - setupEntry.xyz) * (raycastStepSize / rayLength) : 0.0;
+    uint sampleCount = min((uint)(rayLength / raycastStepSize) + 1, raycastMaxSamples);
+
+    // the same positions in texture coordinates of each volume
+    float3 posEntry0 = setupEntry.xyz * texCoordScale + texCoordOffset;
+    float3 sampleStep0 = setupStep * texCoordScale;
+    float2 sampleInterval0 = FusionSampleInterval(posEntry0, sampleStep0, sampleCount);
+    float3 brickExtent0 = MAX_BRICK_SIZE / volumeDimensions;
+    int3 maxBrick0 = (int3)brickGridDimensions - 1;
+
+    float3 posEntry1 = setupEntry.xyz * fusionTexCoordScale + fusionTexCoordOffset;
+    float3 sampleStep1 = setupStep * fusionTexCoordScale;
+    float2 sampleInterval1 = FusionSampleInterval(posEntry1, sampleStep1, sampleCount);
+    float3 brickExtent1 = MAX_BRICK_SIZE / fusionVolumeDimensions;
+    int3 maxBrick1 = (int3)fusionBrickGridDimensions - 1;
+
+    float maxSampleValue = 0.0;
+    [loop]
+    for (float idx = 0.0; idx < sampleCount; )
+    {
+        float3 posData0 = posEntry0 + idx * sampleStep0;
+        float3 posData1 = posEntry1 + idx * sampleStep1;
+        float next0 = FusionNextSample(texBrickMax, posData0, sampleStep0, brickExtent0, maxBrick0, sampleInterval0, idx, primaryIntensityScale, primaryIntensityOffset, maxSampleValue);
+        float next1 = FusionNextSample(texFusionBrickMax, posData1, sampleStep1, brickExtent1, maxBrick1, sampleInterval1, idx, fusionIntensityScale, fusionIntensityOffset, maxSampleValue);
+
+        bool sample0 = (next0 <= idx);
+        bool sample1 = (next1 <= idx);
+        if (sample0)
+        {
+            maxSampleValue = max(maxSampleValue, saturate(texVolumeData.SampleLevel(linearTexSampler, posData0, 0) * primaryIntensityScale + primaryIntensityOffset));
+        }
+        if (sample1)
+        {
+            maxSampleValue = max(maxSampleValue, saturate(texFusionVolumeData.SampleLevel(linearTexSampler, posData1, 0) * fusionIntensityScale + fusionIntensityOffset));
+        }
+        idx = (sample0 || sample1) ? idx + 1.0 : min(min(next0, next1), (float)sampleCount);
+    }
+    return float4(maxSampleValue, maxSampleValue, maxSampleValue, 1.0);
+}
+
+//--------------------------------------------------------------------------------------
+// Out-of-core paging : the bricks of the full resolution volume are paged into the brick
+// pool (bricks of pageBrickSize^3 voxels plus a one voxel apron, so trilinear samples inside
+// a brick need no neighbour brick). The page table holds the pool slot of every resident
+// brick. A sample in a missing brick falls back to the coarse level (texVolumeData); every
+// touched brick sets its bit in pageUsage, which keeps resident bricks and requests missing
+// ones. Page table entries must match BrickPagingPass::PAGE_EMPTY and PAGE_RESIDENT.
+//--------------------------------------------------------------------------------------
+Texture3D<float>    texBrickPool : register(t8);
+Texture3D<uint>     texPageTable : register(t9);
+RWByteAddressBuffer pageUsage    : register(u3);
+
+#define PAGE_EMPTY    0x80000000
+#define PAGE_RESIDENT 0x40000000
+
+cbuffer ConstantBufferPagingPS : register(b4)
+{
+    float3 pagedVolumeDimensions;   // full resolution dimensions in voxels
+    float  pageBrickSize;           // edge length in voxels of a paged brick (without apron)
+    uint3  pageGridDimensions;      // number of bricks per axis
+    uint   pagingPadding1;
+    float3 brickPoolResolution;     // 1 / dimensions of the brick pool texture in voxels
+    float  pagingPadding2;
+}
+
+float4 PS_RAYCASTING_PAGED(VS_OUTPUT input) : SV_Target
+{
+    // calculate 2D texture coordinates in pixel-space for position look-up
+    float2 tex = input.Pos.xy * canvasPixResolution;
+    // lookup ray entry end exit position in respective 2D textures
+    float3 posRayEntry = (float3)texCubeFrontFaces.SampleLevel(linearTexSampler, tex, 0);
+    float3 posRayExit = (float3)texCubeBackFaces.SampleLevel(linearTexSampler, tex, 0);
+
+    // same sample positions as RaycastFixedStep, but the ray ends at its exit point : past it the bricks of the
+    // volume would be looked up (and requested) for nothing
+    float3 sampleStep = raycastStepSize * normalize(posRayExit - posRayEntry);
+    float3 posData = posRayEntry;
+    uint sampleCount = min(raycastMaxSamples, (uint)(length(posRayExit - posRayEntry) / raycastStepSize) + 1);
+
+    // the page table entry is looked up once per brick the ray enters
+    int3 currentBrick = int3(-1, -1, -1);
+    uint pageEntry = PAGE_EMPTY;
+    float3 poolOrigin = 0.0;
+
+    float maxSampleValue = 0.0;
+    [loop]
+    for (uint idx = 0; idx < sampleCount; idx++)
+    {
+        float3 voxelPos = posData * pagedVolumeDimensions;
+        int3 brick = (int3)floor(voxelPos / pageBrickSize);
+        if (all(brick >= 0) && all(brick < (int3)pageGridDimensions))
+        {
+            if (any(brick != currentBrick))
+            {
+                currentBrick = brick;
+                pageEntry = texPageTable.Load(int4(brick, 0));
+                if (PAGE_EMPTY != pageEntry)
+                {
+                    uint brickIndex = ((uint)brick.z * pageGridDimensions.y + (uint)brick.y) * pageGridDimensions.x + (uint)brick.x;
+                    pageUsage.InterlockedOr((brickIndex >> 5) * 4, 1u << (brickIndex & 31));
+                }
+                uint3 slot = uint3(pageEntry & 0x3FF, (pageEntry >> 10) & 0x3FF, (pageEntry >> 20) & 0x3FF);
+                poolOrigin = slot * (pageBrickSize + 2.0) + 1.0 - brick * pageBrickSize;
+            }
+
+            if (pageEntry & PAGE_RESIDENT)
+            {
+                maxSampleValue = max(maxSampleValue, texBrickPool.SampleLevel(linearTexSampler, (poolOrigin + voxelPos) * brickPoolResolution, 0));
+            }
+            else if (PAGE_EMPTY != pageEntry)
+            {
+                // missing brick : coarse fallback until the brick is resident
+                maxSampleValue = max(maxSampleValue, texVolumeData.SampleLevel(linearTexSampler, posData, 0));
+            }
+        }
         posData += sampleStep;
     }
     return float4(maxSampleValue, maxSampleValue, maxSampleValue, 1.0);
 }
 
+//--------------------------------------------------------------------------------------
+// Packed bricks : the full resolution voxels are stored per MAX_BRICK_SIZE^3 brick as
+// minimum plus bit-packed deltas of the brick's bit width (PackedBrickVolume). The bit width
+// is fixed per brick, so every voxel is decoded directly from one or two words - the ray
+// keeps the table entry of the brick it is in, the trilinear interpolation is done on the
+// decoded corner voxels. Entries must match PackedBrickEntry.
+//--------------------------------------------------------------------------------------
+StructuredBuffer<uint2> packedBrickTable : register(t10);  // x : first word, y : brick minimum (bits 0..15) | bit width (bits 16..20)
+ByteAddressBuffer       packedBrickData  : register(t11);  // packed deltas (one padding word at the end)
+
+//--------------------------------------------------------------------------------------
+// Decode one voxel; voxels outside the volume are 0 (border address mode of the sampler)
+//--------------------------------------------------------------------------------------
+float PackedVoxel(int3 voxel, inout int3 cachedBrick, inout uint2 cachedEntry)
+{
+    if (any(voxel < 0) || any(voxel >= (int3)volumeDimensions))
+    {
+        return 0.0;
+    }
+
+    int3 brick = voxel / (int)MAX_BRICK_SIZE;
+    if (any(brick != cachedBrick))
+    {
+        cachedBrick = brick;
+        cachedEntry = packedBrickTable[((uint)brick.z * (uint)brickGridDimensions.y + (uint)brick.y) * (uint)brickGridDimensions.x + (uint)brick.x];
+    }
+
+    uint bitWidth = cachedEntry.y >> 16;
+    uint value = cachedEntry.y & 0xFFFF;
+    if (bitWidth > 0)
+    {
+        uint3 local = (uint3)(voxel - brick * (int)MAX_BRICK_SIZE);
+        uint bitPos = ((local.z * (uint)MAX_BRICK_SIZE + local.y) * (uint)MAX_BRICK_SIZE + local.x) * bitWidth;
+        uint shift = bitPos & 31;
+        uint2 words = packedBrickData.Load2((cachedEntry.x + (bitPos >> 5)) * 4);
+        uint bits = (words.x >> shift) | ((shift + bitWidth > 32) ? (words.y << (32 - shift)) : 0);
+        value += bits & ((1u << bitWidth) - 1);
+    }
+    return (float)value;
+}
+
+//--------------------------------------------------------------------------------------
+// Trilinear sample at the given volume texture coordinates (same voxel centers as SampleLevel)
+//--------------------------------------------------------------------------------------
+float SamplePacked(float3 posData, inout int3 cachedBrick, inout uint2 cachedEntry)
+{
+    float3 voxelPos = posData * volumeDimensions - 0.5;
+    int3 voxel = (int3)floor(voxelPos);
+    float3 w = voxelPos - voxel;
+
+    float c000 = PackedVoxel(voxel + int3(0, 0, 0), cachedBrick, cachedEntry);
+    float c100 = PackedVoxel(voxel + int3(1, 0, 0), cachedBrick, cachedEntry);
+    float c010 = PackedVoxel(voxel + int3(0, 1, 0), cachedBrick, cachedEntry);
+    float c110 = PackedVoxel(voxel + int3(1, 1, 0), cachedBrick, cachedEntry);
+    float c001 = PackedVoxel(voxel + int3(0, 0, 1), cachedBrick, cachedEntry);
+    float c101 = PackedVoxel(voxel + int3(1, 0, 1), cachedBrick, cachedEntry);
+    float c011 = PackedVoxel(voxel + int3(0, 1, 1), cachedBrick, cachedEntry);
+    float c111 = PackedVoxel(voxel + int3(1, 1, 1), cachedBrick, cachedEntry);
+
+    float c00 = lerp(c000, c100, w.x);
+    float c10 = lerp(c010, c110, w.x);
+    float c01 = lerp(c001, c101, w.x);
+    float c11 = lerp(c011, c111, w.x);
+    return lerp(lerp(c00, c10, w.y), lerp(c01, c11, w.y), w.z) * packedValueScale;
+}
+
+//--------------------------------------------------------------------------------------
+// Ray Casting Pixel Shader (3D MIP) - packed bricks
+// Fixed step sampling at the positions of PS_RAYCASTING; bricks whose maximum cannot raise
+// the ray maximum are skipped as a whole (same brick max grid as TraceBrickSkipping).
+//--------------------------------------------------------------------------------------
+float4 PS_RAYCASTING_PACKED(VS_OUTPUT input) : SV_Target
+{
+    // calculate 2D texture coordinates in pixel-space for position look-up
+    float2 tex = input.Pos.xy * canvasPixResolution;
+    // lookup ray entry end exit position in respective 2D textures
+    float3 posRayEntry = (float3)texCubeFrontFaces.SampleLevel(linearTexSampler, tex, 0);
+    float3 posRayExit = (float3)texCubeBackFaces.SampleLevel(linearTexSampler, tex, 0);
+    posRayEntry = posRayEntry * texCoordScale + texCoordOffset;
+    posRayExit = posRayExit * texCoordScale + texCoordOffset;
+
+    float3 sampleStep = raycastStepSize * normalize(posRayExit - posRayEntry);
+    float3 brickExtent = MAX_BRICK_SIZE / volumeDimensions;
+    bool3 stepsAlongAxis = (abs(sampleStep) > 1e-12);
+    float3 safeSampleStep = stepsAlongAxis ? sampleStep : 1.0;
+    int3 maxBrick = (int3)brickGridDimensions - 1;
+
+    // table entry of the brick the last decoded voxel was in
+    int3 cachedBrick = int3(-1, -1, -1);
+    uint2 cachedEntry = uint2(0, 0);
+
+    float maxSampleValue = 0.0;
+    [loop]
+    for (uint idx = 0; idx < raycastMaxSamples; )
+    {
+        float3 posData = posRayEntry + idx * sampleStep;
+
+        // positions outside the volume map to the border bricks - their apron bounds the border samples
+        int3 brick = clamp((int3)floor(posData / brickExtent), 0, maxBrick);
+        float brickMax = texBrickMax.Load(int4(brick, 0));
+        if (brickMax <= maxSampleValue)
+        {
+            // advance to the first sample position at or beyond the brick boundary in ray direction
+            float3 boundary = brick * brickExtent + ((sampleStep > 0.0) ? brickExtent : 0.0);
+            float3 tBoundary = stepsAlongAxis ? (boundary - posData) / safeSampleStep : 1e30;
+            float tExit = min(min(tBoundary.x, tBoundary.y), tBoundary.z);
+            idx += (uint)clamp(ceil(tExit), 1.0, (float)(raycastMaxSamples - idx));
+        }
+        else
+        {
+            maxSampleValue = max(maxSampleValue, SamplePacked(posData, cachedBrick, cachedEntry));
+            idx++;
+        }
+    }
+    return float4(maxSampleValue, maxSampleValue, maxSampleValue, 1.0);
+}
+
 //--------------------------------------------------------------------------------------
 // Ray Casting Setup Pixel Shader - intended for producing debug images
 // - cube front-faces (ray entry position)
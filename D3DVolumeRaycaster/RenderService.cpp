@@ -0,0 +1,579 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: RenderService.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of the RenderService functionality. One receive thread per client,
+//          a single render thread owning the Direct3D device and an encoder thread sending the frames.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#include "stdafx.h"
+#include "RenderService.h"
+
+using namespace std;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    namespace
+    {
+        float elapsedMSec(chrono::steady_clock::time_point begin, chrono::steady_clock::time_point end)
+        {
+            return chrono::duration<float, milli>(end - begin).count();
+        }
+
+        INT64 steadyTimeUSec()
+        {
+            return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    RenderService::RenderService()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    RenderService::~RenderService()
+    {
+        Stop();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Start the service on the given loopback port (0 = ephemeral port)
+    //------------------------------------------------------------------------------------------------------
+    bool RenderService::Start(UINT16 port)
+    {
+        socketsInitialized_ = SocketChannel::InitializeSockets();
+        if (!socketsInitialized_)
+        {
+            return false;
+        }
+        if (!listenChannel_.Listen(port))
+        {
+            Stop();
+            return false;
+        }
+
+        stopping_ = false;
+
+        // the render thread creates and owns the Direct3D device - wait until it is initialized
+        promise<bool> initResult;
+        future<bool> initFuture = initResult.get_future();
+        renderThread_ = thread(&RenderService::renderLoop, this, &initResult);
+        if (!initFuture.get())
+        {
+            Stop();
+            return false;
+        }
+
+        encodeThread_ = thread(&RenderService::encodeLoop, this);
+        acceptThread_ = thread(&RenderService::acceptLoop, this);
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Stop the service and disconnect all clients
+    //------------------------------------------------------------------------------------------------------
+    void RenderService::Stop()
+    {
+        {
+            // set under both queue locks - the render and encode thread cannot miss the wake up between checking
+            // their wait condition and blocking
+            lock_guard<mutex> queueLock(queueMutex_);
+            lock_guard<mutex> encodeLock(encodeMutex_);
+            stopping_ = true;
+        }
+
+        // the accept and receive threads poll stopping_ (a Winsock accept() is not woken up by shutdown())
+        if (acceptThread_.joinable()) acceptThread_.join();
+        listenChannel_.Close();
+
+        {
+            // disconnect the clients - their receive threads exit within POLL_MSEC
+            lock_guard<mutex> lock(sessionsMutex_);
+            for (auto& session : sessions_)
+            {
+                session->channel->Interrupt();
+            }
+        }
+        for (auto& session : sessions_)
+        {
+            if (session->receiveThread.joinable()) session->receiveThread.join();
+        }
+
+        // wake up render and encode thread
+        queueCondition_.notify_all();
+        if (renderThread_.joinable()) renderThread_.join();
+        encodeCondition_.notify_all();
+        if (encodeThread_.joinable()) encodeThread_.join();
+
+        requestQueue_.clear();
+        encodeQueue_.clear();
+        sessions_.clear();
+
+        if (socketsInitialized_)
+        {
+            SocketChannel::ShutdownSockets();
+            socketsInitialized_ = false;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the port the service is listening on
+    //------------------------------------------------------------------------------------------------------
+    UINT16 RenderService::GetPort() const
+    {
+        return listenChannel_.GetLocalPort();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Accept incoming client connections - one receive thread per client
+    //------------------------------------------------------------------------------------------------------
+    void RenderService::acceptLoop()
+    {
+        while (!stopping_)
+        {
+            if (!listenChannel_.WaitReadable(POLL_MSEC))
+            {
+                continue;
+            }
+            shared_ptr<ClientSession> session = make_shared<ClientSession>();
+            session->channel = make_unique<SocketChannel>();
+            if (!listenChannel_.Accept(*session->channel))
+            {
+                break;
+            }
+
+            lock_guard<mutex> lock(sessionsMutex_);
+            // drop sessions of disconnected clients
+            for (auto it = sessions_.begin(); it != sessions_.end();)
+            {
+                if ((*it)->closed)
+                {
+                    (*it)->receiveThread.join();
+                    it = sessions_.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+            session->receiveThread = thread(&RenderService::receiveLoop, this, session);
+            sessions_.push_back(session);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Receive camera updates of a client. A newer update replaces a still pending (stale) one. Requests
+    // that cannot be rendered are dropped before they are queued.
+    //------------------------------------------------------------------------------------------------------
+    void RenderService::receiveLoop(shared_ptr<ClientSession> session)
+    {
+        RenderServiceRequest request;
+        while (!stopping_ && !session->closed)
+        {
+            if (!session->channel->WaitReadable(POLL_MSEC))
+            {
+                continue;
+            }
+            if (!session->channel->ReceiveAll(&request, sizeof(request)))
+            {
+                break;
+            }
+            Clock::time_point receiveTime = Clock::now();
+            if (!ValidateRequest(request))
+            {
+                continue;
+            }
+            if (request.requestKeyframe)
+            {
+                // not part of the pending request - a coalesced request must not drop it
+                session->keyframeRequested = true;
+            }
+
+            lock_guard<mutex> lock(queueMutex_);
+            if (session->hasPending)
+            {
+                // not yet rendered - coalesce
+                session->coalescedRequests++;
+            }
+            else
+            {
+                session->hasPending = true;
+                requestQueue_.push_back(session);
+            }
+            session->pendingRequest = request;
+            session->pendingReceiveTime = receiveTime;
+            queueCondition_.notify_one();
+        }
+        session->closed = true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Check a request received from a client : requests for unknown datasets, empty canvases or invalid
+    // camera / sampling values are rejected, the canvas size and the sampling are clamped to what the 
+    // service renders (a client must not make the render thread allocate arbitrary render targets)
+    //------------------------------------------------------------------------------------------------------
+    bool RenderService::ValidateRequest(RenderServiceRequest& request)
+    {
+        if (request.volumeDataset > static_cast<UINT32>(VOLUME_DATASET::MR_HEAD_TOF) || 
+            0 == request.canvasWidth || 0 == request.canvasHeight || 
+            request.raycastTraversal > 1)
+        {
+            return false;
+        }
+        float quatLengthSq = 0.0f;
+        for (int idx = 0; idx < 4; idx++)
+        {
+            if (!isfinite(request.quatRotation[idx]))
+            {
+                return false;
+            }
+            quatLengthSq += request.quatRotation[idx] * request.quatRotation[idx];
+        }
+        if (quatLengthSq < 1.0e-6f || !isfinite(request.cameraDistance) || !isfinite(request.raycastStepSize))
+        {
+            return false;
+        }
+
+        request.canvasWidth = min(request.canvasWidth, static_cast<UINT32>(MAX_CANVAS_SIZE));
+        request.canvasHeight = min(request.canvasHeight, static_cast<UINT32>(MAX_CANVAS_SIZE));
+        request.raycastMaxSamples = max(1u, min(request.raycastMaxSamples, static_cast<UINT32>(MAX_RAYCAST_SAMPLES)));
+        // same range as the GUI of the renderer
+        request.raycastStepSize = max(0.0001f, min(request.raycastStepSize, 0.1f));
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Render thread : owns the offscreen renderer and renders all queued requests as one batch - the frames of
+    // the batch are recorded concurrently to the deferred contexts of the client render sessions
+    //------------------------------------------------------------------------------------------------------
+    void RenderService::renderLoop(promise<bool>* pInitResult)
+    {
+        // the host renderer owns the device, the pipeline objects and the volume library; every client renders
+        // through its own render session (camera, parameters, render targets) from the shared volumes
+        RayCastRenderer renderer;
+        bool initialized = renderer.InitializeOffscreen(64, 64);
+        pInitResult->set_value(initialized);
+        if (!initialized)
+        {
+            renderer.Release();
+            return;
+        }
+
+        // render sessions are owned by the render thread - created on the first request of a client and
+        // released once the client is gone
+        struct ClientRenderSession
+        {
+            weak_ptr<ClientSession>         client;
+            unique_ptr<RenderSession>       session;
+            UINT32                          volumeDataset;
+        };
+        vector<ClientRenderSession> renderSessions;
+
+        vector<EncodeJob> jobs;
+        vector<RenderSession*> batchSessions;
+        while (true)
+        {
+            // take all pending requests - the frames of a batch are recorded concurrently
+            jobs.clear();
+            {
+                unique_lock<mutex> lock(queueMutex_);
+                queueCondition_.wait(lock, [this]() { return stopping_ || !requestQueue_.empty(); });
+                if (stopping_)
+                {
+                    break;
+                }
+                while (!requestQueue_.empty())
+                {
+                    EncodeJob job;
+                    job.session = requestQueue_.front();
+                    requestQueue_.pop_front();
+                    job.request = job.session->pendingRequest;
+                    job.receiveTime = job.session->pendingReceiveTime;
+                    job.coalescedRequests = job.session->coalescedRequests;
+                    job.session->hasPending = false;
+                    job.session->coalescedRequests = 0;
+                    if (!job.session->closed)
+                    {
+                        jobs.push_back(move(job));
+                    }
+                }
+            }
+
+            // drop render sessions of disconnected clients (releases volumes nobody views anymore)
+            renderSessions.erase(
+                remove_if(renderSessions.begin(), renderSessions.end(), [](const ClientRenderSession& renderSession)
+                {
+                    shared_ptr<ClientSession> client = renderSession.client.lock();
+                    return !client || client->closed;
+                }),
+                renderSessions.end());
+
+            Clock::time_point renderStart = Clock::now();
+
+            batchSessions.clear();
+            for (auto it = jobs.begin(); it != jobs.end();)
+            {
+                it->queueTimeMSec = elapsedMSec(it->receiveTime, renderStart);
+
+                auto renderSession = find_if(renderSessions.begin(), renderSessions.end(), [&it](const ClientRenderSession& candidate)
+                {
+                    return candidate.client.lock() == it->session;
+                });
+                if (renderSession == renderSessions.end())
+                {
+                    ClientRenderSession newSession;
+                    newSession.client = it->session;
+                    newSession.session = make_unique<RenderSession>();
+                    newSession.volumeDataset = ~0u;
+                    renderSessions.push_back(move(newSession));
+                    renderSession = renderSessions.end() - 1;
+                    if (!renderSession->session->Initialize(&renderer, it->request.canvasWidth, it->request.canvasHeight))
+                    {
+                        renderSessions.erase(renderSession);
+                        it = jobs.erase(it);
+                        continue;
+                    }
+                }
+
+                RenderServiceRequest& request = it->request;
+                RenderSession* pSession = renderSession->session.get();
+                if (request.volumeDataset != renderSession->volumeDataset)
+                {
+                    // clients viewing the same study share one resident volume
+                    VolumeHandle volume;
+                    if (!renderer.AcquireVolume(static_cast<VOLUME_DATASET>(request.volumeDataset), volume))
+                    {
+                        it = jobs.erase(it);
+                        continue;
+                    }
+                    pSession->SetVolume(move(volume));
+                    renderSession->volumeDataset = request.volumeDataset;
+                }
+                if (!pSession->Resize(request.canvasWidth, request.canvasHeight))
+                {
+                    it = jobs.erase(it);
+                    continue;
+                }
+                pSession->SetCamera(request.quatRotation, request.cameraDistance);
+                pSession->SetRaycastParameters(request.raycastStepSize, request.raycastMaxSamples, request.raycastTraversal);
+                batchSessions.push_back(pSession);
+                ++it;
+            }
+
+            RenderSession::RecordFrames(batchSessions);
+
+            // submit the recorded frames and read them back in request order
+            for (size_t idx = 0; idx < jobs.size(); idx++)
+            {
+                EncodeJob& job = jobs[idx];
+                if (!batchSessions[idx]->ReadFrame(job.image))
+                {
+                    continue;
+                }
+                job.renderTimeMSec = elapsedMSec(renderStart, Clock::now());
+
+                lock_guard<mutex> lock(encodeMutex_);
+                encodeQueue_.push_back(move(job));
+                encodeCondition_.notify_one();
+            }
+        }
+
+        // sessions use the device of the host renderer - release them first
+        renderSessions.clear();
+        renderer.Release();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Encoder thread : encodes rendered frames and sends them to the requesting clients
+    //------------------------------------------------------------------------------------------------------
+    void RenderService::encodeLoop()
+    {
+        vector<BYTE> encodedFrame;
+        while (true)
+        {
+            EncodeJob job;
+            {
+                unique_lock<mutex> lock(encodeMutex_);
+                encodeCondition_.wait(lock, [this]() { return stopping_ || !encodeQueue_.empty(); });
+                if (stopping_)
+                {
+                    break;
+                }
+                job = move(encodeQueue_.front());
+                encodeQueue_.pop_front();
+            }
+
+            FrameEncoder& encoder = job.session->encoder;
+            if (job.session->keyframeRequested.exchange(false))
+            {
+                encoder.ForceKeyframe();
+            }
+            encoder.Encode(job.image.data(), job.request.canvasWidth, job.request.canvasHeight, encodedFrame);
+            Clock::time_point encodeEnd = Clock::now();
+            const FrameCodecStats& codecStats = encoder.GetLastStats();
+
+            RenderServiceFrameHeader header;
+            header.requestId = job.request.requestId;
+            header.width = job.request.canvasWidth;
+            header.height = job.request.canvasHeight;
+            header.encodedSize = static_cast<UINT32>(encodedFrame.size());
+            header.coalescedRequests = job.coalescedRequests;
+            header.queueTimeMSec = job.queueTimeMSec;
+            header.renderTimeMSec = job.renderTimeMSec;
+            header.encodeTimeMSec = codecStats.encodeTimeMSec;
+            header.serverLatencyMSec = elapsedMSec(job.receiveTime, encodeEnd);
+            header.clientTimeUSec = job.request.clientTimeUSec;
+
+            {
+                lock_guard<mutex> lock(job.session->sendMutex);
+                if (!job.session->channel->SendAll(&header, sizeof(header)) ||
+                    !job.session->channel->SendAll(encodedFrame.data(), encodedFrame.size()))
+                {
+                    // the client did not get the new delta reference - resynchronize with a keyframe (the receive
+                    // thread ends the session of a client that is gone)
+                    encoder.ForceKeyframe();
+                    job.session->channel->Interrupt();
+                    job.session->closed = true;
+                }
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Loopback client stand-in : a sender thread rotates the camera in small steps and sends an update
+    // every 2 ms, while the receive loop decodes the frames and measures the end-to-end latency
+    //------------------------------------------------------------------------------------------------------
+    int RenderService::RunLoopbackClient(UINT16 port, UINT frameCount)
+    {
+        if (!SocketChannel::InitializeSockets())
+        {
+            return 1;
+        }
+
+        int exitCode = 1;
+        {
+            SocketChannel channel;
+            if (channel.Connect("127.0.0.1", port))
+            {
+                atomic<bool> receiving { true };
+                atomic<bool> keyframeNeeded { false };
+
+                thread senderThread([&]()
+                {
+                    RenderServiceRequest request = { 0 };
+                    request.volumeDataset = static_cast<UINT32>(VOLUME_DATASET::MR_HEAD_TOF);
+                    request.canvasWidth = 512;
+                    request.canvasHeight = 512;
+                    request.cameraDistance = -3.0f;
+                    request.raycastStepSize = 0.001f;
+                    request.raycastMaxSamples = 2048;
+                    request.raycastTraversal = 0;
+                    while (receiving)
+                    {
+                        request.requestId++;
+                        float angle = 0.01f * request.requestId;
+                        request.quatRotation[0] = 0.0f;
+                        request.quatRotation[1] = sinf(0.5f * angle);
+                        request.quatRotation[2] = 0.0f;
+                        request.quatRotation[3] = cosf(0.5f * angle);
+                        request.clientTimeUSec = steadyTimeUSec();
+                        request.requestKeyframe = keyframeNeeded.exchange(false) ? 1 : 0;
+                        if (!channel.SendAll(&request, sizeof(request)))
+                        {
+                            break;
+                        }
+                        Sleep(2);
+                    }
+                });
+
+                vector<BYTE> encodedFrame;
+                FrameDecoder decoder;
+                float minLatency = FLT_MAX, maxLatency = 0.0f, sumLatency = 0.0f;
+                UINT receivedFrames = 0, coalescedRequests = 0, resyncRequests = 0;
+                size_t rawBytes = 0, encodedBytes = 0;
+                bool awaitingKeyframe = false;
+
+                RenderServiceFrameHeader header;
+                while (receivedFrames < frameCount && channel.ReceiveAll(&header, sizeof(header)))
+                {
+                    encodedFrame.resize(header.encodedSize);
+                    if (!channel.ReceiveAll(encodedFrame.data(), encodedFrame.size()))
+                    {
+                        break;
+                    }
+                    if (!decoder.Decode(encodedFrame.data(), encodedFrame.size()))
+                    {
+                        // lost the delta reference - request a keyframe once and skip frames until it arrives (the
+                        // periodic keyframe resynchronizes if the request is lost)
+                        if (!awaitingKeyframe)
+                        {
+                            keyframeNeeded = true;
+                            awaitingKeyframe = true;
+                            resyncRequests++;
+                        }
+                        continue;
+                    }
+                    awaitingKeyframe = false;
+                    rawBytes += decoder.GetFrame().size();
+                    encodedBytes += encodedFrame.size();
+
+                    const float latency = 0.001f * (steadyTimeUSec() - header.clientTimeUSec);
+                    minLatency = min(minLatency, latency);
+                    maxLatency = max(maxLatency, latency);
+                    sumLatency += latency;
+                    coalescedRequests += header.coalescedRequests;
+                    receivedFrames++;
+                }
+
+                receiving = false;
+                channel.Interrupt();
+                senderThread.join();
+
+                if (receivedFrames == frameCount)
+                {
+                    const size_t bufferSize = 256;
+                    char charBuffer[bufferSize] = { 0 };
+                    sprintf_s(
+                        charBuffer,
+                        bufferSize,
+                        "render client : %u frames, %u requests coalesced, %u keyframe requests, compression %4.1f : 1 - end-to-end latency min : %4.2f ms, avg : %4.2f ms, max : %4.2f ms\n",
+                        receivedFrames,
+                        coalescedRequests,
+                        resyncRequests,
+                        static_cast<float>(rawBytes) / encodedBytes,
+                        minLatency,
+                        sumLatency / receivedFrames,
+                        maxLatency);
+                    OutputDebugStringA(charBuffer);
+                    exitCode = 0;
+                }
+            }
+        }
+        SocketChannel::ShutdownSockets();
+
+        return exitCode;
+    }
+}
@@ -0,0 +1,152 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: RenderService.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: include file for implementation of the RenderService functionality. Serves MIP frames
+//          rendered offscreen to remote clients over TCP (request queue with per-client coalescing).
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+#include "SocketChannel.h"
+#include "RenderSession.h"
+#include "FrameCodec.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    // camera state sent by a client
+    struct RenderServiceRequest
+    {
+        UINT32  requestId;
+        UINT32  volumeDataset;          // VOLUME_DATASET to render
+        UINT32  canvasWidth;
+        UINT32  canvasHeight;
+        float   quatRotation[4];
+        float   cameraDistance;
+        float   raycastStepSize;
+        UINT32  raycastMaxSamples;
+        UINT32  raycastTraversal;
+        INT64   clientTimeUSec;         // client send time - echoed in the frame header
+        UINT32  requestKeyframe;        // != 0 : the client lost its reference frame - the next frame is a keyframe
+    };
+
+    // header of an encoded frame sent to a client (followed by encodedSize bytes, see FrameEncoder)
+    struct RenderServiceFrameHeader
+    {
+        UINT32  requestId;
+        UINT32  width;
+        UINT32  height;
+        UINT32  encodedSize;
+        UINT32  coalescedRequests;      // number of stale requests replaced by this one
+        float   queueTimeMSec;
+        float   renderTimeMSec;
+        float   encodeTimeMSec;
+        float   serverLatencyMSec;      // request received -> frame sent
+        INT64   clientTimeUSec;
+    };
+
+    class RenderService
+    {
+    public:
+        // constructor / desctructor
+        RenderService();
+        virtual ~RenderService();
+
+        // avoid usage of copy constructor and =operator ...
+        RenderService(RenderService const&) = delete;
+        RenderService& operator= (RenderService const&) = delete;
+
+        // start the service on the given loopback port (0 = ephemeral port)
+        bool Start(UINT16 port);
+        // stop the service and disconnect all clients
+        void Stop();
+        // get the port the service is listening on
+        UINT16 GetPort() const;
+
+        // loopback client stand-in : sends the given number of camera updates (faster than frames can be
+        // rendered, which exercises coalescing) and reports the end-to-end latency
+        static int RunLoopbackClient(UINT16 port, UINT frameCount);
+
+        // check a request received from a client and clamp its parameters to the supported range - false for requests
+        // that cannot be rendered (unknown dataset, empty canvas, invalid camera)
+        static bool ValidateRequest(RenderServiceRequest& request);
+
+    private:
+
+        typedef std::chrono::steady_clock Clock;
+
+        struct ClientSession
+        {
+            std::unique_ptr<SocketChannel>  channel;
+            std::thread                     receiveThread;
+            std::mutex                      sendMutex;
+            std::atomic<bool>               closed { false };
+            // delta reference is per client (encode thread only) - a (re)connected client starts with a keyframe
+            FrameEncoder                    encoder { KEYFRAME_INTERVAL };
+            std::atomic<bool>               keyframeRequested { false };    // set by the receive thread
+            // pending request - guarded by queueMutex_
+            bool                            hasPending = false;
+            RenderServiceRequest            pendingRequest;
+            Clock::time_point               pendingReceiveTime;
+            UINT32                          coalescedRequests = 0;
+        };
+
+        struct EncodeJob
+        {
+            std::shared_ptr<ClientSession>  session;
+            RenderServiceRequest            request;
+            std::vector<BYTE>               image;
+            UINT32                          coalescedRequests;
+            Clock::time_point               receiveTime;
+            float                           queueTimeMSec;
+            float                           renderTimeMSec;
+        };
+
+        void acceptLoop();
+        void receiveLoop(std::shared_ptr<ClientSession> session);
+        void renderLoop(std::promise<bool>* pInitResult);
+        void encodeLoop();
+
+        static const UINT   KEYFRAME_INTERVAL = 30;             // periodic keyframe - bounds the artifacts of a corrupted delta
+        static const UINT   MAX_CANVAS_SIZE = 4096;             // canvas width and height of a request are clamped
+        static const UINT   MAX_RAYCAST_SAMPLES = 4096;         // ... and its maximum number of samples per ray
+        static const DWORD  POLL_MSEC = 100;                    // accept and receive threads check stopping_ in this interval
+
+        SocketChannel                                   listenChannel_;
+        std::thread                                     acceptThread_;
+        std::thread                                     renderThread_;
+        std::thread                                     encodeThread_;
+        std::atomic<bool>                               stopping_ { false };
+        bool                                            socketsInitialized_ = false;
+
+        std::mutex                                      sessionsMutex_;
+        std::vector<std::shared_ptr<ClientSession>>     sessions_;
+
+        // request queue : every client is queued at most once, newer camera updates replace the pending one
+        std::mutex                                      queueMutex_;
+        std::condition_variable                         queueCondition_;
+        std::deque<std::shared_ptr<ClientSession>>      requestQueue_;
+
+        // rendered frames waiting for encoding - encoding runs off the render thread
+        std::mutex                                      encodeMutex_;
+        std::condition_variable                         encodeCondition_;
+        std::deque<EncodeJob>                           encodeQueue_;
+    };
+}
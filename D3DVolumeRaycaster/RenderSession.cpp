@@ -0,0 +1,400 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: RenderSession.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of the RenderSession functionality.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#include "stdafx.h"
+#include "RenderSession.h"
+
+using namespace DirectX;
+using namespace std;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    RenderSession::RenderSession()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    RenderSession::~RenderSession()
+    {
+        Release();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Initialize the session on the device of the given host renderer. The session uses the shaders,
+    // pipeline states and constant buffers of the host; only the render targets are its own.
+    //------------------------------------------------------------------------------------------------------
+    bool RenderSession::Initialize(RayCastRenderer* pRenderer, UINT canvasWidth, UINT canvasHeight)
+    {
+        HRESULT hr = S_OK;
+
+        assert(pRenderer);
+
+        pRenderer_ = pRenderer;
+        canvasWidth_ = max(canvasWidth, 1u);
+        canvasHeight_ = max(canvasHeight, 1u);
+
+        ID3D11Device* pD3DDevice = pRenderer_->GetDevice();
+        if (nullptr == pD3DDevice)
+        {
+            return false;
+        }
+
+        hr = pD3DDevice->CreateDeferredContext(0, &pDeferredContext_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        if (!createRenderTarget()) return false;
+
+        return raySetupPass_.Initialize(pD3DDevice, canvasWidth_, canvasHeight_);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Release all allocated resources 
+    //------------------------------------------------------------------------------------------------------
+    void RenderSession::Release()
+    {
+        stopRecordThread();
+        raySetupPass_.Release();
+        volume_.Reset();
+        SAFE_RELEASE(pCommandList_);
+        SAFE_RELEASE(pStagingTexture_);
+        SAFE_RELEASE(pRenderTargetView_);
+        SAFE_RELEASE(pRenderTexture_);
+        SAFE_RELEASE(pDeferredContext_);
+        pRenderer_ = nullptr;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create offscreen render target and staging texture for read back
+    //------------------------------------------------------------------------------------------------------
+    bool RenderSession::createRenderTarget()
+    {
+        HRESULT hr = S_OK;
+
+        ID3D11Device* pD3DDevice = pRenderer_->GetDevice();
+
+        D3D11_TEXTURE2D_DESC texDesc;
+        ZeroMemory(&texDesc, sizeof(D3D11_TEXTURE2D_DESC));
+        texDesc.Width = canvasWidth_;
+        texDesc.Height = canvasHeight_;
+        texDesc.MipLevels = 1;
+        texDesc.ArraySize = 1;
+        texDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        texDesc.SampleDesc.Count = 1;
+        texDesc.SampleDesc.Quality = 0;
+        texDesc.Usage = D3D11_USAGE_DEFAULT;
+        texDesc.BindFlags = D3D11_BIND_RENDER_TARGET;
+        texDesc.CPUAccessFlags = 0;
+        texDesc.MiscFlags = 0;
+
+        hr = pD3DDevice->CreateTexture2D(&texDesc, nullptr, &pRenderTexture_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        hr = pD3DDevice->CreateRenderTargetView(pRenderTexture_, nullptr, &pRenderTargetView_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        texDesc.Usage = D3D11_USAGE_STAGING;
+        texDesc.BindFlags = 0;
+        texDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+        hr = pD3DDevice->CreateTexture2D(&texDesc, nullptr, &pStagingTexture_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Resize the offscreen render target
+    //------------------------------------------------------------------------------------------------------
+    bool RenderSession::Resize(UINT canvasWidth, UINT canvasHeight)
+    {
+        if (nullptr == pRenderer_) return false;
+
+        canvasWidth = max(canvasWidth, 1u);
+        canvasHeight = max(canvasHeight, 1u);
+        if (canvasWidth == canvasWidth_ && canvasHeight == canvasHeight_) return true;
+
+        canvasWidth_ = canvasWidth;
+        canvasHeight_ = canvasHeight;
+
+        // a recorded frame refers to the old render targets
+        SAFE_RELEASE(pCommandList_);
+        SAFE_RELEASE(pStagingTexture_);
+        SAFE_RELEASE(pRenderTargetView_);
+        SAFE_RELEASE(pRenderTexture_);
+
+        if (!createRenderTarget()) return false;
+
+        return raySetupPass_.OnResize(pRenderer_->GetDevice(), canvasWidth_, canvasHeight_);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Set the volume to render
+    //------------------------------------------------------------------------------------------------------
+    void RenderSession::SetVolume(VolumeHandle volume)
+    {
+        volume_ = std::move(volume);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Set the camera : rotation quaternion (x, y, z, w) and camera distance (= z position of camera)
+    //------------------------------------------------------------------------------------------------------
+    void RenderSession::SetCamera(const float quaternion[4], float cameraDistance)
+    {
+        for (int idx = 0; idx < 4; idx++)
+        {
+            quatRotation_[idx] = quaternion[idx];
+        }
+        cameraDistance_ = cameraDistance;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Set ray casting parameters : sampling step size, maximum samples per ray and traversal mode
+    //------------------------------------------------------------------------------------------------------
+    void RenderSession::SetRaycastParameters(float raycastStepSize, UINT raycastMaxSamples, UINT raycastTraversal)
+    {
+        raycastStepSize_ = raycastStepSize;
+        raycastMaxSamples_ = raycastMaxSamples;
+        raycastTraversal_ = raycastTraversal;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Set render mode and vessel threshold of the point-based MIP
+    //------------------------------------------------------------------------------------------------------
+    void RenderSession::SetRenderMode(UINT renderMode, UINT sparseThreshold)
+    {
+        renderMode_ = renderMode;
+        sparseThreshold_ = sparseThreshold;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Record the frame to the deferred device context. Only the session itself and the (read-only) host
+    // renderer and volume are accessed, so sessions can record concurrently on different threads.
+    //------------------------------------------------------------------------------------------------------
+    bool RenderSession::RecordFrame()
+    {
+        HRESULT hr = S_OK;
+
+        if (nullptr == pDeferredContext_)
+        {
+            return false;
+        }
+        SAFE_RELEASE(pCommandList_);
+
+        // world-view-projection matrix of the session camera (see RayCastRenderer for the conventions)
+        XMMATRIX matrixWorld = volume_ ? volume_->GetWorldMatrix() : XMMatrixIdentity();
+        XMMATRIX matrixRotate = XMMatrixRotationQuaternion(XMVectorSet(quatRotation_[0], quatRotation_[1], quatRotation_[2], quatRotation_[3]));
+        XMMATRIX matrixView = XMMatrixLookAtLH(
+            XMVectorSet(0.0f, 0.0f, cameraDistance_, 0.0f),
+            XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f),
+            XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+        XMMATRIX matrixProjection = XMMatrixPerspectiveFovLH(XM_PIDIV4, canvasWidth_ / static_cast<FLOAT>(canvasHeight_), 0.01f, 10.0f);
+
+        FrameContext frame;
+        frame.matrixWVP = matrixWorld * matrixRotate * matrixView * matrixProjection;
+        frame.pDeviceContext = pDeferredContext_;
+        frame.pRenderTargetView = pRenderTargetView_;
+        frame.pRaySetupPass = &raySetupPass_;
+        frame.pVolume = volume_ ? &*volume_ : nullptr;
+        frame.canvasWidth = canvasWidth_;
+        frame.canvasHeight = canvasHeight_;
+        frame.raycastStepSize = raycastStepSize_;
+        frame.raycastMaxSamples = raycastMaxSamples_;
+        frame.raycastTraversal = raycastTraversal_;
+        frame.renderMode = renderMode_;
+        frame.sparseThreshold = sparseThreshold_;
+        frame.renderWireframe = false;
+        frame.disableCulling = false;
+        frame.pTemporalSeedPass = nullptr;
+        frame.seedMargin = 0.0f;
+        frame.seedStatistics = false;
+        frame.pRefinementPass = nullptr;
+        frame.refineThreshold = 0.0f;
+        frame.footprintLod = true;
+        frame.pWindowLevelPass = nullptr;
+        frame.pFusionVolume = nullptr;
+        frame.projection = 0;
+        frame.pPagingPass = nullptr;
+
+        pRenderer_->RecordFrame(frame);
+
+        hr = pDeferredContext_->FinishCommandList(FALSE, &pCommandList_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Execute the recorded frame on the immediate device context and read back the gray image
+    //------------------------------------------------------------------------------------------------------
+    bool RenderSession::ReadFrame(std::vector<BYTE>& grayImage)
+    {
+        HRESULT hr = S_OK;
+
+        if (nullptr == pCommandList_)
+        {
+            return false;
+        }
+        ID3D11DeviceContext* pImmediateContext = pRenderer_->GetImmediateContext();
+
+        pImmediateContext->ExecuteCommandList(pCommandList_, FALSE);
+        SAFE_RELEASE(pCommandList_);
+
+        // read back render target (R-channel holds the MIP value)
+        pImmediateContext->CopyResource(pStagingTexture_, pRenderTexture_);
+
+        D3D11_MAPPED_SUBRESOURCE mappedResource;
+        hr = pImmediateContext->Map(pStagingTexture_, 0, D3D11_MAP_READ, 0, &mappedResource);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        grayImage.resize(static_cast<size_t>(canvasWidth_) * canvasHeight_);
+        const BYTE* pSrcRow = static_cast<const BYTE*>(mappedResource.pData);
+        BYTE* pDst = grayImage.data();
+        for (UINT row = 0; row < canvasHeight_; row++)
+        {
+            for (UINT col = 0; col < canvasWidth_; col++)
+            {
+                *pDst++ = pSrcRow[4 * col];
+            }
+            pSrcRow += mappedResource.RowPitch;
+        }
+        pImmediateContext->Unmap(pStagingTexture_, 0);
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Record the frames of all given sessions concurrently. Recording is CPU bound (state validation and
+    // command list building); the GPU work is submitted with ReadFrame() on the host renderer thread.
+    // The calling thread records the first session, the others are recorded on their record threads.
+    //------------------------------------------------------------------------------------------------------
+    bool RenderSession::RecordFrames(const std::vector<RenderSession*>& sessions)
+    {
+        if (sessions.empty())
+        {
+            return true;
+        }
+
+        for (size_t idx = 1; idx < sessions.size(); idx++)
+        {
+            sessions[idx]->beginRecord();
+        }
+        bool recorded = sessions[0]->RecordFrame();
+
+        for (size_t idx = 1; idx < sessions.size(); idx++)
+        {
+            recorded = sessions[idx]->endRecord() && recorded;
+        }
+        return recorded;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Let the record thread of the session record the frame - the thread is started with the first frame
+    // and runs until the session is released
+    //------------------------------------------------------------------------------------------------------
+    void RenderSession::beginRecord()
+    {
+        if (!recordThread_.joinable())
+        {
+            stopRecording_ = false;
+            recordThread_ = thread(&RenderSession::recordThreadLoop, this);
+        }
+
+        lock_guard<mutex> lock(recordMutex_);
+        recordRequested_ = true;
+        recordDone_ = false;
+        recordCondition_.notify_all();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Wait until the record thread has recorded the frame requested with beginRecord()
+    //------------------------------------------------------------------------------------------------------
+    bool RenderSession::endRecord()
+    {
+        unique_lock<mutex> lock(recordMutex_);
+        recordCondition_.wait(lock, [this]() { return recordDone_; });
+        return recordSucceeded_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Stop and join the record thread
+    //------------------------------------------------------------------------------------------------------
+    void RenderSession::stopRecordThread()
+    {
+        if (!recordThread_.joinable())
+        {
+            return;
+        }
+        {
+            lock_guard<mutex> lock(recordMutex_);
+            stopRecording_ = true;
+            recordCondition_.notify_all();
+        }
+        recordThread_.join();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Record thread : records a frame per beginRecord() until the thread is stopped
+    //------------------------------------------------------------------------------------------------------
+    void RenderSession::recordThreadLoop()
+    {
+        unique_lock<mutex> lock(recordMutex_);
+        while (true)
+        {
+            recordCondition_.wait(lock, [this]() { return recordRequested_ || stopRecording_; });
+            if (stopRecording_)
+            {
+                break;
+            }
+            recordRequested_ = false;
+
+            lock.unlock();
+            const bool recorded = RecordFrame();
+            lock.lock();
+
+            recordSucceeded_ = recorded;
+            recordDone_ = true;
+            recordCondition_.notify_all();
+        }
+    }
+}
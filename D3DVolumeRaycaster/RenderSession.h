@@ -0,0 +1,111 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: RenderSession.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: include file for implementation of the RenderSession functionality. An independent
+//          view (camera, ray casting parameters, render mode, offscreen target) rendering a shared volume
+//          through the pipeline of a host RayCastRenderer; frames are recorded to a deferred context.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+#include "RayCastRenderer.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    class RenderSession
+    {
+    public:
+        // constructor / desctructor
+        RenderSession();
+        virtual ~RenderSession();
+
+        // avoid usage of copy constructor and =operator ...
+        RenderSession(RenderSession const&) = delete;
+        RenderSession& operator= (RenderSession const&) = delete;
+
+        // initialize the session on the device of the given host renderer - creates a deferred device context
+        // and the offscreen render target
+        bool Initialize(RayCastRenderer* pRenderer, UINT canvasWidth, UINT canvasHeight);
+        // release all allocated resources (the shared volume is released with its last handle)
+        void Release();
+        // resize the offscreen render target
+        bool Resize(UINT canvasWidth, UINT canvasHeight);
+        // set the volume to render
+        void SetVolume(VolumeHandle volume);
+        // set the camera : rotation quaternion (x, y, z, w) and camera distance (= z position of camera)
+        void SetCamera(const float quaternion[4], float cameraDistance);
+        // set ray casting parameters : sampling step size, maximum samples per ray and traversal mode
+        void SetRaycastParameters(float raycastStepSize, UINT raycastMaxSamples, UINT raycastTraversal);
+        // set render mode (see RayCastRenderer) and vessel threshold of the point-based MIP
+        void SetRenderMode(UINT renderMode, UINT sparseThreshold);
+        // record the frame to the deferred device context - may run concurrently with other sessions
+        bool RecordFrame();
+        // execute the recorded frame on the immediate device context and read back the gray image
+        // (one byte per pixel, row-major) - host renderer thread only
+        bool ReadFrame(std::vector<BYTE>& grayImage);
+        
+        // record the frames of all given sessions concurrently (on the record threads of the sessions)
+        static bool RecordFrames(const std::vector<RenderSession*>& sessions);
+
+    private:
+
+        // create offscreen render target and staging texture for read back
+        bool createRenderTarget();
+        // let the record thread of the session record the frame (the thread is started with the first frame)
+        void beginRecord();
+        // wait until the record thread has recorded the frame
+        bool endRecord();
+        // stop and join the record thread
+        void stopRecordThread();
+        // record thread : records a frame per beginRecord() until the thread is stopped
+        void recordThreadLoop();
+
+        // ------------------------------------------------------------------------------------------------------------
+
+        RayCastRenderer*            pRenderer_ = nullptr;           // host renderer : device, pipeline objects
+        ID3D11DeviceContext*        pDeferredContext_ = nullptr;    // records the frames of this session
+        ID3D11CommandList*          pCommandList_ = nullptr;        // recorded, not yet executed frame
+        ID3D11Texture2D*            pRenderTexture_ = nullptr;
+        ID3D11RenderTargetView*     pRenderTargetView_ = nullptr;
+        ID3D11Texture2D*            pStagingTexture_ = nullptr;
+        RaySetupPass                raySetupPass_;                  // ray setup render targets of the session size
+        VolumeHandle                volume_;
+
+        UINT        canvasWidth_ = 1;
+        UINT        canvasHeight_ = 1;
+        float       quatRotation_[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        float       cameraDistance_ = -3.0f;
+        float       raycastStepSize_ = 0.003f;
+        UINT        raycastMaxSamples_ = 550;
+        UINT        raycastTraversal_ = 0;
+        UINT        renderMode_ = 0;
+        UINT        sparseThreshold_ = 64;
+
+        // record thread - lives as long as the session, so a batch of frames does not create threads
+        std::thread                 recordThread_;
+        std::mutex                  recordMutex_;
+        std::condition_variable     recordCondition_;
+        bool                        recordRequested_ = false;
+        bool                        recordDone_ = false;
+        bool                        recordSucceeded_ = false;
+        bool                        stopRecording_ = false;
+    };
+}
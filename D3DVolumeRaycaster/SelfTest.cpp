@@ -0,0 +1,1092 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: SelfTest.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of SelfTest functionality.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#include "stdafx.h"
+#include "SelfTest.h"
+#include "FrameCodec.h"
+#include "RenderService.h"
+#include "SharedFrameRingBuffer.h"
+#include "CineBatchRenderer.h"
+#include "MipImageCache.h"
+#include "BrickPagingPass.h"
+#include "PackedBrickVolume.h"
+#include "DicomSeries.h"
+#include "VolumeResource.h"
+#include "StepSizeController.h"
+#include "TripleBuffer.h"
+#include "DistributedMipRenderer.h"
+
+using namespace std;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    namespace
+    {
+        // dimensions of the test volumes - no multiple of the brick size, odd in every direction at some level
+        const UINT TEST_DIMENSIONS[3] = { 37, 29, 19 };
+
+        //------------------------------------------------------------------------------------------------------
+        // Deterministic pseudo random numbers (linear congruential generator, upper 24 bits)
+        //------------------------------------------------------------------------------------------------------
+        UINT nextRandom(UINT& state)
+        {
+            state = state * 1664525u + 1013904223u;
+            return state >> 8;
+        }
+
+        //------------------------------------------------------------------------------------------------------
+        // Dimensions of a resolution level (same rule as VolumeResource::GetLevelDimensions())
+        //------------------------------------------------------------------------------------------------------
+        void getLevelDimensions(UINT lodLevel, UINT dimensions[3])
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                dimensions[axis] = max(TEST_DIMENSIONS[axis] >> lodLevel, 1u);
+            }
+        }
+
+        //------------------------------------------------------------------------------------------------------
+        // Path of a file in the temporary directory
+        //------------------------------------------------------------------------------------------------------
+        string getTempFileName(const char* name)
+        {
+            char tempPath[MAX_PATH] = { 0 };
+            GetTempPathA(MAX_PATH, tempPath);
+            return string(tempPath) + "D3DVolumeRaycasterSelfTest_" + name;
+        }
+
+        bool readFile(const string& fileName, vector<char>& content)
+        {
+            ifstream file(fileName, ifstream::in | ifstream::binary);
+            content.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+            return !file.bad();
+        }
+
+        //------------------------------------------------------------------------------------------------------
+        // DICOM test files : explicit VR little endian data elements (the length is written as given, so
+        // lengths beyond the end of the file can be tested)
+        //------------------------------------------------------------------------------------------------------
+        void appendElementHeader(vector<char>& buffer, UINT tag, const char* vr, UINT length)
+        {
+            const UINT16 groupElement[2] = { static_cast<UINT16>(tag >> 16), static_cast<UINT16>(tag & 0xFFFF) };
+            buffer.insert(buffer.end(), reinterpret_cast<const char*>(groupElement), reinterpret_cast<const char*>(groupElement) + sizeof(groupElement));
+            buffer.insert(buffer.end(), vr, vr + 2);
+            if (0 == strcmp(vr, "OB") || 0 == strcmp(vr, "OW") || 0 == strcmp(vr, "UN"))
+            {
+                buffer.insert(buffer.end(), 2, '\0');
+                buffer.insert(buffer.end(), reinterpret_cast<const char*>(&length), reinterpret_cast<const char*>(&length) + sizeof(length));
+            }
+            else
+            {
+                const UINT16 shortLength = static_cast<UINT16>(length);
+                buffer.insert(buffer.end(), reinterpret_cast<const char*>(&shortLength), reinterpret_cast<const char*>(&shortLength) + sizeof(shortLength));
+            }
+        }
+
+        void appendString(vector<char>& buffer, UINT tag, const char* vr, const string& value)
+        {
+            string paddedValue = value;
+            if (paddedValue.size() & 1) paddedValue.push_back(0 == strcmp(vr, "UI") ? '\0' : ' ');
+            appendElementHeader(buffer, tag, vr, static_cast<UINT>(paddedValue.size()));
+            buffer.insert(buffer.end(), paddedValue.begin(), paddedValue.end());
+        }
+
+        void appendUnsignedShort(vector<char>& buffer, UINT tag, UINT value)
+        {
+            const UINT16 shortValue = static_cast<UINT16>(value);
+            appendElementHeader(buffer, tag, "US", sizeof(shortValue));
+            buffer.insert(buffer.end(), reinterpret_cast<const char*>(&shortValue), reinterpret_cast<const char*>(&shortValue) + sizeof(shortValue));
+        }
+
+        // preamble, prefix and file meta information (explicit VR little endian)
+        vector<char> beginDicomFile()
+        {
+            vector<char> buffer(128, '\0');
+            buffer.insert(buffer.end(), { 'D', 'I', 'C', 'M' });
+            appendString(buffer, 0x00020010, "UI", "1.2.840.10008.1.2.1");
+            return buffer;
+        }
+
+        bool writeFile(const string& fileName, const vector<char>& buffer)
+        {
+            ofstream file(fileName, ofstream::out | ofstream::binary | ofstream::trunc);
+            file.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+            return !!file;
+        }
+
+        //------------------------------------------------------------------------------------------------------
+        // Slice header of a regular test series : 4 x 4 pixels, 12 of 16 bits, slice k at z = 10 + 2.5 * k
+        //------------------------------------------------------------------------------------------------------
+        DicomSliceHeader makeSliceHeader(UINT sliceIdx)
+        {
+            DicomSliceHeader header;
+            header.fileName = "IM" + to_string(sliceIdx);
+            header.seriesInstanceUID = "1.2.3";
+            header.rows = 4;
+            header.columns = 4;
+            header.bitsAllocated = 16;
+            header.bitsStored = 12;
+            header.highBit = 11;
+            header.pixelDataLength = 32;
+            header.pixelSpacing[0] = 0.5;
+            header.pixelSpacing[1] = 0.7;
+            header.imagePosition[0] = -1.0;
+            header.imagePosition[1] = -1.0;
+            header.imagePosition[2] = 10.0 + 2.5 * sliceIdx;
+            header.hasImagePosition = true;
+            return header;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Construction
+    //------------------------------------------------------------------------------------------------------
+    SelfTest::SelfTest()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destruction
+    //------------------------------------------------------------------------------------------------------
+    SelfTest::~SelfTest()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Run all tests - the tests only use the CPU side of the codecs, caches and validations
+    //------------------------------------------------------------------------------------------------------
+    bool SelfTest::Run()
+    {
+        checkCount_ = 0;
+        failedCount_ = 0;
+
+        testDistributedCompositing();
+        testRenderService();
+        testFrameCodec();
+        testFrameRingBuffer();
+        testCineBatch();
+        testImageCache();
+        testBrickPaging();
+        testPackedBrickCodec();
+        testDicomSeries();
+        testRegionDownsampling();
+        testStepSizeController();
+        testTripleBuffer();
+
+        char charBuffer[128] = { 0 };
+        sprintf_s(charBuffer, sizeof(charBuffer), "self-test : %u checks, %u failed\n", checkCount_, failedCount_);
+        OutputDebugStringA(charBuffer);
+
+        return 0 == failedCount_;
+    }
+
+    UINT SelfTest::GetCheckCount() const
+    {
+        return checkCount_;
+    }
+
+    UINT SelfTest::GetFailedCount() const
+    {
+        return failedCount_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Headless self-test mode
+    //------------------------------------------------------------------------------------------------------
+    int SelfTest::RunSelfTest()
+    {
+        SelfTest selfTest;
+        return selfTest.Run() ? 0 : 1;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Distributed rendering : the vectorized max-composite equals the per-pixel maximum (image size no multiple
+    // of the vector width); for every worker count the reduction tree sends each image to the compositor once
+    //------------------------------------------------------------------------------------------------------
+    void SelfTest::testDistributedCompositing()
+    {
+        const size_t pixelCount = 16 * 5 + 7;
+        vector<BYTE> image(pixelCount), partialImage(pixelCount), expectedImage(pixelCount);
+        UINT randomState = 3;
+        for (size_t pixelIdx = 0; pixelIdx < pixelCount; pixelIdx++)
+        {
+            image[pixelIdx] = static_cast<BYTE>(nextRandom(randomState));
+            partialImage[pixelIdx] = static_cast<BYTE>(nextRandom(randomState));
+            expectedImage[pixelIdx] = max(image[pixelIdx], partialImage[pixelIdx]);
+        }
+        DistributedMipRenderer::MaxComposite(image.data(), partialImage.data(), pixelCount);
+        check(expectedImage == image, "distributed : max-composite");
+
+        bool treeValid = true;
+        for (UINT workerCount = 1; workerCount <= 16; workerCount++)
+        {
+            vector<UINT> receivedImages(workerCount, 0);
+            vector<UINT> children;
+            for (UINT workerIndex = 0; workerIndex < workerCount; workerIndex++)
+            {
+                DistributedMipRenderer::GetReductionChildren(workerIndex, workerCount, children);
+                for (UINT child : children)
+                {
+                    treeValid = treeValid && child < workerCount && DistributedMipRenderer::GetReductionParent(child) == workerIndex;
+                    if (child < workerCount) receivedImages[child]++;
+                }
+            }
+            // every worker but the first sends its image to its parent exactly once
+            treeValid = treeValid && 0 == receivedImages[0] && all_of(receivedImages.begin() + 1, receivedImages.end(), [](UINT count) { return 1 == count; });
+        }
+        check(treeValid, "distributed : reduction tree reaches every worker once");
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Render service : requests of a client are clamped to what the service renders or rejected; a client
+    // that lost its reference frame gets a keyframe it can decode with a fresh decoder
+    //------------------------------------------------------------------------------------------------------
+    void SelfTest::testRenderService()
+    {
+        RenderServiceRequest validRequest = {};
+        validRequest.volumeDataset = 1;
+        validRequest.canvasWidth = 640;
+        validRequest.canvasHeight = 480;
+        validRequest.quatRotation[3] = 1.0f;
+        validRequest.cameraDistance = 2.0f;
+        validRequest.raycastStepSize = 0.004f;
+        validRequest.raycastMaxSamples = 512;
+
+        RenderServiceRequest request = validRequest;
+        check(RenderService::ValidateRequest(request) && 640 == request.canvasWidth && 512 == request.raycastMaxSamples, "render service : valid request accepted unchanged");
+
+        request = validRequest;
+        request.canvasWidth = 100000;
+        request.raycastStepSize = 5.0f;
+        request.raycastMaxSamples = 0;
+        check(RenderService::ValidateRequest(request) && request.canvasWidth < 100000 && request.raycastStepSize <= 0.1f && 1 == request.raycastMaxSamples, "render service : canvas and sampling clamped");
+
+        bool invalidRejected = true;
+        for (int variant = 0; variant < 6; variant++)
+        {
+            request = validRequest;
+            switch (variant)
+            {
+            case 0: request.volumeDataset = 4; break;
+            case 1: request.canvasHeight = 0; break;
+            case 2: request.raycastTraversal = 2; break;
+            case 3: request.quatRotation[0] = NAN; break;
+            case 4: request.quatRotation[3] = 0.0f; break;
+            default: request.cameraDistance = INFINITY; break;
+            }
+            invalidRejected = invalidRejected && !RenderService::ValidateRequest(request);
+        }
+        check(invalidRejected, "render service : invalid requests rejected");
+
+        // the encoder of a client session after a few delta frames, a reconnected client requests a keyframe
+        const UINT width = 40;
+        const UINT height = 24;
+        vector<BYTE> image(static_cast<size_t>(width) * height);
+        FrameEncoder encoder(30);
+        vector<BYTE> encodedFrame;
+        for (UINT frameIdx = 0; frameIdx < 3; frameIdx++)
+        {
+            fill(image.begin(), image.end(), static_cast<BYTE>(frameIdx * 40));
+            encoder.Encode(image.data(), width, height, encodedFrame);
+        }
+        encoder.ForceKeyframe();
+        image[5] = 255;
+        encoder.Encode(image.data(), width, height, encodedFrame);
+        FrameDecoder clientDecoder;
+        check(encoder.GetLastStats().keyframe && clientDecoder.Decode(encodedFrame.data(), encodedFrame.size()) && clientDecoder.GetFrame() == image, "render service : requested keyframe decoded by a new client");
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Frame codec : run-length round trips at the run and literal limits, a keyframe, delta frames with
+    // one and no changed tile (partial border tiles), a delta frame without reference frame and frame
+    // headers beyond the decoder limits
+    //------------------------------------------------------------------------------------------------------
+    void SelfTest::testFrameCodec()
+    {
+        UINT randomState = 3;
+        vector<vector<BYTE>> streams;
+        streams.push_back(vector<BYTE>());
+        streams.push_back(vector<BYTE>(1, 5));
+        streams.push_back(vector<BYTE>(130, 9));
+        streams.push_back(vector<BYTE>(131, 9));
+        streams.push_back(vector<BYTE>(129));
+        for (size_t idx = 0; idx < streams.back().size(); idx++)
+        {
+            streams.back()[idx] = static_cast<BYTE>(idx);
+        }
+        streams.push_back(vector<BYTE>(1000));
+        for (size_t idx = 0; idx < streams.back().size(); idx++)
+        {
+            // short and long runs between literals
+            streams.back()[idx] = static_cast<BYTE>((idx / (1 + idx % 7) % 3) ? nextRandom(randomState) : idx / 50);
+        }
+
+        bool roundTrips = true;
+        bool truncatedRejected = true;
+        for (const auto& stream : streams)
+        {
+            vector<BYTE> encoded;
+            FrameEncoder::EncodeRunLength(stream.data(), stream.size(), encoded);
+            vector<BYTE> decoded(stream.size());
+            roundTrips = roundTrips && FrameEncoder::DecodeRunLength(encoded.data(), encoded.size(), decoded.data(), decoded.size()) && decoded == stream;
+            if (!encoded.empty())
+            {
+                truncatedRejected = truncatedRejected && !FrameEncoder::DecodeRunLength(encoded.data(), encoded.size() - 1, decoded.data(), decoded.size());
+            }
+        }
+        check(roundTrips, "frame codec : run-length round trips");
+        check(truncatedRejected, "frame codec : truncated run-length data rejected");
+
+        const UINT width = 70;
+        const UINT height = 50;
+        vector<BYTE> image(static_cast<size_t>(width) * height);
+        for (size_t idx = 0; idx < image.size(); idx++)
+        {
+            image[idx] = static_cast<BYTE>((idx % width < 35) ? idx / width : nextRandom(randomState));
+        }
+
+        FrameEncoder encoder;
+        FrameDecoder decoder;
+        vector<BYTE> keyframe, deltaFrame, unchangedFrame;
+        encoder.Encode(image.data(), width, height, keyframe);
+        check(encoder.GetLastStats().keyframe && decoder.Decode(keyframe.data(), keyframe.size()) && decoder.GetFrame() == image, "frame codec : keyframe");
+
+        // one changed tile (columns 20 .. 29, rows 17 .. 18 lie in tile (1, 1))
+        for (UINT row = 17; row < 19; row++)
+        {
+            for (UINT column = 20; column < 30; column++)
+            {
+                image[static_cast<size_t>(row) * width + column] ^= 0x55;
+            }
+        }
+        encoder.Encode(image.data(), width, height, deltaFrame);
+        check(!encoder.GetLastStats().keyframe && 1 == encoder.GetLastStats().changedTiles, "frame codec : one changed tile");
+        check(decoder.Decode(deltaFrame.data(), deltaFrame.size()) && decoder.GetFrame() == image, "frame codec : delta frame");
+
+        encoder.Encode(image.data(), width, height, unchangedFrame);
+        check(0 == encoder.GetLastStats().changedTiles && decoder.Decode(unchangedFrame.data(), unchangedFrame.size()) && decoder.GetFrame() == image, "frame codec : unchanged frame");
+
+        FrameDecoder lateDecoder;
+        check(!lateDecoder.Decode(deltaFrame.data(), deltaFrame.size()) && lateDecoder.NeedsKeyframe(), "frame codec : delta frame without reference rejected");
+
+        // keyframe headers announcing a frame beyond the limit or more pixels than the pixel block can hold
+        FrameCodecHeader header;
+        memcpy(&header, keyframe.data(), sizeof(header));
+        vector<BYTE> corruptFrame = keyframe;
+        header.width = FrameDecoder::MAX_FRAME_SIZE + 1;
+        memcpy(corruptFrame.data(), &header, sizeof(header));
+        FrameDecoder corruptDecoder;
+        check(!corruptDecoder.Decode(corruptFrame.data(), corruptFrame.size()) && corruptDecoder.NeedsKeyframe(), "frame codec : oversized frame rejected");
+        header.width = FrameDecoder::MAX_FRAME_SIZE;
+        header.height = FrameDecoder::MAX_FRAME_SIZE;
+        memcpy(corruptFrame.data(), &header, sizeof(header));
+        check(!corruptDecoder.Decode(corruptFrame.data(), corruptFrame.size()), "frame codec : frame larger than its pixel block rejected");
+        check(corruptDecoder.Decode(keyframe.data(), keyframe.size()) && corruptDecoder.GetWidth() == width, "frame codec : keyframe decoded after corrupt frames");
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Frame ring buffer : producer and consumer in one process. Frame n is filled with the value n, so a
+    // frame the consumer releases as valid must not contain pixels of another frame (seqlock).
+    //------------------------------------------------------------------------------------------------------
+    void SelfTest::testFrameRingBuffer()
+    {
+        const UINT slotCount = SharedFrameRingBuffer::MIN_SLOT_COUNT;
+        const UINT width = 64;
+        const UINT height = 32;
+        const size_t pixelCount = static_cast<size_t>(width) * height;
+        const wstring name = L"D3DVolumeRaycasterSelfTest" + to_wstring(GetCurrentProcessId());
+
+        auto writeFrame = [&](SharedFrameRingBuffer& producer, BYTE value)
+        {
+            BYTE* pPixels = producer.BeginWrite(width, height);
+            if (nullptr == pPixels) return false;
+            memset(pPixels, value, pixelCount);
+            producer.EndWrite();
+            return true;
+        };
+        auto isFrameFilled = [&](const SharedFrameView& frameView, BYTE value)
+        {
+            for (size_t pixelIdx = 0; pixelIdx < pixelCount; pixelIdx++)
+            {
+                if (value != frameView.pPixels[pixelIdx]) return false;
+            }
+            return frameView.width == width && frameView.height == height;
+        };
+
+        SharedFrameRingBuffer producer;
+        SharedFrameRingBuffer otherProducer;
+        SharedFrameRingBuffer consumer;
+        SharedFrameView frameView;
+        check(producer.Create(name.c_str(), slotCount, width, height), "frame ring buffer : created");
+        check(!otherProducer.Create(name.c_str(), slotCount, 2 * width, 2 * height), "frame ring buffer : existing name rejected");
+        check(consumer.Open(name.c_str()) && !consumer.AcquireFrame(frameView), "frame ring buffer : opened without frames");
+        check(nullptr == producer.BeginWrite(width + 1, height), "frame ring buffer : oversized frame rejected");
+
+        writeFrame(producer, 1);
+        check(consumer.AcquireFrame(frameView) && 1 == frameView.sequence && isFrameFilled(frameView, 1) && consumer.ReleaseFrame(frameView), "frame ring buffer : frame read");
+
+        // the producer overwrites the slot of an acquired frame -> torn, the consumer continues with the oldest safe frame
+        writeFrame(producer, 2);
+        const bool acquired = consumer.AcquireFrame(frameView);
+        for (BYTE value = 3; value < 3 + slotCount; value++)
+        {
+            writeFrame(producer, value);
+        }
+        check(acquired && 2 == frameView.sequence && !consumer.ReleaseFrame(frameView), "frame ring buffer : overwritten frame released as torn");
+        check(0 < producer.GetDroppedFrames(), "frame ring buffer : unread frames counted as dropped");
+        const UINT64 latestSequence = producer.GetPublishedFrames();
+        check(consumer.AcquireFrame(frameView) && latestSequence + 2 - slotCount == frameView.sequence && 
+            isFrameFilled(frameView, static_cast<BYTE>(frameView.sequence)) && consumer.ReleaseFrame(frameView), "frame ring buffer : late consumer continues with the oldest safe frame");
+        while (consumer.AcquireFrame(frameView))
+        {
+            consumer.ReleaseFrame(frameView);
+        }
+
+        // concurrent producer : frames released as valid are never mixed with pixels of a newer frame
+        const UINT frameCount = 3000;
+        const UINT64 firstSequence = producer.GetPublishedFrames() + 1;
+        atomic<bool> producerDone { false };
+        thread producerThread([&]()
+        {
+            for (UINT frameIdx = 0; frameIdx < frameCount; frameIdx++)
+            {
+                writeFrame(producer, static_cast<BYTE>(firstSequence + frameIdx));
+            }
+            producerDone = true;
+        });
+        UINT validFrames = 0;
+        UINT mixedFrames = 0;
+        UINT64 lastSequence = 0;
+        bool inOrder = true;
+        bool consumerDone = false;
+        while (!consumerDone)
+        {
+            // frames published before the producer is seen as done are still acquired
+            const bool producerFinished = producerDone;
+            if (consumer.AcquireFrame(frameView))
+            {
+                inOrder = inOrder && frameView.sequence > lastSequence;
+                lastSequence = frameView.sequence;
+                const bool filled = isFrameFilled(frameView, static_cast<BYTE>(frameView.sequence));
+                if (consumer.ReleaseFrame(frameView))
+                {
+                    validFrames++;
+                    if (!filled) mixedFrames++;
+                }
+            }
+            else if (producerFinished)
+            {
+                consumerDone = true;
+            }
+            else
+            {
+                this_thread::yield();
+            }
+        }
+        producerThread.join();
+        check(0 < validFrames && 0 == mixedFrames && inOrder, "frame ring buffer : no torn frame released as valid");
+        check(firstSequence + frameCount - 1 == lastSequence, "frame ring buffer : last frame read");
+
+        consumer.Close();
+        producer.Close();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Cine batch : the first frame is the start orientation, frame n of N is rotated by n / N of a full
+    // turn about the axis; PGM frames carry the binary graymap header, raw frames are the plain pixels
+    //------------------------------------------------------------------------------------------------------
+    void SelfTest::testCineBatch()
+    {
+        auto isRotation = [](const float quaternion[4], float x, float y, float z, float w)
+        {
+            return fabs(quaternion[0] - x) < 1e-5f && fabs(quaternion[1] - y) < 1e-5f && fabs(quaternion[2] - z) < 1e-5f && fabs(quaternion[3] - w) < 1e-5f;
+        };
+        const float halfSqrt2 = sqrtf(0.5f);
+        float quaternion[4];
+        CineBatchRenderer::GetFrameRotation(CINE_AXIS::Z, 0, 36, quaternion);
+        check(isRotation(quaternion, 0.0f, 0.0f, 0.0f, 1.0f), "cine batch : first frame not rotated");
+        CineBatchRenderer::GetFrameRotation(CINE_AXIS::Y, 9, 36, quaternion);
+        check(isRotation(quaternion, 0.0f, halfSqrt2, 0.0f, halfSqrt2), "cine batch : quarter turn about y");
+        CineBatchRenderer::GetFrameRotation(CINE_AXIS::X, 18, 36, quaternion);
+        check(isRotation(quaternion, 1.0f, 0.0f, 0.0f, 0.0f), "cine batch : half turn about x");
+
+        const vector<BYTE> image = { 0, 1, 2, 253, 254, 255 };
+        const string fileName = getTempFileName("cine.pgm");
+        vector<char> content;
+        const string pgmHeader = "P5\n3 2\n255\n";
+        check(CineBatchRenderer::WriteImage(fileName, CINE_IMAGE_FORMAT::PGM, image, 3, 2) && readFile(fileName, content) && 
+            content.size() == pgmHeader.size() + image.size() && 0 == memcmp(content.data(), pgmHeader.data(), pgmHeader.size()) && 
+            0 == memcmp(content.data() + pgmHeader.size(), image.data(), image.size()), "cine batch : PGM image written");
+        check(CineBatchRenderer::WriteImage(fileName, CINE_IMAGE_FORMAT::RAW, image, 2, 3) && readFile(fileName, content) && 
+            content.size() == image.size() && 0 == memcmp(content.data(), image.data(), image.size()), "cine batch : raw image written");
+        check(!CineBatchRenderer::WriteImage(fileName, CINE_IMAGE_FORMAT::RAW, image, 3, 3), "cine batch : image smaller than the frame rejected");
+        DeleteFileA(fileName.c_str());
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Image cache : q and -q give one key, nearby rotations share a key, every key field distinguishes
+    // images; the least recently used images are evicted to meet the budget
+    //------------------------------------------------------------------------------------------------------
+    void SelfTest::testImageCache()
+    {
+        const float rotation[4] = { 0.1f, -0.7f, 0.2f, 0.6782f };
+        const float negatedRotation[4] = { -0.1f, 0.7f, -0.2f, -0.6782f };
+        const float nearbyRotation[4] = { 0.1001f, -0.7001f, 0.2001f, 0.6781f };
+        const float halfTurn[4] = { 0.0f, -1.0f, 0.0f, 0.0f };
+        const float negatedHalfTurn[4] = { 0.0f, 1.0f, 0.0f, 0.0f };
+        MipImageKey key = {};
+        MipImageKey otherKey = {};
+        key.cameraDistance = -3.0f;
+        key.canvasWidth = 4;
+        key.canvasHeight = 2;
+        key.raycastStepSize = 0.003f;
+        key.raycastMaxSamples = 550;
+        MipImageCache::QuantizeRotation(rotation, key.quatRotation);
+        otherKey = key;
+        MipImageCache::QuantizeRotation(negatedRotation, otherKey.quatRotation);
+        check(key == otherKey && MipImageKeyHash()(key) == MipImageKeyHash()(otherKey), "image cache : q and -q give the same key");
+        MipImageCache::QuantizeRotation(nearbyRotation, otherKey.quatRotation);
+        check(key == otherKey, "image cache : nearby rotations share a key");
+        MipImageCache::QuantizeRotation(halfTurn, otherKey.quatRotation);
+        MipImageKey halfTurnKey = otherKey;
+        MipImageCache::QuantizeRotation(negatedHalfTurn, halfTurnKey.quatRotation);
+        check(halfTurnKey == otherKey && !(key == otherKey), "image cache : canonical sign for w = 0");
+
+        float dequantized[4];
+        MipImageCache::DequantizeRotation(key.quatRotation, dequantized);
+        float dot = 0.0f;
+        float lengthSq = 0.0f;
+        float rotationLengthSq = 0.0f;
+        for (int idx = 0; idx < 4; idx++)
+        {
+            dot += dequantized[idx] * rotation[idx];
+            lengthSq += dequantized[idx] * dequantized[idx];
+            rotationLengthSq += rotation[idx] * rotation[idx];
+        }
+        check(fabs(lengthSq - 1.0f) < 1e-4f && dot / sqrtf(rotationLengthSq) > 0.999f, "image cache : dequantized rotation normalized and close");
+
+        bool fieldsDistinguish = true;
+        for (int field = 0; field < 9; field++)
+        {
+            otherKey = key;
+            switch (field)
+            {
+            case 0: otherKey.quatRotation[0]++; break;
+            case 1: otherKey.cameraDistance = -2.5f; break;
+            case 2: otherKey.canvasWidth = 8; break;
+            case 3: otherKey.canvasHeight = 8; break;
+            case 4: otherKey.raycastStepSize = 0.004f; break;
+            case 5: otherKey.raycastMaxSamples = 600; break;
+            case 6: otherKey.raycastTraversal = 1; break;
+            case 7: otherKey.displayMapping.windowWidth = 0.5f; break;
+            default: otherKey.volumeDataset = 2; break;
+            }
+            fieldsDistinguish = fieldsDistinguish && !(key == otherKey);
+        }
+        check(fieldsDistinguish, "image cache : every key field distinguishes images");
+
+        // budget of three images : the least recently used one is evicted
+        const size_t imageSize = static_cast<size_t>(key.canvasWidth) * key.canvasHeight;
+        MipImageCache cache;
+        cache.SetBudget(3 * imageSize);
+        vector<MipImageKey> keys(4, key);
+        for (UINT idx = 0; idx < keys.size(); idx++)
+        {
+            keys[idx].volumeDataset = idx;
+        }
+        for (UINT idx = 0; idx < 3; idx++)
+        {
+            cache.Insert(keys[idx], vector<BYTE>(imageSize, static_cast<BYTE>(idx)));
+        }
+        auto cachedImage = cache.Lookup(keys[0]);
+        check(cachedImage && (*cachedImage)[0] == 0 && !cache.Lookup(keys[3]), "image cache : hit and miss");
+        cache.Insert(keys[3], vector<BYTE>(imageSize, 3));
+        MipImageCacheStats stats = cache.GetStats();
+        check(cache.Contains(keys[0]) && !cache.Contains(keys[1]) && cache.Contains(keys[2]) && cache.Contains(keys[3]), "image cache : least recently used image evicted");
+        check(1 == stats.hits && 1 == stats.misses && 1 == stats.evictions && 3 == stats.imageCount && 3 * imageSize == stats.memorySize, "image cache : statistics");
+
+        cache.Insert(keys[2], vector<BYTE>(imageSize, 7));
+        cachedImage = cache.Lookup(keys[2]);
+        check(cachedImage && (*cachedImage)[0] == 7 && 3 * imageSize == cache.GetStats().memorySize, "image cache : image replaced");
+        cache.Insert(keys[1], vector<BYTE>(4 * imageSize, 1));
+        check(!cache.Contains(keys[1]) && 3 == cache.GetStats().imageCount, "image cache : image larger than the budget not cached");
+
+        // updated volume : only its images are removed
+        cache.SetBudget(4 * imageSize);
+        MipImageKey otherRotationKey = keys[2];
+        otherRotationKey.quatRotation[0]++;
+        cache.Insert(otherRotationKey, vector<BYTE>(imageSize, 2));
+        cache.RemoveVolume(keys[2].volumeDataset);
+        stats = cache.GetStats();
+        check(!cache.Contains(keys[2]) && !cache.Contains(otherRotationKey) && cache.Contains(keys[0]) && cache.Contains(keys[3]), "image cache : images of an updated volume removed");
+        check(2 == stats.imageCount && 2 * imageSize == stats.memorySize, "image cache : statistics after removing a volume");
+        cache.Clear();
+        check(0 == cache.GetStats().imageCount && 0 == cache.GetStats().memorySize, "image cache : cleared");
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Brick page table : missing bricks are requested once, placed in free slots first and then replace the
+    // least recently used brick - bricks used by the latest read back frame are never replaced
+    //------------------------------------------------------------------------------------------------------
+    void SelfTest::testBrickPaging()
+    {
+        BrickPageTable pageTable;
+        const UINT poolSlotCounts[3] = { 2, 1, 1 };
+        pageTable.Reset(vector<UINT>({ 0, 0, 0, 0, 0, BrickPageTable::PAGE_EMPTY }), poolSlotCounts);
+        check(2 == pageTable.GetSlotCount() && 0 == pageTable.GetResidentCount(), "brick paging : pool slots");
+
+        vector<UINT64> missingBricks;
+        pageTable.BeginUsage(1);
+        bool resident = pageTable.TouchBrick(0, missingBricks);
+        resident |= pageTable.TouchBrick(1, missingBricks);
+        resident |= pageTable.TouchBrick(0, missingBricks);
+        resident |= pageTable.TouchBrick(5, missingBricks);
+        check(!resident && vector<UINT64>({ 0, 1 }) == missingBricks, "brick paging : missing bricks requested once, empty bricks never");
+
+        vector<UINT> slots;
+        pageTable.GetReplacementSlots(3, slots);
+        check(vector<UINT>({ 0, 1 }) == slots, "brick paging : free slots");
+        UINT64 replacedBrick = pageTable.PlaceBrick(0, slots[0]);
+        check(BrickPageTable::NO_BRICK == replacedBrick, "brick paging : free slot replaces no brick");
+        replacedBrick = pageTable.PlaceBrick(1, slots[1]);
+        const vector<UINT>& entries = pageTable.GetEntries();
+        check(BrickPageTable::NO_BRICK == replacedBrick && 2 == pageTable.GetResidentCount(), "brick paging : bricks resident");
+        check(BrickPageTable::PAGE_RESIDENT == entries[0] && (BrickPageTable::PAGE_RESIDENT | 1) == entries[1], "brick paging : page table entries");
+        UINT slotCoords[3];
+        pageTable.GetSlotCoords(1, slotCoords);
+        check(1 == slotCoords[0] && 0 == slotCoords[1] && 0 == slotCoords[2], "brick paging : slot coordinates");
+
+        // frame 2 uses brick 1 and needs brick 2 : only the slot of brick 0 may be replaced
+        missingBricks.clear();
+        pageTable.BeginUsage(2);
+        resident = pageTable.TouchBrick(1, missingBricks);
+        resident &= !pageTable.TouchBrick(2, missingBricks);
+        check(resident && vector<UINT64>({ 2 }) == missingBricks, "brick paging : resident brick hit");
+        pageTable.GetReplacementSlots(2, slots);
+        check(vector<UINT>({ 0 }) == slots, "brick paging : used bricks not replaced");
+        replacedBrick = pageTable.PlaceBrick(2, slots[0]);
+        check(0 == replacedBrick && 0 == entries[0] && BrickPageTable::PAGE_RESIDENT == entries[2] && 2 == pageTable.GetResidentCount(), "brick paging : least recently used brick replaced");
+        pageTable.GetReplacementSlots(1, slots);
+        check(slots.empty(), "brick paging : working set larger than the pool");
+
+        // a replaced brick is missing again, a cancelled request is requested again
+        missingBricks.clear();
+        pageTable.TouchBrick(0, missingBricks);
+        pageTable.TouchBrick(3, missingBricks);
+        pageTable.TouchBrick(3, missingBricks);
+        pageTable.CancelRequest(3);
+        pageTable.TouchBrick(3, missingBricks);
+        check(vector<UINT64>({ 0, 3, 3 }) == missingBricks, "brick paging : replaced and cancelled bricks requested again");
+
+        pageTable.Clear();
+        check(0 == pageTable.GetSlotCount() && pageTable.GetEntries().empty(), "brick paging : cleared");
+    }
+
+
+    //------------------------------------------------------------------------------------------------------
+    // Packed bricks : random voxels, a constant brick (bit width 0) and a brick of the full value range
+    // (maximum bit width); the border bricks are partially outside the volume
+    //------------------------------------------------------------------------------------------------------
+    void SelfTest::testPackedBrickCodec()
+    {
+        const UINT brick = PackedBrickVolume::BRICK_SIZE;
+        const size_t voxelCount = static_cast<size_t>(TEST_DIMENSIONS[0]) * TEST_DIMENSIONS[1] * TEST_DIMENSIONS[2];
+        for (UINT bytesPerVoxel = 1; bytesPerVoxel <= 2; bytesPerVoxel++)
+        {
+            const UINT maxValue = (2 == bytesPerVoxel) ? 0xFFFF : 0xFF;
+            vector<UINT> voxels(voxelCount);
+            UINT randomState = 17 * bytesPerVoxel;
+            size_t voxelIdx = 0;
+            for (UINT z = 0; z < TEST_DIMENSIONS[2]; z++)
+            {
+                for (UINT y = 0; y < TEST_DIMENSIONS[1]; y++)
+                {
+                    for (UINT x = 0; x < TEST_DIMENSIONS[0]; x++, voxelIdx++)
+                    {
+                        if (x < brick && y < brick && z < brick)
+                        {
+                            voxels[voxelIdx] = 7;
+                        }
+                        else if (x < 2 * brick && y < brick && z < brick)
+                        {
+                            voxels[voxelIdx] = (x & 1) ? maxValue : 0;
+                        }
+                        else
+                        {
+                            voxels[voxelIdx] = nextRandom(randomState) % (maxValue + 1);
+                        }
+                    }
+                }
+            }
+            vector<BYTE> volumeData(voxelCount * bytesPerVoxel);
+            for (voxelIdx = 0; voxelIdx < voxelCount; voxelIdx++)
+            {
+                if (2 == bytesPerVoxel)
+                {
+                    reinterpret_cast<UINT16*>(volumeData.data())[voxelIdx] = static_cast<UINT16>(voxels[voxelIdx]);
+                }
+                else
+                {
+                    volumeData[voxelIdx] = static_cast<BYTE>(voxels[voxelIdx]);
+                }
+            }
+
+            PackedBrickVolume packedVolume;
+            check(packedVolume.Build(volumeData.data(), TEST_DIMENSIONS, bytesPerVoxel), "packed bricks : build");
+            check(packedVolume.GetRawSize() == volumeData.size(), "packed bricks : raw size");
+            const PackedBrickEntry* pBrickTable = packedVolume.GetBrickTable();
+            check(nullptr != pBrickTable && 7 == (pBrickTable[0].minAndBitWidth & 0xFFFF) && 0 == (pBrickTable[0].minAndBitWidth >> 16), "packed bricks : constant brick");
+            check(nullptr != pBrickTable && 8 * bytesPerVoxel == (pBrickTable[1].minAndBitWidth >> 16), "packed bricks : full range brick");
+
+            size_t mismatches = 0;
+            voxelIdx = 0;
+            for (UINT z = 0; z < TEST_DIMENSIONS[2]; z++)
+            {
+                for (UINT y = 0; y < TEST_DIMENSIONS[1]; y++)
+                {
+                    for (UINT x = 0; x < TEST_DIMENSIONS[0]; x++, voxelIdx++)
+                    {
+                        if (packedVolume.DecodeVoxel(x, y, z) != voxels[voxelIdx]) mismatches++;
+                    }
+                }
+            }
+            check(0 == mismatches, (2 == bytesPerVoxel) ? "packed bricks : 16 bit voxels decode to their source values" : "packed bricks : 8 bit voxels decode to their source values");
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // DICOM : the header parser rejects element lengths beyond the end of the file; the slice validation
+    // sorts shuffled slices and rejects gaps, duplicates, mixed series, tilted stacks and a zero rescale
+    // slope; a series with a rescale per slice is mapped to one value range
+    //------------------------------------------------------------------------------------------------------
+    void SelfTest::testDicomSeries()
+    {
+        char tempPath[MAX_PATH] = { 0 };
+        GetTempPathA(MAX_PATH, tempPath);
+        const string directory = string(tempPath) + "D3DVolumeRaycasterSelfTest";
+        CreateDirectoryA(directory.c_str(), nullptr);
+        const string fileName = directory + "\\header.dcm";
+
+        // header parser : a complete header, a value and pixel data longer than the file
+        vector<char> buffer = beginDicomFile();
+        appendUnsignedShort(buffer, 0x00280010, 2);
+        appendUnsignedShort(buffer, 0x00280011, 2);
+        appendElementHeader(buffer, 0x7FE00010, "OW", 8);
+        buffer.insert(buffer.end(), 8, '\0');
+        DicomSliceHeader header;
+        check(writeFile(fileName, buffer) && DicomSeries::ParseHeader(fileName, header) && 2 == header.rows && 8 == header.pixelDataLength, "DICOM : header parsed");
+
+        buffer.resize(buffer.size() - 4);
+        header = DicomSliceHeader();
+        check(writeFile(fileName, buffer) && !DicomSeries::ParseHeader(fileName, header), "DICOM : truncated pixel data rejected");
+
+        buffer = beginDicomFile();
+        appendElementHeader(buffer, 0x00280010, "UN", 0x7FFFFFF0);
+        buffer.insert(buffer.end(), 16, '\0');
+        header = DicomSliceHeader();
+        check(writeFile(fileName, buffer) && !DicomSeries::ParseHeader(fileName, header), "DICOM : element length beyond the end of the file rejected");
+        DeleteFileA(fileName.c_str());
+
+        // slice sort and validation
+        auto checkSlices = [](vector<DicomSliceHeader> slices)
+        {
+            VolumeDatasetInfo datasetInfo = {};
+            return DicomSeries::SortAndCheckSlices(slices, datasetInfo);
+        };
+        const UINT shuffledOrder[] = { 2, 0, 4, 1, 3 };
+        vector<DicomSliceHeader> slices;
+        for (UINT sliceIdx : shuffledOrder)
+        {
+            slices.push_back(makeSliceHeader(sliceIdx));
+        }
+        {
+            vector<DicomSliceHeader> sortedSlices = slices;
+            VolumeDatasetInfo datasetInfo = {};
+            bool sorted = DicomSeries::SortAndCheckSlices(sortedSlices, datasetInfo);
+            for (UINT sliceIdx = 0; sorted && sliceIdx < sortedSlices.size(); sliceIdx++)
+            {
+                sorted = (sortedSlices[sliceIdx].fileName == "IM" + to_string(sliceIdx));
+            }
+            check(sorted, "DICOM : shuffled slices sorted by position");
+            check(5 == datasetInfo.volSlices && 12 == datasetInfo.bitsStored && 4 == datasetInfo.volColumns, "DICOM : dataset dimensions");
+            check(fabs(datasetInfo.voxelSpacing[0] - 0.7f) < 1e-5f && fabs(datasetInfo.voxelSpacing[1] - 0.5f) < 1e-5f && fabs(datasetInfo.voxelSpacing[2] - 2.5f) < 1e-5f, "DICOM : voxel spacing");
+        }
+
+        vector<DicomSliceHeader> invalidSlices(slices.begin(), slices.begin() + 4);
+        check(!checkSlices(invalidSlices), "DICOM : missing slice rejected");
+        invalidSlices = slices;
+        invalidSlices.push_back(makeSliceHeader(4));
+        check(!checkSlices(invalidSlices), "DICOM : duplicate slice rejected");
+        invalidSlices = slices;
+        invalidSlices[3].seriesInstanceUID = "1.2.4";
+        check(!checkSlices(invalidSlices), "DICOM : mixed series rejected");
+        invalidSlices = slices;
+        invalidSlices[3].imagePosition[0] += 1.0;
+        check(!checkSlices(invalidSlices), "DICOM : tilted stack rejected");
+        invalidSlices = slices;
+        invalidSlices[3].rescaleSlope = 0.0;
+        check(!checkSlices(invalidSlices), "DICOM : zero rescale slope rejected");
+
+        // rescale per slice : slice k stores the modality values 0, 60, 120, -60 with slope k + 1 (signed 12 bit)
+        const int modalityValues[4] = { 0, 60, 120, -60 };
+        const UINT sliceCount = 3;
+        vector<string> sliceFileNames;
+        bool filesWritten = true;
+        for (UINT sliceIdx = 0; sliceIdx < sliceCount; sliceIdx++)
+        {
+            buffer = beginDicomFile();
+            appendString(buffer, 0x0020000E, "UI", "1.2.3");
+            appendString(buffer, 0x00200032, "DS", "0\\0\\" + to_string(2 * sliceIdx));
+            appendString(buffer, 0x00200037, "DS", "1\\0\\0\\0\\1\\0");
+            appendUnsignedShort(buffer, 0x00280002, 1);
+            appendUnsignedShort(buffer, 0x00280010, 2);
+            appendUnsignedShort(buffer, 0x00280011, 2);
+            appendString(buffer, 0x00280030, "DS", "1\\1");
+            appendUnsignedShort(buffer, 0x00280100, 16);
+            appendUnsignedShort(buffer, 0x00280101, 12);
+            appendUnsignedShort(buffer, 0x00280102, 11);
+            appendUnsignedShort(buffer, 0x00280103, 1);
+            appendString(buffer, 0x00281052, "DS", "0");
+            appendString(buffer, 0x00281053, "DS", to_string(sliceIdx + 1));
+            appendElementHeader(buffer, 0x7FE00010, "OW", 8);
+            for (int value : modalityValues)
+            {
+                const UINT16 storedValue = static_cast<UINT16>(value / static_cast<int>(sliceIdx + 1)) & 0x0FFF;
+                buffer.insert(buffer.end(), reinterpret_cast<const char*>(&storedValue), reinterpret_cast<const char*>(&storedValue) + sizeof(storedValue));
+            }
+            // files numbered in reverse slice order
+            sliceFileNames.push_back(directory + "\\IM" + to_string(sliceCount - sliceIdx) + ".dcm");
+            filesWritten = writeFile(sliceFileNames.back(), buffer) && filesWritten;
+        }
+        DicomSeries series;
+        const bool seriesLoaded = filesWritten && series.Load(directory.c_str());
+        check(seriesLoaded && sliceCount == series.GetDatasetInfo().volSlices, "DICOM : series with a rescale per slice loaded");
+        if (seriesLoaded)
+        {
+            const UINT16* pVoxels = reinterpret_cast<const UINT16*>(series.GetVolumeData().data());
+            bool sameValues = true;
+            for (UINT sliceIdx = 1; sliceIdx < sliceCount; sliceIdx++)
+            {
+                sameValues = sameValues && (0 == memcmp(pVoxels, pVoxels + 4 * sliceIdx, 4 * sizeof(UINT16)));
+            }
+            check(sameValues, "DICOM : equal modality values map to equal voxels across slices");
+            check(pVoxels[3] < pVoxels[0] && pVoxels[0] < pVoxels[1] && pVoxels[1] < pVoxels[2], "DICOM : rescaled voxels keep the order of the modality values");
+        }
+        for (const auto& sliceFileName : sliceFileNames)
+        {
+            DeleteFileA(sliceFileName.c_str());
+        }
+        RemoveDirectoryA(directory.c_str());
+    }
+
+
+    //------------------------------------------------------------------------------------------------------
+    // Region updates : regions at the corners and inside the volume (odd dimensions - the last voxels fold
+    // into the last coarse voxel) are replaced with lower values, so maxima have to decrease as well
+    //------------------------------------------------------------------------------------------------------
+    void SelfTest::testRegionDownsampling()
+    {
+        const UINT LEVEL_COUNT = 4;
+        const UINT regions[][6] =
+        {
+            { 5, 3, 17, 11, 20, 19 },
+            { 0, 0, 0, 1, 29, 1 },
+            { 36, 28, 18, 37, 29, 19 },
+            { 0, 0, 0, 37, 29, 19 }
+        };
+        const VOXEL_FORMAT voxelFormats[] = { VOXEL_FORMAT::UINT8, VOXEL_FORMAT::UINT16 };
+        for (VOXEL_FORMAT voxelFormat : voxelFormats)
+        {
+            const UINT bytesPerVoxel = (VOXEL_FORMAT::UINT16 == voxelFormat) ? 2 : 1;
+            vector<vector<BYTE>> levels(LEVEL_COUNT);
+            for (UINT lodLevel = 0; lodLevel < LEVEL_COUNT; lodLevel++)
+            {
+                UINT dimensions[3];
+                getLevelDimensions(lodLevel, dimensions);
+                levels[lodLevel].resize(static_cast<size_t>(dimensions[0]) * dimensions[1] * dimensions[2] * bytesPerVoxel);
+            }
+            UINT randomState = 5 + bytesPerVoxel;
+            for (BYTE& value : levels[0])
+            {
+                value = static_cast<BYTE>(nextRandom(randomState));
+            }
+            auto downsampleLevels = [&](const UINT regionBegin[3], const UINT regionEnd[3], vector<vector<BYTE>>& levelData)
+            {
+                UINT levelBegin[3] = { regionBegin[0], regionBegin[1], regionBegin[2] };
+                UINT levelEnd[3] = { regionEnd[0], regionEnd[1], regionEnd[2] };
+                for (UINT lodLevel = 1; lodLevel < LEVEL_COUNT; lodLevel++)
+                {
+                    UINT sourceDimensions[3], targetDimensions[3];
+                    getLevelDimensions(lodLevel - 1, sourceDimensions);
+                    getLevelDimensions(lodLevel, targetDimensions);
+                    VolumeResource::CalcCoarserLevelBox(targetDimensions, levelBegin, levelEnd);
+                    VolumeResource::DownsampleLevel(voxelFormat, levelData[lodLevel - 1].data(), sourceDimensions, levelData[lodLevel].data(), targetDimensions, levelBegin, levelEnd);
+                }
+            };
+            const UINT volumeBegin[3] = { 0, 0, 0 };
+            downsampleLevels(volumeBegin, TEST_DIMENSIONS, levels);
+
+            bool levelsMatch = true;
+            for (const auto& region : regions)
+            {
+                const UINT* pRegionBegin = region;
+                const UINT* pRegionEnd = region + 3;
+                for (UINT z = pRegionBegin[2]; z < pRegionEnd[2]; z++)
+                {
+                    for (UINT y = pRegionBegin[1]; y < pRegionEnd[1]; y++)
+                    {
+                        const size_t rowOffset = ((static_cast<size_t>(z) * TEST_DIMENSIONS[1] + y) * TEST_DIMENSIONS[0]) * bytesPerVoxel;
+                        for (size_t byteIdx = pRegionBegin[0] * bytesPerVoxel; byteIdx < pRegionEnd[0] * bytesPerVoxel; byteIdx++)
+                        {
+                            levels[0][rowOffset + byteIdx] = static_cast<BYTE>(nextRandom(randomState) >> 2);
+                        }
+                    }
+                }
+                downsampleLevels(pRegionBegin, pRegionEnd, levels);
+
+                vector<vector<BYTE>> referenceLevels = levels;
+                downsampleLevels(volumeBegin, TEST_DIMENSIONS, referenceLevels);
+                levelsMatch = levelsMatch && (referenceLevels == levels);
+            }
+            check(levelsMatch, (2 == bytesPerVoxel) ? "region update : 16 bit levels match the full down-sampling" : "region update : 8 bit levels match the full down-sampling");
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Step size controller : render time ~ 1 / step size, so a frame 3 times over the budget triples the step
+    // size; the frames in flight do not change it again, a huge render time is clamped to the coarsest step
+    // size and idle frames ramp back to the fine step size
+    //------------------------------------------------------------------------------------------------------
+    void SelfTest::testStepSizeController()
+    {
+        StepSizeControllerSettings settings;
+        settings.fineStepSize = 0.003f;
+        settings.coarsestStepSize = 0.02f;
+        settings.budgetMSec = 10.0;
+        settings.idleFramesToRefine = 4;
+        StepSizeController controller;
+        controller.Configure(settings);
+        controller.Reset();
+
+        float stepSize = controller.Update(30.0, true);
+        check(fabs(stepSize - 0.009f) < 1e-6f, "step size : step size scaled to the budget");
+        bool stepSizeKept = (stepSize == controller.Update(30.0, true)) && (stepSize == controller.Update(30.0, true));
+        check(stepSizeKept, "step size : frames in flight do not change the step size");
+
+        controller.Reset();
+        stepSize = controller.Update(30.0, true);
+        stepSizeKept = true;
+        for (int frameIdx = 0; frameIdx < 5; frameIdx++)
+        {
+            stepSizeKept = stepSizeKept && (stepSize == controller.Update(10.5, true));
+        }
+        check(stepSizeKept && fabs(controller.GetPredictedTimeMSec() - 10.0) < 1.0, "step size : render times within the hysteresis keep the step size");
+
+        stepSize = controller.Update(1000.0, true);
+        check(settings.coarsestStepSize == stepSize && 83 == controller.GetMaxSamples(550), "step size : clamped to the coarsest step size");
+
+        bool rampDecreasing = true;
+        for (UINT frameIdx = 0; frameIdx < settings.idleFramesToRefine; frameIdx++)
+        {
+            const float idleStepSize = controller.Update(5.0, false);
+            rampDecreasing = rampDecreasing && (idleStepSize < stepSize);
+            stepSize = idleStepSize;
+        }
+        check(rampDecreasing && settings.fineStepSize == stepSize && 550 == controller.GetMaxSamples(550), "step size : idle frames ramp to the fine step size");
+
+        settings.fineStepSize = 0.005f;
+        settings.coarsestStepSize = 0.001f;
+        controller.Configure(settings);
+        check(settings.fineStepSize == controller.GetStepSize(), "step size : coarsest step size not below the fine step size");
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Triple buffer : the reader takes the latest published snapshot once; with a concurrent writer every
+    // snapshot the reader takes is complete and newer than the previous one
+    //------------------------------------------------------------------------------------------------------
+    void SelfTest::testTripleBuffer()
+    {
+        TripleBuffer<UINT> buffer;
+        check(!buffer.Consume(), "triple buffer : nothing published");
+        buffer.Back() = 1;
+        buffer.Publish();
+        buffer.Back() = 2;
+        buffer.Publish();
+        check(buffer.Consume() && 2 == buffer.Front(), "triple buffer : latest snapshot consumed");
+        check(!buffer.Consume() && 2 == buffer.Front(), "triple buffer : snapshot consumed once");
+        buffer.Back() = 3;
+        buffer.Publish();
+        check(buffer.Consume() && 3 == buffer.Front(), "triple buffer : next snapshot consumed");
+
+        // concurrent writer : snapshots of 16 copies of a sequence number
+        struct Snapshot
+        {
+            UINT values[16];
+        };
+        const UINT SNAPSHOT_COUNT = 20000;
+        TripleBuffer<Snapshot> snapshots;
+        thread writerThread([&snapshots, SNAPSHOT_COUNT]()
+        {
+            for (UINT sequence = 1; sequence <= SNAPSHOT_COUNT; sequence++)
+            {
+                Snapshot& snapshot = snapshots.Back();
+                fill(begin(snapshot.values), end(snapshot.values), sequence);
+                snapshots.Publish();
+            }
+        });
+        bool complete = true;
+        bool increasing = true;
+        UINT lastSequence = 0;
+        while (lastSequence < SNAPSHOT_COUNT && complete && increasing)
+        {
+            if (!snapshots.Consume())
+            {
+                this_thread::yield();
+                continue;
+            }
+            const UINT* pValues = snapshots.Front().values;
+            complete = all_of(pValues, pValues + 16, [pValues](UINT value) { return value == pValues[0]; });
+            increasing = pValues[0] > lastSequence;
+            lastSequence = pValues[0];
+        }
+        writerThread.join();
+        check(complete && increasing && SNAPSHOT_COUNT == lastSequence, "triple buffer : concurrent snapshots complete, in order and the last one read");
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Count a check and report it if it failed
+    //------------------------------------------------------------------------------------------------------
+    void SelfTest::check(bool passed, const char* description)
+    {
+        checkCount_++;
+        if (passed)
+        {
+            return;
+        }
+        failedCount_++;
+
+        char charBuffer[256] = { 0 };
+        sprintf_s(charBuffer, sizeof(charBuffer), "self-test : FAILED - %s\n", description);
+        OutputDebugStringA(charBuffer);
+    }
+}
@@ -0,0 +1,86 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: SelfTest.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: include file for implementation of the SelfTest functionality (headless checks of the
+//          CPU side codecs, caches and validations).
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    class SelfTest
+    {
+    public:
+        // constructor / desctructor
+        SelfTest();
+        virtual ~SelfTest();
+
+        // avoid usage of copy constructor and =operator ...
+        SelfTest(SelfTest const&) = delete;
+        SelfTest& operator= (SelfTest const&) = delete;
+
+        // run all tests (no Direct3D device needed) and report every failed check to the debug output - false if any
+        // check failed
+        bool Run();
+        // get the number of checks and failed checks of the last run
+        UINT GetCheckCount() const;
+        UINT GetFailedCount() const;
+
+        // headless self-test mode : run all tests and return the exit code (0 = all checks passed)
+        static int RunSelfTest();
+
+    private:
+
+        // distributed rendering : max-compositing, reduction tree covering every worker once
+        void testDistributedCompositing();
+        // render service : request validation and clamping, keyframe on request of a client without reference frame
+        void testRenderService();
+        // frame ring buffer : name collisions, frame order, torn frames, late consumers, concurrent producer / consumer
+        void testFrameRingBuffer();
+        // cine batch : frame rotations over the full turn, image files
+        void testCineBatch();
+        // image cache : rotation quantization, keys, least recently used eviction within the budget, removal of a volume
+        void testImageCache();
+        // brick page table : placement in free slots, least recently used replacement, requests of missing bricks
+        void testBrickPaging();
+        // packed bricks : every voxel decodes to its source value (8 and 16 bit, border bricks, constant bricks)
+        void testPackedBrickCodec();
+        // DICOM : element lengths beyond the end of the file, slice sort and validation, rescale across slices
+        void testDicomSeries();
+        // region updates : re-down-sampling the covering boxes gives the same levels as down-sampling the whole volume
+        void testRegionDownsampling();
+        // step size controller : step size for the budget, settling after a change, clamping, idle ramp to the fine step
+        void testStepSizeController();
+        // triple buffer : latest snapshot only, no snapshot twice, concurrent writer and reader without torn snapshots
+        void testTripleBuffer();
+        // frame codec : run-length coding round trips, key and delta frames, delta frames without reference, corrupt headers
+        void testFrameCodec();
+        // count a check and report it if it failed
+        void check(bool passed, const char* description);
+
+        // ------------------------------------------------------------------------------------------------------------
+
+        UINT    checkCount_ = 0;
+        UINT    failedCount_ = 0;
+    };
+}
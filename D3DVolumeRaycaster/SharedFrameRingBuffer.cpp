@@ -0,0 +1,336 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: SharedFrameRingBuffer.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of the SharedFrameRingBuffer functionality. Lock-free single producer /
+//          single consumer publishing with per-slot sequence numbers (sequence lock).
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#include "stdafx.h"
+#include "SharedFrameRingBuffer.h"
+
+using namespace std;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    // shared memory layout : ring header, followed by slotCount slots (slot header + pixel data)
+    struct SharedFrameRingBuffer::RingHeader
+    {
+        UINT32              magic;
+        UINT32              slotCount;
+        UINT64              slotSize;               // slot header + pixel capacity, multiple of 64 bytes
+        UINT64              pixelCapacity;
+        atomic<UINT64>      writeSequence;          // last published frame
+        atomic<UINT64>      readSequence;           // last frame released by the consumer
+        atomic<UINT64>      droppedFrames;
+        atomic<UINT32>      consumerAttached;
+    };
+
+    struct SharedFrameRingBuffer::SlotHeader
+    {
+        atomic<UINT64>      sequence;               // 2 * frame sequence when published, odd while written
+        UINT32              width;
+        UINT32              height;
+        INT64               timestampUSec;
+    };
+
+    namespace
+    {
+        const UINT32 RING_MAGIC = 0x474E5246;       // 'FRNG'
+        const UINT64 HEADER_SIZE = 256;
+        const UINT64 SLOT_HEADER_SIZE = 64;
+
+        static_assert(sizeof(atomic<UINT64>) == sizeof(UINT64), "shared memory atomics need to be address-free");
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    SharedFrameRingBuffer::SharedFrameRingBuffer()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    SharedFrameRingBuffer::~SharedFrameRingBuffer()
+    {
+        Close();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Producer : create the named shared memory with slotCount slots for frames up to maxWidth x maxHeight.
+    // Fails if a mapping of that name exists already - it belongs to another producer and may be smaller 
+    // than the layout written here.
+    //------------------------------------------------------------------------------------------------------
+    bool SharedFrameRingBuffer::Create(const wchar_t* name, UINT slotCount, UINT maxWidth, UINT maxHeight)
+    {
+        Close();
+
+        slotCount = max(slotCount, MIN_SLOT_COUNT);
+        const UINT64 pixelCapacity = (static_cast<UINT64>(maxWidth) * maxHeight + 63) & ~63ull;
+        const UINT64 slotSize = SLOT_HEADER_SIZE + pixelCapacity;
+        const UINT64 mappingSize = HEADER_SIZE + slotSize * slotCount;
+
+        hMapping_ = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+            static_cast<DWORD>(mappingSize >> 32), static_cast<DWORD>(mappingSize & 0xFFFFFFFF), name);
+        if (nullptr == hMapping_)
+        {
+            return false;
+        }
+        if (ERROR_ALREADY_EXISTS == GetLastError())
+        {
+            Close();
+            return false;
+        }
+        pSharedMemory_ = static_cast<BYTE*>(MapViewOfFile(hMapping_, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+        if (nullptr == pSharedMemory_)
+        {
+            Close();
+            return false;
+        }
+
+        pHeader_ = new (pSharedMemory_) RingHeader;
+        pHeader_->slotCount = slotCount;
+        pHeader_->slotSize = slotSize;
+        pHeader_->pixelCapacity = pixelCapacity;
+        pHeader_->writeSequence.store(0);
+        pHeader_->readSequence.store(0);
+        pHeader_->droppedFrames.store(0);
+        pHeader_->consumerAttached.store(0);
+        for (UINT slotIdx = 0; slotIdx < slotCount; slotIdx++)
+        {
+            SlotHeader* pSlot = new (pSharedMemory_ + HEADER_SIZE + slotSize * slotIdx) SlotHeader;
+            pSlot->sequence.store(0);
+        }
+        // publish the layout last - consumers check the magic number
+        atomic_thread_fence(memory_order_release);
+        pHeader_->magic = RING_MAGIC;
+
+        isProducer_ = true;
+        writeSequence_ = 0;
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Consumer : open existing named shared memory; the layout in the ring header needs to fit into the
+    // mapped view
+    //------------------------------------------------------------------------------------------------------
+    bool SharedFrameRingBuffer::Open(const wchar_t* name)
+    {
+        Close();
+
+        hMapping_ = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, name);
+        if (nullptr == hMapping_)
+        {
+            return false;
+        }
+        pSharedMemory_ = static_cast<BYTE*>(MapViewOfFile(hMapping_, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+        if (nullptr == pSharedMemory_)
+        {
+            Close();
+            return false;
+        }
+        pHeader_ = reinterpret_cast<RingHeader*>(pSharedMemory_);
+        if (RING_MAGIC != pHeader_->magic)
+        {
+            Close();
+            return false;
+        }
+        atomic_thread_fence(memory_order_acquire);
+
+        MEMORY_BASIC_INFORMATION memoryInfo;
+        if (0 == VirtualQuery(pSharedMemory_, &memoryInfo, sizeof(memoryInfo)) || 
+            pHeader_->slotCount < MIN_SLOT_COUNT || 
+            pHeader_->slotSize < SLOT_HEADER_SIZE + pHeader_->pixelCapacity || 
+            pHeader_->slotSize > (memoryInfo.RegionSize - HEADER_SIZE) / pHeader_->slotCount)
+        {
+            Close();
+            return false;
+        }
+
+        isProducer_ = false;
+        // start with the most recent frame
+        readSequence_ = pHeader_->writeSequence.load(memory_order_acquire);
+        readSequence_ = (readSequence_ > 0) ? readSequence_ - 1 : 0;
+        pHeader_->readSequence.store(readSequence_, memory_order_release);
+        pHeader_->consumerAttached.store(1, memory_order_release);
+        skippedFrames_ = 0;
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Unmap and close shared memory
+    //------------------------------------------------------------------------------------------------------
+    void SharedFrameRingBuffer::Close()
+    {
+        if (pHeader_ && !isProducer_)
+        {
+            pHeader_->consumerAttached.store(0, memory_order_release);
+        }
+        if (pSharedMemory_)
+        {
+            UnmapViewOfFile(pSharedMemory_);
+            pSharedMemory_ = nullptr;
+        }
+        if (hMapping_)
+        {
+            CloseHandle(hMapping_);
+            hMapping_ = nullptr;
+        }
+        pHeader_ = nullptr;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the slot of the given frame sequence number
+    //------------------------------------------------------------------------------------------------------
+    SharedFrameRingBuffer::SlotHeader* SharedFrameRingBuffer::getSlot(UINT64 sequence) const
+    {
+        const UINT64 slotIdx = sequence % pHeader_->slotCount;
+        return reinterpret_cast<SlotHeader*>(pSharedMemory_ + HEADER_SIZE + pHeader_->slotSize * slotIdx);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Producer : get the pixel buffer of the next slot (nullptr if the frame does not fit into a slot).
+    // The producer never waits for the consumer - the oldest slot is overwritten.
+    //------------------------------------------------------------------------------------------------------
+    BYTE* SharedFrameRingBuffer::BeginWrite(UINT width, UINT height)
+    {
+        if (!isProducer_ || nullptr == pHeader_ || static_cast<UINT64>(width) * height > pHeader_->pixelCapacity)
+        {
+            return nullptr;
+        }
+
+        writeSequence_ = pHeader_->writeSequence.load(memory_order_relaxed) + 1;
+
+        // overwriting a frame the attached consumer has not read yet -> dropped
+        if (pHeader_->consumerAttached.load(memory_order_acquire) &&
+            writeSequence_ > pHeader_->readSequence.load(memory_order_acquire) + pHeader_->slotCount)
+        {
+            pHeader_->droppedFrames.fetch_add(1, memory_order_relaxed);
+        }
+
+        SlotHeader* pSlot = getSlot(writeSequence_);
+        // odd sequence marks the slot as being written
+        pSlot->sequence.store(2 * writeSequence_ - 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        pSlot->width = width;
+        pSlot->height = height;
+        pSlot->timestampUSec = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+
+        return reinterpret_cast<BYTE*>(pSlot) + SLOT_HEADER_SIZE;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Producer : publish the frame written since BeginWrite()
+    //------------------------------------------------------------------------------------------------------
+    void SharedFrameRingBuffer::EndWrite()
+    {
+        if (!isProducer_ || nullptr == pHeader_ || 0 == writeSequence_)
+        {
+            return;
+        }
+        getSlot(writeSequence_)->sequence.store(2 * writeSequence_, memory_order_release);
+        pHeader_->writeSequence.store(writeSequence_, memory_order_release);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Consumer : get the next published frame without copying (false if there is no new frame). If the
+    // consumer has fallen behind, it continues with the oldest frame the producer cannot overwrite next.
+    //------------------------------------------------------------------------------------------------------
+    bool SharedFrameRingBuffer::AcquireFrame(SharedFrameView& frameView)
+    {
+        if (isProducer_ || nullptr == pHeader_)
+        {
+            return false;
+        }
+
+        while (true)
+        {
+            const UINT64 writeSequence = pHeader_->writeSequence.load(memory_order_acquire);
+            if (writeSequence <= readSequence_)
+            {
+                return false;
+            }
+
+            UINT64 nextSequence = readSequence_ + 1;
+            const UINT64 oldestSafeSequence = (writeSequence + 2 > pHeader_->slotCount) ? writeSequence + 2 - pHeader_->slotCount : 1;
+            if (nextSequence < oldestSafeSequence)
+            {
+                skippedFrames_ += oldestSafeSequence - nextSequence;
+                nextSequence = oldestSafeSequence;
+            }
+
+            const SlotHeader* pSlot = getSlot(nextSequence);
+            if (pSlot->sequence.load(memory_order_acquire) != 2 * nextSequence)
+            {
+                // overwritten meanwhile - try again with a newer frame
+                skippedFrames_++;
+                readSequence_ = nextSequence;
+                continue;
+            }
+
+            frameView.pPixels = reinterpret_cast<const BYTE*>(pSlot) + SLOT_HEADER_SIZE;
+            frameView.width = pSlot->width;
+            frameView.height = pSlot->height;
+            frameView.sequence = nextSequence;
+            frameView.timestampUSec = pSlot->timestampUSec;
+            readSequence_ = nextSequence;
+            return true;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Consumer : release the frame; false if the producer has overwritten the slot meanwhile (frame is torn)
+    //------------------------------------------------------------------------------------------------------
+    bool SharedFrameRingBuffer::ReleaseFrame(const SharedFrameView& frameView)
+    {
+        if (isProducer_ || nullptr == pHeader_)
+        {
+            return false;
+        }
+
+        atomic_thread_fence(memory_order_acquire);
+        const bool isValid = (getSlot(frameView.sequence)->sequence.load(memory_order_relaxed) == 2 * frameView.sequence);
+        if (!isValid)
+        {
+            skippedFrames_++;
+        }
+        pHeader_->readSequence.store(frameView.sequence, memory_order_release);
+
+        return isValid;
+    }
+
+    UINT64 SharedFrameRingBuffer::GetDroppedFrames() const
+    {
+        return pHeader_ ? pHeader_->droppedFrames.load(memory_order_relaxed) : 0;
+    }
+
+    UINT64 SharedFrameRingBuffer::GetSkippedFrames() const
+    {
+        return skippedFrames_;
+    }
+
+    UINT64 SharedFrameRingBuffer::GetPublishedFrames() const
+    {
+        return pHeader_ ? pHeader_->writeSequence.load(memory_order_relaxed) : 0;
+    }
+}
@@ -0,0 +1,95 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: SharedFrameRingBuffer.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: include file for implementation of the SharedFrameRingBuffer functionality. Ring buffer
+//          of frame slots in named shared memory for zero-copy frame hand-off to a consumer process.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    // view on a frame in shared memory (valid until ReleaseFrame() is called)
+    struct SharedFrameView
+    {
+        const BYTE* pPixels = nullptr;      // gray values, row-major (row pitch = width)
+        UINT        width = 0;
+        UINT        height = 0;
+        UINT64      sequence = 0;           // frame sequence number (starts with 1)
+        INT64       timestampUSec = 0;      // producer time stamp (steady clock)
+    };
+
+    class SharedFrameRingBuffer
+    {
+    public:
+        // minimum number of slots : the producer may write one slot while the consumer reads another one
+        static const UINT MIN_SLOT_COUNT = 3;
+
+        // constructor / desctructor
+        SharedFrameRingBuffer();
+        virtual ~SharedFrameRingBuffer();
+
+        // avoid usage of copy constructor and =operator ...
+        SharedFrameRingBuffer(SharedFrameRingBuffer const&) = delete;
+        SharedFrameRingBuffer& operator= (SharedFrameRingBuffer const&) = delete;
+
+        // producer : create the named shared memory with slotCount slots for frames up to maxWidth x maxHeight (fails if
+        // the name is in use)
+        bool Create(const wchar_t* name, UINT slotCount, UINT maxWidth, UINT maxHeight);
+        // consumer : open existing named shared memory (fails if the ring layout does not fit into the mapping)
+        bool Open(const wchar_t* name);
+        // unmap and close shared memory
+        void Close();
+
+        // producer : get the pixel buffer of the next slot (nullptr if the frame does not fit into a slot)
+        BYTE* BeginWrite(UINT width, UINT height);
+        // producer : publish the frame written since BeginWrite()
+        void EndWrite();
+
+        // consumer : get the next published frame without copying (false if there is no new frame)
+        bool AcquireFrame(SharedFrameView& frameView);
+        // consumer : release the frame; false if the producer has overwritten the slot meanwhile (frame is torn)
+        bool ReleaseFrame(const SharedFrameView& frameView);
+
+        // frames overwritten by the producer before the consumer has read them
+        UINT64 GetDroppedFrames() const;
+        // frames skipped or torn on the consumer side
+        UINT64 GetSkippedFrames() const;
+        // number of published frames
+        UINT64 GetPublishedFrames() const;
+
+    private:
+
+        struct RingHeader;
+        struct SlotHeader;
+
+        SlotHeader* getSlot(UINT64 sequence) const;
+
+        HANDLE          hMapping_ = nullptr;
+        BYTE*           pSharedMemory_ = nullptr;
+        RingHeader*     pHeader_ = nullptr;
+        UINT64          writeSequence_ = 0;         // producer : sequence of the frame being written
+        UINT64          readSequence_ = 0;          // consumer : sequence of the last acquired frame
+        UINT64          skippedFrames_ = 0;         // consumer side
+        bool            isProducer_ = false;
+    };
+}
@@ -0,0 +1,247 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: SocketChannel.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of SocketChannel functionality.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SocketChannel.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    SocketChannel::SocketChannel()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    SocketChannel::~SocketChannel()
+    {
+        Close();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Initialize Winsock - needs to be called once per process before any socket is used
+    //------------------------------------------------------------------------------------------------------
+    bool SocketChannel::InitializeSockets()
+    {
+        WSADATA wsaData;
+        return 0 == WSAStartup(MAKEWORD(2, 2), &wsaData);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Shutdown Winsock - counterpart of InitializeSockets()
+    //------------------------------------------------------------------------------------------------------
+    void SocketChannel::ShutdownSockets()
+    {
+        WSACleanup();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Listen for incoming connections on the loopback interface; port 0 selects an ephemeral port
+    //------------------------------------------------------------------------------------------------------
+    bool SocketChannel::Listen(UINT16 port)
+    {
+        Close();
+
+        socket_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (INVALID_SOCKET == socket_)
+        {
+            return false;
+        }
+
+        sockaddr_in address;
+        ZeroMemory(&address, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if (SOCKET_ERROR == bind(socket_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) ||
+            SOCKET_ERROR == listen(socket_, SOMAXCONN))
+        {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the local port the socket is bound to
+    //------------------------------------------------------------------------------------------------------
+    UINT16 SocketChannel::GetLocalPort() const
+    {
+        sockaddr_in address;
+        int addressLength = sizeof(address);
+        if (SOCKET_ERROR == getsockname(socket_, reinterpret_cast<sockaddr*>(&address), &addressLength))
+        {
+            return 0;
+        }
+        return ntohs(address.sin_port);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Wait for an incoming connection and hand it over to the given channel
+    //------------------------------------------------------------------------------------------------------
+    bool SocketChannel::Accept(SocketChannel& clientChannel)
+    {
+        SOCKET clientSocket = accept(socket_, nullptr, nullptr);
+        if (INVALID_SOCKET == clientSocket)
+        {
+            return false;
+        }
+        // we send small request messages - disable Nagle's algorithm to avoid latency
+        BOOL noDelay = TRUE;
+        setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+
+        clientChannel.Close();
+        clientChannel.socket_ = clientSocket;
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Wait at most timeoutMSec for an incoming connection (listening socket) or received data. Only a timeout
+    // returns false - on socket errors the caller's Accept() / ReceiveAll() fails and reports them.
+    //------------------------------------------------------------------------------------------------------
+    bool SocketChannel::WaitReadable(DWORD timeoutMSec)
+    {
+        if (INVALID_SOCKET == socket_)
+        {
+            return true;
+        }
+        fd_set readSet;
+        FD_ZERO(&readSet);
+        FD_SET(socket_, &readSet);
+        timeval timeout;
+        timeout.tv_sec = static_cast<long>(timeoutMSec / 1000);
+        timeout.tv_usec = static_cast<long>((timeoutMSec % 1000) * 1000);
+        // the first parameter of select() is ignored by Winsock
+        return 0 != select(0, &readSet, nullptr, nullptr, &timeout);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Connect to the given host (IPv4 address string) and port
+    //------------------------------------------------------------------------------------------------------
+    bool SocketChannel::Connect(const char* host, UINT16 port)
+    {
+        Close();
+
+        socket_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (INVALID_SOCKET == socket_)
+        {
+            return false;
+        }
+
+        sockaddr_in address;
+        ZeroMemory(&address, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        if (1 != inet_pton(AF_INET, host, &address.sin_addr) ||
+            SOCKET_ERROR == connect(socket_, reinterpret_cast<sockaddr*>(&address), sizeof(address)))
+        {
+            Close();
+            return false;
+        }
+
+        BOOL noDelay = TRUE;
+        setsockopt(socket_, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Send the complete data block (blocks until all bytes are sent)
+    //------------------------------------------------------------------------------------------------------
+    bool SocketChannel::SendAll(const void* pData, size_t size)
+    {
+        const char* pBytes = static_cast<const char*>(pData);
+        while (size > 0)
+        {
+            // send() takes an int length - send large blocks in chunks
+            int chunkSize = static_cast<int>(min(size, static_cast<size_t>(1 << 30)));
+            int sentBytes = send(socket_, pBytes, chunkSize, 0);
+            if (sentBytes <= 0)
+            {
+                return false;
+            }
+            pBytes += sentBytes;
+            size -= sentBytes;
+        }
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Receive exactly the given number of bytes (blocks until all bytes are received)
+    //------------------------------------------------------------------------------------------------------
+    bool SocketChannel::ReceiveAll(void* pData, size_t size)
+    {
+        char* pBytes = static_cast<char*>(pData);
+        while (size > 0)
+        {
+            int chunkSize = static_cast<int>(min(size, static_cast<size_t>(1 << 30)));
+            int receivedBytes = recv(socket_, pBytes, chunkSize, 0);
+            if (receivedBytes <= 0)
+            {
+                // connection closed by peer or socket error
+                return false;
+            }
+            pBytes += receivedBytes;
+            size -= receivedBytes;
+        }
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Check if socket is open
+    //------------------------------------------------------------------------------------------------------
+    bool SocketChannel::IsOpen() const
+    {
+        return INVALID_SOCKET != socket_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Shut down send and receive direction - the peer sees the connection closed. A thread blocked in
+    // Accept() is not woken up (Winsock), threads waiting for connections poll with WaitReadable().
+    // The socket itself stays valid until Close() is called by the owning thread.
+    //------------------------------------------------------------------------------------------------------
+    void SocketChannel::Interrupt()
+    {
+        if (INVALID_SOCKET != socket_)
+        {
+            shutdown(socket_, SD_BOTH);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Close the socket
+    //------------------------------------------------------------------------------------------------------
+    void SocketChannel::Close()
+    {
+        if (INVALID_SOCKET != socket_)
+        {
+            shutdown(socket_, SD_BOTH);
+            closesocket(socket_);
+            socket_ = INVALID_SOCKET;
+        }
+    }
+}
@@ -0,0 +1,77 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: SocketChannel.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: include file for implementation of the SocketChannel functionality. Thin wrapper around
+//          a blocking Winsock TCP stream socket used for inter-process communication.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+// note : winsock2.h needs to be included after windows.h with WIN32_LEAN_AND_MEAN (no winsock.h conflict)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    class SocketChannel
+    {
+    public:
+        // constructor / desctructor
+        SocketChannel();
+        virtual ~SocketChannel();
+
+        // avoid usage of copy constructor and =operator ...
+        SocketChannel(SocketChannel const&) = delete;
+        SocketChannel& operator= (SocketChannel const&) = delete;
+
+        // initialize Winsock - needs to be called once per process before any socket is used
+        static bool InitializeSockets();
+        // shutdown Winsock - counterpart of InitializeSockets()
+        static void ShutdownSockets();
+
+        // listen for incoming connections on the loopback interface; port 0 selects an ephemeral port
+        bool Listen(UINT16 port);
+        // get the local port the socket is bound to
+        UINT16 GetLocalPort() const;
+        // wait for an incoming connection and hand it over to the given channel
+        bool Accept(SocketChannel& clientChannel);
+        // wait at most timeoutMSec for an incoming connection (listening socket) or received data - false on timeout
+        // only; socket errors return true, so the following Accept() / ReceiveAll() reports them
+        bool WaitReadable(DWORD timeoutMSec);
+        // connect to the given host (IPv4 address string) and port
+        bool Connect(const char* host, UINT16 port);
+        // send the complete data block (blocks until all bytes are sent)
+        bool SendAll(const void* pData, size_t size);
+        // receive exactly the given number of bytes (blocks until all bytes are received)
+        bool ReceiveAll(void* pData, size_t size);
+        // check if socket is open
+        bool IsOpen() const;
+        // shut down send and receive direction - the peer sees the connection closed (does not unblock Accept(),
+        // threads waiting for connections poll with WaitReadable())
+        void Interrupt();
+        // close the socket
+        void Close();
+
+    private:
+
+        SOCKET  socket_ = INVALID_SOCKET;
+    };
+}
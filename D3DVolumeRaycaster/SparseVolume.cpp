@@ -0,0 +1,247 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: SparseVolume.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of SparseVolume functionality.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "SparseVolume.h"
+
+using namespace std;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    SparseVolume::SparseVolume()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    SparseVolume::~SparseVolume()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Count voxels above threshold per brick for the given range of brick layers (z-direction)
+    // note : the counts are accumulated in brickOffsets_[brickIndex + 1] (prepared for the prefix sum)
+    //------------------------------------------------------------------------------------------------------
+    void SparseVolume::countBrickVoxels(const unsigned char* pVolumeData, UINT brickLayerBegin, UINT brickLayerEnd)
+    {
+        const size_t slicePitch = static_cast<size_t>(volDimensions_[0]) * volDimensions_[1];
+
+        for (UINT slice = brickLayerBegin * BRICK_SIZE; slice < min(brickLayerEnd * BRICK_SIZE, volDimensions_[2]); slice++)
+        {
+            const UINT brickZ = slice / BRICK_SIZE;
+            for (UINT row = 0; row < volDimensions_[1]; row++)
+            {
+                const unsigned char* pRow = pVolumeData + slice * slicePitch + static_cast<size_t>(row) * volDimensions_[0];
+                const UINT brickRowBase = (brickZ * brickCount_[1] + row / BRICK_SIZE) * brickCount_[0];
+                for (UINT column = 0; column < volDimensions_[0]; column++)
+                {
+                    if (pRow[column] > threshold_)
+                    {
+                        brickOffsets_[brickRowBase + column / BRICK_SIZE + 1]++;
+                    }
+                }
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Copy voxels above threshold to their brick ranges for the given range of brick layers (z-direction)
+    // note : brickOffsets_ must contain the prefix sum; the bricks of a layer are only written by one thread
+    //------------------------------------------------------------------------------------------------------
+    void SparseVolume::fillBrickVoxels(const unsigned char* pVolumeData, UINT brickLayerBegin, UINT brickLayerEnd)
+    {
+        const size_t slicePitch = static_cast<size_t>(volDimensions_[0]) * volDimensions_[1];
+        const UINT bricksPerLayer = brickCount_[0] * brickCount_[1];
+
+        // per brick write cursor of this layer range
+        vector<UINT> writeCursor(
+            brickOffsets_.begin() + brickLayerBegin * bricksPerLayer,
+            brickOffsets_.begin() + brickLayerEnd * bricksPerLayer);
+
+        for (UINT slice = brickLayerBegin * BRICK_SIZE; slice < min(brickLayerEnd * BRICK_SIZE, volDimensions_[2]); slice++)
+        {
+            const UINT brickZ = slice / BRICK_SIZE;
+            for (UINT row = 0; row < volDimensions_[1]; row++)
+            {
+                const unsigned char* pRow = pVolumeData + slice * slicePitch + static_cast<size_t>(row) * volDimensions_[0];
+                const UINT brickRowBase = ((brickZ - brickLayerBegin) * brickCount_[1] + row / BRICK_SIZE) * brickCount_[0];
+                for (UINT column = 0; column < volDimensions_[0]; column++)
+                {
+                    if (pRow[column] > threshold_)
+                    {
+                        SparseVoxel& voxel = voxels_[writeCursor[brickRowBase + column / BRICK_SIZE]++];
+                        voxel.x = static_cast<UINT16>(column);
+                        voxel.y = static_cast<UINT16>(row);
+                        voxel.z = static_cast<UINT16>(slice);
+                        voxel.value = pRow[column];
+                    }
+                }
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Build sparse representation : collect all voxels above given threshold, sorted by brick.
+    // Bricks are ordered x-fastest, voxels within a brick in scan-line order. The work is split into
+    // ranges of brick layers (z-direction) which are processed in parallel.
+    //------------------------------------------------------------------------------------------------------
+    bool SparseVolume::Build(const char* pVolumeData, UINT volColumns, UINT volRows, UINT volSlices, UINT threshold)
+    {
+        Release();
+
+        if (nullptr == pVolumeData || 0 == volColumns || 0 == volRows || 0 == volSlices)
+        {
+            return false;
+        }
+        // voxel positions are stored as 16 bit values
+        if (volColumns > 0xFFFF || volRows > 0xFFFF || volSlices > 0xFFFF)
+        {
+            return false;
+        }
+
+        const unsigned char* pData = reinterpret_cast<const unsigned char*>(pVolumeData);
+
+        volDimensions_[0] = volColumns;
+        volDimensions_[1] = volRows;
+        volDimensions_[2] = volSlices;
+        threshold_ = threshold;
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            brickCount_[axis] = (volDimensions_[axis] + BRICK_SIZE - 1) / BRICK_SIZE;
+        }
+        const UINT totalBricks = brickCount_[0] * brickCount_[1] * brickCount_[2];
+        brickOffsets_.assign(totalBricks + 1, 0);
+
+        // split brick layers over the available hardware threads
+        UINT threadCount = max(1u, min(thread::hardware_concurrency(), brickCount_[2]));
+        UINT layersPerThread = (brickCount_[2] + threadCount - 1) / threadCount;
+        vector<thread> workers;
+
+        // pass 1 : count voxels per brick
+        for (UINT threadIdx = 0; threadIdx < threadCount; threadIdx++)
+        {
+            UINT layerBegin = threadIdx * layersPerThread;
+            UINT layerEnd = min(layerBegin + layersPerThread, brickCount_[2]);
+            if (layerBegin < layerEnd)
+            {
+                workers.emplace_back(&SparseVolume::countBrickVoxels, this, pData, layerBegin, layerEnd);
+            }
+        }
+        for (auto& worker : workers) worker.join();
+        workers.clear();
+
+        // prefix sum -> first voxel index per brick
+        for (UINT brickIdx = 0; brickIdx < totalBricks; brickIdx++)
+        {
+            brickOffsets_[brickIdx + 1] += brickOffsets_[brickIdx];
+        }
+        voxels_.resize(brickOffsets_[totalBricks]);
+
+        // pass 2 : scatter voxels to their brick ranges
+        for (UINT threadIdx = 0; threadIdx < threadCount; threadIdx++)
+        {
+            UINT layerBegin = threadIdx * layersPerThread;
+            UINT layerEnd = min(layerBegin + layersPerThread, brickCount_[2]);
+            if (layerBegin < layerEnd)
+            {
+                workers.emplace_back(&SparseVolume::fillBrickVoxels, this, pData, layerBegin, layerEnd);
+            }
+        }
+        for (auto& worker : workers) worker.join();
+
+        occupancy_ = static_cast<float>(static_cast<double>(voxels_.size()) /
+            (static_cast<double>(volColumns) * volRows * volSlices));
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Release all allocated memory
+    //------------------------------------------------------------------------------------------------------
+    void SparseVolume::Release()
+    {
+        voxels_.clear();
+        voxels_.shrink_to_fit();
+        brickOffsets_.clear();
+        brickOffsets_.shrink_to_fit();
+        brickCount_[0] = brickCount_[1] = brickCount_[2] = 0;
+        occupancy_ = 0.0f;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get pointer to the sparse voxel list (brick-sorted)
+    //------------------------------------------------------------------------------------------------------
+    const SparseVoxel* SparseVolume::GetVoxels() const
+    {
+        return voxels_.empty() ? nullptr : voxels_.data();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get number of voxels in the sparse voxel list
+    //------------------------------------------------------------------------------------------------------
+    UINT SparseVolume::GetVoxelCount() const
+    {
+        return static_cast<UINT>(voxels_.size());
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the number of bricks in x-, y- and z-direction
+    //------------------------------------------------------------------------------------------------------
+    void SparseVolume::GetBrickCount(UINT brickCount[3]) const
+    {
+        brickCount[0] = brickCount_[0];
+        brickCount[1] = brickCount_[1];
+        brickCount[2] = brickCount_[2];
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the first sparse voxel index of the given brick; index brickCount equals the voxel count
+    //------------------------------------------------------------------------------------------------------
+    UINT SparseVolume::GetBrickOffset(UINT brickIndex) const
+    {
+        assert(brickIndex < brickOffsets_.size());
+        return brickOffsets_[brickIndex];
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get fraction of voxels (0.0 .. 1.0) above threshold
+    //------------------------------------------------------------------------------------------------------
+    float SparseVolume::GetOccupancy() const
+    {
+        return occupancy_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the threshold used to build the sparse representation
+    //------------------------------------------------------------------------------------------------------
+    UINT SparseVolume::GetThreshold() const
+    {
+        return threshold_;
+    }
+}
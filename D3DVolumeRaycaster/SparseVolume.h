@@ -0,0 +1,89 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: SparseVolume.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: include file for implementation of the SparseVolume functionality. Holds the list of
+//          above-threshold voxels of a volume dataset (sorted by brick) for point-based MIP rendering.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    // sparse voxel : voxel position (column, row, slice) and intensity value
+    // -> memory layout matches the vertex format DXGI_FORMAT_R16G16B16A16_UINT
+    struct SparseVoxel
+    {
+        UINT16 x;
+        UINT16 y;
+        UINT16 z;
+        UINT16 value;
+    };
+
+    class SparseVolume
+    {
+    public:
+        // edge length of a brick in voxels - voxels are sorted brick by brick
+        static const UINT BRICK_SIZE = 16;
+
+        // constructor / desctructor
+        SparseVolume();
+        virtual ~SparseVolume();
+
+        // avoid usage of copy constructor and =operator ...
+        SparseVolume(SparseVolume const&) = delete;
+        SparseVolume& operator= (SparseVolume const&) = delete;
+
+        // build sparse representation : collect all voxels above given threshold, sorted by brick
+        bool Build(const char* pVolumeData, UINT volColumns, UINT volRows, UINT volSlices, UINT threshold);
+        // release all allocated memory
+        void Release();
+
+        // get pointer to the sparse voxel list (brick-sorted)
+        const SparseVoxel* GetVoxels() const;
+        // get number of voxels in the sparse voxel list
+        UINT GetVoxelCount() const;
+        // get the number of bricks in x-, y- and z-direction
+        void GetBrickCount(UINT brickCount[3]) const;
+        // get the first sparse voxel index of the given brick; index brickCount equals the voxel count
+        UINT GetBrickOffset(UINT brickIndex) const;
+        // get fraction of voxels (0.0 .. 1.0) above threshold
+        float GetOccupancy() const;
+        // get the threshold used to build the sparse representation
+        UINT GetThreshold() const;
+
+    private:
+
+        // count voxels above threshold per brick for the given range of brick layers (z-direction)
+        void countBrickVoxels(const unsigned char* pVolumeData, UINT brickLayerBegin, UINT brickLayerEnd);
+        // copy voxels above threshold to their brick ranges for the given range of brick layers (z-direction)
+        void fillBrickVoxels(const unsigned char* pVolumeData, UINT brickLayerBegin, UINT brickLayerEnd);
+
+        // ------------------------------------------------------------------------------------------------------------
+
+        std::vector<SparseVoxel>    voxels_;            // above-threshold voxels, sorted by brick
+        std::vector<UINT>           brickOffsets_;      // per brick : index of first voxel in voxels_ (+1 entry for end)
+        UINT                        brickCount_[3] = { 0, 0, 0 };
+        UINT                        volDimensions_[3] = { 0, 0, 0 };
+        UINT                        threshold_ = 0;
+        float                       occupancy_ = 0.0f;
+    };
+}
@@ -0,0 +1,154 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: StepSizeController.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of StepSizeController functionality.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#include "stdafx.h"
+#include "StepSizeController.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    const double StepSizeController::COST_SMOOTHING = 0.3;
+
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    StepSizeController::StepSizeController()
+    {
+        Reset();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    StepSizeController::~StepSizeController()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Set the controller parameters
+    //------------------------------------------------------------------------------------------------------
+    void StepSizeController::Configure(const StepSizeControllerSettings& settings)
+    {
+        settings_ = settings;
+        settings_.coarsestStepSize = max(settings_.coarsestStepSize, settings_.fineStepSize);
+        settings_.budgetMSec = max(settings_.budgetMSec, 1.0);
+        settings_.idleFramesToRefine = max(settings_.idleFramesToRefine, 1u);
+        stepSize_ = clampStepSize(stepSize_);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Return to the fine step size and forget the measurements
+    //------------------------------------------------------------------------------------------------------
+    void StepSizeController::Reset()
+    {
+        stepSize_ = settings_.fineStepSize;
+        measuredStepSize_ = stepSize_;
+        rampStartStepSize_ = stepSize_;
+        costEstimate_ = 0.0;
+        settleFrames_ = 0;
+        idleFrames_ = 0;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Closed-loop update. The render time is modeled as cost / step size (the sample count per ray is
+    // inversely proportional to the step size); the cost is estimated from the measured render times.
+    // - interacting : the step size is set to meet the budget as soon as the predicted render time leaves
+    //   the hysteresis band around the budget; after a change, SETTLE_FRAMES frames pass before the next
+    //   decision, as the frames in flight still report the old step size
+    // - idle : the step size ramps geometrically back to the fine step size within idleFramesToRefine frames
+    //------------------------------------------------------------------------------------------------------
+    float StepSizeController::Update(double renderTimeMSec, bool interacting)
+    {
+        // update the cost estimate with the measurement of the previous frame
+        if (renderTimeMSec > 0.0)
+        {
+            const double measuredCost = renderTimeMSec * measuredStepSize_;
+            costEstimate_ = (costEstimate_ > 0.0) ? 
+                (1.0 - COST_SMOOTHING) * costEstimate_ + COST_SMOOTHING * measuredCost : 
+                measuredCost;
+        }
+
+        if (!interacting)
+        {
+            if (0 == idleFrames_)
+            {
+                rampStartStepSize_ = stepSize_;
+            }
+            idleFrames_ = min(idleFrames_ + 1, settings_.idleFramesToRefine);
+            const float rampPosition = 1.0f - static_cast<float>(idleFrames_) / settings_.idleFramesToRefine;
+            stepSize_ = settings_.fineStepSize * powf(rampStartStepSize_ / settings_.fineStepSize, rampPosition);
+            settleFrames_ = 0;
+        }
+        else
+        {
+            if (idleFrames_ > 0)
+            {
+                // interaction starts - decide immediately
+                idleFrames_ = 0;
+                settleFrames_ = 0;
+            }
+
+            if (settleFrames_ > 0)
+            {
+                settleFrames_--;
+            }
+            else if (costEstimate_ > 0.0)
+            {
+                const double predictedTimeMSec = costEstimate_ / stepSize_;
+                const bool overBudget = predictedTimeMSec > settings_.budgetMSec * (1.0 + settings_.hysteresis);
+                const bool underBudget = predictedTimeMSec < settings_.budgetMSec * (1.0 - settings_.hysteresis) && stepSize_ > settings_.fineStepSize;
+                if (overBudget || underBudget)
+                {
+                    const float newStepSize = clampStepSize(static_cast<float>(costEstimate_ / settings_.budgetMSec));
+                    if (newStepSize != stepSize_)
+                    {
+                        stepSize_ = newStepSize;
+                        settleFrames_ = SETTLE_FRAMES;
+                    }
+                }
+            }
+        }
+
+        measuredStepSize_ = stepSize_;
+        return stepSize_;
+    }
+
+    float StepSizeController::GetStepSize() const
+    {
+        return stepSize_;
+    }
+
+    UINT StepSizeController::GetMaxSamples(UINT fineMaxSamples) const
+    {
+        return max(1u, static_cast<UINT>(ceilf(fineMaxSamples * settings_.fineStepSize / stepSize_)));
+    }
+
+    double StepSizeController::GetPredictedTimeMSec() const
+    {
+        return costEstimate_ / stepSize_;
+    }
+
+    float StepSizeController::clampStepSize(float stepSize) const
+    {
+        return min(max(stepSize, settings_.fineStepSize), settings_.coarsestStepSize);
+    }
+}
@@ -0,0 +1,84 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: StepSizeController.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: closed-loop controller choosing the ray-casting step size per frame from measured
+//          render times - meets a latency budget while interacting and refines when idle.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    // parameters of the step size controller
+    struct StepSizeControllerSettings
+    {
+        float   fineStepSize = 0.003f;      // step size of idle frames (full quality) - lower limit
+        float   coarsestStepSize = 0.02f;   // upper limit of the step size while interacting
+        double  budgetMSec = 33.3;          // render time budget per frame while interacting
+        double  hysteresis = 0.15;          // relative dead band around the budget without step size changes
+        UINT    idleFramesToRefine = 20;    // idle frames until the fine step size is reached again
+    };
+
+    class StepSizeController
+    {
+    public:
+        // constructor / desctructor
+        StepSizeController();
+        virtual ~StepSizeController();
+
+        // set the controller parameters (takes effect with the next update)
+        void Configure(const StepSizeControllerSettings& settings);
+        // feed the render time of the last frame and whether the view is changing; returns the step size
+        // of the next frame
+        float Update(double renderTimeMSec, bool interacting);
+        // return to the fine step size and forget the measurements
+        void Reset();
+
+        // get the step size of the next frame
+        float GetStepSize() const;
+        // get the maximum number of samples per ray covering the same ray length as fineMaxSamples at the
+        // fine step size
+        UINT GetMaxSamples(UINT fineMaxSamples) const;
+        // get the estimated render time of the next frame
+        double GetPredictedTimeMSec() const;
+
+    private:
+
+        // clamp a step size to [fine, coarsest]
+        float clampStepSize(float stepSize) const;
+
+        // ------------------------------------------------------------------------------------------------------------
+
+        // frames without step size decisions after a change (frames in flight still report the old step size)
+        static const UINT SETTLE_FRAMES = 2;
+        // weight of the newest measurement in the cost estimate
+        static const double COST_SMOOTHING;
+
+        StepSizeControllerSettings  settings_;
+        float   stepSize_ = 0.003f;
+        float   measuredStepSize_ = 0.003f;     // step size of the frame the next measurement belongs to
+        float   rampStartStepSize_ = 0.003f;    // step size at the end of the interaction (start of the idle ramp)
+        double  costEstimate_ = 0.0;            // smoothed render time * step size (render time ~ 1 / step size)
+        UINT    settleFrames_ = 0;
+        UINT    idleFrames_ = 0;
+    };
+}
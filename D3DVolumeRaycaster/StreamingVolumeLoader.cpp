@@ -0,0 +1,306 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: StreamingVolumeLoader.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of the StreamingVolumeLoader functionality.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#include "stdafx.h"
+#include "StreamingVolumeLoader.h"
+
+using namespace std;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    //------------------------------------------------------------------------------------------------------
+    // Construction
+    //------------------------------------------------------------------------------------------------------
+    StreamingVolumeLoader::StreamingVolumeLoader()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destruction
+    //------------------------------------------------------------------------------------------------------
+    StreamingVolumeLoader::~StreamingVolumeLoader()
+    {
+        Stop();
+        WaitForAbandoned();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create an empty streamed volume of the given dataset and start the loader thread. The caller renders
+    // the streamed volume right away - slices not uploaded yet are empty.
+    //------------------------------------------------------------------------------------------------------
+    bool StreamingVolumeLoader::Start(
+        ID3D11Device* pD3DDevice, 
+        ID3D11DeviceContext* pImmediateContext, 
+        const VolumeDatasetInfo& datasetInfo, 
+        VOXEL_FORMAT voxelFormat, 
+        function<bool(VolumeHandle&)> acquireComplete, 
+        VolumeHandle& streamedVolume)
+    {
+        Stop();
+
+        startTime_ = chrono::steady_clock::now();
+        if (!VolumeResource::CreateStreamed(pD3DDevice, pImmediateContext, datasetInfo, voxelFormat, pStreamed_))
+        {
+            return false;
+        }
+        datasetInfo_ = datasetInfo;
+        voxelFormat_ = voxelFormat;
+        acquireComplete_ = move(acquireComplete);
+        uploadChunk_ = 0;
+        loadedSlices_ = 0;
+        stopLoader_ = false;
+        pAcquire_ = make_shared<AcquireState>();
+
+        streamedVolume = VolumeHandle(pStreamed_);
+        loaderThread_ = thread(&StreamingVolumeLoader::loaderThreadProc, this, pAcquire_);
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Stop the loader thread and release the streamed volume (handles of the caller keep it alive). Reading
+    // stops at the next chunk; a complete volume being created is not waited for - the thread is abandoned and
+    // joined once it ends, its volume is dropped.
+    //------------------------------------------------------------------------------------------------------
+    void StreamingVolumeLoader::Stop()
+    {
+        bool abandonLoader = false;
+        {
+            lock_guard<mutex> lock(mutex_);
+            stopLoader_ = true;
+            if (pAcquire_ && pAcquire_->acquiring && !pAcquire_->done)
+            {
+                pAcquire_->abandoned = true;
+                abandonLoader = true;
+            }
+            if (abandonLoader && loaderThread_.joinable())
+            {
+                abandonedThreads_.emplace_back(move(loaderThread_), pAcquire_);
+            }
+            reapAbandoned();
+        }
+        condition_.notify_all();
+        if (loaderThread_.joinable()) loaderThread_.join();
+
+        for (auto& chunk : chunks_)
+        {
+            chunk.data.clear();
+            chunk.ready = false;
+        }
+        pAcquire_.reset();
+        acquireComplete_ = nullptr;
+        pStreamed_.reset();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Wait for the abandoned threads : they create their volume on the device of the caller
+    //------------------------------------------------------------------------------------------------------
+    void StreamingVolumeLoader::WaitForAbandoned()
+    {
+        list<pair<thread, shared_ptr<AcquireState>>> abandonedThreads;
+        {
+            lock_guard<mutex> lock(mutex_);
+            abandonedThreads.swap(abandonedThreads_);
+        }
+        for (auto& abandoned : abandonedThreads)
+        {
+            abandoned.first.join();
+        }
+    }
+
+    bool StreamingVolumeLoader::IsActive() const
+    {
+        return nullptr != pStreamed_;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Render thread : upload the chunks read since the last call (in slice order) and hand the staging
+    // chunks back to the loader thread
+    //------------------------------------------------------------------------------------------------------
+    bool StreamingVolumeLoader::Upload(ID3D11DeviceContext* pImmediateContext)
+    {
+        if (!pStreamed_)
+        {
+            return false;
+        }
+
+        bool uploaded = false;
+        for (;;)
+        {
+            SliceChunk& chunk = chunks_[uploadChunk_];
+            {
+                lock_guard<mutex> lock(mutex_);
+                if (!chunk.ready) break;
+            }
+            pStreamed_->UpdateSlices(pImmediateContext, chunk.sliceBegin, chunk.sliceEnd, chunk.data.data());
+            if (0 == loadedSlices_)
+            {
+                reportElapsedTime("first slices rendered");
+            }
+            loadedSlices_ = chunk.sliceEnd;
+            uploaded = true;
+            {
+                lock_guard<mutex> lock(mutex_);
+                chunk.ready = false;
+            }
+            condition_.notify_all();
+            uploadChunk_ ^= 1;
+        }
+
+        bool loaderFailed = false;
+        {
+            lock_guard<mutex> lock(mutex_);
+            loaderFailed = pAcquire_->done && !pAcquire_->completeVolume && !chunks_[uploadChunk_].ready;
+        }
+        if (loaderFailed)
+        {
+            // read error or the complete volume could not be created - keep rendering the slices loaded so far
+            reportElapsedTime("streaming failed");
+            Stop();
+        }
+
+        return uploaded;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Render thread : take the complete volume - only after all slices are uploaded, so the image never
+    // jumps back to a partially loaded state
+    //------------------------------------------------------------------------------------------------------
+    bool StreamingVolumeLoader::TakeCompleteVolume(VolumeHandle& completeVolume)
+    {
+        if (!pStreamed_ || loadedSlices_ < datasetInfo_.volSlices)
+        {
+            return false;
+        }
+        {
+            lock_guard<mutex> lock(mutex_);
+            if (!pAcquire_->completeVolume) return false;
+            completeVolume = move(pAcquire_->completeVolume);
+        }
+        reportElapsedTime("complete volume resident");
+        Stop();
+
+        return true;
+    }
+
+    UINT StreamingVolumeLoader::GetLoadedSlices() const
+    {
+        return loadedSlices_;
+    }
+
+    UINT StreamingVolumeLoader::GetSliceCount() const
+    {
+        return datasetInfo_.volSlices;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Loader thread : read the slices chunk by chunk into the free staging chunk and convert them to the
+    // storage format. After the last chunk the complete volume is created - it re-reads the file, which
+    // is in the file system cache by then. From then on the thread touches its acquire state only, so Stop()
+    // and the next Start() need not wait for it.
+    //------------------------------------------------------------------------------------------------------
+    void StreamingVolumeLoader::loaderThreadProc(shared_ptr<AcquireState> pAcquire)
+    {
+        const UINT fileBytesPerVoxel = (datasetInfo_.bitsStored > 8) ? 2 : 1;
+        const size_t fileSlicePitch = static_cast<size_t>(datasetInfo_.volColumns) * datasetInfo_.volRows * fileBytesPerVoxel;
+
+        ifstream volDataFile(datasetInfo_.fileName, ifstream::in | ifstream::binary);
+        UINT chunkIdx = 0;
+        for (UINT sliceBegin = 0; sliceBegin < datasetInfo_.volSlices && volDataFile; sliceBegin += CHUNK_SLICES)
+        {
+            SliceChunk& chunk = chunks_[chunkIdx];
+            {
+                unique_lock<mutex> lock(mutex_);
+                condition_.wait(lock, [this, &chunk] { return stopLoader_ || !chunk.ready; });
+                if (stopLoader_)
+                {
+                    return;
+                }
+            }
+
+            // the render thread does not touch a chunk that is not ready
+            chunk.sliceBegin = sliceBegin;
+            chunk.sliceEnd = min(sliceBegin + CHUNK_SLICES, datasetInfo_.volSlices);
+            chunk.data.resize(fileSlicePitch * (chunk.sliceEnd - chunk.sliceBegin));
+            volDataFile.read(chunk.data.data(), static_cast<streamsize>(chunk.data.size()));
+            if (!volDataFile) break;
+            VolumeResource::ConvertVoxels(datasetInfo_, voxelFormat_, chunk.data);
+
+            {
+                lock_guard<mutex> lock(mutex_);
+                chunk.ready = true;
+            }
+            chunkIdx ^= 1;
+        }
+
+        function<bool(VolumeHandle&)> acquireComplete;
+        {
+            lock_guard<mutex> lock(mutex_);
+            if (volDataFile && !stopLoader_)
+            {
+                acquireComplete = acquireComplete_;
+                pAcquire->acquiring = true;
+            }
+        }
+        VolumeHandle completeVolume;
+        if (acquireComplete)
+        {
+            acquireComplete(completeVolume);
+        }
+        lock_guard<mutex> lock(mutex_);
+        if (!pAcquire->abandoned)
+        {
+            pAcquire->completeVolume = move(completeVolume);
+        }
+        pAcquire->done = true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Join the abandoned threads that ended - they only release their lock after setting done (caller holds mutex_)
+    //------------------------------------------------------------------------------------------------------
+    void StreamingVolumeLoader::reapAbandoned()
+    {
+        for (auto it = abandonedThreads_.begin(); it != abandonedThreads_.end();)
+        {
+            if (!it->second->done)
+            {
+                ++it;
+                continue;
+            }
+            it->first.join();
+            it = abandonedThreads_.erase(it);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Report the elapsed time since Start() (debug output)
+    //------------------------------------------------------------------------------------------------------
+    void StreamingVolumeLoader::reportElapsedTime(const char* milestone) const
+    {
+        const double elapsedMs = chrono::duration<double, milli>(chrono::steady_clock::now() - startTime_).count();
+
+        const size_t bufferSize = 256;
+        char charBuffer[bufferSize];
+        sprintf_s(charBuffer, bufferSize, "Streaming %s : %s after %.1f ms (%u / %u slices)\n", datasetInfo_.fileName, milestone, elapsedMs, loadedSlices_, datasetInfo_.volSlices);
+        OutputDebugStringA(charBuffer);
+    }
+}
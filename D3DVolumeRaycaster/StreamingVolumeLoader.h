@@ -0,0 +1,119 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: StreamingVolumeLoader.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: include file for implementation of the StreamingVolumeLoader functionality. Progressive
+//          loading of a volume in slice chunks - the volume is rendered while the remaining slices stream in.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+#include "VolumeResource.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    class StreamingVolumeLoader
+    {
+    public:
+        // number of slices read and uploaded at once
+        static const UINT CHUNK_SLICES = 16;
+
+        // constructor / desctructor
+        StreamingVolumeLoader();
+        virtual ~StreamingVolumeLoader();
+
+        // avoid usage of copy constructor and =operator ...
+        StreamingVolumeLoader(StreamingVolumeLoader const&) = delete;
+        StreamingVolumeLoader& operator= (StreamingVolumeLoader const&) = delete;
+
+        // create an empty streamed volume of the given dataset (returned in streamedVolume) and start the loader thread
+        // reading its slices. Once all slices are read the loader thread calls acquireComplete to create the complete
+        // volume (all resolution levels and sparse voxel list) that replaces the streamed one.
+        bool Start(
+            ID3D11Device* pD3DDevice, 
+            ID3D11DeviceContext* pImmediateContext, 
+            const VolumeDatasetInfo& datasetInfo, 
+            VOXEL_FORMAT voxelFormat, 
+            std::function<bool(VolumeHandle&)> acquireComplete, 
+            VolumeHandle& streamedVolume);
+        // stop the loader thread and release the streamed volume - a complete volume being created is abandoned, its
+        // thread is joined later
+        void Stop();
+        // wait for the abandoned threads still creating a complete volume (before the device is released)
+        void WaitForAbandoned();
+        // is a volume streamed
+        bool IsActive() const;
+        // render thread : upload the slice chunks read since the last call to the streamed volume (returns true if
+        // new slices were uploaded)
+        bool Upload(ID3D11DeviceContext* pImmediateContext);
+        // render thread : take the complete volume once all slices are uploaded and it is created (ends streaming)
+        bool TakeCompleteVolume(VolumeHandle& completeVolume);
+
+        // get the number of uploaded slices and the number of slices of the streamed volume
+        UINT GetLoadedSlices() const;
+        UINT GetSliceCount() const;
+
+    private:
+
+        // a chunk of slices (storage format) read by the loader thread, waiting for upload
+        struct SliceChunk
+        {
+            UINT                sliceBegin = 0;
+            UINT                sliceEnd = 0;
+            std::vector<char>   data;
+            bool                ready = false;  // read by the loader thread, owned by the render thread until uploaded
+        };
+
+        // the complete volume of one Start() - outlives the loader thread's run if Stop() abandons it (guarded by mutex_)
+        struct AcquireState
+        {
+            VolumeHandle    completeVolume;
+            bool            acquiring = false;  // all slices read, acquireComplete is running
+            bool            done = false;       // the loader thread ended (completeVolume empty -> failed)
+            bool            abandoned = false;  // Stop() did not wait - the complete volume is dropped
+        };
+
+        // loader thread : read the slice chunks (alternating between the two staging chunks), then create the
+        // complete volume
+        void loaderThreadProc(std::shared_ptr<AcquireState> pAcquire);
+        // join the abandoned threads that ended (caller holds mutex_)
+        void reapAbandoned();
+        // report the elapsed time since Start() (debug output)
+        void reportElapsedTime(const char* milestone) const;
+
+        // ------------------------------------------------------------------------------------------------------------
+
+        std::shared_ptr<VolumeResource>     pStreamed_;
+        VolumeDatasetInfo                   datasetInfo_ = { nullptr, 0, 0, 0, 8, { 1.0f, 1.0f, 1.0f } };
+        VOXEL_FORMAT                        voxelFormat_ = VOXEL_FORMAT::UINT8;
+        std::function<bool(VolumeHandle&)>  acquireComplete_;
+        // double-buffered staging : the loader thread reads the next chunk while the render thread uploads the other
+        SliceChunk                          chunks_[2];
+        UINT                                uploadChunk_ = 0;   // next chunk to upload (render thread)
+        UINT                                loadedSlices_ = 0;
+        std::thread                         loaderThread_;
+        std::mutex                          mutex_;
+        std::condition_variable             condition_;
+        bool                                stopLoader_ = false;
+        std::shared_ptr<AcquireState>       pAcquire_;
+        std::list<std::pair<std::thread, std::shared_ptr<AcquireState>>> abandonedThreads_;
+        std::chrono::steady_clock::time_point startTime_;
+    };
+}
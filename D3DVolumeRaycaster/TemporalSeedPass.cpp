@@ -0,0 +1,264 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: TemporalSeedPass.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of TemporalSeedPass functionality.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#include "stdafx.h"
+#include "TemporalSeedPass.h"
+
+using namespace DirectX;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    TemporalSeedPass::TemporalSeedPass()
+        : matrixHistoryWVP_(XMMatrixIdentity())
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    TemporalSeedPass::~TemporalSeedPass()
+    {
+        Release();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create the history texture of canvas size (same format as the raw MIP image for direct copies)
+    //------------------------------------------------------------------------------------------------------
+    bool TemporalSeedPass::createTextureResources(ID3D11Device* pD3DDevice, UINT canvasWidth, UINT canvasHeight)
+    {
+        HRESULT hr = S_OK;
+
+        D3D11_TEXTURE2D_DESC texDesc;
+        ZeroMemory(&texDesc, sizeof(texDesc));
+        texDesc.Width = canvasWidth;
+        texDesc.Height = canvasHeight;
+        texDesc.MipLevels = 1;
+        texDesc.ArraySize = 1;
+        texDesc.Format = DXGI_FORMAT_R16_UNORM;
+        texDesc.SampleDesc.Count = 1;
+        texDesc.SampleDesc.Quality = 0;
+        texDesc.Usage = D3D11_USAGE_DEFAULT;
+        texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        texDesc.CPUAccessFlags = 0;
+        texDesc.MiscFlags = 0;
+
+        hr = pD3DDevice->CreateTexture2D(&texDesc, nullptr, &pHistoryTexture_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        hr = pD3DDevice->CreateShaderResourceView(pHistoryTexture_, nullptr, &pHistoryResView_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        hasHistory_ = false;
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create the statistics counter buffer (raw UAV) and its staging buffers
+    //------------------------------------------------------------------------------------------------------
+    bool TemporalSeedPass::createStatisticsBuffers(ID3D11Device* pD3DDevice)
+    {
+        HRESULT hr = S_OK;
+
+        D3D11_BUFFER_DESC bufferDesc = { 0 };
+        bufferDesc.ByteWidth = STATISTICS_COUNTERS * sizeof(UINT);
+        bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+        bufferDesc.BindFlags = D3D11_BIND_UNORDERED_ACCESS;
+        bufferDesc.CPUAccessFlags = 0;
+        bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+
+        hr = pD3DDevice->CreateBuffer(&bufferDesc, nullptr, &pStatisticsBuffer_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc;
+        ZeroMemory(&uavDesc, sizeof(uavDesc));
+        uavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+        uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
+        uavDesc.Buffer.FirstElement = 0;
+        uavDesc.Buffer.NumElements = STATISTICS_COUNTERS;
+        uavDesc.Buffer.Flags = D3D11_BUFFER_UAV_FLAG_RAW;
+
+        hr = pD3DDevice->CreateUnorderedAccessView(pStatisticsBuffer_, &uavDesc, &pStatisticsUAV_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        bufferDesc.Usage = D3D11_USAGE_STAGING;
+        bufferDesc.BindFlags = 0;
+        bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        bufferDesc.MiscFlags = 0;
+        for (UINT idx = 0; idx < STATISTICS_LATENCY; idx++)
+        {
+            hr = pD3DDevice->CreateBuffer(&bufferDesc, nullptr, &pStatisticsStaging_[idx]);
+            if (FAILED(hr))
+            {
+                return false;
+            }
+            statisticsPending_[idx] = false;
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Initialize temporal seeding - create history texture and statistics buffers
+    //------------------------------------------------------------------------------------------------------
+    bool TemporalSeedPass::Initialize(ID3D11Device* pD3DDevice, UINT canvasWidth, UINT canvasHeight)
+    {
+        assert(pD3DDevice);
+
+        if (!createTextureResources(pD3DDevice, canvasWidth, canvasHeight)) return false;
+        if (!createStatisticsBuffers(pD3DDevice)) return false;
+
+        frameCounter_ = 0;
+        stats_ = TemporalSeedStats();
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Release all allocated resources
+    //------------------------------------------------------------------------------------------------------
+    void TemporalSeedPass::Release()
+    {
+        SAFE_RELEASE(pHistoryResView_);
+        SAFE_RELEASE(pHistoryTexture_);
+        SAFE_RELEASE(pStatisticsUAV_);
+        SAFE_RELEASE(pStatisticsBuffer_);
+        for (UINT idx = 0; idx < STATISTICS_LATENCY; idx++)
+        {
+            SAFE_RELEASE(pStatisticsStaging_[idx]);
+            statisticsPending_[idx] = false;
+        }
+        hasHistory_ = false;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Resize handler - recreates the history texture
+    //------------------------------------------------------------------------------------------------------
+    bool TemporalSeedPass::OnResize(ID3D11Device* pD3DDevice, UINT canvasWidth, UINT canvasHeight)
+    {
+        SAFE_RELEASE(pHistoryResView_);
+        SAFE_RELEASE(pHistoryTexture_);
+        return createTextureResources(pD3DDevice, canvasWidth, canvasHeight);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Begin a seeded frame - reset the statistics counters
+    //------------------------------------------------------------------------------------------------------
+    void TemporalSeedPass::BeginFrame(ID3D11DeviceContext* pImmediateContext)
+    {
+        const UINT zero[4] = { 0, 0, 0, 0 };
+        pImmediateContext->ClearUnorderedAccessViewUint(pStatisticsUAV_, zero);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // End a seeded frame - copy the frame to the history texture and queue the statistics for read back
+    //------------------------------------------------------------------------------------------------------
+    void TemporalSeedPass::EndFrame(ID3D11DeviceContext* pImmediateContext, ID3D11Texture2D* pFrameTexture, const XMMATRIX& matrixWVP)
+    {
+        pImmediateContext->CopyResource(pHistoryTexture_, pFrameTexture);
+        matrixHistoryWVP_ = matrixWVP;
+        hasHistory_ = true;
+
+        const UINT slot = static_cast<UINT>(frameCounter_ % STATISTICS_LATENCY);
+        if (statisticsPending_[slot])
+        {
+            // the ring is full - the oldest copy has to be read before it is overwritten
+            readStatistics(pImmediateContext);
+        }
+        pImmediateContext->CopyResource(pStatisticsStaging_[slot], pStatisticsBuffer_);
+        statisticsFrame_[slot] = frameCounter_;
+        statisticsPending_[slot] = true;
+        frameCounter_++;
+
+        // read back copies that are STATISTICS_LATENCY - 1 frames old (GPU is done with them by now)
+        const UINT oldest = static_cast<UINT>(frameCounter_ % STATISTICS_LATENCY);
+        if (statisticsPending_[oldest] && frameCounter_ - statisticsFrame_[oldest] >= STATISTICS_LATENCY - 1)
+        {
+            readStatistics(pImmediateContext);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Read back the oldest queued statistics
+    //------------------------------------------------------------------------------------------------------
+    void TemporalSeedPass::readStatistics(ID3D11DeviceContext* pImmediateContext)
+    {
+        const UINT oldest = static_cast<UINT>(frameCounter_ % STATISTICS_LATENCY);
+        if (!statisticsPending_[oldest])
+        {
+            return;
+        }
+
+        D3D11_MAPPED_SUBRESOURCE mappedResource;
+        HRESULT hr = pImmediateContext->Map(pStatisticsStaging_[oldest], 0, D3D11_MAP_READ, 0, &mappedResource);
+        if (SUCCEEDED(hr))
+        {
+            const UINT* pCounters = reinterpret_cast<const UINT*>(mappedResource.pData);
+            stats_.samplesTaken = pCounters[0];
+            stats_.samplesSkippedBySeed = pCounters[1];
+            stats_.samplesRetraced = pCounters[2];
+            stats_.raysSeeded = pCounters[3];
+            stats_.raysRetraced = pCounters[4];
+            pImmediateContext->Unmap(pStatisticsStaging_[oldest], 0);
+        }
+        statisticsPending_[oldest] = false;
+    }
+
+    bool TemporalSeedPass::HasHistory() const
+    {
+        return hasHistory_;
+    }
+
+    ID3D11ShaderResourceView* TemporalSeedPass::GetHistoryResourceView() const
+    {
+        return pHistoryResView_;
+    }
+
+    XMMATRIX TemporalSeedPass::GetHistoryMatrixWVP() const
+    {
+        return matrixHistoryWVP_;
+    }
+
+    ID3D11UnorderedAccessView* TemporalSeedPass::GetStatisticsView() const
+    {
+        return pStatisticsUAV_;
+    }
+
+    const TemporalSeedStats& TemporalSeedPass::GetStats() const
+    {
+        return stats_;
+    }
+}
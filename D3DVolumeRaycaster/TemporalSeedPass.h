@@ -0,0 +1,105 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: TemporalSeedPass.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: temporal seeding of the ray-casting pass - keeps the MIP image of the previous frame
+//          as lower bound for the rays of the current frame and collects the seeding statistics.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    // statistics of a seeded frame (counted by the seeded ray-casting pixel shader)
+    struct TemporalSeedStats
+    {
+        UINT64 samplesTaken = 0;            // volume samples taken (including re-traced rays)
+        UINT64 samplesSkippedBySeed = 0;    // samples skipped only because of the seed (brick max above the ray maximum)
+        UINT64 samplesRetraced = 0;         // samples taken again by re-traced rays
+        UINT64 raysSeeded = 0;              // rays with a positive seed
+        UINT64 raysRetraced = 0;            // rays with a maximum below their seed
+    };
+
+    class TemporalSeedPass
+    {
+    public:
+        // constructor / desctructor
+        TemporalSeedPass();
+        virtual ~TemporalSeedPass();
+
+        // avoid usage of copy constructor and =operator ...
+        TemporalSeedPass(TemporalSeedPass const&) = delete;
+        TemporalSeedPass& operator= (TemporalSeedPass const&) = delete;
+
+        // initialize temporal seeding - create history texture and statistics buffers
+        bool Initialize(ID3D11Device* pD3DDevice, UINT canvasWidth, UINT canvasHeight);
+        // release all allocated resources 
+        void Release();
+        // resize handler - recreates the history texture (the history is lost)
+        bool OnResize(ID3D11Device* pD3DDevice, UINT canvasWidth, UINT canvasHeight);
+        // begin a seeded frame - reset the statistics counters
+        void BeginFrame(ID3D11DeviceContext* pImmediateContext);
+        // end a seeded frame - keep the raw MIP image (R16, before window/level) as history of the next frame
+        // and queue the statistics counters for read back
+        void EndFrame(ID3D11DeviceContext* pImmediateContext, ID3D11Texture2D* pFrameTexture, const DirectX::XMMATRIX& matrixWVP);
+
+        // is a history image available
+        bool HasHistory() const;
+        // get resource view to the MIP image of the previous frame
+        ID3D11ShaderResourceView* GetHistoryResourceView() const;
+        // get the world-view-projection matrix the history image was rendered with
+        DirectX::XMMATRIX GetHistoryMatrixWVP() const;
+        // get unordered access view to the statistics counters
+        ID3D11UnorderedAccessView* GetStatisticsView() const;
+        // get the statistics of the latest frame read back (STATISTICS_LATENCY frames behind)
+        const TemporalSeedStats& GetStats() const;
+
+        // number of counters written by the seeded ray-casting pixel shader
+        static const UINT STATISTICS_COUNTERS = 8;
+
+    private:
+
+        // create the history texture of canvas size
+        bool createTextureResources(ID3D11Device* pD3DDevice, UINT canvasWidth, UINT canvasHeight);
+        // create the statistics counter buffer and its staging buffers
+        bool createStatisticsBuffers(ID3D11Device* pD3DDevice);
+        // read back the oldest queued statistics (without stalling on the GPU)
+        void readStatistics(ID3D11DeviceContext* pImmediateContext);
+
+        // ------------------------------------------------------------------------------------------------------------
+
+        static const UINT STATISTICS_LATENCY = 3;   // number of staging buffers for statistics read back
+
+        // MIP image of the previous frame (R16 - the precision of 16 bit volumes is kept for the seed)
+        ID3D11Texture2D*            pHistoryTexture_ = nullptr;
+        ID3D11ShaderResourceView*   pHistoryResView_ = nullptr;
+        DirectX::XMMATRIX           matrixHistoryWVP_;
+        bool                        hasHistory_ = false;
+        // statistics counters (raw buffer) and read back ring
+        ID3D11Buffer*               pStatisticsBuffer_ = nullptr;
+        ID3D11UnorderedAccessView*  pStatisticsUAV_ = nullptr;
+        ID3D11Buffer*               pStatisticsStaging_[STATISTICS_LATENCY] = { nullptr, nullptr, nullptr };
+        UINT64                      statisticsFrame_[STATISTICS_LATENCY] = { 0, 0, 0 };
+        bool                        statisticsPending_[STATISTICS_LATENCY] = { false, false, false };
+        UINT64                      frameCounter_ = 0;
+        TemporalSeedStats           stats_;
+    };
+}
@@ -0,0 +1,88 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: TripleBuffer.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: lock-free triple buffer - a single writer publishes snapshots, a single reader always
+//          takes the latest one. Neither side ever waits for the other.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    // Three slots : the writer owns the back slot, the reader owns the front slot and the middle slot holds the
+    // latest published snapshot. Publish() and Consume() swap their slot with the middle slot in one atomic
+    // exchange, so the writer can publish any number of snapshots while the reader works on an older one.
+    template <typename T>
+    class TripleBuffer
+    {
+    public:
+        // constructor / desctructor
+        TripleBuffer() = default;
+        ~TripleBuffer() = default;
+
+        // avoid usage of copy constructor and =operator ...
+        TripleBuffer(TripleBuffer const&) = delete;
+        TripleBuffer& operator= (TripleBuffer const&) = delete;
+
+        // writer : the slot to fill with the next snapshot
+        T& Back()
+        {
+            return slots_[backIdx_];
+        }
+
+        // writer : publish the back slot as the latest snapshot (replaces an unconsumed older snapshot)
+        void Publish()
+        {
+            const UINT middle = middle_.exchange(backIdx_ | FRESH_BIT, std::memory_order_acq_rel);
+            backIdx_ = middle & INDEX_MASK;
+        }
+
+        // reader : take the latest snapshot if one was published since the last call; returns false otherwise
+        // (the front slot keeps the previous snapshot)
+        bool Consume()
+        {
+            if (0 == (middle_.load(std::memory_order_relaxed) & FRESH_BIT))
+            {
+                return false;
+            }
+            const UINT middle = middle_.exchange(frontIdx_, std::memory_order_acq_rel);
+            frontIdx_ = middle & INDEX_MASK;
+            return true;
+        }
+
+        // reader : the snapshot taken by the last successful Consume()
+        const T& Front() const
+        {
+            return slots_[frontIdx_];
+        }
+
+    private:
+
+        static const UINT INDEX_MASK = 0x3;
+        static const UINT FRESH_BIT = 0x4;  // the middle slot holds a snapshot the reader has not taken yet
+
+        T                   slots_[3] = {};
+        std::atomic<UINT>   middle_ { 1 };  // index of the middle slot | FRESH_BIT
+        UINT                backIdx_ = 0;   // writer only
+        UINT                frontIdx_ = 2;  // reader only
+    };
+}
@@ -0,0 +1,232 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: VolumeLibrary.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of the VolumeLibrary functionality.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#include "stdafx.h"
+#include "VolumeLibrary.h"
+
+using namespace std;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    VolumeLibrary::VolumeLibrary()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    VolumeLibrary::~VolumeLibrary()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get a handle to the given dataset in the given storage; the dataset is loaded only if no other handle
+    // refers to it. If the dataset is resident in the same storage with another sparse threshold its voxels are
+    // shared and only the sparse voxel list is built. The file is read outside the library lock and the volume is
+    // published under it; a request for voxels that are being loaded waits for that load, so they are read once.
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeLibrary::Acquire(ID3D11Device* pD3DDevice, VOLUME_DATASET volumeDataset, VOLUME_STORAGE storage, UINT sparseThreshold, VolumeHandle& volumeHandle)
+    {
+        const VolumeKey volumeKey = { volumeDataset, storage, sparseThreshold };
+        shared_ptr<const VolumeResource> pVoxelSource;
+        {
+            unique_lock<mutex> lock(mutex_);
+            loadedCondition_.wait(lock, [this, &volumeKey]
+            {
+                return none_of(loadingVolumes_.begin(), loadingVolumes_.end(), [&volumeKey](const VolumeKey& key) { return key.SharesVoxels(volumeKey); });
+            });
+            if (findVolume(volumeKey, volumeHandle))
+            {
+                return true;
+            }
+            pVoxelSource = findVoxels(volumeKey);
+            if (pVoxelSource && pVoxelSource->GetPartitionCount() > 1)
+            {
+                // partitioned volumes have no sparse voxel list - the threshold does not matter
+                volumeHandle = VolumeHandle(move(pVoxelSource));
+                volumes_.emplace_back(volumeKey, volumeHandle.pResource_);
+                return true;
+            }
+            loadingVolumes_.push_back(volumeKey);
+        }
+
+        const VolumeDatasetInfo& datasetInfo = GetVolumeDatasetInfo(volumeDataset);
+        bool volumeLoaded = false;
+        if (pVoxelSource)
+        {
+            volumeLoaded = VolumeResource::CreateSharedVoxels(pD3DDevice, datasetInfo, *pVoxelSource, sparseThreshold, volumeHandle);
+        }
+        else
+        {
+            volumeLoaded = VolumeResource::Create(pD3DDevice, datasetInfo, 0, datasetInfo.volSlices, GetNativeVoxelFormat(datasetInfo), storage, sparseThreshold, volumeHandle);
+        }
+
+        {
+            lock_guard<mutex> lock(mutex_);
+            loadingVolumes_.erase(find(loadingVolumes_.begin(), loadingVolumes_.end(), volumeKey));
+            if (volumeLoaded)
+            {
+                volumes_.emplace_back(volumeKey, volumeHandle.pResource_);
+            }
+        }
+        loadedCondition_.notify_all();
+
+        return volumeLoaded;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get a handle to the given dataset if it is resident - lets callers choose how to load missing datasets
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeLibrary::Find(VOLUME_DATASET volumeDataset, VOLUME_STORAGE storage, UINT sparseThreshold, VolumeHandle& volumeHandle)
+    {
+        lock_guard<mutex> lock(mutex_);
+
+        const VolumeKey volumeKey = { volumeDataset, storage, sparseThreshold };
+        return findVolume(volumeKey, volumeHandle);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Check whether the voxels of the given dataset are resident in the given storage
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeLibrary::IsResident(VOLUME_DATASET volumeDataset, VOLUME_STORAGE storage)
+    {
+        lock_guard<mutex> lock(mutex_);
+
+        const VolumeKey volumeKey = { volumeDataset, storage, 0 };
+        return nullptr != findVoxels(volumeKey);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the number of resident volumes (dataset and storage pairs - the volumes of one pair share their voxels)
+    //------------------------------------------------------------------------------------------------------
+    UINT VolumeLibrary::GetResidentCount()
+    {
+        lock_guard<mutex> lock(mutex_);
+
+        vector<VolumeKey> residentVoxels;
+        for (auto& volume : volumes_)
+        {
+            if (volume.second.expired()) continue;
+            const VolumeKey& volumeKey = volume.first;
+            if (none_of(residentVoxels.begin(), residentVoxels.end(), [&volumeKey](const VolumeKey& key) { return key.SharesVoxels(volumeKey); }))
+            {
+                residentVoxels.push_back(volumeKey);
+            }
+        }
+        return static_cast<UINT>(residentVoxels.size());
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the GPU memory size of all resident volumes : the shared voxels of a dataset and storage pair are
+    // counted once, the point vertex buffer of every sparse threshold on its own
+    //------------------------------------------------------------------------------------------------------
+    size_t VolumeLibrary::GetResidentMemorySize()
+    {
+        lock_guard<mutex> lock(mutex_);
+
+        size_t memorySize = 0;
+        vector<VolumeKey> residentVoxels;
+        vector<const VolumeResource*> countedResources;
+        for (auto& volume : volumes_)
+        {
+            shared_ptr<const VolumeResource> pResource = volume.second.lock();
+            if (!pResource) continue;
+            if (find(countedResources.begin(), countedResources.end(), pResource.get()) != countedResources.end()) continue;
+            countedResources.push_back(pResource.get());
+
+            const VolumeKey& volumeKey = volume.first;
+            if (none_of(residentVoxels.begin(), residentVoxels.end(), [&volumeKey](const VolumeKey& key) { return key.SharesVoxels(volumeKey); }))
+            {
+                residentVoxels.push_back(volumeKey);
+                memorySize += pResource->GetMemorySize();
+            }
+            else
+            {
+                memorySize += pResource->GetPointBufferSize();
+            }
+        }
+        return memorySize;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get a handle to the live volume of the given key. The caller holds the library lock.
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeLibrary::findVolume(const VolumeKey& volumeKey, VolumeHandle& volumeHandle)
+    {
+        for (auto& volume : volumes_)
+        {
+            if (!(volume.first == volumeKey)) continue;
+            shared_ptr<const VolumeResource> pResource = volume.second.lock();
+            if (pResource)
+            {
+                volumeHandle = VolumeHandle(move(pResource));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get a live volume sharing the voxels of the given key (any sparse threshold); entries whose last handle
+    // was released are dropped. The caller holds the library lock.
+    //------------------------------------------------------------------------------------------------------
+    shared_ptr<const VolumeResource> VolumeLibrary::findVoxels(const VolumeKey& volumeKey)
+    {
+        shared_ptr<const VolumeResource> pVoxelSource;
+        for (auto it = volumes_.begin(); it != volumes_.end();)
+        {
+            shared_ptr<const VolumeResource> pResource = it->second.lock();
+            if (!pResource)
+            {
+                // last handle released - drop entry
+                it = volumes_.erase(it);
+                continue;
+            }
+            if (!pVoxelSource && it->first.SharesVoxels(volumeKey))
+            {
+                pVoxelSource = move(pResource);
+            }
+            ++it;
+        }
+        return pVoxelSource;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Compare two library keys
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeLibrary::VolumeKey::operator== (const VolumeKey& other) const
+    {
+        return SharesVoxels(other) && sparseThreshold == other.sparseThreshold;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Check whether two library keys refer to the same voxels (dataset and storage)
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeLibrary::VolumeKey::SharesVoxels(const VolumeKey& other) const
+    {
+        return volumeDataset == other.volumeDataset && storage == other.storage;
+    }
+}
@@ -0,0 +1,80 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: VolumeLibrary.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: include file for implementation of the VolumeLibrary functionality. Thread-safe cache
+//          of loaded volumes - every study is resident once, regardless of the number of viewers.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+#include "VolumeResource.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    class VolumeLibrary
+    {
+    public:
+        // constructor / desctructor
+        VolumeLibrary();
+        virtual ~VolumeLibrary();
+
+        // avoid usage of copy constructor and =operator ...
+        VolumeLibrary(VolumeLibrary const&) = delete;
+        VolumeLibrary& operator= (VolumeLibrary const&) = delete;
+
+        // get a handle to the given dataset in the given storage; the dataset is loaded only if no other handle refers to it.
+        // The file is read outside the library lock - Find() and IsResident() do not wait for a load.
+        bool Acquire(ID3D11Device* pD3DDevice, VOLUME_DATASET volumeDataset, VOLUME_STORAGE storage, UINT sparseThreshold, VolumeHandle& volumeHandle);
+        // get a handle to the given dataset only if it is resident (never loads)
+        bool Find(VOLUME_DATASET volumeDataset, VOLUME_STORAGE storage, UINT sparseThreshold, VolumeHandle& volumeHandle);
+        // check whether the voxels of the given dataset are resident in the given storage (for any sparse threshold) -
+        // Acquire() then only builds the sparse voxel list
+        bool IsResident(VOLUME_DATASET volumeDataset, VOLUME_STORAGE storage);
+        // get the number of resident volumes (datasets) and their GPU memory size (shared voxels counted once)
+        UINT GetResidentCount();
+        size_t GetResidentMemorySize();
+
+    private:
+
+        // the library does not keep volumes alive - a volume is released with its last handle. The volumes of one
+        // dataset and storage share their voxels; only the sparse voxel list depends on the threshold.
+        struct VolumeKey
+        {
+            VOLUME_DATASET  volumeDataset;
+            VOLUME_STORAGE  storage;
+            UINT            sparseThreshold;
+
+            bool operator== (const VolumeKey& other) const;
+            // same dataset and storage (the voxels are shared)
+            bool SharesVoxels(const VolumeKey& other) const;
+        };
+
+        // get a handle to the live entry of the given key
+        bool findVolume(const VolumeKey& volumeKey, VolumeHandle& volumeHandle);
+        // get a live entry sharing the voxels of the given key (any sparse threshold) and drop expired entries
+        std::shared_ptr<const VolumeResource> findVoxels(const VolumeKey& volumeKey);
+
+        std::mutex                                                  mutex_;
+        std::condition_variable                                     loadedCondition_;   // signalled when a load ends
+        std::vector<std::pair<VolumeKey, std::weak_ptr<const VolumeResource>>> volumes_;
+        std::vector<VolumeKey>                                      loadingVolumes_;    // loads in flight (outside the lock)
+    };
+}
@@ -0,0 +1,1487 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: VolumeResource.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of the VolumeResource functionality.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#include "stdafx.h"
+#include "VolumeResource.h"
+
+using namespace std;
+using namespace DirectX;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    //------------------------------------------------------------------------------------------------------
+    // Get file name and dimensions of the given demo volume dataset
+    //------------------------------------------------------------------------------------------------------
+    const VolumeDatasetInfo& GetVolumeDatasetInfo(VOLUME_DATASET volumeDataset)
+    {
+        static const VolumeDatasetInfo datasetInfos[] =
+        {
+            { "..\\..\\data\\CT_head_c256_r256_s225.raw", 256, 256, 225, 8, { 1.0f, 1.0f, 1.0f } },
+            { "..\\..\\data\\CTA_c512_r512_s79.raw", 512, 512, 79, 8, { 1.0f, 1.0f, 1.0f } },
+            { "..\\..\\data\\MR_abdomen_c384_r512_s80.raw", 384, 512, 80, 8, { 1.0f, 1.0f, 1.0f } },
+            { "..\\..\\data\\MR_TOF_Angio_c416_r512_s112.raw", 416, 512, 112, 8, { 1.0f, 1.0f, 1.0f } }
+        };
+        
+        UINT datasetIndex = static_cast<UINT>(volumeDataset);
+        if (datasetIndex >= ARRAYSIZE(datasetInfos))
+        {
+            // unknown dataset - fall back to MR Abdomen
+            datasetIndex = static_cast<UINT>(VOLUME_DATASET::MR_ABDOMEN);
+        }
+        return datasetInfos[datasetIndex];
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the storage format keeping the full dynamic range of the given dataset
+    //------------------------------------------------------------------------------------------------------
+    VOXEL_FORMAT GetNativeVoxelFormat(const VolumeDatasetInfo& datasetInfo)
+    {
+        return (datasetInfo.bitsStored > 8) ? VOXEL_FORMAT::UINT16 : VOXEL_FORMAT::UINT8;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    VolumeResource::VolumeResource()
+        : matrixWorld_(XMMatrixIdentity())
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    VolumeResource::~VolumeResource()
+    {
+        SAFE_RELEASE(pPointBuffer_);
+        SAFE_RELEASE(pPackedBrickDataResView_);
+        SAFE_RELEASE(pPackedBrickData_);
+        SAFE_RELEASE(pPackedBrickTableResView_);
+        SAFE_RELEASE(pPackedBrickTable_);
+        SAFE_RELEASE(pBrickMaxResView_);
+        SAFE_RELEASE(pBrickMaxTexture_);
+        SAFE_RELEASE(pShaderResView_);
+        SAFE_RELEASE(p3DTexture_);
+        sparseVolume_.Release();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Load the slab [sliceBegin, sliceEnd) of a raw volume file and create all GPU resources
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeResource::Create(
+        ID3D11Device* pD3DDevice, 
+        const VolumeDatasetInfo& datasetInfo, 
+        UINT sliceBegin, 
+        UINT sliceEnd, 
+        VOXEL_FORMAT voxelFormat, 
+        VOLUME_STORAGE storage, 
+        UINT sparseThreshold, 
+        VolumeHandle& volumeHandle)
+    {
+        return createVolume(pD3DDevice, datasetInfo, nullptr, sliceBegin, sliceEnd, voxelFormat, storage, sparseThreshold, volumeHandle);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create all GPU resources of the whole volume from volume data in memory (raw file layout)
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeResource::CreateFromMemory(
+        ID3D11Device* pD3DDevice, 
+        const VolumeDatasetInfo& datasetInfo, 
+        const vector<char>& volumeData, 
+        VOXEL_FORMAT voxelFormat, 
+        VOLUME_STORAGE storage, 
+        UINT sparseThreshold, 
+        VolumeHandle& volumeHandle)
+    {
+        return createVolume(pD3DDevice, datasetInfo, &volumeData, 0, datasetInfo.volSlices, voxelFormat, storage, sparseThreshold, volumeHandle);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create the slab [sliceBegin, sliceEnd) of the given dataset (read from its raw file or from memory)
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeResource::createVolume(
+        ID3D11Device* pD3DDevice, 
+        const VolumeDatasetInfo& datasetInfo, 
+        const vector<char>* pVolumeSource, 
+        UINT sliceBegin, 
+        UINT sliceEnd, 
+        VOXEL_FORMAT voxelFormat, 
+        VOLUME_STORAGE storage, 
+        UINT sparseThreshold, 
+        VolumeHandle& volumeHandle)
+    {
+        assert(pD3DDevice);
+
+        const UINT regionBegin[3] = { 0, 0, sliceBegin };
+        const UINT regionEnd[3] = { datasetInfo.volColumns, datasetInfo.volRows, sliceEnd };
+
+        shared_ptr<VolumeResource> pResource(new VolumeResource());
+        pResource->voxelFormat_ = voxelFormat;
+        pResource->bytesPerVoxel_ = (VOXEL_FORMAT::UINT16 == voxelFormat) ? 2 : 1;
+        pResource->storage_ = storage;
+
+        UINT partitionCounts[3];
+        calcPartitionCounts(
+            regionBegin, 
+            regionEnd, 
+            pResource->bytesPerVoxel_, 
+            (VOLUME_STORAGE::PACKED_BRICKS == storage) ? MAX_PACKED_PARTITION_BYTES : MAX_PARTITION_BYTES, 
+            partitionCounts);
+        if (1 == partitionCounts[0] * partitionCounts[1] * partitionCounts[2])
+        {
+            if (!pResource->createRegion(pD3DDevice, datasetInfo, pVolumeSource, regionBegin, regionEnd, sparseThreshold))
+            {
+                return false;
+            }
+            volumeHandle = VolumeHandle(move(pResource));
+            return true;
+        }
+
+        // the slab exceeds the 3D texture limits : split it into partitions of (nearly) equal size, each loaded with
+        // one overlap voxel on its inner sides - the partitioned resource covers the whole slab
+        for (UINT pz = 0; pz < partitionCounts[2]; pz++)
+        {
+            for (UINT py = 0; py < partitionCounts[1]; py++)
+            {
+                for (UINT px = 0; px < partitionCounts[0]; px++)
+                {
+                    const UINT partitionIdx[3] = { px, py, pz };
+                    UINT partitionBegin[3], partitionEnd[3];
+                    for (int axis = 0; axis < 3; axis++)
+                    {
+                        const UINT64 extent = regionEnd[axis] - regionBegin[axis];
+                        partitionBegin[axis] = regionBegin[axis] + static_cast<UINT>(extent * partitionIdx[axis] / partitionCounts[axis]);
+                        partitionEnd[axis] = regionBegin[axis] + static_cast<UINT>(extent * (partitionIdx[axis] + 1) / partitionCounts[axis]);
+                    }
+
+                    unique_ptr<VolumeResource> pPartition(new VolumeResource());
+                    pPartition->voxelFormat_ = voxelFormat;
+                    pPartition->bytesPerVoxel_ = pResource->bytesPerVoxel_;
+                    pPartition->storage_ = storage;
+                    if (!pPartition->createRegion(pD3DDevice, datasetInfo, pVolumeSource, partitionBegin, partitionEnd, sparseThreshold))
+                    {
+                        return false;
+                    }
+                    pResource->memorySize_ += pPartition->GetMemorySize();
+                    pResource->partitions_.push_back(move(pPartition));
+                }
+            }
+        }
+        for (int axis = 0; axis < 3; axis++)
+        {
+            pResource->dimensions_[axis] = regionEnd[axis] - regionBegin[axis];
+        }
+        pResource->matrixWorld_ = calcRegionWorldMatrix(datasetInfo, regionBegin, regionEnd);
+
+        volumeHandle = VolumeHandle(move(pResource));
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create an empty volume of the given dataset for progressive loading (see UpdateSlices). Volume texture
+    // and brick max grid are default usage resources; all voxels and bricks are 0 - slices not loaded yet
+    // are empty and their bricks are skipped.
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeResource::CreateStreamed(
+        ID3D11Device* pD3DDevice, 
+        ID3D11DeviceContext* pImmediateContext, 
+        const VolumeDatasetInfo& datasetInfo, 
+        VOXEL_FORMAT voxelFormat, 
+        shared_ptr<VolumeResource>& pResource)
+    {
+        assert(pD3DDevice && pImmediateContext);
+        HRESULT hr = S_OK;
+
+        const UINT regionBegin[3] = { 0, 0, 0 };
+        const UINT regionEnd[3] = { datasetInfo.volColumns, datasetInfo.volRows, datasetInfo.volSlices };
+
+        shared_ptr<VolumeResource> pStreamed(new VolumeResource());
+        pStreamed->voxelFormat_ = voxelFormat;
+        pStreamed->bytesPerVoxel_ = (VOXEL_FORMAT::UINT16 == voxelFormat) ? 2 : 1;
+
+        UINT partitionCounts[3];
+        calcPartitionCounts(regionBegin, regionEnd, pStreamed->bytesPerVoxel_, MAX_PARTITION_BYTES, partitionCounts);
+        if (1 != partitionCounts[0] * partitionCounts[1] * partitionCounts[2])
+        {
+            return false;
+        }
+        for (int axis = 0; axis < 3; axis++)
+        {
+            pStreamed->dimensions_[axis] = regionEnd[axis];
+            pStreamed->brickGridDimensions_[axis] = (regionEnd[axis] + MAX_BRICK_SIZE - 1) / MAX_BRICK_SIZE;
+        }
+        pStreamed->matrixWorld_ = calcRegionWorldMatrix(datasetInfo, regionBegin, regionEnd);
+
+        // volume texture (full resolution level only - the max down-sampled levels need the complete volume)
+        D3D11_TEXTURE3D_DESC texDesc { 0 };
+        texDesc.Width = pStreamed->dimensions_[0];
+        texDesc.Height = pStreamed->dimensions_[1];
+        texDesc.Depth = pStreamed->dimensions_[2];
+        texDesc.MipLevels = 1;
+        texDesc.Format = (VOXEL_FORMAT::UINT16 == voxelFormat) ? DXGI_FORMAT_R16_UNORM : DXGI_FORMAT_R8_UNORM;
+        texDesc.Usage = D3D11_USAGE_DEFAULT;
+        texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        texDesc.CPUAccessFlags = 0;
+        texDesc.MiscFlags = 0;
+        hr = pD3DDevice->CreateTexture3D(&texDesc, nullptr, &pStreamed->p3DTexture_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        hr = pD3DDevice->CreateShaderResourceView(pStreamed->p3DTexture_, nullptr, &pStreamed->pShaderResView_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        // the initial content of a default usage texture is undefined : clear it slice by slice
+        const UINT rowPitch = pStreamed->dimensions_[0] * pStreamed->bytesPerVoxel_;
+        const UINT slicePitch = rowPitch * pStreamed->dimensions_[1];
+        vector<char> emptySlice(slicePitch, 0);
+        for (UINT slice = 0; slice < pStreamed->dimensions_[2]; slice++)
+        {
+            D3D11_BOX sliceBox = { 0, 0, slice, pStreamed->dimensions_[0], pStreamed->dimensions_[1], slice + 1 };
+            pImmediateContext->UpdateSubresource(pStreamed->p3DTexture_, 0, &sliceBox, emptySlice.data(), rowPitch, slicePitch);
+        }
+        pStreamed->memorySize_ = static_cast<size_t>(slicePitch) * pStreamed->dimensions_[2];
+
+        // brick max grid
+        const UINT brickRowPitch = pStreamed->brickGridDimensions_[0] * pStreamed->bytesPerVoxel_;
+        const UINT brickSlicePitch = brickRowPitch * pStreamed->brickGridDimensions_[1];
+        pStreamed->brickMaxData_.assign(static_cast<size_t>(brickSlicePitch) * pStreamed->brickGridDimensions_[2], 0);
+
+        texDesc.Width = pStreamed->brickGridDimensions_[0];
+        texDesc.Height = pStreamed->brickGridDimensions_[1];
+        texDesc.Depth = pStreamed->brickGridDimensions_[2];
+        D3D11_SUBRESOURCE_DATA initData { 0 };
+        initData.pSysMem = pStreamed->brickMaxData_.data();
+        initData.SysMemPitch = brickRowPitch;
+        initData.SysMemSlicePitch = brickSlicePitch;
+        hr = pD3DDevice->CreateTexture3D(&texDesc, &initData, &pStreamed->pBrickMaxTexture_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        hr = pD3DDevice->CreateShaderResourceView(pStreamed->pBrickMaxTexture_, nullptr, &pStreamed->pBrickMaxResView_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        pStreamed->memorySize_ += pStreamed->brickMaxData_.size();
+
+        pResource = move(pStreamed);
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Streamed volumes : write the slices [sliceBegin, sliceEnd) to the volume texture and merge their maxima
+    // into the bricks whose apron reaches into them. Voxels only change from empty (0) to their value, so the
+    // merged maxima equal those of createBrickMaxGrid() once all slices are written.
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeResource::UpdateSlices(ID3D11DeviceContext* pImmediateContext, UINT sliceBegin, UINT sliceEnd, const char* pSliceData)
+    {
+        if (brickMaxData_.empty() || updatable_ || sliceBegin >= sliceEnd || sliceEnd > dimensions_[2])
+        {
+            // not a streamed volume or invalid slice range
+            return false;
+        }
+
+        const UINT rowPitch = dimensions_[0] * bytesPerVoxel_;
+        const UINT slicePitch = rowPitch * dimensions_[1];
+        D3D11_BOX sliceBox = { 0, 0, sliceBegin, dimensions_[0], dimensions_[1], sliceEnd };
+        pImmediateContext->UpdateSubresource(p3DTexture_, 0, &sliceBox, pSliceData, rowPitch, slicePitch);
+
+        // brick layers whose voxel range (including the apron) intersects the slices
+        const UINT layerBegin = ((sliceBegin > 0) ? sliceBegin - 1 : 0) / MAX_BRICK_SIZE;
+        const UINT layerEnd = min(sliceEnd / MAX_BRICK_SIZE + 1, brickGridDimensions_[2]);
+        if (VOXEL_FORMAT::UINT16 == voxelFormat_)
+        {
+            computeBrickMaxLayers(
+                reinterpret_cast<const UINT16*>(pSliceData), 
+                sliceBegin, 
+                sliceEnd, 
+                reinterpret_cast<UINT16*>(brickMaxData_.data()), 
+                layerBegin, 
+                layerEnd);
+        }
+        else
+        {
+            computeBrickMaxLayers(
+                reinterpret_cast<const BYTE*>(pSliceData), 
+                sliceBegin, 
+                sliceEnd, 
+                brickMaxData_.data(), 
+                layerBegin, 
+                layerEnd);
+        }
+
+        const UINT brickRowPitch = brickGridDimensions_[0] * bytesPerVoxel_;
+        const UINT brickSlicePitch = brickRowPitch * brickGridDimensions_[1];
+        D3D11_BOX brickBox = { 0, 0, layerBegin, brickGridDimensions_[0], brickGridDimensions_[1], layerEnd };
+        pImmediateContext->UpdateSubresource(
+            pBrickMaxTexture_, 
+            0, 
+            &brickBox, 
+            brickMaxData_.data() + static_cast<size_t>(brickSlicePitch) * layerBegin, 
+            brickRowPitch, 
+            brickSlicePitch);
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create an updatable volume of the given dataset : default usage volume texture (all resolution levels)
+    // and brick max grid, plus CPU copies of both for recomputing updated regions. The initial voxels are
+    // taken from volume data in memory (raw file layout) or are 0 without pVolumeSource.
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeResource::CreateUpdatable(
+        ID3D11Device* pD3DDevice, 
+        const VolumeDatasetInfo& datasetInfo, 
+        const vector<char>* pVolumeSource, 
+        VOXEL_FORMAT voxelFormat, 
+        shared_ptr<VolumeResource>& pResource)
+    {
+        assert(pD3DDevice);
+
+        const UINT regionBegin[3] = { 0, 0, 0 };
+        const UINT regionEnd[3] = { datasetInfo.volColumns, datasetInfo.volRows, datasetInfo.volSlices };
+
+        shared_ptr<VolumeResource> pUpdatable(new VolumeResource());
+        pUpdatable->voxelFormat_ = voxelFormat;
+        pUpdatable->bytesPerVoxel_ = (VOXEL_FORMAT::UINT16 == voxelFormat) ? 2 : 1;
+        pUpdatable->updatable_ = true;
+
+        UINT partitionCounts[3];
+        calcPartitionCounts(regionBegin, regionEnd, pUpdatable->bytesPerVoxel_, MAX_PARTITION_BYTES, partitionCounts);
+        if (1 != partitionCounts[0] * partitionCounts[1] * partitionCounts[2])
+        {
+            return false;
+        }
+
+        vector<char> volumeData;
+        if (pVolumeSource)
+        {
+            if (!pUpdatable->loadVolumeData(datasetInfo, pVolumeSource, regionBegin, regionEnd, volumeData))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                pUpdatable->dimensions_[axis] = regionEnd[axis];
+            }
+            pUpdatable->matrixWorld_ = calcRegionWorldMatrix(datasetInfo, regionBegin, regionEnd);
+            volumeData.assign(static_cast<size_t>(regionEnd[0]) * regionEnd[1] * regionEnd[2] * pUpdatable->bytesPerVoxel_, 0);
+        }
+
+        // no sparse voxel list - it would have to be rebuilt for the whole volume with every update
+        if (!pUpdatable->createGPUResources(pD3DDevice, volumeData))
+        {
+            return false;
+        }
+
+        pResource = move(pUpdatable);
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Updatable volumes : replace the voxels of the box [regionBegin, regionEnd) and recompute everything
+    // derived from them - the down-sampled voxels covering the box on every resolution level and the maxima
+    // of the bricks whose apron reaches into it. Only these parts are uploaded, so the cost follows the size
+    // of the box, not the size of the volume.
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeResource::UpdateRegion(
+        ID3D11DeviceContext* pImmediateContext, 
+        const UINT regionBegin[3], 
+        const UINT regionEnd[3], 
+        const char* pRegionData, 
+        size_t regionDataSize)
+    {
+        if (!updatable_ || nullptr == pRegionData)
+        {
+            return false;
+        }
+        size_t regionVoxels = 1;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            if (regionBegin[axis] >= regionEnd[axis] || regionEnd[axis] > dimensions_[axis])
+            {
+                return false;
+            }
+            regionVoxels *= regionEnd[axis] - regionBegin[axis];
+        }
+        if (regionDataSize != regionVoxels * bytesPerVoxel_)
+        {
+            // region data of another box or voxel format
+            return false;
+        }
+
+        // upload the box [boxBegin, boxEnd) of a resolution level from its CPU copy
+        auto uploadLevelBox = [this, pImmediateContext](UINT lodLevel, const UINT boxBegin[3], const UINT boxEnd[3])
+        {
+            UINT levelDimensions[3];
+            GetLevelDimensions(lodLevel, levelDimensions);
+            const size_t rowPitch = static_cast<size_t>(levelDimensions[0]) * bytesPerVoxel_;
+            const size_t slicePitch = rowPitch * levelDimensions[1];
+            D3D11_BOX levelBox = { boxBegin[0], boxBegin[1], boxBegin[2], boxEnd[0], boxEnd[1], boxEnd[2] };
+            pImmediateContext->UpdateSubresource(
+                p3DTexture_, 
+                lodLevel, 
+                &levelBox, 
+                levelData_[lodLevel].data() + slicePitch * boxBegin[2] + rowPitch * boxBegin[1] + static_cast<size_t>(boxBegin[0]) * bytesPerVoxel_, 
+                static_cast<UINT>(rowPitch), 
+                static_cast<UINT>(slicePitch));
+        };
+
+        // full resolution level : copy the rows of the box into the CPU copy
+        const size_t rowPitch = static_cast<size_t>(dimensions_[0]) * bytesPerVoxel_;
+        const size_t slicePitch = rowPitch * dimensions_[1];
+        const size_t regionRowSize = static_cast<size_t>(regionEnd[0] - regionBegin[0]) * bytesPerVoxel_;
+        const size_t regionSliceSize = regionRowSize * (regionEnd[1] - regionBegin[1]);
+        for (UINT z = regionBegin[2]; z < regionEnd[2]; z++)
+        {
+            for (UINT y = regionBegin[1]; y < regionEnd[1]; y++)
+            {
+                memcpy(
+                    levelData_[0].data() + slicePitch * z + rowPitch * y + static_cast<size_t>(regionBegin[0]) * bytesPerVoxel_, 
+                    pRegionData + regionSliceSize * (z - regionBegin[2]) + regionRowSize * (y - regionBegin[1]), 
+                    regionRowSize);
+            }
+        }
+        uploadLevelBox(0, regionBegin, regionEnd);
+
+        // resolution levels : the box of the coarser level covering the updated box of the finer level
+        UINT levelBegin[3] = { regionBegin[0], regionBegin[1], regionBegin[2] };
+        UINT levelEnd[3] = { regionEnd[0], regionEnd[1], regionEnd[2] };
+        for (UINT lodLevel = 1; lodLevel < lodLevelCount_; lodLevel++)
+        {
+            UINT sourceDimensions[3], targetDimensions[3];
+            GetLevelDimensions(lodLevel - 1, sourceDimensions);
+            GetLevelDimensions(lodLevel, targetDimensions);
+            CalcCoarserLevelBox(targetDimensions, levelBegin, levelEnd);
+            DownsampleLevel(voxelFormat_, levelData_[lodLevel - 1].data(), sourceDimensions, levelData_[lodLevel].data(), targetDimensions, levelBegin, levelEnd);
+            uploadLevelBox(lodLevel, levelBegin, levelEnd);
+        }
+
+        // bricks whose voxel range (including the apron) intersects the box - voxels may have decreased, so
+        // their maxima are recomputed from scratch
+        UINT brickBegin[3], brickEnd[3];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            brickBegin[axis] = ((regionBegin[axis] > 0) ? regionBegin[axis] - 1 : 0) / MAX_BRICK_SIZE;
+            brickEnd[axis] = min(regionEnd[axis] / MAX_BRICK_SIZE + 1, brickGridDimensions_[axis]);
+        }
+        const size_t brickRowPitch = static_cast<size_t>(brickGridDimensions_[0]) * bytesPerVoxel_;
+        const size_t brickSlicePitch = brickRowPitch * brickGridDimensions_[1];
+        for (UINT bz = brickBegin[2]; bz < brickEnd[2]; bz++)
+        {
+            for (UINT by = brickBegin[1]; by < brickEnd[1]; by++)
+            {
+                memset(
+                    brickMaxData_.data() + brickSlicePitch * bz + brickRowPitch * by + static_cast<size_t>(brickBegin[0]) * bytesPerVoxel_, 
+                    0, 
+                    static_cast<size_t>(brickEnd[0] - brickBegin[0]) * bytesPerVoxel_);
+            }
+        }
+        if (VOXEL_FORMAT::UINT16 == voxelFormat_)
+        {
+            computeBrickMaxBox(
+                reinterpret_cast<const UINT16*>(levelData_[0].data()), 
+                0, 
+                dimensions_[2], 
+                reinterpret_cast<UINT16*>(brickMaxData_.data()), 
+                brickBegin, 
+                brickEnd);
+        }
+        else
+        {
+            computeBrickMaxBox(levelData_[0].data(), 0, dimensions_[2], brickMaxData_.data(), brickBegin, brickEnd);
+        }
+        D3D11_BOX brickBox = { brickBegin[0], brickBegin[1], brickBegin[2], brickEnd[0], brickEnd[1], brickEnd[2] };
+        pImmediateContext->UpdateSubresource(
+            pBrickMaxTexture_, 
+            0, 
+            &brickBox, 
+            brickMaxData_.data() + brickSlicePitch * brickBegin[2] + brickRowPitch * brickBegin[1] + static_cast<size_t>(brickBegin[0]) * bytesPerVoxel_, 
+            static_cast<UINT>(brickRowPitch), 
+            static_cast<UINT>(brickSlicePitch));
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Load the region [regionBegin, regionEnd) of a raw volume file (or volume data in memory) and create the
+    // GPU resources of it
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeResource::createRegion(
+        ID3D11Device* pD3DDevice, 
+        const VolumeDatasetInfo& datasetInfo, 
+        const vector<char>* pVolumeSource, 
+        const UINT regionBegin[3], 
+        const UINT regionEnd[3], 
+        UINT sparseThreshold)
+    {
+        vector<char> volumeData;
+        if (!loadVolumeData(datasetInfo, pVolumeSource, regionBegin, regionEnd, volumeData))
+        {
+            return false;
+        }
+
+        // build the sparse (above-threshold) voxel list for point-based MIP rendering while raw data is available
+        // (point-based MIP is not supported for partial volumes; the splats keep 8 bit intensities)
+        const bool isPartial = (regionBegin[0] > 0 || regionBegin[1] > 0 || regionBegin[2] > 0 ||
+            regionEnd[0] < datasetInfo.volColumns || regionEnd[1] < datasetInfo.volRows || regionEnd[2] < datasetInfo.volSlices);
+        if (!isPartial)
+        {
+            buildSparseVolume(volumeData, sparseThreshold);
+        }
+
+        return createGPUResources(pD3DDevice, volumeData);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create a volume sharing the voxel storage of the given volume, with a sparse voxel list of its own for the
+    // given threshold. The GPU resources are referenced (not copied), so a new vessel threshold costs one point
+    // vertex buffer instead of a second volume texture.
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeResource::CreateSharedVoxels(
+        ID3D11Device* pD3DDevice, 
+        const VolumeDatasetInfo& datasetInfo, 
+        const VolumeResource& voxelSource, 
+        UINT sparseThreshold, 
+        VolumeHandle& volumeHandle)
+    {
+        assert(pD3DDevice);
+        assert(voxelSource.partitions_.empty() && !voxelSource.updatable_);
+
+        shared_ptr<VolumeResource> pResource(new VolumeResource());
+        pResource->p3DTexture_ = voxelSource.p3DTexture_;
+        pResource->pShaderResView_ = voxelSource.pShaderResView_;
+        pResource->pBrickMaxTexture_ = voxelSource.pBrickMaxTexture_;
+        pResource->pBrickMaxResView_ = voxelSource.pBrickMaxResView_;
+        pResource->pPackedBrickTable_ = voxelSource.pPackedBrickTable_;
+        pResource->pPackedBrickTableResView_ = voxelSource.pPackedBrickTableResView_;
+        pResource->pPackedBrickData_ = voxelSource.pPackedBrickData_;
+        pResource->pPackedBrickDataResView_ = voxelSource.pPackedBrickDataResView_;
+        IUnknown* sharedResources[] = {
+            pResource->p3DTexture_, pResource->pShaderResView_, pResource->pBrickMaxTexture_, pResource->pBrickMaxResView_, 
+            pResource->pPackedBrickTable_, pResource->pPackedBrickTableResView_, pResource->pPackedBrickData_, pResource->pPackedBrickDataResView_ };
+        for (IUnknown* pShared : sharedResources)
+        {
+            if (pShared) pShared->AddRef();
+        }
+        for (int axis = 0; axis < 3; axis++)
+        {
+            pResource->dimensions_[axis] = voxelSource.dimensions_[axis];
+            pResource->brickGridDimensions_[axis] = voxelSource.brickGridDimensions_[axis];
+            pResource->texCoordScale_[axis] = voxelSource.texCoordScale_[axis];
+            pResource->texCoordOffset_[axis] = voxelSource.texCoordOffset_[axis];
+        }
+        pResource->voxelFormat_ = voxelSource.voxelFormat_;
+        pResource->storage_ = voxelSource.storage_;
+        pResource->bytesPerVoxel_ = voxelSource.bytesPerVoxel_;
+        pResource->lodLevelCount_ = voxelSource.lodLevelCount_;
+        pResource->matrixWorld_ = voxelSource.matrixWorld_;
+        pResource->memorySize_ = voxelSource.memorySize_ - voxelSource.pointBufferSize_;
+
+        // the sparse voxel list needs the voxels of the whole volume
+        const UINT regionBegin[3] = { 0, 0, 0 };
+        const UINT regionEnd[3] = { datasetInfo.volColumns, datasetInfo.volRows, datasetInfo.volSlices };
+        vector<char> volumeData;
+        if (!pResource->loadVolumeData(datasetInfo, nullptr, regionBegin, regionEnd, volumeData))
+        {
+            return false;
+        }
+        pResource->buildSparseVolume(volumeData, sparseThreshold);
+        if (!pResource->createPointBuffer(pD3DDevice))
+        {
+            return false;
+        }
+
+        volumeHandle = VolumeHandle(move(pResource));
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Build the sparse voxel list from the voxels of the whole volume (storage format; 16 bit voxels are reduced
+    // to 8 bit intensities for the splats)
+    //------------------------------------------------------------------------------------------------------
+    void VolumeResource::buildSparseVolume(const vector<char>& volumeData, UINT sparseThreshold)
+    {
+        if (VOXEL_FORMAT::UINT16 == voxelFormat_)
+        {
+            const UINT16* pVoxels = reinterpret_cast<const UINT16*>(volumeData.data());
+            vector<char> volumeData8Bit(volumeData.size() / 2);
+            for (size_t idx = 0; idx < volumeData8Bit.size(); idx++)
+            {
+                volumeData8Bit[idx] = static_cast<char>(pVoxels[idx] >> 8);
+            }
+            sparseVolume_.Build(volumeData8Bit.data(), dimensions_[0], dimensions_[1], dimensions_[2], sparseThreshold);
+        }
+        else
+        {
+            sparseVolume_.Build(volumeData.data(), dimensions_[0], dimensions_[1], dimensions_[2], sparseThreshold);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create the point vertex buffer of the sparse voxel list (a list exceeding the size of one vertex buffer is
+    // dropped - point-based MIP is not available then)
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeResource::createPointBuffer(ID3D11Device* pD3DDevice)
+    {
+        const UINT64 pointBufferSize = static_cast<UINT64>(sizeof(SparseVoxel)) * sparseVolume_.GetVoxelCount();
+        if (pointBufferSize > MAX_PARTITION_BYTES)
+        {
+            sparseVolume_.Release();
+        }
+        else if (pointBufferSize > 0)
+        {
+            D3D11_BUFFER_DESC bufferDesc = { 0 };
+            bufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+            bufferDesc.ByteWidth = static_cast<UINT>(pointBufferSize);
+            bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+            bufferDesc.CPUAccessFlags = 0;
+
+            D3D11_SUBRESOURCE_DATA initData = { 0 };
+            initData.pSysMem = sparseVolume_.GetVoxels();
+            HRESULT hr = pD3DDevice->CreateBuffer(&bufferDesc, &initData, &pPointBuffer_);
+            if (FAILED(hr))
+            {
+                return false;
+            }
+            pointBufferSize_ = bufferDesc.ByteWidth;
+            memorySize_ += pointBufferSize_;
+        }
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the number of partitions per axis : every partition edge (plus two overlap voxels) fits the 3D texture
+    // limit, then the longest partition edge is split until the full resolution level fits maxPartitionBytes
+    //------------------------------------------------------------------------------------------------------
+    void VolumeResource::calcPartitionCounts(const UINT regionBegin[3], const UINT regionEnd[3], UINT bytesPerVoxel, UINT64 maxPartitionBytes, UINT partitionCounts[3])
+    {
+        UINT extents[3];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            extents[axis] = regionEnd[axis] - regionBegin[axis];
+            partitionCounts[axis] = (extents[axis] + MAX_PARTITION_EXTENT - 1) / MAX_PARTITION_EXTENT;
+        }
+
+        for (;;)
+        {
+            UINT64 partitionBytes = bytesPerVoxel;
+            int splitAxis = -1;
+            UINT splitExtent = 1;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                const UINT partitionExtent = (extents[axis] + partitionCounts[axis] - 1) / partitionCounts[axis];
+                partitionBytes *= partitionExtent + ((partitionCounts[axis] > 1) ? 2 : 0);
+                if (partitionExtent > splitExtent)
+                {
+                    splitAxis = axis;
+                    splitExtent = partitionExtent;
+                }
+            }
+            if (partitionBytes <= maxPartitionBytes || splitAxis < 0)
+            {
+                break;
+            }
+            partitionCounts[splitAxis]++;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the world matrix mapping the unit-cube to the region [regionBegin, regionEnd) of the full volume
+    //------------------------------------------------------------------------------------------------------
+    XMMATRIX VolumeResource::calcRegionWorldMatrix(const VolumeDatasetInfo& datasetInfo, const UINT regionBegin[3], const UINT regionEnd[3])
+    {
+        const float volDimensions[3] = 
+        { 
+            static_cast<float>(datasetInfo.volColumns), 
+            static_cast<float>(datasetInfo.volRows), 
+            static_cast<float>(datasetInfo.volSlices) 
+        };
+        const float volExtents[3] = 
+        { 
+            volDimensions[0] * datasetInfo.voxelSpacing[0], 
+            volDimensions[1] * datasetInfo.voxelSpacing[1], 
+            volDimensions[2] * datasetInfo.voxelSpacing[2] 
+        };
+
+        // scale the unit cube to volume boundaries - the extent with maximum value maps to 1.0
+        const float maxExtentValue = max(max(volExtents[0], volExtents[1]), volExtents[2]);
+        const XMMATRIX matrixScale = XMMatrixScaling(volExtents[0] / maxExtentValue, volExtents[1] / maxExtentValue, volExtents[2] / maxExtentValue);
+
+        // unit-cube -> region of the full volume
+        float regionScale[3], regionCenter[3];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            regionScale[axis] = (regionEnd[axis] - regionBegin[axis]) / volDimensions[axis];
+            regionCenter[axis] = 0.5f * (static_cast<float>(regionBegin[axis]) + static_cast<float>(regionEnd[axis])) / volDimensions[axis] - 0.5f;
+        }
+        const XMMATRIX matrixRegion = XMMatrixScaling(regionScale[0], regionScale[1], regionScale[2]) *
+            XMMatrixTranslation(regionCenter[0], regionCenter[1], regionCenter[2]);
+
+        return matrixRegion * matrixScale;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Load the region [regionBegin, regionEnd) of the volume raw data. A partial volume is extended by one
+    // overlap voxel on each inner side, which ensures seamless trilinear interpolation across slab and
+    // partition boundaries. The world matrix maps the unit-cube to the region of the (scaled) full volume and
+    // the texture coordinate transform maps the region into the loaded voxels. File offsets and sizes are
+    // 64 bit - the file may exceed 4 GiB. Volume data in memory (pVolumeSource) has the layout of the raw
+    // file. The voxels are converted to the storage format (ConvertVoxels).
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeResource::loadVolumeData(
+        const VolumeDatasetInfo& datasetInfo, 
+        const vector<char>* pVolumeSource, 
+        const UINT regionBegin[3], 
+        const UINT regionEnd[3], 
+        vector<char>& volumeData)
+    {
+        const UINT volDimensions[3] = { datasetInfo.volColumns, datasetInfo.volRows, datasetInfo.volSlices };
+        assert(datasetInfo.bitsStored >= 8 && datasetInfo.bitsStored <= 16);
+
+        UINT loadBegin[3];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            assert(regionBegin[axis] < regionEnd[axis]);
+            assert(regionEnd[axis] <= volDimensions[axis]);
+            loadBegin[axis] = (regionBegin[axis] > 0) ? regionBegin[axis] - 1 : 0;
+            const UINT loadEnd = (regionEnd[axis] < volDimensions[axis]) ? regionEnd[axis] + 1 : volDimensions[axis];
+            dimensions_[axis] = loadEnd - loadBegin[axis];
+        }
+
+        const UINT fileBytesPerVoxel = (datasetInfo.bitsStored > 8) ? 2 : 1;
+        const UINT64 rowPitch = static_cast<UINT64>(volDimensions[0]) * fileBytesPerVoxel;
+        const UINT64 slicePitch = rowPitch * volDimensions[1];
+        const UINT64 expectedSize = slicePitch * volDimensions[2];
+
+        ifstream volDataFile;
+        if (pVolumeSource)
+        {
+            if (pVolumeSource->size() != expectedSize)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            volDataFile.open(datasetInfo.fileName, ifstream::in | ifstream::binary);
+            if (!volDataFile)
+            {
+                return false;
+            }
+
+            // get length of file 
+            volDataFile.seekg(0, volDataFile.end);
+            const UINT64 length = static_cast<UINT64>(volDataFile.tellg());
+
+            // raw files of external volumes : the description given by the user has to match the file
+            if (length != expectedSize)
+            {
+                return false;
+            }
+        }
+        // read size bytes at the given offset of the raw file (or copy them from the volume data in memory)
+        auto readBlock = [pVolumeSource, &volDataFile](UINT64 offset, char* pTarget, size_t size)
+        {
+            if (pVolumeSource)
+            {
+                memcpy(pTarget, pVolumeSource->data() + offset, size);
+                return true;
+            }
+            volDataFile.seekg(static_cast<streamoff>(offset), volDataFile.beg);
+            volDataFile.read(pTarget, static_cast<streamsize>(size));
+            return !!volDataFile;
+        };
+
+        // read data block (only the voxels of the region)
+        const size_t loadRowSize = static_cast<size_t>(dimensions_[0]) * fileBytesPerVoxel;
+        const size_t loadSliceSize = loadRowSize * dimensions_[1];
+        volumeData.resize(loadSliceSize * dimensions_[2]);
+        if (dimensions_[0] == volDimensions[0] && dimensions_[1] == volDimensions[1])
+        {
+            // whole slices : one contiguous block
+            if (!readBlock(slicePitch * loadBegin[2], volumeData.data(), volumeData.size()))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            // part of the slices : read the loaded rows of every slice and keep the loaded columns
+            vector<char> rows(static_cast<size_t>(rowPitch) * dimensions_[1]);
+            for (UINT z = 0; z < dimensions_[2]; z++)
+            {
+                if (!readBlock(slicePitch * (loadBegin[2] + z) + rowPitch * loadBegin[1], rows.data(), rows.size()))
+                {
+                    return false;
+                }
+                char* pSlice = volumeData.data() + loadSliceSize * z;
+                for (UINT y = 0; y < dimensions_[1]; y++)
+                {
+                    memcpy(pSlice + loadRowSize * y, rows.data() + static_cast<size_t>(rowPitch) * y + static_cast<size_t>(loadBegin[0]) * fileBytesPerVoxel, loadRowSize);
+                }
+            }
+        }
+
+        ConvertVoxels(datasetInfo, voxelFormat_, volumeData);
+
+        matrixWorld_ = calcRegionWorldMatrix(datasetInfo, regionBegin, regionEnd);
+
+        // region -> loaded voxels (including overlap)
+        for (int axis = 0; axis < 3; axis++)
+        {
+            texCoordScale_[axis] = (regionEnd[axis] - regionBegin[axis]) / static_cast<float>(dimensions_[axis]);
+            texCoordOffset_[axis] = (regionBegin[axis] - loadBegin[axis]) / static_cast<float>(dimensions_[axis]);
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Convert voxels read from the raw file of the given dataset to the storage format : 9 .. 16 bit data fills 
+    // the 16 bit range (so the UNORM values of every bit depth span 0 .. 1), 8 bit data is expanded to 16 bit 
+    // or vice versa.
+    //------------------------------------------------------------------------------------------------------
+    void VolumeResource::ConvertVoxels(const VolumeDatasetInfo& datasetInfo, VOXEL_FORMAT voxelFormat, vector<char>& volumeData)
+    {
+        const UINT fileBytesPerVoxel = (datasetInfo.bitsStored > 8) ? 2 : 1;
+        const size_t voxelCount = volumeData.size() / fileBytesPerVoxel;
+        if (2 == fileBytesPerVoxel)
+        {
+            // 9 .. 16 bit data : shift the bits stored to the top of the word (masks unused high bits) ...
+            UINT16* pVoxels = reinterpret_cast<UINT16*>(volumeData.data());
+            const UINT shift = 16 - datasetInfo.bitsStored;
+            for (size_t idx = 0; idx < voxelCount; idx++)
+            {
+                pVoxels[idx] = static_cast<UINT16>(pVoxels[idx] << shift);
+            }
+            if (VOXEL_FORMAT::UINT8 == voxelFormat)
+            {
+                // ... and keep the high byte for 8 bit storage
+                for (size_t idx = 0; idx < voxelCount; idx++)
+                {
+                    volumeData[idx] = static_cast<char>(pVoxels[idx] >> 8);
+                }
+                volumeData.resize(voxelCount);
+            }
+        }
+        else if (VOXEL_FORMAT::UINT16 == voxelFormat)
+        {
+            // 8 bit data in 16 bit storage : v * 257 maps 255 to 65535
+            vector<char> volumeData16Bit(voxelCount * 2);
+            UINT16* pVoxels = reinterpret_cast<UINT16*>(volumeData16Bit.data());
+            for (size_t idx = 0; idx < voxelCount; idx++)
+            {
+                pVoxels[idx] = static_cast<UINT16>(static_cast<BYTE>(volumeData[idx]) * 257);
+            }
+            volumeData.swap(volumeData16Bit);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create the voxel storage (3D texture or packed bricks), point vertex buffer and brick max grid
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeResource::createGPUResources(ID3D11Device* pD3DDevice, const vector<char>& volumeData)
+    {
+        memorySize_ = 0;
+        if (VOLUME_STORAGE::PACKED_BRICKS == storage_)
+        {
+            if (!createPackedBricks(pD3DDevice, volumeData))
+            {
+                return false;
+            }
+        }
+        else if (!createVolumeTexture(pD3DDevice, volumeData))
+        {
+            return false;
+        }
+
+        // the point list of the sparse voxels
+        if (!createPointBuffer(pD3DDevice))
+        {
+            return false;
+        }
+
+        return createBrickMaxGrid(pD3DDevice, volumeData);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create 3D texture (with max down-sampled resolution levels) and its shader resource view
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeResource::createVolumeTexture(ID3D11Device* pD3DDevice, const vector<char>& volumeData)
+    {
+        HRESULT hr = S_OK;
+
+        // resolution levels : halve every dimension (down to one voxel) until MAX_LOD_LEVELS is reached
+        lodLevelCount_ = 1;
+        while (lodLevelCount_ < MAX_LOD_LEVELS)
+        {
+            UINT levelDimensions[3];
+            GetLevelDimensions(lodLevelCount_ - 1, levelDimensions);
+            if (1 == levelDimensions[0] && 1 == levelDimensions[1] && 1 == levelDimensions[2])
+            {
+                break;
+            }
+            lodLevelCount_++;
+        }
+
+        // max down-sampled levels 1 .. lodLevelCount_ - 1
+        vector<vector<BYTE>> levelData(lodLevelCount_);
+        for (UINT lodLevel = 1; lodLevel < lodLevelCount_; lodLevel++)
+        {
+            UINT sourceDimensions[3], targetDimensions[3];
+            GetLevelDimensions(lodLevel - 1, sourceDimensions);
+            GetLevelDimensions(lodLevel, targetDimensions);
+            levelData[lodLevel].resize(static_cast<size_t>(targetDimensions[0]) * targetDimensions[1] * targetDimensions[2] * bytesPerVoxel_);
+            const BYTE* pSource = (1 == lodLevel) ? reinterpret_cast<const BYTE*>(volumeData.data()) : levelData[lodLevel - 1].data();
+            const UINT targetBegin[3] = { 0, 0, 0 };
+            DownsampleLevel(voxelFormat_, pSource, sourceDimensions, levelData[lodLevel].data(), targetDimensions, targetBegin, targetDimensions);
+        }
+
+        // create 3D texture for volume data (immutable - the resource never changes after creation - unless the volume
+        // is updatable)
+        D3D11_TEXTURE3D_DESC texDesc { 0 };
+        texDesc.Width = dimensions_[0];
+        texDesc.Height = dimensions_[1];
+        texDesc.Depth = dimensions_[2];
+        texDesc.MipLevels = lodLevelCount_;
+        texDesc.Format = (VOXEL_FORMAT::UINT16 == voxelFormat_) ? DXGI_FORMAT_R16_UNORM : DXGI_FORMAT_R8_UNORM;
+        texDesc.Usage = updatable_ ? D3D11_USAGE_DEFAULT : D3D11_USAGE_IMMUTABLE;
+        texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        texDesc.CPUAccessFlags = 0;
+        texDesc.MiscFlags = 0;
+
+        // initialize texel data with loaded volume raw data (level 0) and the down-sampled levels
+        D3D11_SUBRESOURCE_DATA tex3DRawData[MAX_LOD_LEVELS];
+        for (UINT lodLevel = 0; lodLevel < lodLevelCount_; lodLevel++)
+        {
+            UINT levelDimensions[3];
+            GetLevelDimensions(lodLevel, levelDimensions);
+            tex3DRawData[lodLevel].pSysMem = (0 == lodLevel) ? static_cast<const void*>(volumeData.data()) : levelData[lodLevel].data();
+            tex3DRawData[lodLevel].SysMemPitch = levelDimensions[0] * bytesPerVoxel_;                           // -> row pitch in bytes
+            tex3DRawData[lodLevel].SysMemSlicePitch = levelDimensions[0] * levelDimensions[1] * bytesPerVoxel_; // -> slice pitch in bytes
+            memorySize_ += static_cast<size_t>(levelDimensions[0]) * levelDimensions[1] * levelDimensions[2] * bytesPerVoxel_;
+        }
+
+        hr = pD3DDevice->CreateTexture3D(&texDesc, tex3DRawData, &p3DTexture_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        hr = pD3DDevice->CreateShaderResourceView(p3DTexture_, nullptr, &pShaderResView_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        if (updatable_)
+        {
+            // updatable volume : keep all levels for recomputing the down-sampled voxels of updated regions
+            levelData[0].assign(volumeData.begin(), volumeData.end());
+            levelData_ = move(levelData);
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create the packed bricks : brick table (structured buffer of PackedBrickEntry) and packed deltas (raw
+    // buffer). The packed bricks replace the volume texture and its resolution levels - the sampler decodes
+    // the voxels, so only the full resolution level exists.
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeResource::createPackedBricks(ID3D11Device* pD3DDevice, const vector<char>& volumeData)
+    {
+        HRESULT hr = S_OK;
+
+        lodLevelCount_ = 1;
+
+        PackedBrickVolume packedBricks;
+        if (!packedBricks.Build(volumeData.data(), dimensions_, bytesPerVoxel_))
+        {
+            return false;
+        }
+        if (packedBricks.GetDataWordCount() >= (1ull << D3D11_REQ_BUFFER_RESOURCE_TEXEL_COUNT_2_TO_EXP))
+        {
+            return false;
+        }
+
+        UINT brickCount[3];
+        packedBricks.GetBrickCount(brickCount);
+        const UINT totalBricks = brickCount[0] * brickCount[1] * brickCount[2];
+
+        // brick table
+        D3D11_BUFFER_DESC bufferDesc = { 0 };
+        bufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+        bufferDesc.ByteWidth = totalBricks * sizeof(PackedBrickEntry);
+        bufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        bufferDesc.CPUAccessFlags = 0;
+        bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        bufferDesc.StructureByteStride = sizeof(PackedBrickEntry);
+
+        D3D11_SUBRESOURCE_DATA initData = { 0 };
+        initData.pSysMem = packedBricks.GetBrickTable();
+        hr = pD3DDevice->CreateBuffer(&bufferDesc, &initData, &pPackedBrickTable_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        hr = pD3DDevice->CreateShaderResourceView(pPackedBrickTable_, nullptr, &pPackedBrickTableResView_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        // packed deltas (at least one word - a volume of constant bricks has no deltas); one padding word lets
+        // the decoder always read two words
+        vector<UINT> paddedData(packedBricks.GetData(), packedBricks.GetData() + packedBricks.GetDataWordCount());
+        paddedData.push_back(0);
+
+        bufferDesc.ByteWidth = static_cast<UINT>(paddedData.size() * sizeof(UINT));
+        bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
+        bufferDesc.StructureByteStride = 0;
+        initData.pSysMem = paddedData.data();
+        hr = pD3DDevice->CreateBuffer(&bufferDesc, &initData, &pPackedBrickData_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
+        ZeroMemory(&viewDesc, sizeof(viewDesc));
+        viewDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+        viewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFEREX;
+        viewDesc.BufferEx.FirstElement = 0;
+        viewDesc.BufferEx.NumElements = static_cast<UINT>(paddedData.size());
+        viewDesc.BufferEx.Flags = D3D11_BUFFEREX_SRV_FLAG_RAW;
+        hr = pD3DDevice->CreateShaderResourceView(pPackedBrickData_, &viewDesc, &pPackedBrickDataResView_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        memorySize_ += packedBricks.GetPackedSize() + sizeof(UINT);
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Get the box of the coarser level (of the given dimensions) whose voxels cover the given box of the finer
+    // level - the box is replaced in place
+    //------------------------------------------------------------------------------------------------------
+    void VolumeResource::CalcCoarserLevelBox(const UINT targetDimensions[3], UINT levelBegin[3], UINT levelEnd[3])
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            levelBegin[axis] = min(levelBegin[axis] / 2, targetDimensions[axis] - 1);
+            levelEnd[axis] = min((levelEnd[axis] - 1) / 2 + 1, targetDimensions[axis]);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Down-sample the box [targetBegin, targetEnd) of a level in the given voxel format
+    //------------------------------------------------------------------------------------------------------
+    void VolumeResource::DownsampleLevel(
+        VOXEL_FORMAT voxelFormat, 
+        const BYTE* pSource, 
+        const UINT sourceDimensions[3], 
+        BYTE* pTarget, 
+        const UINT targetDimensions[3], 
+        const UINT targetBegin[3], 
+        const UINT targetEnd[3])
+    {
+        if (VOXEL_FORMAT::UINT16 == voxelFormat)
+        {
+            downsampleMax(
+                reinterpret_cast<const UINT16*>(pSource), 
+                sourceDimensions, 
+                reinterpret_cast<UINT16*>(pTarget), 
+                targetDimensions, 
+                targetBegin, 
+                targetEnd);
+        }
+        else
+        {
+            downsampleMax(pSource, sourceDimensions, pTarget, targetDimensions, targetBegin, targetEnd);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Down-sample a level by the maximum of 2x2x2 voxels (the last voxel of an odd dimension is added to
+    // the last target voxel, so every source voxel contributes) - computes the target voxels in the box
+    // [targetBegin, targetEnd) of the target level
+    //------------------------------------------------------------------------------------------------------
+    template <typename T>
+    void VolumeResource::downsampleMax(
+        const T* pSource, 
+        const UINT sourceDimensions[3], 
+        T* pTarget, 
+        const UINT targetDimensions[3], 
+        const UINT targetBegin[3], 
+        const UINT targetEnd[3])
+    {
+        // source voxel range of a target voxel
+        auto sourceRange = [&](UINT axis, UINT targetIdx, UINT& sourceBegin, UINT& sourceEnd)
+        {
+            sourceBegin = min(2 * targetIdx, sourceDimensions[axis] - 1);
+            sourceEnd = (targetIdx + 1 == targetDimensions[axis]) ? sourceDimensions[axis] : min(2 * targetIdx + 2, sourceDimensions[axis]);
+        };
+
+        const size_t sourceSliceSize = static_cast<size_t>(sourceDimensions[0]) * sourceDimensions[1];
+        for (UINT tz = targetBegin[2]; tz < targetEnd[2]; tz++)
+        {
+            UINT zBegin, zEnd;
+            sourceRange(2, tz, zBegin, zEnd);
+            for (UINT ty = targetBegin[1]; ty < targetEnd[1]; ty++)
+            {
+                UINT yBegin, yEnd;
+                sourceRange(1, ty, yBegin, yEnd);
+                T* pTargetRow = pTarget + (static_cast<size_t>(tz) * targetDimensions[1] + ty) * targetDimensions[0];
+                for (UINT tx = targetBegin[0]; tx < targetEnd[0]; tx++)
+                {
+                    UINT xBegin, xEnd;
+                    sourceRange(0, tx, xBegin, xEnd);
+
+                    T value = 0;
+                    for (UINT z = zBegin; z < zEnd; z++)
+                    {
+                        for (UINT y = yBegin; y < yEnd; y++)
+                        {
+                            const T* pRow = pSource + z * sourceSliceSize + static_cast<size_t>(y) * sourceDimensions[0];
+                            for (UINT x = xBegin; x < xEnd; x++)
+                            {
+                                value = max(value, pRow[x]);
+                            }
+                        }
+                    }
+                    pTargetRow[tx] = value;
+                }
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create the brick max grid: the maximum of every MAX_BRICK_SIZE^3 brick including a one voxel apron, 
+    // so that it bounds all trilinear samples taken at positions inside the brick. The grid has the voxel format
+    // of the volume, so the bound is exact for 16 bit data as well.
+    //------------------------------------------------------------------------------------------------------
+    bool VolumeResource::createBrickMaxGrid(ID3D11Device* pD3DDevice, const vector<char>& volumeData)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            brickGridDimensions_[axis] = (dimensions_[axis] + MAX_BRICK_SIZE - 1) / MAX_BRICK_SIZE;
+        }
+        const size_t brickCount = static_cast<size_t>(brickGridDimensions_[0]) * brickGridDimensions_[1] * brickGridDimensions_[2];
+        vector<BYTE> brickMax(brickCount * bytesPerVoxel_, 0);
+
+        // split brick layers over the available hardware threads
+        UINT threadCount = max(1u, min(thread::hardware_concurrency(), brickGridDimensions_[2]));
+        UINT layersPerThread = (brickGridDimensions_[2] + threadCount - 1) / threadCount;
+        vector<thread> workers;
+        for (UINT threadIdx = 0; threadIdx < threadCount; threadIdx++)
+        {
+            UINT layerBegin = threadIdx * layersPerThread;
+            UINT layerEnd = min(layerBegin + layersPerThread, brickGridDimensions_[2]);
+            if (layerBegin < layerEnd)
+            {
+                if (VOXEL_FORMAT::UINT16 == voxelFormat_)
+                {
+                    workers.emplace_back(
+                        &VolumeResource::computeBrickMaxLayers<UINT16>, 
+                        this, 
+                        reinterpret_cast<const UINT16*>(volumeData.data()), 
+                        0, 
+                        dimensions_[2], 
+                        reinterpret_cast<UINT16*>(brickMax.data()), 
+                        layerBegin, 
+                        layerEnd);
+                }
+                else
+                {
+                    workers.emplace_back(
+                        &VolumeResource::computeBrickMaxLayers<BYTE>, 
+                        this, 
+                        reinterpret_cast<const BYTE*>(volumeData.data()), 
+                        0, 
+                        dimensions_[2], 
+                        brickMax.data(), 
+                        layerBegin, 
+                        layerEnd);
+                }
+            }
+        }
+        for (auto& worker : workers) worker.join();
+
+        D3D11_TEXTURE3D_DESC texDesc { 0 };
+        texDesc.Width = brickGridDimensions_[0];
+        texDesc.Height = brickGridDimensions_[1];
+        texDesc.Depth = brickGridDimensions_[2];
+        texDesc.MipLevels = 1;
+        texDesc.Format = (VOXEL_FORMAT::UINT16 == voxelFormat_) ? DXGI_FORMAT_R16_UNORM : DXGI_FORMAT_R8_UNORM;
+        texDesc.Usage = updatable_ ? D3D11_USAGE_DEFAULT : D3D11_USAGE_IMMUTABLE;
+        texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        texDesc.CPUAccessFlags = 0;
+        texDesc.MiscFlags = 0;
+
+        D3D11_SUBRESOURCE_DATA initData { 0 };
+        initData.pSysMem = brickMax.data();
+        initData.SysMemPitch = brickGridDimensions_[0] * bytesPerVoxel_;
+        initData.SysMemSlicePitch = brickGridDimensions_[0] * brickGridDimensions_[1] * bytesPerVoxel_;
+
+        HRESULT hr = pD3DDevice->CreateTexture3D(&texDesc, &initData, &pBrickMaxTexture_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        hr = pD3DDevice->CreateShaderResourceView(pBrickMaxTexture_, nullptr, &pBrickMaxResView_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        memorySize_ += brickMax.size();
+        if (updatable_)
+        {
+            brickMaxData_ = move(brickMax);
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Compute the maxima of the brick layers [layerBegin, layerEnd) of the brick max grid over the slices
+    // [sliceBegin, sliceEnd) (pSlices points to slice sliceBegin). The maxima are merged into pBrickMax, so
+    // slices can be added one slab at a time.
+    //------------------------------------------------------------------------------------------------------
+    template <typename T>
+    void VolumeResource::computeBrickMaxLayers(const T* pSlices, UINT sliceBegin, UINT sliceEnd, T* pBrickMax, UINT layerBegin, UINT layerEnd) const
+    {
+        const UINT brickBegin[3] = { 0, 0, layerBegin };
+        const UINT brickEnd[3] = { brickGridDimensions_[0], brickGridDimensions_[1], layerEnd };
+        computeBrickMaxBox(pSlices, sliceBegin, sliceEnd, pBrickMax, brickBegin, brickEnd);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Compute the maxima of the bricks [brickBegin, brickEnd) over the slices [sliceBegin, sliceEnd) and merge
+    // them into pBrickMax
+    //------------------------------------------------------------------------------------------------------
+    template <typename T>
+    void VolumeResource::computeBrickMaxBox(
+        const T* pSlices, 
+        UINT sliceBegin, 
+        UINT sliceEnd, 
+        T* pBrickMax, 
+        const UINT brickBegin[3], 
+        const UINT brickEnd[3]) const
+    {
+        const size_t sliceSize = static_cast<size_t>(dimensions_[0]) * dimensions_[1];
+
+        // voxel range of a brick including the apron, clamped to the volume
+        auto voxelRange = [this](UINT axis, UINT brickIdx, UINT& voxelBegin, UINT& voxelEnd)
+        {
+            voxelBegin = (brickIdx * MAX_BRICK_SIZE > 0) ? brickIdx * MAX_BRICK_SIZE - 1 : 0;
+            voxelEnd = min((brickIdx + 1) * MAX_BRICK_SIZE + 1, dimensions_[axis]);
+        };
+
+        for (UINT bz = brickBegin[2]; bz < brickEnd[2]; bz++)
+        {
+            UINT zBegin, zEnd;
+            voxelRange(2, bz, zBegin, zEnd);
+            zBegin = max(zBegin, sliceBegin);
+            zEnd = min(zEnd, sliceEnd);
+            for (UINT by = brickBegin[1]; by < brickEnd[1]; by++)
+            {
+                UINT yBegin, yEnd;
+                voxelRange(1, by, yBegin, yEnd);
+                for (UINT bx = brickBegin[0]; bx < brickEnd[0]; bx++)
+                {
+                    UINT xBegin, xEnd;
+                    voxelRange(0, bx, xBegin, xEnd);
+
+                    T& brickMax = pBrickMax[(static_cast<size_t>(bz) * brickGridDimensions_[1] + by) * brickGridDimensions_[0] + bx];
+                    T value = brickMax;
+                    for (UINT z = zBegin; z < zEnd; z++)
+                    {
+                        for (UINT y = yBegin; y < yEnd; y++)
+                        {
+                            const T* pRow = pSlices + (z - sliceBegin) * sliceSize + static_cast<size_t>(y) * dimensions_[0];
+                            for (UINT x = xBegin; x < xEnd; x++)
+                            {
+                                value = max(value, pRow[x]);
+                            }
+                        }
+                    }
+                    brickMax = value;
+                }
+            }
+        }
+    }
+
+    ID3D11ShaderResourceView* VolumeResource::GetShaderResourceView() const
+    {
+        return pShaderResView_;
+    }
+
+    void VolumeResource::GetDimensions(UINT dimensions[3]) const
+    {
+        for (int idx = 0; idx < 3; idx++)
+        {
+            dimensions[idx] = dimensions_[idx];
+        }
+    }
+
+    VOXEL_FORMAT VolumeResource::GetVoxelFormat() const
+    {
+        return voxelFormat_;
+    }
+
+    VOLUME_STORAGE VolumeResource::GetStorage() const
+    {
+        return storage_;
+    }
+
+    void VolumeResource::GetPackedBrickResourceViews(ID3D11ShaderResourceView* packedBrickResViews[2]) const
+    {
+        packedBrickResViews[0] = pPackedBrickTableResView_;
+        packedBrickResViews[1] = pPackedBrickDataResView_;
+    }
+
+    UINT VolumeResource::GetLodLevelCount() const
+    {
+        return lodLevelCount_;
+    }
+
+    void VolumeResource::GetLevelDimensions(UINT lodLevel, UINT dimensions[3]) const
+    {
+        // same rule as Direct3D mip levels
+        for (int idx = 0; idx < 3; idx++)
+        {
+            dimensions[idx] = max(dimensions_[idx] >> lodLevel, 1u);
+        }
+    }
+
+    XMMATRIX VolumeResource::GetWorldMatrix() const
+    {
+        return matrixWorld_;
+    }
+
+    void VolumeResource::GetWorldBounds(float boundsMin[3], float boundsMax[3]) const
+    {
+        // the world matrix only scales and translates the unit-cube (-0.5 .. 0.5)
+        XMFLOAT3 corner0, corner1;
+        XMStoreFloat3(&corner0, XMVector3TransformCoord(XMVectorSet(-0.5f, -0.5f, -0.5f, 1.0f), matrixWorld_));
+        XMStoreFloat3(&corner1, XMVector3TransformCoord(XMVectorSet(0.5f, 0.5f, 0.5f, 1.0f), matrixWorld_));
+        boundsMin[0] = min(corner0.x, corner1.x);
+        boundsMin[1] = min(corner0.y, corner1.y);
+        boundsMin[2] = min(corner0.z, corner1.z);
+        boundsMax[0] = max(corner0.x, corner1.x);
+        boundsMax[1] = max(corner0.y, corner1.y);
+        boundsMax[2] = max(corner0.z, corner1.z);
+    }
+
+    void VolumeResource::GetTexCoordTransform(float texCoordScale[3], float texCoordOffset[3]) const
+    {
+        for (int idx = 0; idx < 3; idx++)
+        {
+            texCoordScale[idx] = texCoordScale_[idx];
+            texCoordOffset[idx] = texCoordOffset_[idx];
+        }
+    }
+
+    const SparseVolume& VolumeResource::GetSparseVolume() const
+    {
+        return sparseVolume_;
+    }
+
+    ID3D11Buffer* VolumeResource::GetPointBuffer() const
+    {
+        return pPointBuffer_;
+    }
+
+    ID3D11ShaderResourceView* VolumeResource::GetBrickMaxResourceView() const
+    {
+        return pBrickMaxResView_;
+    }
+
+    void VolumeResource::GetBrickGridDimensions(UINT brickGridDimensions[3]) const
+    {
+        for (int idx = 0; idx < 3; idx++)
+        {
+            brickGridDimensions[idx] = brickGridDimensions_[idx];
+        }
+    }
+
+    size_t VolumeResource::GetMemorySize() const
+    {
+        return memorySize_;
+    }
+
+    size_t VolumeResource::GetPointBufferSize() const
+    {
+        return pointBufferSize_;
+    }
+
+    UINT VolumeResource::GetPartitionCount() const
+    {
+        return partitions_.empty() ? 1 : static_cast<UINT>(partitions_.size());
+    }
+
+    const VolumeResource& VolumeResource::GetPartition(UINT partitionIdx) const
+    {
+        if (partitions_.empty())
+        {
+            assert(0 == partitionIdx);
+            return *this;
+        }
+        assert(partitionIdx < partitions_.size());
+        return *partitions_[partitionIdx];
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Volume handle
+    //------------------------------------------------------------------------------------------------------
+    VolumeHandle::VolumeHandle(shared_ptr<const VolumeResource> pResource)
+        : pResource_(move(pResource))
+    {
+    }
+
+    VolumeHandle VolumeHandle::Share() const
+    {
+        return VolumeHandle(pResource_);
+    }
+
+    void VolumeHandle::Reset()
+    {
+        pResource_.reset();
+    }
+
+    long VolumeHandle::GetShareCount() const
+    {
+        return pResource_.use_count();
+    }
+}
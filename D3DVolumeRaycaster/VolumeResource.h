@@ -0,0 +1,332 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: VolumeResource.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: include file for implementation of the VolumeResource functionality. Immutable volume
+//          (3D texture + acceleration data) shared by reference-counted, move-only handles.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+#include "SparseVolume.h"
+#include "PackedBrickVolume.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    // enum for identifying the volume dataset to load
+    enum class VOLUME_DATASET
+    {
+        CT_HEAD = 0,
+        CT_HEAD_ANGIO,
+        MR_ABDOMEN,
+        MR_HEAD_TOF
+    };
+
+    // GPU storage format of the voxels
+    enum class VOXEL_FORMAT
+    {
+        UINT8 = 0,      // DXGI_FORMAT_R8_UNORM
+        UINT16          // DXGI_FORMAT_R16_UNORM (12 and 16 bit CT / MR series without quantization)
+    };
+
+    // GPU storage of the full resolution voxels
+    enum class VOLUME_STORAGE
+    {
+        TEXTURE = 0,    // 3D texture with max down-sampled resolution levels (all render modes)
+        PACKED_BRICKS   // lossless packed bricks (PackedBrickVolume) decoded by the sampler - 3D MIP and point splatting only
+    };
+
+    // file name, dimensions, voxel depth and voxel spacing of a volume dataset
+    struct VolumeDatasetInfo
+    {
+        const char* fileName;
+        UINT        volColumns;
+        UINT        volRows;
+        UINT        volSlices;
+        UINT        bitsStored;     // 8 (one byte per voxel) or 9 .. 16 (little-endian 16 bit words per voxel)
+        float       voxelSpacing[3];// voxel size along columns, rows and slices (mm) - scales the world box
+    };
+
+    // get file name and dimensions of the given demo volume dataset
+    const VolumeDatasetInfo& GetVolumeDatasetInfo(VOLUME_DATASET volumeDataset);
+    // get the storage format keeping the full dynamic range of the given dataset
+    VOXEL_FORMAT GetNativeVoxelFormat(const VolumeDatasetInfo& datasetInfo);
+
+    class VolumeHandle;
+
+    class VolumeResource
+    {
+    public:
+        // edge length in voxels of a brick of the brick max grid used for empty-space skipping
+        static const UINT MAX_BRICK_SIZE = 8;
+        // maximum number of resolution levels of the volume texture (level 0 = full resolution)
+        static const UINT MAX_LOD_LEVELS = 5;
+        // maximum edge length in voxels of a partition (3D texture limit minus the overlap voxel on both sides)
+        static const UINT MAX_PARTITION_EXTENT = D3D11_REQ_TEXTURE3D_U_V_OR_W_DIMENSION - 2;
+        // maximum size in bytes of the full resolution level of a partition (including the overlap voxels)
+        static const UINT64 MAX_PARTITION_BYTES = 1ull << 30;
+        // maximum size in bytes of the full resolution level of a partition stored as packed bricks (the packed size
+        // does not exceed the raw size by more than the brick table; raw buffer views address at most 2^27 words)
+        static const UINT64 MAX_PACKED_PARTITION_BYTES = 1ull << 28;
+
+        virtual ~VolumeResource();
+
+        // avoid usage of copy constructor and =operator ...
+        VolumeResource(VolumeResource const&) = delete;
+        VolumeResource& operator= (VolumeResource const&) = delete;
+
+        // load the slab [sliceBegin, sliceEnd) of a raw volume file and create all GPU resources with the given
+        // voxel format (the data is rescaled if it differs from the file's bits stored) and storage; the resource is
+        // immutable afterwards and can be shared by any number of render sessions. A slab exceeding the 3D texture
+        // limits (MAX_PARTITION_EXTENT, MAX_PARTITION_BYTES or MAX_PACKED_PARTITION_BYTES) is split into partitions.
+        static bool Create(
+            ID3D11Device* pD3DDevice, 
+            const VolumeDatasetInfo& datasetInfo, 
+            UINT sliceBegin, 
+            UINT sliceEnd, 
+            VOXEL_FORMAT voxelFormat, 
+            VOLUME_STORAGE storage, 
+            UINT sparseThreshold, 
+            VolumeHandle& volumeHandle);
+        // create all GPU resources from volume data already in memory (raw file layout of the given dataset, e.g. an
+        // ingested DICOM series) - like Create() for the whole volume
+        static bool CreateFromMemory(
+            ID3D11Device* pD3DDevice, 
+            const VolumeDatasetInfo& datasetInfo, 
+            const std::vector<char>& volumeData, 
+            VOXEL_FORMAT voxelFormat, 
+            VOLUME_STORAGE storage, 
+            UINT sparseThreshold, 
+            VolumeHandle& volumeHandle);
+        // create a volume sharing the voxel storage, resolution levels and brick max grid of the given (whole, not
+        // partitioned) volume of the dataset, with a sparse voxel list of its own for the given threshold - the raw
+        // file is read for the sparse voxel list only
+        static bool CreateSharedVoxels(
+            ID3D11Device* pD3DDevice, 
+            const VolumeDatasetInfo& datasetInfo, 
+            const VolumeResource& voxelSource, 
+            UINT sparseThreshold, 
+            VolumeHandle& volumeHandle);
+        // create an updatable volume of the given dataset (e.g. a live acquisition) : its creator replaces regions with
+        // UpdateRegion() while the volume is rendered. The initial voxels are taken from pVolumeSource (raw file layout)
+        // or are 0 for nullptr. Updatable volumes have no sparse voxel list and are not partitioned.
+        static bool CreateUpdatable(
+            ID3D11Device* pD3DDevice, 
+            const VolumeDatasetInfo& datasetInfo, 
+            const std::vector<char>* pVolumeSource, 
+            VOXEL_FORMAT voxelFormat, 
+            std::shared_ptr<VolumeResource>& pResource);
+        // create an empty (all voxels 0) volume of the given dataset for progressive loading : its creator adds the
+        // slices with UpdateSlices() while the volume is rendered. A streamed volume has the full resolution level
+        // only and no sparse voxel list; volumes exceeding the limits of a single 3D texture are not streamed.
+        static bool CreateStreamed(
+            ID3D11Device* pD3DDevice, 
+            ID3D11DeviceContext* pImmediateContext, 
+            const VolumeDatasetInfo& datasetInfo, 
+            VOXEL_FORMAT voxelFormat, 
+            std::shared_ptr<VolumeResource>& pResource);
+        // convert voxels read from the raw file of the given dataset to the given storage format (in place)
+        static void ConvertVoxels(const VolumeDatasetInfo& datasetInfo, VOXEL_FORMAT voxelFormat, std::vector<char>& volumeData);
+        // resolution levels : replace the given box of a finer level by the box of the coarser level (of the given
+        // dimensions) whose voxels cover it
+        static void CalcCoarserLevelBox(const UINT targetDimensions[3], UINT levelBegin[3], UINT levelEnd[3]);
+        // resolution levels : max down-sample the box [targetBegin, targetEnd) of a level from the finer level (voxels
+        // of the given format)
+        static void DownsampleLevel(
+            VOXEL_FORMAT voxelFormat, 
+            const BYTE* pSource, 
+            const UINT sourceDimensions[3], 
+            BYTE* pTarget, 
+            const UINT targetDimensions[3], 
+            const UINT targetBegin[3], 
+            const UINT targetEnd[3]);
+
+        // streamed volumes : write the slices [sliceBegin, sliceEnd) (storage format) to the volume texture and raise
+        // the maxima of the bricks reaching into them
+        bool UpdateSlices(ID3D11DeviceContext* pImmediateContext, UINT sliceBegin, UINT sliceEnd, const char* pSliceData);
+        // updatable volumes : replace the voxels of the box [regionBegin, regionEnd) (storage format, x fastest) and
+        // update the resolution levels and brick maxima covering it - regionDataSize has to match the box
+        bool UpdateRegion(
+            ID3D11DeviceContext* pImmediateContext, 
+            const UINT regionBegin[3], 
+            const UINT regionEnd[3], 
+            const char* pRegionData, 
+            size_t regionDataSize);
+
+        // get the shader resource view of the volume texture (nullptr for packed bricks)
+        ID3D11ShaderResourceView* GetShaderResourceView() const;
+        // get the storage of the full resolution voxels
+        VOLUME_STORAGE GetStorage() const;
+        // get the shader resource views of the packed bricks : brick table (structured buffer) and packed deltas
+        // (raw buffer) - nullptr for texture storage
+        void GetPackedBrickResourceViews(ID3D11ShaderResourceView* packedBrickResViews[2]) const;
+        // get the dimensions of the volume texture (columns, rows, slices)
+        void GetDimensions(UINT dimensions[3]) const;
+        // get the storage format of the volume texture and the brick max grid
+        VOXEL_FORMAT GetVoxelFormat() const;
+        // get the number of resolution levels (mip levels of the volume texture; each level is the 2x2x2 maximum
+        // of the finer level, so thin bright structures survive the down-sampling)
+        UINT GetLodLevelCount() const;
+        // get the dimensions of the given resolution level
+        void GetLevelDimensions(UINT lodLevel, UINT dimensions[3]) const;
+        // get the world matrix mapping the unit-cube to the (slab of the) volume
+        DirectX::XMMATRIX GetWorldMatrix() const;
+        // get the axis-aligned box of the (slab of the) volume in world space
+        void GetWorldBounds(float boundsMin[3], float boundsMax[3]) const;
+        // get the transform of ray setup coordinates to volume texture coordinates
+        void GetTexCoordTransform(float texCoordScale[3], float texCoordOffset[3]) const;
+        // get the sparse (above-threshold) voxel list - empty for partial volumes
+        const SparseVolume& GetSparseVolume() const;
+        // get the point vertex buffer of the sparse voxel list (nullptr if empty)
+        ID3D11Buffer* GetPointBuffer() const;
+        // get the shader resource view of the brick max grid (one texel per MAX_BRICK_SIZE^3 voxel brick)
+        ID3D11ShaderResourceView* GetBrickMaxResourceView() const;
+        // get the dimensions of the brick max grid
+        void GetBrickGridDimensions(UINT brickGridDimensions[3]) const;
+        // get the GPU memory size in bytes (sum of all partitions)
+        size_t GetMemorySize() const;
+        // get the GPU memory size in bytes of the point vertex buffer (the part not shared by CreateSharedVoxels)
+        size_t GetPointBufferSize() const;
+        // get the number of partitions - 1 : the resource holds the volume texture itself; > 1 : the volume is split
+        // into sub-volumes with one voxel overlap, each a resource of its own (the partitioned resource only
+        // provides dimensions, world matrix and memory size)
+        UINT GetPartitionCount() const;
+        // get the given partition (the resource itself if it is not partitioned)
+        const VolumeResource& GetPartition(UINT partitionIdx) const;
+
+    private:
+
+        VolumeResource();
+
+        // pVolumeSource : volume data in memory (raw file layout) or nullptr to read the raw file of the dataset
+        static bool createVolume(
+            ID3D11Device* pD3DDevice, 
+            const VolumeDatasetInfo& datasetInfo, 
+            const std::vector<char>* pVolumeSource, 
+            UINT sliceBegin, 
+            UINT sliceEnd, 
+            VOXEL_FORMAT voxelFormat, 
+            VOLUME_STORAGE storage, 
+            UINT sparseThreshold, 
+            VolumeHandle& volumeHandle);
+        bool createRegion(
+            ID3D11Device* pD3DDevice, 
+            const VolumeDatasetInfo& datasetInfo, 
+            const std::vector<char>* pVolumeSource, 
+            const UINT regionBegin[3], 
+            const UINT regionEnd[3], 
+            UINT sparseThreshold);
+        bool loadVolumeData(
+            const VolumeDatasetInfo& datasetInfo, 
+            const std::vector<char>* pVolumeSource, 
+            const UINT regionBegin[3], 
+            const UINT regionEnd[3], 
+            std::vector<char>& volumeData);
+        // number of partitions per axis keeping every partition within the 3D texture limits
+        static void calcPartitionCounts(const UINT regionBegin[3], const UINT regionEnd[3], UINT bytesPerVoxel, UINT64 maxPartitionBytes, UINT partitionCounts[3]);
+        // world matrix mapping the unit-cube to the region [regionBegin, regionEnd) of the (scaled) full volume - the
+        // longest physical extent (dimensions times voxel spacing) maps to 1.0
+        static DirectX::XMMATRIX calcRegionWorldMatrix(const VolumeDatasetInfo& datasetInfo, const UINT regionBegin[3], const UINT regionEnd[3]);
+        // sparse voxel list of the whole volume (8 bit intensities) and its point vertex buffer
+        void buildSparseVolume(const std::vector<char>& volumeData, UINT sparseThreshold);
+        bool createPointBuffer(ID3D11Device* pD3DDevice);
+        bool createGPUResources(ID3D11Device* pD3DDevice, const std::vector<char>& volumeData);
+        bool createVolumeTexture(ID3D11Device* pD3DDevice, const std::vector<char>& volumeData);
+        bool createPackedBricks(ID3D11Device* pD3DDevice, const std::vector<char>& volumeData);
+        bool createBrickMaxGrid(ID3D11Device* pD3DDevice, const std::vector<char>& volumeData);
+        // voxel data is BYTE (UINT8) or UINT16 (UINT16 format)
+        template <typename T>
+        static void downsampleMax(
+            const T* pSource, 
+            const UINT sourceDimensions[3], 
+            T* pTarget, 
+            const UINT targetDimensions[3], 
+            const UINT targetBegin[3], 
+            const UINT targetEnd[3]);
+        template <typename T>
+        void computeBrickMaxLayers(const T* pSlices, UINT sliceBegin, UINT sliceEnd, T* pBrickMax, UINT layerBegin, UINT layerEnd) const;
+        template <typename T>
+        void computeBrickMaxBox(
+            const T* pSlices, 
+            UINT sliceBegin, 
+            UINT sliceEnd, 
+            T* pBrickMax, 
+            const UINT brickBegin[3], 
+            const UINT brickEnd[3]) const;
+
+        // ------------------------------------------------------------------------------------------------------------
+
+        ID3D11Texture3D*            p3DTexture_ = nullptr;
+        ID3D11ShaderResourceView*   pShaderResView_ = nullptr;
+        ID3D11Buffer*               pPointBuffer_ = nullptr;
+        ID3D11Texture3D*            pBrickMaxTexture_ = nullptr;
+        ID3D11ShaderResourceView*   pBrickMaxResView_ = nullptr;
+        ID3D11Buffer*               pPackedBrickTable_ = nullptr;
+        ID3D11ShaderResourceView*   pPackedBrickTableResView_ = nullptr;
+        ID3D11Buffer*               pPackedBrickData_ = nullptr;
+        ID3D11ShaderResourceView*   pPackedBrickDataResView_ = nullptr;
+        UINT                        dimensions_[3] = { 1, 1, 1 };
+        VOXEL_FORMAT                voxelFormat_ = VOXEL_FORMAT::UINT8;
+        VOLUME_STORAGE              storage_ = VOLUME_STORAGE::TEXTURE;
+        UINT                        bytesPerVoxel_ = 1;
+        UINT                        brickGridDimensions_[3] = { 1, 1, 1 };
+        UINT                        lodLevelCount_ = 1;
+        DirectX::XMMATRIX           matrixWorld_;
+        float                       texCoordScale_[3] = { 1.0f, 1.0f, 1.0f };
+        float                       texCoordOffset_[3] = { 0.0f, 0.0f, 0.0f };
+        SparseVolume                sparseVolume_;
+        size_t                      memorySize_ = 0;
+        size_t                      pointBufferSize_ = 0;
+        std::vector<std::unique_ptr<VolumeResource>> partitions_;   // sub-volumes of a partitioned volume (empty otherwise)
+        std::vector<BYTE>           brickMaxData_;                  // CPU copy of the brick max grid (streamed and updatable volumes)
+        std::vector<std::vector<BYTE>> levelData_;                  // CPU copies of the resolution levels (updatable volumes only)
+        bool                        updatable_ = false;
+    };
+
+    // move-only handle to a shared, immutable volume resource; additional handles are created explicitly
+    // with Share(). The resource is released with its last handle.
+    class VolumeHandle
+    {
+    public:
+        VolumeHandle() = default;
+        explicit VolumeHandle(std::shared_ptr<const VolumeResource> pResource);
+
+        VolumeHandle(VolumeHandle&&) = default;
+        VolumeHandle& operator= (VolumeHandle&&) = default;
+        VolumeHandle(VolumeHandle const&) = delete;
+        VolumeHandle& operator= (VolumeHandle const&) = delete;
+
+        // create an additional handle to the same resource
+        VolumeHandle Share() const;
+        // release the reference to the resource
+        void Reset();
+        // get the number of handles sharing the resource
+        long GetShareCount() const;
+
+        const VolumeResource* operator->() const { return pResource_.get(); }
+        const VolumeResource& operator*() const { return *pResource_; }
+        explicit operator bool() const { return nullptr != pResource_; }
+
+    private:
+
+        friend class VolumeLibrary;
+        std::shared_ptr<const VolumeResource> pResource_;
+    };
+}
@@ -0,0 +1,336 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: WindowLevelPass.cpp
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: implementation of WindowLevelPass functionality.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#include "stdafx.h"
+#include "WindowLevelPass.h"
+
+using namespace DirectX;
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    //------------------------------------------------------------------------------------------------------
+    // Compare display mappings
+    //------------------------------------------------------------------------------------------------------
+    bool DisplayMapping::operator== (const DisplayMapping& other) const
+    {
+        return windowCenter == other.windowCenter &&
+               windowWidth == other.windowWidth &&
+               gamma == other.gamma &&
+               invert == other.invert;
+    }
+
+    bool DisplayMapping::operator!= (const DisplayMapping& other) const
+    {
+        return !(*this == other);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Default constructor
+    //------------------------------------------------------------------------------------------------------
+    WindowLevelPass::WindowLevelPass()
+    {
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Destructor
+    //------------------------------------------------------------------------------------------------------
+    WindowLevelPass::~WindowLevelPass()
+    {
+        Release();
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create the full viewport vertex-shader and the window/level pixel-shader
+    //------------------------------------------------------------------------------------------------------
+    bool WindowLevelPass::createShaderObjects(ID3D11Device* pD3DDevice)
+    {
+        HRESULT hr = S_OK;
+
+        ID3DBlob* pVSBlob = nullptr;
+        hr = CompileShaderFromFile(L"WindowLevelShader.fx", "VS_FULLSCREEN", "vs_5_0", &pVSBlob);
+        if (FAILED(hr))
+        {
+            MessageBox(
+                nullptr,
+                L"The FX file WindowLevelShader.fx cannot be compiled.  Please run this executable from the directory that contains the FX file.",
+                L"Error",
+                MB_OK);
+            return false;
+        }
+
+        hr = pD3DDevice->CreateVertexShader(pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), nullptr, &pFullscreenVS_);
+        SAFE_RELEASE(pVSBlob);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        ID3DBlob* pPSBlob = nullptr;
+        hr = CompileShaderFromFile(L"WindowLevelShader.fx", "PS_WINDOW_LEVEL", "ps_5_0", &pPSBlob);
+        if (FAILED(hr))
+        {
+            MessageBox(
+                nullptr,
+                L"The FX file WindowLevelShader.fx cannot be compiled.  Please run this executable from the directory that contains the FX file.",
+                L"Error",
+                MB_OK);
+            return false;
+        }
+
+        hr = pD3DDevice->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, &pWindowLevelPS_);
+        SAFE_RELEASE(pPSBlob);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        // the full viewport triangle is drawn solid, independent of the wireframe and culling settings of the ray-casting
+        D3D11_RASTERIZER_DESC rasterizerDesc;
+        ZeroMemory(&rasterizerDesc, sizeof(rasterizerDesc));
+        rasterizerDesc.FillMode = D3D11_FILL_SOLID;
+        rasterizerDesc.CullMode = D3D11_CULL_NONE;
+        rasterizerDesc.DepthClipEnable = TRUE;
+        hr = pD3DDevice->CreateRasterizerState(&rasterizerDesc, &pSolidRS_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create the display look-up table
+    //------------------------------------------------------------------------------------------------------
+    bool WindowLevelPass::createLutResources(ID3D11Device* pD3DDevice)
+    {
+        HRESULT hr = S_OK;
+
+        D3D11_BUFFER_DESC bufferDesc = { 0 };
+        bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+        bufferDesc.ByteWidth = LUT_SIZE * sizeof(float);
+        bufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        bufferDesc.CPUAccessFlags = 0;
+
+        hr = pD3DDevice->CreateBuffer(&bufferDesc, nullptr, &pLutBuffer_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+        D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
+        ZeroMemory(&viewDesc, sizeof(viewDesc));
+        viewDesc.Format = DXGI_FORMAT_R32_FLOAT;
+        viewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+        viewDesc.Buffer.FirstElement = 0;
+        viewDesc.Buffer.NumElements = LUT_SIZE;
+        hr = pD3DDevice->CreateShaderResourceView(pLutBuffer_, &viewDesc, &pLutResView_);
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        lut_.resize(LUT_SIZE);
+        lutValid_ = false;
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Compute the display look-up table of the given mapping - four entries per iteration with the
+    // DirectXMath vector functions (SSE2), LUT_SIZE is a multiple of four
+    //------------------------------------------------------------------------------------------------------
+    void WindowLevelPass::buildLut(const DisplayMapping& displayMapping)
+    {
+        const float windowWidth = max(displayMapping.windowWidth, 1.0f / 65535.0f);
+        const float gamma = max(displayMapping.gamma, 0.01f);
+
+        // gray = ((value - center) / width + 0.5) ^ (1 / gamma) with value = index / (LUT_SIZE - 1) - the raw value
+        // of the R16 projection image itself
+        const XMVECTOR scale = XMVectorReplicate(1.0f / ((LUT_SIZE - 1) * windowWidth));
+        const XMVECTOR offset = XMVectorReplicate(0.5f - displayMapping.windowCenter / windowWidth);
+        const XMVECTOR exponent = XMVectorReplicate(1.0f / gamma);
+        const XMVECTOR step = XMVectorReplicate(4.0f);
+        XMVECTOR index = XMVectorSet(0.0f, 1.0f, 2.0f, 3.0f);
+
+        for (UINT lutIdx = 0; lutIdx < LUT_SIZE; lutIdx += 4)
+        {
+            XMVECTOR gray = XMVectorSaturate(XMVectorMultiplyAdd(index, scale, offset));
+            gray = XMVectorPow(gray, exponent);
+            if (displayMapping.invert)
+            {
+                gray = XMVectorSubtract(XMVectorSplatOne(), gray);
+            }
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&lut_[lutIdx]), gray);
+            index = XMVectorAdd(index, step);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Create the projection images of canvas size
+    //------------------------------------------------------------------------------------------------------
+    bool WindowLevelPass::createTextureResources(ID3D11Device* pD3DDevice, UINT canvasWidth, UINT canvasHeight)
+    {
+        HRESULT hr = S_OK;
+
+        D3D11_TEXTURE2D_DESC texDsc = { 0 };
+        texDsc.ArraySize = 1;
+        texDsc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+        texDsc.Usage = D3D11_USAGE_DEFAULT;
+        texDsc.Format = DXGI_FORMAT_R16_UNORM;
+        texDsc.Width = canvasWidth;
+        texDsc.Height = canvasHeight;
+        texDsc.MipLevels = 1;
+        texDsc.SampleDesc.Count = 1;
+        texDsc.CPUAccessFlags = 0;
+
+        for (UINT projection = 0; projection < PROJECTION_COUNT; projection++)
+        {
+            hr = pD3DDevice->CreateTexture2D(&texDsc, nullptr, &pProjectionTextures_[projection]);
+            if (FAILED(hr))
+            {
+                return false;
+            }
+            hr = pD3DDevice->CreateRenderTargetView(pProjectionTextures_[projection], nullptr, &pProjectionRenderTargetViews_[projection]);
+            if (FAILED(hr))
+            {
+                return false;
+            }
+            hr = pD3DDevice->CreateShaderResourceView(pProjectionTextures_[projection], nullptr, &pProjectionResViews_[projection]);
+            if (FAILED(hr))
+            {
+                return false;
+            }
+        }
+
+        imageSize_[0] = canvasWidth;
+        imageSize_[1] = canvasHeight;
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Release the projection images
+    //------------------------------------------------------------------------------------------------------
+    void WindowLevelPass::releaseTextureResources()
+    {
+        for (UINT projection = 0; projection < PROJECTION_COUNT; projection++)
+        {
+            SAFE_RELEASE(pProjectionResViews_[projection]);
+            SAFE_RELEASE(pProjectionRenderTargetViews_[projection]);
+            SAFE_RELEASE(pProjectionTextures_[projection]);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Initialize the window/level pass - create Direct3D resources
+    //------------------------------------------------------------------------------------------------------
+    bool WindowLevelPass::Initialize(ID3D11Device* pD3DDevice, UINT canvasWidth, UINT canvasHeight)
+    {
+        assert(pD3DDevice);
+        assert(canvasWidth > 0);
+        assert(canvasHeight > 0);
+
+        if (!createShaderObjects(pD3DDevice)) return false;
+        if (!createLutResources(pD3DDevice)) return false;
+        if (!createTextureResources(pD3DDevice, canvasWidth, canvasHeight)) return false;
+
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Release all allocated resources 
+    //------------------------------------------------------------------------------------------------------
+    void WindowLevelPass::Release()
+    {
+        releaseTextureResources();
+        SAFE_RELEASE(pSolidRS_);
+        SAFE_RELEASE(pLutResView_);
+        SAFE_RELEASE(pLutBuffer_);
+        lutValid_ = false;
+        SAFE_RELEASE(pWindowLevelPS_);
+        SAFE_RELEASE(pFullscreenVS_);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Resize handler - recreates the projection images
+    //------------------------------------------------------------------------------------------------------
+    bool WindowLevelPass::OnResize(ID3D11Device* pD3DDevice, UINT canvasWidth, UINT canvasHeight)
+    {
+        releaseTextureResources();
+        return createTextureResources(pD3DDevice, canvasWidth, canvasHeight);
+    }
+
+    //------------------------------------------------------------------------------------------------------
+    // Map the given projection image to the render target
+    //------------------------------------------------------------------------------------------------------
+    void WindowLevelPass::Resolve(ID3D11DeviceContext* pDeviceContext, ID3D11RenderTargetView* pRenderTargetView, const DisplayMapping& displayMapping, UINT projection)
+    {
+        assert(projection < PROJECTION_COUNT);
+
+        // display parameters changed : rebuild and upload the table (256 KB), the projection images stay untouched
+        if (!lutValid_ || displayMapping != lutMapping_)
+        {
+            buildLut(displayMapping);
+            pDeviceContext->UpdateSubresource(pLutBuffer_, 0, nullptr, lut_.data(), 0, 0);
+            lutMapping_ = displayMapping;
+            lutValid_ = true;
+        }
+
+        D3D11_VIEWPORT viewPort;
+        viewPort.Width = static_cast<FLOAT>(imageSize_[0]);
+        viewPort.Height = static_cast<FLOAT>(imageSize_[1]);
+        viewPort.MinDepth = 0.0f;
+        viewPort.MaxDepth = 1.0f;
+        viewPort.TopLeftX = 0;
+        viewPort.TopLeftY = 0;
+        pDeviceContext->RSSetViewports(1, &viewPort);
+        pDeviceContext->RSSetState(pSolidRS_);
+
+        // binding the target unbinds the projection images from the Output-Merger stage before they are read
+        pDeviceContext->OMSetRenderTargets(1, &pRenderTargetView, nullptr);
+        pDeviceContext->IASetInputLayout(nullptr);
+        pDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        pDeviceContext->VSSetShader(pFullscreenVS_, nullptr, 0);
+        pDeviceContext->PSSetShader(pWindowLevelPS_, nullptr, 0);
+        ID3D11ShaderResourceView* resolveResView[2] = { pProjectionResViews_[projection], pLutResView_ };
+        pDeviceContext->PSSetShaderResources(0, 2, resolveResView);
+        pDeviceContext->Draw(3, 0);
+
+        // unbind - the projection images are the render targets of the next frame
+        ID3D11ShaderResourceView* nullResView[2] = { nullptr, nullptr };
+        pDeviceContext->PSSetShaderResources(0, 2, nullResView);
+    }
+
+    ID3D11RenderTargetView* const* WindowLevelPass::GetProjectionRenderTargetViews() const
+    {
+        return pProjectionRenderTargetViews_;
+    }
+
+    ID3D11RenderTargetView* WindowLevelPass::GetMipRenderTargetView() const
+    {
+        return pProjectionRenderTargetViews_[0];
+    }
+
+    ID3D11Texture2D* WindowLevelPass::GetMipTexture() const
+    {
+        return pProjectionTextures_[0];
+    }
+}
@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: WindowLevelPass.h
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: C++
+//
+// Descrip: include file for implementation of the WindowLevelPass functionality. Keeps the raw
+//          projection images of a frame (R16 - MIP, MinIP, AIP) and maps one of them to display
+//          gray values after the ray-casting through a look-up table built from the display mapping.
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+#pragma once
+
+#include "stdafx.h"
+
+namespace D3D11_VOLUME_RAYCASTER
+{
+    // mapping of the raw MIP values to display gray values - display parameters only, changing them
+    // never requires the volume to be traversed again
+    struct DisplayMapping
+    {
+        float   windowCenter = 0.5f;    // MIP value mapped to mid gray (0.0 .. 1.0 = full range of the voxel format)
+        float   windowWidth = 1.0f;     // MIP value range mapped to black .. white
+        float   gamma = 1.0f;           // gray = windowed value ^ (1 / gamma) - gamma > 1 brightens the mid tones
+        bool    invert = false;         // white for low, black for high MIP values
+
+        bool operator== (const DisplayMapping& other) const;
+        bool operator!= (const DisplayMapping& other) const;
+    };
+
+    class WindowLevelPass
+    {
+    public:
+        // constructor / desctructor
+        WindowLevelPass();
+        virtual ~WindowLevelPass();
+
+        // avoid usage of copy constructor and =operator ...
+        WindowLevelPass(WindowLevelPass const&) = delete;
+        WindowLevelPass& operator= (WindowLevelPass const&) = delete;
+
+        // number of projection images : 0 = MIP (maximum), 1 = MinIP (minimum), 2 = AIP (average intensity)
+        static const UINT PROJECTION_COUNT = 3;
+
+        // initialize the window/level pass - create shaders and the projection images of canvas size
+        bool Initialize(ID3D11Device* pD3DDevice, UINT canvasWidth, UINT canvasHeight);
+        // release all allocated resources 
+        void Release();
+        // resize handler - recreates the projection images
+        bool OnResize(ID3D11Device* pD3DDevice, UINT canvasWidth, UINT canvasHeight);
+        // map the given projection image to the render target (full viewport draw, sets its own pipeline state) -
+        // the look-up table is rebuilt if the display mapping has changed since the last resolve
+        void Resolve(ID3D11DeviceContext* pDeviceContext, ID3D11RenderTargetView* pRenderTargetView, const DisplayMapping& displayMapping, UINT projection);
+        // get the render target views of the projection images (targets of the ray-casting, PROJECTION_COUNT views)
+        ID3D11RenderTargetView* const* GetProjectionRenderTargetViews() const;
+        // get the render target view of the MIP image
+        ID3D11RenderTargetView* GetMipRenderTargetView() const;
+        // get the MIP image texture
+        ID3D11Texture2D* GetMipTexture() const;
+
+    private:
+
+        // create the full viewport vertex-shader and the window/level pixel-shader
+        bool createShaderObjects(ID3D11Device* pD3DDevice);
+        // create the display look-up table
+        bool createLutResources(ID3D11Device* pD3DDevice);
+        // compute the display look-up table of the given mapping (four entries per iteration)
+        void buildLut(const DisplayMapping& displayMapping);
+        // create the projection images of canvas size
+        bool createTextureResources(ID3D11Device* pD3DDevice, UINT canvasWidth, UINT canvasHeight);
+        // release the projection images
+        void releaseTextureResources();
+
+        // ------------------------------------------------------------------------------------------------------------
+
+        ID3D11VertexShader*         pFullscreenVS_ = nullptr;
+        ID3D11PixelShader*          pWindowLevelPS_ = nullptr;
+        ID3D11RasterizerState*      pSolidRS_ = nullptr;
+        // display look-up table : one gray value per value of the 16 bit projection images, so any window - however
+        // narrow - is applied exactly (a typed buffer, the table exceeds the 1D texture size limit)
+        static const UINT           LUT_SIZE = 65536;
+        ID3D11Buffer*               pLutBuffer_ = nullptr;
+        ID3D11ShaderResourceView*   pLutResView_ = nullptr;
+        std::vector<float>          lut_;
+        DisplayMapping              lutMapping_;        // mapping of the uploaded table
+        bool                        lutValid_ = false;
+        // raw projection images (R16 - the precision of 16 bit volumes is kept until the window is applied)
+        ID3D11Texture2D*            pProjectionTextures_[PROJECTION_COUNT] = { nullptr, nullptr, nullptr };
+        ID3D11RenderTargetView*     pProjectionRenderTargetViews_[PROJECTION_COUNT] = { nullptr, nullptr, nullptr };
+        ID3D11ShaderResourceView*   pProjectionResViews_[PROJECTION_COUNT] = { nullptr, nullptr, nullptr };
+        UINT                        imageSize_[2] = { 0, 0 };
+    };
+}
@@ -0,0 +1,62 @@
+//------------------------------------------------------------------------------------------------------
+//
+// Project: Direct3D 11 based Volume Ray-Caster (3D MIP rendering mode)
+//    File: WindowLevelShader.fx
+// Version: 1.0
+//  Author: B. Kidalka
+//    Date: 2026-10-18
+//
+//    Lang: HLSL
+//
+// Descrip: vertex- and pixel-shader mapping a raw projection image to display gray values through the
+//          display look-up table (window/level, gamma, inversion).
+//
+//------------------------------------------------------------------------------------------------------
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//------------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------
+// Texture Variables
+//--------------------------------------------------------------------------------------
+Texture2D<float> texMipImage : register(t0);    // raw projection values - MIP, MinIP or AIP (0.0 .. 1.0 = full range of the voxel format)
+Buffer<float> bufDisplayLut : register(t1);     // display gray value of every 16 bit raw value
+
+//--------------------------------------------------------------------------------------
+// Structs defining shader stage outputs
+//--------------------------------------------------------------------------------------
+struct VS_OUTPUT
+{
+    float4 Pos : SV_POSITION;
+};
+
+//--------------------------------------------------------------------------------------
+// Vertex Shader - one triangle covering the viewport (no vertex buffer, vertex id 0 .. 2)
+//--------------------------------------------------------------------------------------
+VS_OUTPUT VS_FULLSCREEN(uint vertexId : SV_VertexID)
+{
+    VS_OUTPUT output = (VS_OUTPUT)0;
+    float2 corner = float2((vertexId << 1) & 2, vertexId & 2);
+    output.Pos = float4(corner * float2(2.0, -2.0) + float2(-1.0, 1.0), 0.0, 1.0);
+    return output;
+}
+
+//--------------------------------------------------------------------------------------
+// Pixel Shader - the display mapping is applied once per pixel to the maximum found by the
+// ray, so changing the window only repeats this pass. The look-up table has one entry per
+// value of the R16 projection image, so the raw value indexes it exactly.
+//--------------------------------------------------------------------------------------
+float4 PS_WINDOW_LEVEL(VS_OUTPUT input) : SV_Target
+{
+    float value = texMipImage.Load(int3(input.Pos.xy, 0));
+    uint lutIdx = (uint)(saturate(value) * 65535.0 + 0.5);
+    float gray = bufDisplayLut.Load(lutIdx);
+    return float4(gray, gray, gray, 1.0);
+}
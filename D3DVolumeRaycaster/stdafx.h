@@ -29,6 +29,7 @@
 #define WIN32_LEAN_AND_MEAN             // exclude rarely-used stuff from Windows headers
 // Windows Header Files
 #include <windows.h>
+#include <shellapi.h>
 // DirectX SDK ... 
 #include <d3d11.h>
 #include <d3dcompiler.h>
@@ -36,7 +37,24 @@
 #include <directxcolors.h>
 // standard includes
 #include <memory>
+#include <cmath>
+#include <cfloat>
 #include <fstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <list>
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
+// SSE2 intrinsics
+#include <emmintrin.h>
 
 
 namespace D3D11_VOLUME_RAYCASTER